@@ -0,0 +1,76 @@
+-- Makes sure that the multi-threaded animation update path produces the same bone poses as the serial one
+local mdlName = "player/soldier"
+local numEntities = 32
+local numSteps = 20
+local dt = 1.0 / 60.0
+local epsilon = 0.0001
+
+local mdl = game.load_model(mdlName)
+if mdl == nil then
+	return false, "Failed to load model '" .. mdlName .. "'!"
+end
+local numAnims = mdl:GetAnimationCount()
+if numAnims == 0 then
+	return false, "Model '" .. mdlName .. "' has no animations!"
+end
+
+local function run_animations(multiThreaded)
+	console.run("sh_animation_update_multithreaded", multiThreaded and "1" or "0")
+	local entities = {}
+	for i = 1, numEntities do
+		local ent = ents.create("entity")
+		ent:AddComponent(ents.COMPONENT_MODEL)
+		local animC = ent:AddComponent(ents.COMPONENT_ANIMATED)
+		ent:SetModel(mdlName)
+		ent:Spawn()
+		animC:PlayAnimation((i - 1) % numAnims)
+		table.insert(entities, ent)
+	end
+
+	for i = 1, numSteps do
+		game.update_animations(dt)
+	end
+
+	local poses = {}
+	for _, ent in ipairs(entities) do
+		local animC = ent:GetComponent(ents.COMPONENT_ANIMATED)
+		local entPoses = {}
+		for boneId = 0, animC:GetBoneCount() - 1 do
+			table.insert(entPoses, animC:GetBonePose(boneId))
+		end
+		table.insert(poses, entPoses)
+		ent:Remove()
+	end
+	return poses
+end
+
+local function is_equal(a, b)
+	local posA = a:GetOrigin()
+	local posB = b:GetOrigin()
+	local rotA = a:GetRotation()
+	local rotB = b:GetRotation()
+	return math.abs(posA.x - posB.x) < epsilon
+		and math.abs(posA.y - posB.y) < epsilon
+		and math.abs(posA.z - posB.z) < epsilon
+		and math.abs(rotA.w - rotB.w) < epsilon
+		and math.abs(rotA.x - rotB.x) < epsilon
+		and math.abs(rotA.y - rotB.y) < epsilon
+		and math.abs(rotA.z - rotB.z) < epsilon
+end
+
+local multiThreadedEnabled = console.get_convar_bool("sh_animation_update_multithreaded")
+local posesSerial = run_animations(false)
+local posesParallel = run_animations(true)
+console.run("sh_animation_update_multithreaded", multiThreadedEnabled and "1" or "0")
+
+for entIdx, entPoses in ipairs(posesSerial) do
+	for boneIdx, pose in ipairs(entPoses) do
+		local posePar = posesParallel[entIdx][boneIdx]
+		if posePar == nil or is_equal(pose, posePar) == false then
+			return false,
+				"Bone pose mismatch for entity " .. entIdx .. ", bone " .. (boneIdx - 1) .. " between serial and multi-threaded animation update!"
+		end
+	end
+end
+
+return true
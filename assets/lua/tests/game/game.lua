@@ -1,3 +1,4 @@
 include("/tests/base.lua")
 
 tests.queue("tests/game/create_entity.lua")
+tests.queue("tests/game/animation_update_multithreaded.lua")
@@ -15,6 +15,7 @@
 #include "pragma/rendering/game_world_shader_settings.hpp"
 #include "pragma/game/c_game.h"
 #include "pragma/audio/c_alsound.h"
+#include <optional>
 
 #undef PlaySound
 
@@ -37,12 +38,17 @@ struct DLLCLIENT ServerInfo {
 	void SetDownloadPath(const std::string &path);
 };
 
+namespace pragma::networking {
+	struct ResourceHashJob;
+};
 struct DLLCLIENT ResourceDownload {
-	ResourceDownload(VFilePtrReal file, std::string name, unsigned int size)
+	ResourceDownload(VFilePtrReal file, std::string name, uint64_t size, std::optional<std::string> hash, uint64_t offset = 0)
 	{
 		this->file = file;
 		this->name = name;
 		this->size = size;
+		this->hash = hash;
+		this->offset = offset;
 	}
 	~ResourceDownload()
 	{
@@ -51,7 +57,12 @@ struct DLLCLIENT ResourceDownload {
 	}
 	VFilePtrReal file;
 	std::string name;
-	unsigned int size;
+	uint64_t size;
+	std::optional<std::string> hash; // Has no value if the server was unable to hash the file, in which case it isn't verified
+	uint64_t offset; // Number of bytes received so far
+	uint32_t failedAttempts = 0; // Number of times the received file didn't match the server's hash
+	bool awaitingResend = false; // A nack has been sent, fragments are dropped until the server has rewound to 'offset'
+	std::shared_ptr<pragma::networking::ResourceHashJob> verifyJob; // Set while the received file is being hashed
 };
 
 class CLNetMessage;
@@ -85,7 +96,17 @@ class DLLCLIENT ClientState : public NetworkState {
   private:
 	std::unique_ptr<pragma::networking::IClient> m_client;
 	std::unique_ptr<ServerInfo> m_svInfo;
-	std::unique_ptr<ResourceDownload> m_resDownload; // Current resource file being downloaded
+	std::unordered_map<uint32_t, std::unique_ptr<ResourceDownload>> m_resDownloads; // Resource files currently being downloaded, by transfer id
+	// Announced resources for which a local file of the same size exists, which is being hashed to determine whether a download is required
+	struct PendingResourceInfo {
+		uint32_t transferId = 0;
+		std::string file;
+		std::string fileDst;
+		uint64_t size = 0;
+		std::string hash;
+		std::shared_ptr<pragma::networking::ResourceHashJob> localHashJob;
+	};
+	std::vector<PendingResourceInfo> m_pendingResourceInfos;
 
 	unsigned int GetServerMessageID(std::string identifier);
 	unsigned int GetServerConVarID(std::string scmd);
@@ -209,6 +230,12 @@ class DLLCLIENT ClientState : public NetworkState {
 	void HandleClientReceiveServerInfo(NetPacket &packet);
 	void HandleClientResource(NetPacket &packet);
 	void HandleClientResourceFragment(NetPacket &packet);
+	void SendResourceInfoResponse(uint32_t transferId, bool send, uint64_t resumeOffset = 0);
+	void BeginResourceDownload(uint32_t transferId, const std::string &file, const std::string &fileDst, uint64_t size, const std::optional<std::string> &hash);
+	// Called once the received file has been verified (or if there is no hash to verify it against)
+	void FinishResourceDownload(uint32_t transferId, bool hashMatches);
+	// Polls the hash jobs of pending resources and downloads
+	void UpdateResourceHashJobs();
 
 	void HandleLuaNetPacket(NetPacket &packet);
 
@@ -19,6 +19,7 @@ namespace pragma {
 		CBotComponent(BaseEntity &ent) : BaseBotComponent(ent) {}
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual void InitializeLuaObject(lua_State *l) override;
 	  protected:
 		void OnFootStep(BaseCharacterComponent::FootType foot);
@@ -18,6 +18,7 @@ namespace pragma {
 		CFlashlightComponent(BaseEntity &ent) : BaseFlashlightComponent(ent) {}
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual void InitializeLuaObject(lua_State *l) override;
 	};
 };
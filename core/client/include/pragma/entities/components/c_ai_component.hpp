@@ -31,6 +31,7 @@ namespace pragma {
 		virtual ~CAIComponent() override;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual bool ShouldTransmitNetData() const override { return false; }
 		virtual void ReceiveSnapshotData(NetPacket &packet) override;
 	};
@@ -10,6 +10,7 @@
 
 #include "pragma/clientdefinitions.h"
 #include <pragma/entities/components/base_bvh_component.hpp>
+#include <pragma/entities/components/hitbox_bvh_data.hpp>
 #include "pragma/entities/components/hitbox_mesh_bvh_builder.hpp"
 
 class Model;
@@ -95,18 +96,6 @@ namespace pragma {
 	};
 
 	namespace bvh {
-		struct DLLCLIENT HitboxObb {
-			HitboxObb(const Vector3 &min, const Vector3 &max);
-			pragma::bvh::BBox ToBvhBBox(const umath::ScaledTransform &pose, Vector3 &outOrigin) const;
-			umath::ScaledTransform GetPose(const std::vector<umath::ScaledTransform> &effectivePoses) const;
-			Vector3 position; // Position relative to bone
-			Vector3 halfExtents;
-			Vector3 min;
-			Vector3 max;
-
-			pragma::animation::BoneId boneId = std::numeric_limits<pragma::animation::BoneId>::max();
-		};
-
 		struct DLLCLIENT ObbBvhTree : public pragma::bvh::BvhTree {
 			struct DLLCLIENT HitData {
 				size_t primitiveIndex;
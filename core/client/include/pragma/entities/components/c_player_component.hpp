@@ -41,6 +41,7 @@ namespace pragma {
 		virtual void OnUnCrouch() override;
 		virtual void SetLocalPlayer(bool b) override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		void UpdateObserverOffset();
 		virtual void SetObserverMode(OBSERVERMODE mode) override;
@@ -22,6 +22,7 @@ namespace pragma {
 		virtual void OnTick(double dt) override;
 		virtual void ReceiveData(NetPacket &packet) override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual Bool ReceiveNetEvent(UInt32 eventId, NetPacket &p) override;
 		virtual bool ShouldTransmitNetData() const override { return true; }
 		virtual void OnEntitySpawn() override;
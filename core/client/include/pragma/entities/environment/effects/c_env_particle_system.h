@@ -14,6 +14,7 @@
 #include "pragma/particlesystem/c_particle.h"
 #include "pragma/rendering/c_alpha_mode.hpp"
 #include "pragma/particlesystem/c_particlemodifier.h"
+#include "pragma/particlesystem/c_particle_streams.hpp"
 #include <mathutil/transform.hpp>
 #include <fsys/vfileptr.h>
 #include <optional>
@@ -128,6 +129,7 @@ namespace pragma {
 		virtual void OnRemove() override;
 		virtual ~CParticleSystemComponent() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual void ReceiveData(NetPacket &packet) override;
 		virtual void SetRemoveOnComplete(bool b) override;
 		virtual void InitializeLuaObject(lua_State *l) override;
@@ -335,6 +337,8 @@ namespace pragma {
 		util::WeakHandle<CParticleSystemComponent> m_hParent = {};
 		std::vector<Node> m_nodes;
 		std::vector<CParticle> m_particles;
+		// Only valid during the simulation
+		pragma::ParticleStreams m_particleStreams;
 		std::vector<std::size_t> m_sortedParticleIndices;
 		std::vector<std::size_t> m_particleIndicesToBufferIndices;
 		std::vector<std::size_t> m_bufferIndicesToParticleIndices;
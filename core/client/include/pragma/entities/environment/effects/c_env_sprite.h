@@ -23,6 +23,7 @@ namespace pragma {
 		virtual void ReceiveData(NetPacket &packet) override;
 		virtual void OnTick(double dt) override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		void SetOrientationType(CParticleSystemComponent::OrientationType orientationType);
 		virtual void StartParticle();
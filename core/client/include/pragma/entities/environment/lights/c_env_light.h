@@ -72,6 +72,7 @@ namespace pragma {
 		virtual void ReceiveData(NetPacket &packet) override;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		virtual Bool ReceiveNetEvent(pragma::NetEventId eventId, NetPacket &packet) override;
 
@@ -24,6 +24,7 @@
 #include <pragma/input/inkeys.h>
 #include <mathutil/color.h>
 #include <pragma/util/bulletinfo.h>
+#include <pragma/networking/snapshot_delta.hpp>
 #include <queue>
 #include <wgui/wihandle.h>
 #include <sharedutils/property/util_property.hpp>
@@ -504,6 +505,11 @@ class DLLCLIENT CGame : public Game {
 		std::array<double, std::numeric_limits<decltype(lastInMessageId)>::max() + 1> messageTimestamps;
 	};
 	MessagePacketTracker m_snapshotTracker;
+	// Decoded entity states of the last received snapshots, used as baselines for delta-compressed snapshots
+	pragma::networking::SnapshotBaselineBuffer m_snapshotBaselines;
+	// Set if a delta snapshot referenced an unknown baseline, until the requested full snapshot has arrived
+	bool m_fullSnapshotRequested = false;
+	pragma::networking::SnapshotQuantizer m_snapshotQuantizer;
 	MessagePacketTracker m_userInputTracker;
 	std::vector<double> m_lostPackets;
 	void UpdateLostPackets();
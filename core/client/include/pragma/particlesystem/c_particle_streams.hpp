@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __C_PARTICLE_STREAMS_HPP__
+#define __C_PARTICLE_STREAMS_HPP__
+
+#include "pragma/clientdefinitions.h"
+#include <mathutil/uvec.h>
+#include <mathutil/umath.h>
+#include <vector>
+#include <array>
+#include <cinttypes>
+
+class CParticle;
+namespace pragma {
+	enum class ParticleStream : uint8_t {
+		PositionX = 0u,
+		PositionY,
+		PositionZ,
+		VelocityX,
+		VelocityY,
+		VelocityZ,
+		Life,
+		TimeAlive,
+		ColorR,
+		ColorG,
+		ColorB,
+		ColorA,
+		Radius,
+
+		Count
+	};
+
+	// Groups of streams which are read from and written to the particles together
+	enum class ParticleStreamFlags : uint8_t {
+		None = 0u,
+		Position = 1u,
+		Velocity = Position << 1u,
+		Life = Velocity << 1u,
+		TimeAlive = Life << 1u,
+		Color = TimeAlive << 1u,
+		Radius = Color << 1u,
+
+		All = Position | Velocity | Life | TimeAlive | Color | Radius
+	};
+
+	// A range of the particle streams. Every stream has 'count' consecutive elements.
+	struct DLLCLIENT ParticleBatch {
+		float *GetStream(ParticleStream stream) const { return streams[static_cast<size_t>(stream)]; }
+		std::array<float *, static_cast<size_t>(ParticleStream::Count)> streams {};
+		// Index of the particle in the particle system for every element
+		const uint32_t *particleIndices = nullptr;
+		uint32_t count = 0;
+	};
+
+	// Structure-of-arrays copy of the simulated state of all living particles of a particle system.
+	// The streams are laid out contiguously so that batch operators can process them with vectorized loops.
+#pragma warning(push)
+#pragma warning(disable : 4251)
+	class DLLCLIENT ParticleStreams {
+	  public:
+		// Copies all particles with a remaining lifetime into the streams
+		void Gather(const std::vector<CParticle> &particles, uint32_t numParticles);
+		// Re-reads the specified streams of the previously gathered particles
+		void Refresh(const std::vector<CParticle> &particles, ParticleStreamFlags streams = ParticleStreamFlags::All);
+		// Writes the specified streams back to the particles they were gathered from
+		void Scatter(std::vector<CParticle> &particles, ParticleStreamFlags streams = ParticleStreamFlags::All) const;
+		uint32_t GetCount() const;
+		ParticleBatch GetBatch(uint32_t start, uint32_t end);
+		ParticleBatch GetBatch();
+	  private:
+		std::array<std::vector<float>, static_cast<size_t>(ParticleStream::Count)> m_streams;
+		std::vector<uint32_t> m_particleIndices;
+		uint32_t m_count = 0;
+	};
+#pragma warning(pop)
+
+	// Common stream operations for batch operators
+	namespace particle_batch {
+		DLLCLIENT void add_velocity(ParticleBatch &batch, const Vector3 &v);
+		DLLCLIENT void scale_velocity(ParticleBatch &batch, float scale);
+	};
+};
+
+REGISTER_BASIC_BITWISE_OPERATORS(pragma::ParticleStreamFlags)
+
+#endif
@@ -9,6 +9,7 @@
 #define __C_PARTICLEMODIFIER_H__
 
 #include "pragma/particlesystem/c_particle.h"
+#include "pragma/particlesystem/c_particle_streams.hpp"
 #include <unordered_map>
 #include <cmaterial.h>
 
@@ -81,6 +82,13 @@ class DLLCLIENT CParticleOperator : public CParticleModifier {
 	virtual void PostSimulate(CParticle &particle, double tDelta);
 	virtual void Simulate(double tDelta);
 	virtual void Simulate(CParticle &particle, double tDelta, float strength);
+	// Operators which support batch simulation are applied to the particle streams of the particle system instead of
+	// being invoked for every particle individually. PreSimulate and PostSimulate are not called for these operators.
+	virtual bool SupportsBatchSimulation() const;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta);
+	// Streams which may be changed by Simulate or SimulateBatch. When switching between batch and per-particle operators,
+	// only these streams are written back to or re-read from the particles.
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	float CalcStrength(float curTime) const;
   private:
@@ -95,6 +103,9 @@ class DLLCLIENT CParticleOperatorLifespanDecay : public CParticleOperator {
   public:
 	CParticleOperatorLifespanDecay() = default;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 };
 
 ///////////////////////
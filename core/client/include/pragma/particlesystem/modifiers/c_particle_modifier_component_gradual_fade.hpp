@@ -26,6 +26,10 @@ class DLLCLIENT CParticleModifierComponentGradualFade : public CParticleModifier
 	// Returns the eased fade fraction
 	float GetEasedFadeFraction(CParticle &p) const;
 	bool GetEasedFadeFraction(CParticle &p, float &outFraction) const;
+	// Returns true if the fade times are the same for all particles, in which case the fade fraction only
+	// depends on the time alive and lifespan of the particle
+	bool IsFadeTimeConstant() const;
+	bool GetEasedFadeFraction(float timeAlive, float lifeSpan, float &outFraction) const;
   private:
 	CParticleModifierComponentRandomVariable<std::uniform_real_distribution<float>, float> m_fStart;
 	CParticleModifierComponentRandomVariable<std::uniform_real_distribution<float>, float> m_fEnd;
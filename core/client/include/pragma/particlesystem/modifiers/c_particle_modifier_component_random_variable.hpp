@@ -33,6 +33,8 @@ class DLLCLIENT CParticleModifierComponentRandomVariable {
 	T GetMin() const;
 	T GetMax() const;
 	bool IsSet() const;
+	// Returns true if the variable evaluates to the same value for all particles
+	bool IsConstant() const;
   private:
 	uint32_t m_iSeed = umath::random_int(0u, std::numeric_limits<uint32_t>::max());
 	TUniformDis m_value = TUniformDis(T(0), T(0));
@@ -116,4 +118,10 @@ T CParticleModifierComponentRandomVariable<TUniformDis, T>::GetMax() const
 	return m_value.max();
 }
 
+template<class TUniformDis, typename T>
+bool CParticleModifierComponentRandomVariable<TUniformDis, T>::IsConstant() const
+{
+	return m_value.min() == m_value.max();
+}
+
 #endif
@@ -20,6 +20,7 @@ class DLLCLIENT CParticleModifierComponentTime {
 	CParticleModifierComponentTime() = default;
 	void Initialize(const std::string &prefix, const std::unordered_map<std::string, std::string> &values);
 	float GetTime(float t, CParticle &p) const;
+	float GetTime(float t, float lifeSpan) const;
   private:
 	bool m_bLifetimeFraction = false;
 };
@@ -18,6 +18,7 @@ class DLLCLIENT CParticleOperatorColorFade : public CParticleOperator, public CP
 	CParticleOperatorColorFade() = default;
 	virtual void Simulate(CParticle &particle, double, float strength) override;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 	virtual void OnParticleCreated(CParticle &particle) override;
   private:
 	CParticleModifierComponentRandomColor m_colorStart;
@@ -15,7 +15,10 @@ class DLLCLIENT CParticleOperatorGravity : public CParticleOperatorWorldBase {
 	CParticleOperatorGravity() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   protected:
 	float m_gravityScale = 1.f;
 	Vector3 m_gravityForce = {0.f, -1.f, 0.f};
@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorTextureScrolling : public CParticleOperator {
 	CParticleOperatorTextureScrolling() = default;
 	virtual void Simulate(CParticle &particle, double, float strength) override;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 	virtual void OnParticleCreated(CParticle &particle) override;
   private:
 	void SetFrameOffset(CParticle &particle, Vector2 uv);
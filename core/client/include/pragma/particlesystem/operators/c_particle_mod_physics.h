@@ -31,6 +31,7 @@ class DLLCLIENT CParticleOperatorPhysics : public CParticleOperator {
 	virtual void OnParticleSystemStopped() override;
 	virtual void PreSimulate(CParticle &particle, double) override;
 	virtual void PostSimulate(CParticle &particle, double) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 };
 
 class DLLCLIENT CParticleOperatorPhysicsSphere : public CParticleOperatorPhysics {
@@ -16,6 +16,9 @@ class DLLCLIENT CParticleOperatorRadiusFadeBase : public CParticleOperator, publ
   public:
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 	virtual void OnParticleCreated(CParticle &particle) override;
   protected:
 	CParticleOperatorRadiusFadeBase(const std::string &identifier);
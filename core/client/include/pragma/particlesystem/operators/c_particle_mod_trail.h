@@ -19,6 +19,7 @@ class DLLCLIENT CParticleOperatorTrail : public CParticleOperator {
 	CParticleOperatorTrail() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 };
 
 #endif
@@ -18,6 +18,9 @@ class DLLCLIENT CParticleOperatorVelocity : public CParticleOperator {
 	CParticleOperatorVelocity() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 	float GetSpeed() const;
 };
 
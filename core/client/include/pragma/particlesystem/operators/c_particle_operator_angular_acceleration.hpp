@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorAngularAcceleration : public CParticleOperator
 	CParticleOperatorAngularAcceleration() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   private:
 	Vector3 m_vAcceleration = {};
 };
@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorAnimationPlayback : public CParticleOperator {
 	CParticleOperatorAnimationPlayback() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   private:
 	float m_playbackSpeed = 1.f;
 };
@@ -15,7 +15,10 @@ class DLLCLIENT CParticleOperatorCylindricalVortex : public CParticleOperatorWor
 	CParticleOperatorCylindricalVortex() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   private:
 	Vector3 m_vAxis = {0.f, 1.f, 0.f};
 	float m_fStrength = 2.f;
@@ -25,6 +28,7 @@ class DLLCLIENT CParticleOperatorCylindricalVortex : public CParticleOperatorWor
 	Vector3 m_dtOrigin = {};
 	Vector3 m_dtAxis = {};
 	Quat m_dtRotation = uquat::identity();
+	Mat3 m_dtRotationMatrix {1.f};
 };
 
 #endif
@@ -15,6 +15,7 @@ class DLLCLIENT CParticleOperatorJitter : public CParticleOperatorWander {
 	CParticleOperatorJitter() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 };
 
 #endif
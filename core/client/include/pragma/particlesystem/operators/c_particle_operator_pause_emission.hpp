@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorPauseEmissionBase : public CParticleOperator {
   public:
 	virtual void Simulate(double tDelta) override;
 	virtual void OnParticleSystemStarted() override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   protected:
 	CParticleOperatorPauseEmissionBase() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
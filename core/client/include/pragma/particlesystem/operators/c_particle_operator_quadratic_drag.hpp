@@ -16,7 +16,10 @@ class DLLCLIENT CParticleOperatorQuadraticDrag : public CParticleOperator {
 	CParticleOperatorQuadraticDrag() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   private:
 	float m_fAmount = 1.f;
 	float m_fTickDrag = 1.f;
@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorRandomEmissionRate : public CParticleOperator {
 	CParticleOperatorRandomEmissionRate() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 	virtual void OnParticleSystemStarted() override;
   private:
 	float GetInterval() const;
@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorToroidalVortex : public CParticleOperatorWorldB
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   private:
 	Vector3 m_vAxis = {0.f, 1.f, 0.f};
 	float m_fHeight = 1.f;
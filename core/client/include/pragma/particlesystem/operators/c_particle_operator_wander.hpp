@@ -16,6 +16,7 @@ class DLLCLIENT CParticleOperatorWander : public CParticleOperatorWorldBase {
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
 	virtual void OnParticleCreated(CParticle &particle) override;
   protected:
 	std::vector<int32_t> m_hashCodes;
@@ -16,7 +16,10 @@ class DLLCLIENT CParticleOperatorWind : public CParticleOperator {
 	CParticleOperatorWind() = default;
 	virtual void Initialize(pragma::CParticleSystemComponent &pSystem, const std::unordered_map<std::string, std::string> &values) override;
 	virtual void Simulate(CParticle &particle, double tDelta, float strength) override;
+	virtual bool SupportsBatchSimulation() const override;
+	virtual void SimulateBatch(pragma::ParticleBatch &batch, double tDelta) override;
 	virtual void Simulate(double tDelta) override;
+	virtual pragma::ParticleStreamFlags GetWrittenStreams() const override;
   private:
 	bool m_bRotateWithEmitter = false;
 	float m_fStrength = 2.f;
@@ -36,6 +36,9 @@ namespace pragma {
 		bool m_bLockCurrentNode = false;
 
 		const util::BSPTree::Node *m_pCurrentNode = nullptr;
+		// Decompressed visibility row of the current cluster
+		std::vector<uint8_t> m_currentClusterVisibility;
+		util::BSPTree::ClusterIndex m_currentCluster = std::numeric_limits<util::BSPTree::ClusterIndex>::max();
 	};
 };
 
@@ -11,6 +11,7 @@
 #include "pragma/clientdefinitions.h"
 #include "pragma/entities/c_baseentity.h"
 #include "pragma/model/c_modelmesh.h"
+#include <pragma/util/job_system.hpp>
 #include <cmaterialmanager.h>
 #include <shader/prosper_shader.hpp>
 
@@ -86,9 +87,12 @@ namespace pragma::rendering {
 		~RenderQueue();
 		void Clear();
 		void Reserve();
+		// Items added from a worker of the job system are appended to a buffer owned by that worker without any locking.
+		// They are moved into the queue by Sort, so the queue must be sorted before it is used.
 		void Add(const std::vector<RenderQueueItem> &items);
 		void Add(const RenderQueueItem &item);
 		void Add(CBaseEntity &ent, RenderMeshIndex meshIdx, CMaterial &mat, prosper::PipelineID pipelineId, const CCameraComponent *optCam = nullptr);
+		// Rebuilds the sorted item indices from the sorting keys of the queue items (stable radix sort)
 		void Sort();
 		void Merge(const RenderQueue &other);
 		const std::string &GetName() const { return m_name; }
@@ -102,7 +106,11 @@ namespace pragma::rendering {
 		bool IsComplete() const;
 	  private:
 		RenderQueue(std::string name);
+		void MergeWorkerItems();
 
+		JobSystem &m_jobSystem;
+		std::vector<std::vector<RenderQueueItem>> m_workerItems;
+		RenderQueueSortList m_sortBuffer;
 		std::atomic<bool> m_locked = false;
 		mutable std::condition_variable m_threadWaitCondition {};
 		mutable std::mutex m_threadWaitMutex {};
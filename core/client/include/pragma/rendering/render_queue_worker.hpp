@@ -9,17 +9,19 @@
 #define __RENDER_QUEUE_WORKER_HPP__
 
 #include "pragma/clientdefinitions.h"
+#include <pragma/util/job_system.hpp>
 #include <queue>
 #include <vector>
 #include <mutex>
 #include <atomic>
-#include <thread>
 
 #undef AddJob
 
 struct RenderQueueWorkerStats;
 namespace pragma::rendering {
 	class RenderQueueWorker;
+	// Distributes the render queue jobs over the workers of the engine job system. Every RenderQueueWorker is a lane which
+	// runs as a single job at a time, so the number of workers limits how many jobs are executed concurrently.
 	class RenderQueueWorkerManager {
 	  public:
 		using Job = std::function<void(void)>;
@@ -38,32 +40,31 @@ namespace pragma::rendering {
 		const RenderQueueWorker &GetWorker(uint32_t i) const;
 	  private:
 		friend RenderQueueWorker;
+		JobSystem &m_jobSystem;
+		JobSystem::SubsystemId m_subsystem = JobSystem::DEFAULT_SUBSYSTEM;
 		std::vector<std::shared_ptr<RenderQueueWorker>> m_workers;
 		std::queue<Job> m_pendingJobs;
 
 		std::queue<Job> m_readyJobs;
-		std::condition_variable m_readyJobCondition;
-		std::atomic<bool> m_workAvailable = false;
-		std::atomic<uint32_t> m_numThreadsWorking = 0;
+		uint32_t m_numWorkersActive = 0;
 		std::mutex m_readyJobMutex;
 
 		std::condition_variable m_workCompleteCondition;
-		std::mutex m_workCompleteMutex;
 		uint32_t m_numJobsPerBatch = 2;
 	};
 
 	class RenderQueueWorker {
 	  public:
 		RenderQueueWorker(RenderQueueWorkerManager &manager);
-		~RenderQueueWorker();
 
 		void SetStats(RenderQueueWorkerStats *stats);
-		void Stop();
 	  private:
-		void StartThread();
-		std::thread m_thread;
+		friend RenderQueueWorkerManager;
+		// Executes batches of ready jobs until there are none left
+		void Run();
 		RenderQueueWorkerManager &m_manager;
-		std::atomic<bool> m_running = true;
+		// Guarded by the ready job mutex of the manager
+		bool m_active = false;
 		RenderQueueWorkerStats *m_stats = nullptr;
 	};
 };
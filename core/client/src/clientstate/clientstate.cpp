@@ -72,7 +72,7 @@ DLLCLIENT ClientState *client = NULL;
 extern CGame *c_game;
 
 std::vector<std::string> &get_required_game_textures();
-ClientState::ClientState() : NetworkState(), m_client(nullptr), m_svInfo(nullptr), m_resDownload(nullptr), m_volMaster(1.f), m_hMainMenu(), m_luaGUI(NULL)
+ClientState::ClientState() : NetworkState(), m_client(nullptr), m_svInfo(nullptr), m_volMaster(1.f), m_hMainMenu(), m_luaGUI(NULL)
 {
 	client = this;
 	m_soundScriptManager = std::make_unique<CSoundScriptManager>();
@@ -508,6 +508,7 @@ void ClientState::Think()
 		if(m_client->IsDisconnected() == true)
 			Disconnect();
 	}
+	UpdateResourceHashJobs();
 }
 
 void ClientState::Tick() { NetworkState::Tick(); }
@@ -574,6 +575,8 @@ void ClientState::DestroyClient()
 {
 	m_client = nullptr;
 	m_svInfo = nullptr;
+	m_resDownloads.clear(); // Partial downloads remain on disk and will be resumed on the next connect
+	m_pendingResourceInfos.clear();
 }
 
 bool ClientState::IsConnected() const { return (m_client != nullptr) ? true : false; }
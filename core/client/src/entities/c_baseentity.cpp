@@ -190,7 +190,7 @@ void CBaseEntity::Initialize()
 	BaseEntity::Initialize();
 	std::string className;
 	g_ClientEntityFactories->GetClassName(typeid(*this), &className);
-	m_className = pragma::ents::register_class_name(className);
+	SetClass(className);
 }
 
 void CBaseEntity::DoSpawn()
@@ -38,6 +38,11 @@ void CBotComponent::Initialize()
 		return util::EventReply::Unhandled;
 	});
 }
+void CBotComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseBotComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_FOOT_STEP);
+}
 util::EventReply CBotComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseBotComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -45,6 +45,13 @@ void CFlashlightComponent::Initialize()
 	});
 }
 
+void CFlashlightComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseFlashlightComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
+
 util::EventReply CFlashlightComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseFlashlightComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -228,12 +228,9 @@ void CWorldComponent::BuildOfflineRenderQueues(bool rebuild)
 	auto &meshesPerClusters = m_meshesPerCluster;
 	if(meshesPerClusters.empty()) {
 		meshesPerClusters.resize(numClusters);
-		auto fAddClusterMesh = [&meshesPerClusters](util::BSPTree::ClusterIndex clusterIndex, RenderMeshIndex meshIdx) {
-			auto &clusterMeshes = meshesPerClusters.at(clusterIndex);
-			if(clusterMeshes.size() == clusterMeshes.capacity())
-				clusterMeshes.reserve(clusterMeshes.size() * 1.1 + 100);
-			clusterMeshes.push_back(meshIdx);
-		};
+		// Clusters every render mesh is located in
+		std::vector<std::pair<RenderMeshIndex, std::vector<util::BSPTree::ClusterIndex>>> meshClusters;
+		meshClusters.reserve(renderMeshes.size());
 		for(auto meshIdx = decltype(renderMeshes.size()) {0u}; meshIdx < renderMeshes.size(); ++meshIdx) {
 			auto &subMesh = renderMeshes.at(meshIdx);
 			auto it = subMeshToMesh.find(subMesh.get());
@@ -241,33 +238,35 @@ void CWorldComponent::BuildOfflineRenderQueues(bool rebuild)
 				continue;
 			auto *mesh = it->second;
 			auto meshClusterIdx = mesh->GetReferenceId();
+			std::vector<util::BSPTree::ClusterIndex> clusters;
 			if(meshClusterIdx == std::numeric_limits<uint32_t>::max()) {
 				// Probably a displacement, which don't have a single cluster associated with them.
 				// We'll have to determine which clusters they belong to manually.
 				Vector3 min, max;
 				mesh->GetBounds(min, max);
 				auto leafNodes = m_bspTree->FindLeafNodesInAabb(min, max);
-				std::unordered_set<util::BSPTree::ClusterIndex> clusters;
 				for(auto *node : leafNodes) {
-					auto meshClusterIdx = node->cluster;
-					if(meshClusterIdx == std::numeric_limits<util::BSPTree::ClusterIndex>::max())
+					if(node->cluster == std::numeric_limits<util::BSPTree::ClusterIndex>::max() || std::find(clusters.begin(), clusters.end(), node->cluster) != clusters.end())
 						continue;
-					for(auto clusterIdx = decltype(numClusters) {0u}; clusterIdx < numClusters; ++clusterIdx) {
-						if(m_bspTree->IsClusterVisible(clusterIdx, meshClusterIdx) == false)
-							continue;
-						auto it = clusters.find(clusterIdx);
-						if(it != clusters.end())
-							continue;
-						clusters.insert(clusterIdx);
-						fAddClusterMesh(clusterIdx, meshIdx);
-					}
+					clusters.push_back(node->cluster);
 				}
-				continue;
 			}
-			for(auto clusterIdx = decltype(numClusters) {0u}; clusterIdx < numClusters; ++clusterIdx) {
-				if(m_bspTree->IsClusterVisible(clusterIdx, meshClusterIdx) == false)
-					continue;
-				fAddClusterMesh(clusterIdx, meshIdx);
+			else
+				clusters.push_back(meshClusterIdx);
+			if(!clusters.empty())
+				meshClusters.push_back({static_cast<RenderMeshIndex>(meshIdx), std::move(clusters)});
+		}
+
+		// Only one visibility row is decompressed at a time, so the full cluster matrix never has to be resident
+		std::vector<uint8_t> row;
+		for(auto clusterIdx = decltype(numClusters) {0u}; clusterIdx < numClusters; ++clusterIdx) {
+			if(!m_bspTree->DecompressClusterVisibility(clusterIdx, row))
+				continue;
+			auto &clusterMeshes = meshesPerClusters.at(clusterIdx);
+			for(auto &[meshIdx, clusters] : meshClusters) {
+				auto visible = std::find_if(clusters.begin(), clusters.end(), [&row](util::BSPTree::ClusterIndex cluster) { return util::BSPTree::IsClusterVisible(row, cluster); }) != clusters.end();
+				if(visible)
+					clusterMeshes.push_back(meshIdx);
 			}
 		}
 	}
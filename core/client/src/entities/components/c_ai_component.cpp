@@ -145,6 +145,11 @@ void CAIComponent::OnEntityComponentAdded(BaseEntityComponent &component)
 	}
 }
 
+void CAIComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseAIComponent::GetHandledEvents(outEvents);
+}
+
 util::EventReply CAIComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseAIComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
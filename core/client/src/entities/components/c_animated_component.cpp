@@ -242,7 +242,8 @@ bool CAnimatedComponent::MaintainAnimations(double dt)
 #pragma message("TODO: Undo this and do it properly!")
 	//if(BaseEntity::MaintainAnimations() == false)
 	//	return false;
-	if(ShouldUpdateBones() == false)
+	// If we're being called from UpdateAnimationsMT, the conditions have already been evaluated on the main thread
+	if(umath::is_flag_set(m_stateFlags, StateFlags::BoneUpdateConditionsChecked) == false && ShouldUpdateBones() == false)
 		return false;
 	BaseAnimatedComponent::MaintainAnimations(dt);
 	SetBoneBufferDirty(); // TODO: Only if anything has actually changed
@@ -257,7 +258,8 @@ void CAnimatedComponent::UpdateBoneMatricesMT()
 	auto *bindPose = GetBindPose();
 	if(m_boneMatrices.empty() || bindPose == nullptr)
 		return;
-	if(UpdateSkeleton()) // Costly
+	auto skeletonUpdated = UpdateSkeleton(); // Costly
+	if(skeletonUpdated)
 		SetBoneBufferDirty();
 	auto physRootBoneId = OnSkeletonUpdated();
 
@@ -275,6 +277,16 @@ void CAnimatedComponent::UpdateBoneMatricesMT()
 		Con::cwar << Con::endl;
 		return;
 	}
+	// The SoA global poses can only be used if they were just computed and nothing else could have modified the processed bones since
+	if(skeletonUpdated && IsSoaPoseEnabled() && !IsSkeletonUpdateListenerEnabled() && !callbacksEnabled && m_soaPose.IsInitialized(mdl->GetSkeleton()) && refFrame.GetBoneCount() == numBones) {
+		if(!m_soaPose.HasBindPoses())
+			m_soaPose.SetBindPoses(refFrame.GetBoneTransforms());
+		std::optional<animation::BoneId> identityBoneId {};
+		if(physRootBoneId < numBones)
+			identityBoneId = physRootBoneId;
+		m_soaPose.ComputeSkinningMatrices(m_boneMatrices, identityBoneId);
+		return;
+	}
 	for(unsigned int i = 0; i < GetBoneCount(); i++) {
 		auto &t = m_processedBones.at(i);
 		auto &pos = t.GetOrigin();
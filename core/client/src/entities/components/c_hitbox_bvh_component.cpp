@@ -17,6 +17,7 @@
 #include "pragma/debug/c_debugoverlay.h"
 #include "pragma/logging.hpp"
 #include <pragma/entities/components/bvh_data.hpp>
+#include <pragma/entities/components/bvh_intersection_t.hpp>
 #include <pragma/entities/components/util_bvh.hpp>
 #include <pragma/debug/intel_vtune.hpp>
 #include "pragma/model/c_model.h"
@@ -734,21 +735,6 @@ void CHitboxBvhComponent::DebugDraw()
 	}
 }
 
-pragma::bvh::HitboxObb::HitboxObb(const Vector3 &min, const Vector3 &max) : min {min}, max {max} { umath::geometry::calc_aabb_extents(min, max, position, halfExtents); }
-
-umath::ScaledTransform pragma::bvh::HitboxObb::GetPose(const std::vector<umath::ScaledTransform> &effectivePoses) const
-{
-	auto pose = effectivePoses[boneId];
-	pose.TranslateLocal(position);
-	return pose;
-}
-
-pragma::bvh::BBox pragma::bvh::HitboxObb::ToBvhBBox(const umath::ScaledTransform &pose, Vector3 &outOrigin) const
-{
-	auto [aabbMin, aabbMax] = umath::geometry::calc_aabb_around_obb(pose, position, halfExtents);
-	return pragma::bvh::BBox {pragma::bvh::to_bvh_vector(aabbMin), pragma::bvh::to_bvh_vector(aabbMax)};
-}
-
 bool pragma::bvh::ObbBvhTree::DoInitializeBvh(pragma::bvh::Executor &executor, ::bvh::v2::DefaultBuilder<pragma::bvh::Node>::Config &config)
 {
 	auto numObbs = primitives.size();
@@ -139,6 +139,14 @@ void CPlayerComponent::OnEntityComponentAdded(BaseEntityComponent &component)
 	}
 }
 
+void CPlayerComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BasePlayerComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_DEPLOY_WEAPON);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_SET_ACTIVE_WEAPON);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_CHARACTER_ORIENTATION_CHANGED);
+}
+
 util::EventReply CPlayerComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BasePlayerComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -25,31 +25,16 @@ void CStaticBvhCacheComponent::Initialize() { BaseStaticBvhCacheComponent::Initi
 
 void CStaticBvhCacheComponent::DoRebuildBvh() {}
 
-void CStaticBvhCacheComponent::TestRebuildBvh()
+void CStaticBvhCacheComponent::GetEntityMeshes(BaseEntity &ent, std::vector<std::shared_ptr<ModelSubMesh>> &outMeshes) const
 {
-	std::vector<std::shared_ptr<ModelSubMesh>> meshes;
-	std::vector<BaseEntity *> meshToEntity;
-	std::vector<umath::ScaledTransform> meshPoses;
-	for(auto *c : m_entities) {
-		auto &ent = c->GetEntity();
-		auto *mdlC = static_cast<CModelComponent *>(ent.GetModelComponent());
-		if(!mdlC)
+	auto *mdlC = static_cast<CModelComponent *>(ent.GetModelComponent());
+	if(!mdlC)
+		return;
+	auto &renderMeshes = mdlC->GetRenderMeshes();
+	outMeshes.reserve(renderMeshes.size());
+	for(auto &mesh : renderMeshes) {
+		if(!ShouldConsiderMesh(*mesh))
 			continue;
-		auto &renderMeshes = mdlC->GetRenderMeshes();
-		if(meshes.size() == meshes.capacity()) {
-			meshes.reserve(meshes.size() * 1.5 + renderMeshes.size() + 100);
-			meshToEntity.reserve(meshes.size());
-			meshPoses.reserve(meshes.size());
-		}
-		auto &pose = ent.GetPose();
-		for(auto &mesh : renderMeshes) {
-			if(!ShouldConsiderMesh(*mesh))
-				continue;
-			meshes.push_back(mesh);
-			meshToEntity.push_back(&ent);
-			meshPoses.push_back(pose);
-		}
+		outMeshes.push_back(mesh);
 	}
-
-	Build(std::move(meshes), std::move(meshToEntity), std::move(meshPoses));
 }
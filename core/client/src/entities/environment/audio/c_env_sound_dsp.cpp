@@ -98,6 +98,11 @@ void CBaseSoundDspComponent::OnEntitySpawn()
 	if(m_kvDsp.empty() == false)
 		m_dsp = c_game->GetAuxEffect(m_kvDsp);
 }
+void CBaseSoundDspComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvSoundDspComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
 util::EventReply CBaseSoundDspComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvSoundDspComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
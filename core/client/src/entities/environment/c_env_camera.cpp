@@ -122,6 +122,12 @@ void CCameraComponent::OnEntityComponentAdded(BaseEntityComponent &component)
 	if(typeid(component) == typeid(CFieldAngleComponent))
 		SetFieldAngleComponent(static_cast<CFieldAngleComponent &>(component));
 }
+void CCameraComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvCameraComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
 util::EventReply CCameraComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvCameraComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
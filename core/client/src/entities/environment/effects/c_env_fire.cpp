@@ -26,6 +26,12 @@ void CFireComponent::Initialize()
 	pragma::CParticleSystemComponent::Precache("fire.wpt");
 }
 void CFireComponent::ReceiveData(NetPacket &packet) { m_fireType = packet->ReadString(); }
+void CFireComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvFireComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
 util::EventReply CFireComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvFireComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
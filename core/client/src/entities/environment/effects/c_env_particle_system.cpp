@@ -75,6 +75,10 @@ void CParticleSystemComponent::OnEntitySpawn()
 	CreateParticle();
 	BaseEnvParticleSystemComponent::OnEntitySpawn();
 }
+void CParticleSystemComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvParticleSystemComponent::GetHandledEvents(outEvents);
+}
 util::EventReply CParticleSystemComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvParticleSystemComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
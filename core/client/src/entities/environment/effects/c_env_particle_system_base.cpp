@@ -1536,46 +1536,91 @@ void CParticleSystemComponent::Simulate(double tDelta)
 	umath::set_flag(m_flags, Flags::HasMovingParticles, bMoving);
 	auto &pose = GetEntity().GetPose();
 	auto &posCam = cam->GetEntity().GetPosition();
-	for(auto i = decltype(m_maxParticlesCur) {0}; i < m_maxParticlesCur; ++i) {
-		auto &p = m_particles[i];
-		if(p.GetLife() > 0.f) {
-			// p.SetPrevPos(p.GetPosition());
-			for(auto &op : m_operators)
+
+	// Operators which don't support batch simulation (e.g. Lua operators) are invoked for every particle individually
+	for(auto &op : m_operators) {
+		if(op->SupportsBatchSimulation())
+			continue;
+		for(auto i = decltype(m_maxParticlesCur) {0}; i < m_maxParticlesCur; ++i) {
+			auto &p = m_particles[i];
+			if(p.GetLife() > 0.f)
 				op->PreSimulate(p, tDelta);
-			for(auto &op : m_operators)
-				op->Simulate(p, tDelta);
-
-			auto velAng = p.GetAngularVelocity() * static_cast<float>(tDelta);
-			if(uvec::length_sqr(velAng) > 0.f) {
-				// Update world rotation
-				auto rotOld = p.GetWorldRotation();
-				auto rotNew = glm::quat_cast(glm::eulerAngleYXZ(velAng.y, velAng.x, velAng.z)) * rotOld;
-				p.SetWorldRotation(rotNew);
-				if(rotOld.w != rotNew.w || rotOld.x != rotNew.x || rotOld.y != rotNew.y || rotOld.z != rotNew.z)
-					umath::set_flag(m_flags, Flags::HasMovingParticles, true);
-
-				// Update sprite rotation
-				auto rot = p.GetRotation();
-				rot += umath::rad_to_deg(velAng.y);
-				p.SetRotation(rot);
-			}
+		}
+	}
 
-			auto pos = p.GetPosition();
-			auto &vel = p.GetVelocity();
-			if(uvec::length(vel) > 0.f) {
-				auto velEffective = vel;
-				if(umath::is_flag_set(m_flags, Flags::RotateWithEmitter))
-					uvec::rotate(&velEffective, pose.GetRotation());
-				pos += velEffective * static_cast<float>(tDelta);
-				p.SetPosition(pos);
-				if(umath::is_flag_set(m_flags, Flags::HasMovingParticles) == false && uvec::length_sqr(velEffective) > 0.f)
-					umath::set_flag(m_flags, Flags::HasMovingParticles, true);
-			}
-			p.SetCameraDistance(glm::length2(pos - posCam));
-			for(auto &op : m_operators)
-				op->PostSimulate(p, tDelta);
-			//numRender++;
+	m_particleStreams.Gather(m_particles, m_maxParticlesCur);
+	auto batch = m_particleStreams.GetBatch();
+	// Only the streams an operator actually writes have to be written back to (or re-read from) the particles
+	auto modifiedStreams = pragma::ParticleStreamFlags::None;
+	for(auto &op : m_operators) {
+		if(op->SupportsBatchSimulation()) {
+			op->SimulateBatch(batch, tDelta);
+			modifiedStreams |= op->GetWrittenStreams();
+			continue;
+		}
+		if(modifiedStreams != pragma::ParticleStreamFlags::None) {
+			m_particleStreams.Scatter(m_particles, modifiedStreams);
+			modifiedStreams = pragma::ParticleStreamFlags::None;
 		}
+		for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i)
+			op->Simulate(m_particles[batch.particleIndices[i]], tDelta);
+		auto writtenStreams = op->GetWrittenStreams();
+		if(writtenStreams != pragma::ParticleStreamFlags::None)
+			m_particleStreams.Refresh(m_particles, writtenStreams);
+	}
+
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		auto &p = m_particles[batch.particleIndices[i]];
+		auto velAng = p.GetAngularVelocity() * static_cast<float>(tDelta);
+		if(uvec::length_sqr(velAng) > 0.f) {
+			// Update world rotation
+			auto rotOld = p.GetWorldRotation();
+			auto rotNew = glm::quat_cast(glm::eulerAngleYXZ(velAng.y, velAng.x, velAng.z)) * rotOld;
+			p.SetWorldRotation(rotNew);
+			if(rotOld.w != rotNew.w || rotOld.x != rotNew.x || rotOld.y != rotNew.y || rotOld.z != rotNew.z)
+				umath::set_flag(m_flags, Flags::HasMovingParticles, true);
+
+			// Update sprite rotation
+			auto rot = p.GetRotation();
+			rot += umath::rad_to_deg(velAng.y);
+			p.SetRotation(rot);
+		}
+	}
+
+	// Integrate the velocities
+	{
+		auto *posX = batch.GetStream(pragma::ParticleStream::PositionX);
+		auto *posY = batch.GetStream(pragma::ParticleStream::PositionY);
+		auto *posZ = batch.GetStream(pragma::ParticleStream::PositionZ);
+		auto *velX = batch.GetStream(pragma::ParticleStream::VelocityX);
+		auto *velY = batch.GetStream(pragma::ParticleStream::VelocityY);
+		auto *velZ = batch.GetStream(pragma::ParticleStream::VelocityZ);
+		auto m = umath::is_flag_set(m_flags, Flags::RotateWithEmitter) ? glm::mat3_cast(pose.GetRotation()) : Mat3 {1.f};
+		auto dt = static_cast<float>(tDelta);
+		auto maxSpeedSqr = 0.f;
+		for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+			auto vx = m[0][0] * velX[i] + m[1][0] * velY[i] + m[2][0] * velZ[i];
+			auto vy = m[0][1] * velX[i] + m[1][1] * velY[i] + m[2][1] * velZ[i];
+			auto vz = m[0][2] * velX[i] + m[1][2] * velY[i] + m[2][2] * velZ[i];
+			posX[i] += vx * dt;
+			posY[i] += vy * dt;
+			posZ[i] += vz * dt;
+			maxSpeedSqr = std::max(maxSpeedSqr, vx * vx + vy * vy + vz * vz);
+		}
+		if(maxSpeedSqr > 0.f)
+			umath::set_flag(m_flags, Flags::HasMovingParticles, true);
+	}
+	m_particleStreams.Scatter(m_particles, modifiedStreams | pragma::ParticleStreamFlags::Position);
+
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		auto &p = m_particles[batch.particleIndices[i]];
+		p.SetCameraDistance(glm::length2(p.GetPosition() - posCam));
+	}
+	for(auto &op : m_operators) {
+		if(op->SupportsBatchSimulation())
+			continue;
+		for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i)
+			op->PostSimulate(m_particles[batch.particleIndices[i]], tDelta);
 	}
 	//
 
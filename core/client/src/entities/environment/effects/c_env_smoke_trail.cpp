@@ -42,6 +42,12 @@ void CSmokeTrailComponent::ReceiveData(NetPacket &packet)
 	m_maxSpriteSize = packet->Read<float>();
 	m_material = packet->ReadString();
 }
+void CSmokeTrailComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvSmokeTrailComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
 util::EventReply CSmokeTrailComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvSmokeTrailComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
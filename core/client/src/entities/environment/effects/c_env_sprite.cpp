@@ -57,6 +57,13 @@ void CSpriteComponent::UpdateColor()
 
 void CSpriteComponent::SetOrientationType(pragma::CParticleSystemComponent::OrientationType orientationType) { m_orientationType = orientationType; }
 
+void CSpriteComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvSpriteComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
+
 util::EventReply CSpriteComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvSpriteComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
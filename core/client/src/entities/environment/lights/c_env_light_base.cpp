@@ -28,6 +28,11 @@ void CBaseLightComponent::Initialize() { BaseEnvLightComponent::Initialize(); }
 
 void CBaseLightComponent::OnEntityComponentAdded(BaseEntityComponent &component) { BaseEnvLightComponent::OnEntityComponentAdded(component); }
 
+void CBaseLightComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvLightComponent::GetHandledEvents(outEvents);
+}
+
 util::EventReply CBaseLightComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvLightComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
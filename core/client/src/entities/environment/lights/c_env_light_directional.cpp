@@ -187,6 +187,11 @@ Bool CLightDirectionalComponent::ReceiveNetEvent(pragma::NetEventId eventId, Net
 		return CBaseNetComponent::ReceiveNetEvent(eventId, packet);
 	return true;
 }
+void CLightDirectionalComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvLightDirectionalComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+}
 util::EventReply CLightDirectionalComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvLightDirectionalComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -185,6 +185,13 @@ void CLightSpotVolComponent::ReceiveData(NetPacket &packet)
 	});
 }
 
+void CLightSpotVolComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEnvLightSpotVolComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_ON);
+	outEvents.push_back(BaseToggleComponent::EVENT_ON_TURN_OFF);
+}
+
 util::EventReply CLightSpotVolComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEnvLightSpotVolComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
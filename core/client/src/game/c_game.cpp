@@ -1242,6 +1242,9 @@ void CGame::InitializeWorldData(pragma::asset::WorldData &worldData)
 
 bool CGame::LoadMap(const std::string &map, const Vector3 &origin, std::vector<EntityHandle> *entities)
 {
+	// Baselines of the previous map are meaningless for the new one
+	m_snapshotBaselines.Clear();
+	m_fullSnapshotRequested = false;
 	bool r = Game::LoadMap(map, origin, entities);
 	m_flags |= GameFlags::MapLoaded;
 	if(r == true) {
@@ -1403,19 +1406,58 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 		return; // Old snapshot; Just skip it (We're already received a newer snapshot, this one's out of order)
 	m_snapshotTracker.CheckMessages(snapshotId, m_lostPackets, t);
 
+	const pragma::networking::SnapshotBaselineBuffer::Baseline *baseline = nullptr;
+	auto hasBaseline = packet->Read<bool>();
+	if(hasBaseline) {
+		auto baselineId = packet->Read<uint8_t>();
+		baseline = m_snapshotBaselines.Find(baselineId);
+		if(baseline == nullptr && m_fullSnapshotRequested == false) {
+			// We can't recover from this on our own, the server has to drop its baselines and send a full snapshot
+			Con::cwar << "Received delta snapshot for unknown baseline " << +baselineId << "! Requesting full snapshot..." << Con::endl;
+			m_fullSnapshotRequested = true;
+			NetPacket request;
+			client->SendPacket("snapshot_full_request", request, pragma::networking::Protocol::SlowReliable);
+		}
+	}
+	else {
+		m_fullSnapshotRequested = false;
+		auto min = packet->Read<Vector3>();
+		auto max = packet->Read<Vector3>();
+		m_snapshotQuantizer.SetBounds(min, max);
+	}
+	pragma::networking::SnapshotBaselineBuffer::EntityStates entityStates;
+
 	//std::cout<<"Received snapshot with "<<(m_tServer -tOld)<<" time difference to last snapshot"<<std::endl;
 	const auto maxCorrectionDistance = umath::pow2(10.f);
 	unsigned int numEnts = packet->Read<unsigned int>();
 	for(unsigned int i = 0; i < numEnts; i++) {
-		CBaseEntity *ent = static_cast<CBaseEntity *>(nwm::read_entity(packet));
-		Vector3 pos = nwm::read_vector(packet);
-		Vector3 vel = nwm::read_vector(packet);
-		Vector3 angVel = nwm::read_vector(packet);
-		auto orientation = nwm::read_quat(packet);
+		auto entIdx = packet->Read<uint32_t>();
+		auto *ent = (entIdx != std::numeric_limits<uint32_t>::max()) ? static_cast<CBaseEntity *>(GetEntity(entIdx)) : nullptr;
+		auto *baselineState = baseline ? baseline->FindEntityState(entIdx) : nullptr;
+		auto state = baselineState ? *baselineState : pragma::networking::QuantizedEntityState {};
+		auto fields = pragma::networking::read_entity_state_delta(packet, state);
+		if(baselineState)
+			fields |= pragma::networking::SnapshotEntityFields::All;
+		entityStates[entIdx] = state;
+		Vector3 pos = m_snapshotQuantizer.DequantizePosition(state);
+		Vector3 vel = pragma::networking::SnapshotQuantizer::DequantizeVelocity(state.velocity);
+		Vector3 angVel = pragma::networking::SnapshotQuantizer::DequantizeVelocity(state.angularVelocity);
+		auto orientation = pragma::networking::SnapshotQuantizer::DequantizeRotation(state.rotation);
 		auto entDataSize = packet->Read<UInt8>();
 		if(ent != NULL) {
-			pos += vel * tDelta;
-			if(uvec::length_sqr(angVel) > 0.0)
+			// If the baseline is unknown, fields that haven't been transmitted keep their current values
+			using pragma::networking::SnapshotEntityFields;
+			if(!umath::is_flag_set(fields, SnapshotEntityFields::Velocity))
+				vel = ent->GetVelocity();
+			if(!umath::is_flag_set(fields, SnapshotEntityFields::AngularVelocity))
+				angVel = ent->GetAngularVelocity();
+			if(umath::is_flag_set(fields, SnapshotEntityFields::Position))
+				pos += vel * tDelta;
+			else
+				pos = ent->GetPosition();
+			if(!umath::is_flag_set(fields, SnapshotEntityFields::Rotation))
+				orientation = ent->GetRotation();
+			else if(uvec::length_sqr(angVel) > 0.0)
 				orientation = uquat::create(EulerAngles(umath::rad_to_deg(angVel.x), umath::rad_to_deg(angVel.y), umath::rad_to_deg(angVel.z)) * tDelta) * orientation; // TODO: Check if this is correct
 
 			// Move the entity to the correct position without teleporting it.
@@ -1562,6 +1604,28 @@ void CGame::ReceiveSnapshot(NetPacket &packet)
 			charComponent->SetViewOrientation(orientation);
 		}
 	}
+
+	// Entities that are no longer relevant to us won't receive any updates until they become relevant again, so they mustn't be extrapolated any further
+	auto numOutOfScope = packet->Read<uint32_t>();
+	for(auto i = decltype(numOutOfScope) {0u}; i < numOutOfScope; ++i) {
+		auto *ent = GetEntity(packet->Read<uint32_t>());
+		if(ent == nullptr)
+			continue;
+		auto pVelComponent = ent->GetComponent<pragma::VelocityComponent>();
+		if(pVelComponent.valid()) {
+			pVelComponent->SetVelocity({});
+			pVelComponent->SetAngularVelocity({});
+		}
+	}
+
+	// If we were missing the baseline, the decoded states are incomplete and mustn't be used as a baseline themselves
+	if(hasBaseline && baseline == nullptr)
+		return;
+	m_snapshotBaselines.Add(snapshotId, m_tServer, std::move(entityStates));
+	NetPacket ack;
+	ack->Write<uint8_t>(snapshotId);
+	ack->Write<double>(m_tServer);
+	client->SendPacket("snapshot_ack", ack, pragma::networking::Protocol::FastUnreliable);
 }
 
 static void set_action_input(Action action, bool b, bool bKeepMagnitude, const float *inMagnitude = nullptr)
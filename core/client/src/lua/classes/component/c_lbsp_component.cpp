@@ -29,7 +29,7 @@ void Lua::BSP::register_class(lua_State *l, luabind::module_ &entsMod, luabind::
 		}
 	}));
 	defBspTree.def("GetClusterVisibility", static_cast<void (*)(lua_State *, ::util::BSPTree &)>([](lua_State *l, ::util::BSPTree &tree) {
-		auto &clusterVisibility = tree.GetClusterVisibility();
+		auto &clusterVisibility = static_cast<const ::util::BSPTree &>(tree).GetClusterVisibility();
 		auto t = Lua::CreateTable(l);
 		auto idx = 1;
 		for(auto vis : clusterVisibility) {
@@ -19,6 +19,7 @@
 #include <sharedutils/scope_guard.h>
 #include <sharedutils/util_library.hpp>
 #include <pragma/game/game_resources.h>
+#include <pragma/networking/resource_transfer.hpp>
 
 #define RESOURCE_TRANSFER_VERBOSE 0
 
@@ -33,13 +34,32 @@ void ClientState::StartResourceTransfer()
 	SendPacket("resource_begin", resourceReq, pragma::networking::Protocol::SlowReliable);
 }
 
+static std::string read_part_hash(const std::string &fileName)
+{
+	auto f = FileManager::OpenFile(fileName.c_str(), "rb");
+	if(f == nullptr)
+		return {};
+	std::string hash;
+	hash.resize(f->GetSize());
+	f->Read(hash.data(), hash.size());
+	return hash;
+}
+
+void ClientState::SendResourceInfoResponse(uint32_t transferId, bool send, uint64_t resumeOffset)
+{
+	NetPacket response;
+	response->Write<uint32_t>(transferId);
+	response->Write<bool>(send);
+	response->Write<uint64_t>(resumeOffset);
+	SendPacket("resourceinfo_response", response, pragma::networking::Protocol::SlowReliable);
+}
+
 void ClientState::HandleClientResource(NetPacket &packet)
 {
+	auto transferId = packet->Read<uint32_t>();
 	std::string file = packet->ReadString();
 	if(!IsValidResource(file)) {
-		NetPacket response;
-		response->Write<bool>(false);
-		SendPacket("resourceinfo_response", response, pragma::networking::Protocol::SlowReliable);
+		SendResourceInfoResponse(transferId, false);
 		return;
 	}
 	auto bDefaultPath = true;
@@ -56,63 +76,177 @@ void ClientState::HandleClientResource(NetPacket &packet)
 
 	FileManager::CreatePath(fileDst.substr(0, fileDst.find_last_of('\\')).c_str());
 	auto size = packet->Read<UInt64>();
-	Con::ccl << "Downloading file '" << file << "' (" << util::get_pretty_bytes(size) << ")..." << Con::endl;
-	auto f = FileManager::OpenFile(file.c_str(), "rb"); //,fsys::SearchFlags::Local);
-	NetPacket response;
-	bool bSkip = false;
-	if(f != NULL) {
-		if(f->GetSize() == size) {
-			bSkip = true;
-			Con::ccl << "File '" << file << "' doesn't differ from server's. Skipping..." << Con::endl;
-			f.reset();
-			response->Write<bool>(false);
+	std::optional<std::string> hash {};
+	if(packet->Read<bool>())
+		hash = packet->ReadString();
+	// Without a hash we can't tell whether the local file is up to date, so it's always downloaded
+	if(hash.has_value() && size > 0) {
+		auto f = FileManager::OpenFile(file.c_str(), "rb"); //,fsys::SearchFlags::Local);
+		if(f != NULL && f->GetSize() == size) {
+			// Hashing large files can take a while, the download is started (or skipped) by UpdateResourceHashJobs once the hash is known
+			m_pendingResourceInfos.push_back({transferId, file, fileDst, size, *hash, pragma::networking::schedule_resource_hash(file)});
+			return;
+		}
+	}
+	BeginResourceDownload(transferId, file, fileDst, size, hash);
+}
+
+void ClientState::BeginResourceDownload(uint32_t transferId, const std::string &file, const std::string &fileDst, uint64_t size, const std::optional<std::string> &hash)
+{
+	if(size == 0) {
+		FileManager::OpenFile<VFilePtrReal>(fileDst.c_str(), "wb");
+		SendResourceInfoResponse(transferId, false);
+		return;
+	}
+
+	// If a previous download of the same file has been interrupted, we can continue where it left off
+	auto partName = fileDst + ".part";
+	auto partHashName = partName + ".hash";
+	uint64_t resumeOffset = 0;
+	if(hash.has_value() && read_part_hash(partHashName) == *hash) {
+		auto fPart = FileManager::OpenFile(partName.c_str(), "rb");
+		if(fPart != nullptr && fPart->GetSize() < size)
+			resumeOffset = fPart->GetSize();
+	}
+	auto fDst = FileManager::OpenFile<VFilePtrReal>(partName.c_str(), (resumeOffset > 0) ? "ab" : "wb");
+	if(fDst == NULL) {
+		Con::cwar << Con::PREFIX_CLIENT << "[ResourceManager] Unable to write file '" << fileDst << "'. Skipping..." << Con::endl;
+		SendResourceInfoResponse(transferId, false);
+		return;
+	}
+	if(resumeOffset == 0) {
+		if(hash.has_value()) {
+			auto fHash = FileManager::OpenFile<VFilePtrReal>(partHashName.c_str(), "wb");
+			if(fHash != nullptr)
+				fHash->Write(hash->data(), hash->size());
 		}
 		else
-			f = nullptr;
+			FileManager::RemoveFile(partHashName.c_str()); // Unverified downloads can't be resumed
+		Con::ccl << "Downloading file '" << file << "' (" << util::get_pretty_bytes(size) << ")..." << Con::endl;
 	}
-	if(bSkip == false)
-		f = FileManager::OpenFile((fileDst + ".part").c_str(), "wb");
-	if(!bSkip) {
-		if(f == NULL) {
-			response->Write<bool>(false);
-			Con::cwar << Con::PREFIX_CLIENT << "[ResourceManager] Unable to write file '" << fileDst << "'. Skipping..." << Con::endl;
+	else
+		Con::ccl << "Resuming download of file '" << file << "' (" << util::get_pretty_bytes(resumeOffset) << " / " << util::get_pretty_bytes(size) << ")..." << Con::endl;
+	m_resDownloads[transferId] = std::make_unique<ResourceDownload>(fDst, fileDst, size, hash, resumeOffset);
+	SendResourceInfoResponse(transferId, true, resumeOffset);
+}
+
+void ClientState::UpdateResourceHashJobs()
+{
+	for(auto it = m_pendingResourceInfos.begin(); it != m_pendingResourceInfos.end();) {
+		if(it->localHashJob->complete == false) {
+			++it;
+			continue;
 		}
-		else {
-			response->Write<bool>(true);
-			m_resDownload = std::make_unique<ResourceDownload>(std::static_pointer_cast<VFilePtrInternalReal>(f), fileDst, CUInt32(size));
+		auto info = std::move(*it);
+		it = m_pendingResourceInfos.erase(it);
+		if(info.localHashJob->hash == info.hash) {
+			Con::ccl << "File '" << info.file << "' doesn't differ from server's. Skipping..." << Con::endl;
+			SendResourceInfoResponse(info.transferId, false);
+			continue;
 		}
+		BeginResourceDownload(info.transferId, info.file, info.fileDst, info.size, info.hash);
 	}
-	SendPacket("resourceinfo_response", response, pragma::networking::Protocol::SlowReliable);
+
+	std::vector<std::pair<uint32_t, bool>> verified;
+	for(auto &[transferId, res] : m_resDownloads) {
+		if(res->verifyJob == nullptr || res->verifyJob->complete == false)
+			continue;
+		verified.push_back({transferId, res->verifyJob->hash == res->hash});
+	}
+	for(auto &[transferId, hashMatches] : verified)
+		FinishResourceDownload(transferId, hashMatches);
 }
 
+static constexpr uint32_t RESOURCE_TRANSFER_MAX_ATTEMPTS = 3;
+// Asks the server to rewind the transfer to the specified offset
+static void send_resource_nack(ClientState &state, uint32_t transferId, uint64_t offset)
+{
+	NetPacket nack;
+	nack->Write<uint32_t>(transferId);
+	nack->Write<uint64_t>(offset);
+	state.SendPacket("resource_nack", nack, pragma::networking::Protocol::SlowReliable);
+}
 void ClientState::HandleClientResourceFragment(NetPacket &packet)
 {
-	if(m_resDownload == NULL)
+	pragma::networking::ResourceFragment fragment {};
+	auto valid = pragma::networking::read_resource_fragment(packet, fragment);
+	auto it = m_resDownloads.find(fragment.transferId);
+	if(it == m_resDownloads.end())
 		return;
-	std::array<uint8_t, RESOURCE_TRANSFER_FRAGMENT_SIZE> buf;
-	unsigned int read = packet->Read<unsigned int>();
-	packet->Read(buf.data(), read);
-	auto &res = m_resDownload;
-	auto f = res->file;
-	f->Write(buf.data(), read);
-	NetPacket resourceReq;
+	auto &res = it->second;
+	if(res->verifyJob != nullptr)
+		return; // The file is complete and currently being verified
+	if(valid == false || fragment.offset != res->offset || res->offset + fragment.data.size() > res->size) {
+		// Fragments that were already in flight when we sent the nack are expected to be out of order
+		if(res->awaitingResend && valid && fragment.offset != res->offset)
+			return;
+		Con::cwar << Con::PREFIX_CLIENT << "[ResourceManager] Received invalid fragment for file '" << res->name << "'! Requesting resend..." << Con::endl;
+		res->awaitingResend = true;
+		send_resource_nack(*this, fragment.transferId, res->offset);
+		return;
+	}
+	res->awaitingResend = false;
+	res->file->Write(fragment.data.data(), fragment.data.size());
+	res->offset += fragment.data.size();
 #if RESOURCE_TRANSFER_VERBOSE == 1
-	Con::ccl << "[ResourceManager] " << ((f->Tell() / float(res->size)) * 100) << "%" << Con::endl;
+	Con::ccl << "[ResourceManager] " << ((res->offset / float(res->size)) * 100) << "%" << Con::endl;
 #endif
-	if(read < RESOURCE_TRANSFER_FRAGMENT_SIZE) {
-		auto resName = res->name;
-		res = nullptr;
-		f = nullptr;
-		resourceReq->Write<bool>(true);
-
-		if((FileManager::Exists(resName.c_str()) == true && FileManager::RemoveFile(resName.c_str()) == false) || FileManager::RenameFile((resName + ".part").c_str(), resName.c_str()) == false)
-			Con::ccl << "File '" << (resName + ".part") << "' successfully received, but unable to rename to '" << resName << "'... Requesting next..." << Con::endl;
-		else
-			Con::ccl << "File '" << resName << "' successfully received... Requesting next..." << Con::endl;
+	if(res->offset >= res->size) {
+		res->file = nullptr;
+		if(res->hash.has_value() == false) {
+			FinishResourceDownload(fragment.transferId, true);
+			return;
+		}
+		// The last fragment is acknowledged once the file has been verified, see UpdateResourceHashJobs
+		res->verifyJob = pragma::networking::schedule_resource_hash(res->name + ".part");
+		return;
+	}
+	NetPacket ack;
+	ack->Write<uint32_t>(fragment.transferId);
+	ack->Write<uint64_t>(res->offset);
+	SendPacket("resource_ack", ack, pragma::networking::Protocol::SlowReliable);
+}
+
+void ClientState::FinishResourceDownload(uint32_t transferId, bool hashMatches)
+{
+	auto it = m_resDownloads.find(transferId);
+	if(it == m_resDownloads.end())
+		return;
+	auto &res = it->second;
+	res->verifyJob = nullptr;
+	auto partName = res->name + ".part";
+	auto partHashName = partName + ".hash";
+	if(hashMatches == false) {
+		if(++res->failedAttempts < RESOURCE_TRANSFER_MAX_ATTEMPTS) {
+			res->file = FileManager::OpenFile<VFilePtrReal>(partName.c_str(), "wb");
+			if(res->file != nullptr) {
+				Con::cwar << Con::PREFIX_CLIENT << "[ResourceManager] Content of received file '" << res->name << "' doesn't match server's! Requesting resend..." << Con::endl;
+				res->offset = 0;
+				res->awaitingResend = true;
+				send_resource_nack(*this, transferId, 0);
+				return;
+			}
+		}
+		Con::cwar << Con::PREFIX_CLIENT << "[ResourceManager] Content of received file '" << res->name << "' doesn't match server's! Discarding..." << Con::endl;
+		NetPacket abort;
+		abort->Write<uint32_t>(transferId);
+		SendPacket("resource_abort", abort, pragma::networking::Protocol::SlowReliable);
+		m_resDownloads.erase(it);
+		FileManager::RemoveFile(partName.c_str());
+		FileManager::RemoveFile(partHashName.c_str());
+		return;
 	}
+	NetPacket ack;
+	ack->Write<uint32_t>(transferId);
+	ack->Write<uint64_t>(res->offset);
+	auto resName = res->name;
+	m_resDownloads.erase(it);
+	FileManager::RemoveFile(partHashName.c_str());
+	if((FileManager::Exists(resName.c_str()) == true && FileManager::RemoveFile(resName.c_str()) == false) || FileManager::RenameFile(partName.c_str(), resName.c_str()) == false)
+		Con::ccl << "File '" << partName << "' successfully received, but unable to rename to '" << resName << "'..." << Con::endl;
 	else
-		resourceReq->Write<bool>(false);
-	SendPacket("resource_request", resourceReq, pragma::networking::Protocol::SlowReliable);
+		Con::ccl << "File '" << resName << "' successfully received..." << Con::endl;
+	SendPacket("resource_ack", ack, pragma::networking::Protocol::SlowReliable);
 }
 
 ////////////////////
@@ -30,6 +30,8 @@ extern DLLCLIENT CGame *c_game;
 void ClientState::HandlePacket(NetPacket &packet)
 {
 	packet->SetClient(true);
+	// See ServerState::HandlePacket
+	c_engine->WakeMainLoop();
 	CallCallbacks<void, std::reference_wrapper<NetPacket>>("OnReceivePacket", packet);
 	unsigned int ID = packet.GetMessageID();
 	CLNetMessage *msg = GetNetMessage(ID);
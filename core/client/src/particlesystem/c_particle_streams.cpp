@@ -0,0 +1,161 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_client.h"
+#include "pragma/particlesystem/c_particle_streams.hpp"
+#include "pragma/particlesystem/c_particle.h"
+
+using namespace pragma;
+
+void ParticleStreams::Gather(const std::vector<CParticle> &particles, uint32_t numParticles)
+{
+	if(m_particleIndices.size() < numParticles) {
+		m_particleIndices.resize(numParticles);
+		for(auto &stream : m_streams)
+			stream.resize(numParticles);
+	}
+	m_count = 0;
+	for(auto i = decltype(numParticles) {0u}; i < numParticles; ++i) {
+		if(particles[i].GetLife() > 0.f)
+			m_particleIndices[m_count++] = i;
+	}
+	Refresh(particles);
+}
+
+void ParticleStreams::Refresh(const std::vector<CParticle> &particles, ParticleStreamFlags streams)
+{
+	auto getStream = [this](ParticleStream stream) { return m_streams[static_cast<size_t>(stream)].data(); };
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Position)) {
+		auto *posX = getStream(ParticleStream::PositionX);
+		auto *posY = getStream(ParticleStream::PositionY);
+		auto *posZ = getStream(ParticleStream::PositionZ);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx) {
+			auto &pos = particles[m_particleIndices[idx]].GetPosition();
+			posX[idx] = pos.x;
+			posY[idx] = pos.y;
+			posZ[idx] = pos.z;
+		}
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Velocity)) {
+		auto *velX = getStream(ParticleStream::VelocityX);
+		auto *velY = getStream(ParticleStream::VelocityY);
+		auto *velZ = getStream(ParticleStream::VelocityZ);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx) {
+			auto &vel = particles[m_particleIndices[idx]].GetVelocity();
+			velX[idx] = vel.x;
+			velY[idx] = vel.y;
+			velZ[idx] = vel.z;
+		}
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Life)) {
+		auto *life = getStream(ParticleStream::Life);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			life[idx] = particles[m_particleIndices[idx]].GetLife();
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::TimeAlive)) {
+		auto *timeAlive = getStream(ParticleStream::TimeAlive);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			timeAlive[idx] = particles[m_particleIndices[idx]].GetTimeAlive();
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Color)) {
+		auto *colR = getStream(ParticleStream::ColorR);
+		auto *colG = getStream(ParticleStream::ColorG);
+		auto *colB = getStream(ParticleStream::ColorB);
+		auto *colA = getStream(ParticleStream::ColorA);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx) {
+			auto &col = particles[m_particleIndices[idx]].GetColor();
+			colR[idx] = col.r;
+			colG[idx] = col.g;
+			colB[idx] = col.b;
+			colA[idx] = col.a;
+		}
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Radius)) {
+		auto *radius = getStream(ParticleStream::Radius);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			radius[idx] = particles[m_particleIndices[idx]].GetRadius();
+	}
+}
+
+void ParticleStreams::Scatter(std::vector<CParticle> &particles, ParticleStreamFlags streams) const
+{
+	auto getStream = [this](ParticleStream stream) { return m_streams[static_cast<size_t>(stream)].data(); };
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Position)) {
+		auto *posX = getStream(ParticleStream::PositionX);
+		auto *posY = getStream(ParticleStream::PositionY);
+		auto *posZ = getStream(ParticleStream::PositionZ);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			particles[m_particleIndices[idx]].SetPosition({posX[idx], posY[idx], posZ[idx]});
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Velocity)) {
+		auto *velX = getStream(ParticleStream::VelocityX);
+		auto *velY = getStream(ParticleStream::VelocityY);
+		auto *velZ = getStream(ParticleStream::VelocityZ);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			particles[m_particleIndices[idx]].SetVelocity({velX[idx], velY[idx], velZ[idx]});
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Life)) {
+		auto *life = getStream(ParticleStream::Life);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			particles[m_particleIndices[idx]].SetLife(life[idx]);
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::TimeAlive)) {
+		auto *timeAlive = getStream(ParticleStream::TimeAlive);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			particles[m_particleIndices[idx]].SetTimeAlive(timeAlive[idx]);
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Color)) {
+		auto *colR = getStream(ParticleStream::ColorR);
+		auto *colG = getStream(ParticleStream::ColorG);
+		auto *colB = getStream(ParticleStream::ColorB);
+		auto *colA = getStream(ParticleStream::ColorA);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			particles[m_particleIndices[idx]].SetColor(Vector4 {colR[idx], colG[idx], colB[idx], colA[idx]});
+	}
+	if(umath::is_flag_set(streams, ParticleStreamFlags::Radius)) {
+		auto *radius = getStream(ParticleStream::Radius);
+		for(auto idx = decltype(m_count) {0u}; idx < m_count; ++idx)
+			particles[m_particleIndices[idx]].SetRadius(radius[idx]);
+	}
+}
+
+uint32_t ParticleStreams::GetCount() const { return m_count; }
+
+ParticleBatch ParticleStreams::GetBatch(uint32_t start, uint32_t end)
+{
+	ParticleBatch batch {};
+	for(auto i = decltype(m_streams.size()) {0u}; i < m_streams.size(); ++i)
+		batch.streams[i] = m_streams[i].data() + start;
+	batch.particleIndices = m_particleIndices.data() + start;
+	batch.count = end - start;
+	return batch;
+}
+ParticleBatch ParticleStreams::GetBatch() { return GetBatch(0, m_count); }
+
+void particle_batch::add_velocity(ParticleBatch &batch, const Vector3 &v)
+{
+	auto *velX = batch.GetStream(ParticleStream::VelocityX);
+	auto *velY = batch.GetStream(ParticleStream::VelocityY);
+	auto *velZ = batch.GetStream(ParticleStream::VelocityZ);
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		velX[i] += v.x;
+		velY[i] += v.y;
+		velZ[i] += v.z;
+	}
+}
+
+void particle_batch::scale_velocity(ParticleBatch &batch, float scale)
+{
+	auto *velX = batch.GetStream(ParticleStream::VelocityX);
+	auto *velY = batch.GetStream(ParticleStream::VelocityY);
+	auto *velZ = batch.GetStream(ParticleStream::VelocityZ);
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		velX[i] *= scale;
+		velY[i] *= scale;
+		velZ[i] *= scale;
+	}
+}
@@ -195,7 +195,16 @@ void CParticleOperator::Simulate(CParticle &particle, double tDelta, float stren
 
 void CParticleOperator::PostSimulate(CParticle &particle, double tDelta) {}
 
+bool CParticleOperator::SupportsBatchSimulation() const { return false; }
+
+void CParticleOperator::SimulateBatch(pragma::ParticleBatch &batch, double tDelta) {}
+
+pragma::ParticleStreamFlags CParticleOperator::GetWrittenStreams() const { return pragma::ParticleStreamFlags::All; }
+
 void CParticleOperatorLifespanDecay::Simulate(CParticle &, double, float strength) {}
+bool CParticleOperatorLifespanDecay::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorLifespanDecay::SimulateBatch(pragma::ParticleBatch &, double) {}
+pragma::ParticleStreamFlags CParticleOperatorLifespanDecay::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
 
 ///////////////////////
 
@@ -59,3 +59,16 @@ float CParticleModifierComponentGradualFade::GetEasedFadeFraction(CParticle &p)
 	GetEasedFadeFraction(p, fraction);
 	return fraction;
 }
+bool CParticleModifierComponentGradualFade::IsFadeTimeConstant() const { return m_fStart.IsConstant() && m_fEnd.IsConstant(); }
+bool CParticleModifierComponentGradualFade::GetEasedFadeFraction(float timeAlive, float lifeSpan, float &outFraction) const
+{
+	auto tStart = GetTime(m_fStart.GetMin(), lifeSpan);
+	if(timeAlive < tStart) {
+		outFraction = 0.f;
+		return false;
+	}
+	auto tEnd = GetTime(m_fEnd.GetMin(), lifeSpan);
+	auto tDelta = tEnd - tStart;
+	outFraction = Ease((tDelta != 0.f) ? umath::clamp((timeAlive - tStart) / tDelta, 0.f, 1.f) : 0.f);
+	return true;
+}
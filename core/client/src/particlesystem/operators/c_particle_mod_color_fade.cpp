@@ -63,3 +63,4 @@ void CParticleOperatorColorFade::Simulate(CParticle &particle, double, float str
 		color.a = newColor.a;
 	particle.SetColor(color);
 }
+pragma::ParticleStreamFlags CParticleOperatorColorFade::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Color; }
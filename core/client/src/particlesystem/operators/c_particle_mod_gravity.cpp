@@ -50,3 +50,10 @@ void CParticleOperatorGravity::Simulate(CParticle &particle, double tDelta, floa
 	auto &oldVel = particle.GetVelocity();
 	particle.SetVelocity(oldVel + (m_bUseCustomGravityForce ? m_gravityForce : gravity) * m_gravityScale * static_cast<float>(tDelta));
 }
+bool CParticleOperatorGravity::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorGravity::SimulateBatch(pragma::ParticleBatch &batch, double tDelta)
+{
+	auto dtGravity = m_bUseCustomGravityForce ? m_dtGravity : (c_game->GetGravity() * m_gravityScale * static_cast<float>(tDelta));
+	pragma::particle_batch::add_velocity(batch, dtGravity);
+}
+pragma::ParticleStreamFlags CParticleOperatorGravity::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
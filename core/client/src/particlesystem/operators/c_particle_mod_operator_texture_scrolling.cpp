@@ -56,3 +56,4 @@ void CParticleOperatorTextureScrolling::Simulate(CParticle &particle, double dt,
 
 	SetFrameOffset(particle, uv);
 }
+pragma::ParticleStreamFlags CParticleOperatorTextureScrolling::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
@@ -202,6 +202,7 @@ void CParticleOperatorPhysicsModel::OnParticleCreated(CParticle &particle)
 	CParticleOperatorPhysics::OnParticleCreated(particle);
 	particle.SetOrigin(m_model->GetOrigin());
 }
+pragma::ParticleStreamFlags CParticleOperatorPhysics::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
 
 std::shared_ptr<pragma::physics::IShape> CParticleOperatorPhysicsModel::CreateShape()
 {
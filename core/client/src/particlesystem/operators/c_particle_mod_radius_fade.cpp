@@ -59,6 +59,34 @@ void CParticleOperatorRadiusFadeBase::Simulate(CParticle &particle, double, floa
 	auto radius = radiusStart + (radiusEnd - radiusStart) * tFade;
 	ApplyRadius(particle, radius);
 }
+bool CParticleOperatorRadiusFadeBase::SupportsBatchSimulation() const
+{
+	// Random start or end values depend on the seed of the individual particle and lengths are not part of the particle streams
+	return m_identifier == "radius" && IsFadeTimeConstant() && m_fRadiusEnd.IsConstant() && (m_particleStartRadiuses != nullptr || m_fRadiusStart.IsConstant());
+}
+void CParticleOperatorRadiusFadeBase::SimulateBatch(pragma::ParticleBatch &batch, double tDelta)
+{
+	auto *life = batch.GetStream(pragma::ParticleStream::Life);
+	auto *timeAlive = batch.GetStream(pragma::ParticleStream::TimeAlive);
+	auto *radius = batch.GetStream(pragma::ParticleStream::Radius);
+	auto radiusEnd = m_fRadiusEnd.GetMin();
+	auto constRadiusStart = m_fRadiusStart.GetMin();
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		auto tFade = 0.f;
+		if(GetEasedFadeFraction(timeAlive[i], timeAlive[i] + life[i], tFade) == false)
+			continue;
+		auto radiusStart = constRadiusStart;
+		if(m_particleStartRadiuses != nullptr) {
+			// Use last known particle radius
+			auto &ptRadiusStart = (*m_particleStartRadiuses)[batch.particleIndices[i]];
+			if(ptRadiusStart == std::numeric_limits<float>::max())
+				ptRadiusStart = radius[i];
+			radiusStart = ptRadiusStart;
+		}
+		radius[i] = radiusStart + (radiusEnd - radiusStart) * tFade;
+	}
+}
+pragma::ParticleStreamFlags CParticleOperatorRadiusFadeBase::GetWrittenStreams() const { return (m_identifier == "radius") ? pragma::ParticleStreamFlags::Radius : pragma::ParticleStreamFlags::None; }
 
 ////////////////////////////
 
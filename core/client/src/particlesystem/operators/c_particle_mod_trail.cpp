@@ -78,3 +78,4 @@ void CParticleOperatorTrail::Simulate(CParticle &particle, double, float strengt
 		particle.SetPosition(p);
 	}
 }
+pragma::ParticleStreamFlags CParticleOperatorTrail::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Position; }
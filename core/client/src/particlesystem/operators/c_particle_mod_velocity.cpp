@@ -32,3 +32,6 @@ void CParticleOperatorVelocity::Simulate(CParticle &particle, double tDelta, flo
 	particle.SetVelocity(vel);
 }
 float CParticleOperatorVelocity::GetSpeed() const { return uvec::length(m_velocity); }
+bool CParticleOperatorVelocity::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorVelocity::SimulateBatch(pragma::ParticleBatch &batch, double tDelta) { pragma::particle_batch::add_velocity(batch, m_velocity * static_cast<float>(tDelta)); }
+pragma::ParticleStreamFlags CParticleOperatorVelocity::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
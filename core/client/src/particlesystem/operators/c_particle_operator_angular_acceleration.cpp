@@ -28,3 +28,4 @@ void CParticleOperatorAngularAcceleration::Simulate(CParticle &particle, double
 	CParticleOperator::Simulate(particle, tDelta, strength);
 	particle.SetAngularVelocity(particle.GetAngularVelocity() + m_vAcceleration * static_cast<float>(tDelta));
 }
+pragma::ParticleStreamFlags CParticleOperatorAngularAcceleration::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
@@ -27,3 +27,4 @@ void CParticleOperatorAnimationPlayback::Simulate(CParticle &particle, double tD
 	CParticleOperator::Simulate(particle, tDelta, strength);
 	particle.SetFrameOffset(fmodf(particle.GetFrameOffset() + tDelta * m_playbackSpeed, 1.f));
 }
+pragma::ParticleStreamFlags CParticleOperatorAnimationPlayback::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
@@ -13,6 +13,7 @@
 #include <sharedutils/util_string.h>
 #include <sharedutils/util.h>
 #include <algorithm>
+#include <cmath>
 
 REGISTER_PARTICLE_OPERATOR(cylindrical_vortex, CParticleOperatorCylindricalVortex);
 
@@ -42,6 +43,7 @@ void CParticleOperatorCylindricalVortex::Simulate(double tDelta)
 
 	// find divergence rotation
 	m_dtRotation = uquat::create(m_dtAxis, -m_fDivergence);
+	m_dtRotationMatrix = glm::mat3_cast(m_dtRotation);
 }
 void CParticleOperatorCylindricalVortex::Simulate(CParticle &particle, double tDelta, float strength)
 {
@@ -57,3 +59,37 @@ void CParticleOperatorCylindricalVortex::Simulate(CParticle &particle, double tD
 	uvec::rotate(&v, m_dtRotation);
 	particle.SetVelocity(particle.GetVelocity() + v);
 }
+bool CParticleOperatorCylindricalVortex::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorCylindricalVortex::SimulateBatch(pragma::ParticleBatch &batch, double tDelta)
+{
+	auto *posX = batch.GetStream(pragma::ParticleStream::PositionX);
+	auto *posY = batch.GetStream(pragma::ParticleStream::PositionY);
+	auto *posZ = batch.GetStream(pragma::ParticleStream::PositionZ);
+	auto *velX = batch.GetStream(pragma::ParticleStream::VelocityX);
+	auto *velY = batch.GetStream(pragma::ParticleStream::VelocityY);
+	auto *velZ = batch.GetStream(pragma::ParticleStream::VelocityZ);
+	auto axis = m_dtAxis;
+	auto origin = m_dtOrigin;
+	auto &m = m_dtRotationMatrix;
+	auto strength = m_dtStrength;
+	const auto EPSILON = 0.0001f;
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		auto relX = posX[i] - origin.x;
+		auto relY = posY[i] - origin.y;
+		auto relZ = posZ[i] - origin.z;
+		// cross product of vortex axis and relative position is direction
+		auto vx = axis.y * relZ - axis.z * relY;
+		auto vy = axis.z * relX - axis.x * relZ;
+		auto vz = axis.x * relY - axis.y * relX;
+		auto l = std::sqrt(vx * vx + vy * vy + vz * vz);
+		// Particles on the axis are not affected
+		auto scale = (l < EPSILON) ? 0.f : (strength / l);
+		vx *= scale;
+		vy *= scale;
+		vz *= scale;
+		velX[i] += m[0][0] * vx + m[1][0] * vy + m[2][0] * vz;
+		velY[i] += m[0][1] * vx + m[1][1] * vy + m[2][1] * vz;
+		velZ[i] += m[0][2] * vx + m[1][2] * vy + m[2][2] * vz;
+	}
+}
+pragma::ParticleStreamFlags CParticleOperatorCylindricalVortex::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
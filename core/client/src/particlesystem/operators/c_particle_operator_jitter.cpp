@@ -28,3 +28,4 @@ void CParticleOperatorJitter::Simulate(CParticle &particle, double tDelta, float
 	auto time = m_dtTime + (pid & 255) / 256.f;
 	particle.SetPosition(particle.GetPosition() + Vector3(util::noise::get_noise(time, pid) * m_dtStrength, util::noise::get_noise(time, pid + 1) * m_dtStrength, util::noise::get_noise(time, pid + 2) * m_dtStrength));
 }
+pragma::ParticleStreamFlags CParticleOperatorJitter::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Position; }
@@ -35,3 +35,6 @@ void CParticleOperatorLinearDrag::Simulate(CParticle &particle, double tDelta, f
 	CParticleOperator::Simulate(particle, tDelta, strength);
 	particle.SetVelocity(particle.GetVelocity() * m_fTickDrag);
 }
+bool CParticleOperatorLinearDrag::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorLinearDrag::SimulateBatch(pragma::ParticleBatch &batch, double tDelta) { pragma::particle_batch::scale_velocity(batch, m_fTickDrag); }
+pragma::ParticleStreamFlags CParticleOperatorLinearDrag::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
@@ -62,6 +62,7 @@ void CParticleOperatorPauseEmissionBase::Simulate(double tDelta)
 		break;
 	}
 }
+pragma::ParticleStreamFlags CParticleOperatorPauseEmissionBase::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
 
 /////////////////////
 
@@ -12,6 +12,7 @@
 #include <sharedutils/util_string.h>
 #include <sharedutils/util.h>
 #include <algorithm>
+#include <cmath>
 
 REGISTER_PARTICLE_OPERATOR(quadratic_drag, CParticleOperatorQuadraticDrag);
 
@@ -36,3 +37,19 @@ void CParticleOperatorQuadraticDrag::Simulate(CParticle &particle, double tDelta
 	auto &velocity = particle.GetVelocity();
 	particle.SetVelocity(velocity * umath::max(0.f, 1.f - m_fTickDrag * uvec::length(velocity)));
 }
+bool CParticleOperatorQuadraticDrag::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorQuadraticDrag::SimulateBatch(pragma::ParticleBatch &batch, double tDelta)
+{
+	auto *velX = batch.GetStream(pragma::ParticleStream::VelocityX);
+	auto *velY = batch.GetStream(pragma::ParticleStream::VelocityY);
+	auto *velZ = batch.GetStream(pragma::ParticleStream::VelocityZ);
+	auto tickDrag = m_fTickDrag;
+	for(auto i = decltype(batch.count) {0u}; i < batch.count; ++i) {
+		auto speed = std::sqrt(velX[i] * velX[i] + velY[i] * velY[i] + velZ[i] * velZ[i]);
+		auto scale = std::max(0.f, 1.f - tickDrag * speed);
+		velX[i] *= scale;
+		velY[i] *= scale;
+		velZ[i] *= scale;
+	}
+}
+pragma::ParticleStreamFlags CParticleOperatorQuadraticDrag::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
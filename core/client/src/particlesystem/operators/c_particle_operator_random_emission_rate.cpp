@@ -51,3 +51,4 @@ void CParticleOperatorRandomEmissionRate::Simulate(double tDelta)
 		++count;
 	ps.SetNextParticleEmissionCount(count);
 }
+pragma::ParticleStreamFlags CParticleOperatorRandomEmissionRate::GetWrittenStreams() const { return pragma::ParticleStreamFlags::None; }
@@ -79,3 +79,4 @@ void CParticleOperatorToroidalVortex::Simulate(CParticle &particle, double tDelt
 	uvec::rotate(&v, rot);
 	particle.SetVelocity(particle.GetVelocity() + v);
 }
+pragma::ParticleStreamFlags CParticleOperatorToroidalVortex::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
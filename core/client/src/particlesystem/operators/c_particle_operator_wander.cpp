@@ -52,3 +52,4 @@ void CParticleOperatorWander::Simulate(CParticle &particle, double tDelta, float
 	auto time = m_dtTime + (pid & 255) / 256.f;
 	particle.SetVelocity(particle.GetVelocity() + Vector3(util::noise::get_noise(time, pid) * m_dtStrength, util::noise::get_noise(time, pid + 1) * m_dtStrength, util::noise::get_noise(time, pid + 2) * m_dtStrength));
 }
+pragma::ParticleStreamFlags CParticleOperatorWander::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
@@ -46,3 +46,6 @@ void CParticleOperatorWind::Simulate(CParticle &particle, double tDelta, float s
 	CParticleOperator::Simulate(particle, tDelta, strength);
 	particle.SetVelocity(particle.GetVelocity() + m_vDelta);
 }
+bool CParticleOperatorWind::SupportsBatchSimulation() const { return true; }
+void CParticleOperatorWind::SimulateBatch(pragma::ParticleBatch &batch, double tDelta) { pragma::particle_batch::add_velocity(batch, m_vDelta); }
+pragma::ParticleStreamFlags CParticleOperatorWind::GetWrittenStreams() const { return pragma::ParticleStreamFlags::Velocity; }
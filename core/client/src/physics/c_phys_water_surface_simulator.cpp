@@ -38,7 +38,7 @@ static auto cvGPUAcceleration = GetClientConVar("cl_water_surface_simulation_ena
 void CPhysWaterSurfaceSimulator::InitializeSurface()
 {
 	PhysWaterSurfaceSimulator::InitializeSurface();
-	if(m_particleField.empty() == true)
+	if(GetParticleCount() == 0)
 		return;
 	m_bUseComputeShaders = cvGPUAcceleration->GetBool();
 	m_bUseThread = !m_bUseComputeShaders;
@@ -60,7 +60,7 @@ void CPhysWaterSurfaceSimulator::InitializeSurface()
 			m_triangleIndices.push_back(ptIdx1);
 		}
 	}
-	m_particlePositions.resize(m_particleField.size());
+	m_particlePositions.resize(GetParticleCount());
 
 	if(m_bUseComputeShaders == false || m_whShaderSurface.expired() || m_whShaderSurfaceIntegrate.expired() || m_whShaderSurfaceSolveEdges.expired() || m_whShaderSurfaceSumEdges.expired() || pragma::ShaderWaterSurface::DESCRIPTOR_SET_WATER_EFFECT.IsValid() == false
 	  || pragma::ShaderWaterSplash::DESCRIPTOR_SET_WATER_EFFECT.IsValid() == false || pragma::ShaderWaterSurfaceIntegrate::DESCRIPTOR_SET_WATER_PARTICLES.IsValid() == false || pragma::ShaderWaterSurface::DESCRIPTOR_SET_SURFACE_INFO.IsValid() == false
@@ -73,12 +73,13 @@ void CPhysWaterSurfaceSimulator::InitializeSurface()
 	auto &shaderWaterSurfaceIntegrate = static_cast<pragma::ShaderWaterSurfaceIntegrate &>(*m_whShaderSurfaceIntegrate.get());
 	m_descSetGroupIntegrate = c_engine->GetRenderContext().CreateDescriptorSetGroup(pragma::ShaderWaterSurfaceIntegrate::DESCRIPTOR_SET_WATER_PARTICLES);
 
-	auto size = sizeof(Particle) * m_particleField.size();
+	auto particleField = CreateParticleField();
+	auto size = sizeof(Particle) * particleField.size();
 	prosper::util::BufferCreateInfo createInfo {};
 	createInfo.usageFlags = prosper::BufferUsageFlags::StorageBufferBit;
 	createInfo.size = size;
 	createInfo.memoryFeatures = prosper::MemoryFeatureFlags::GPUBulk;
-	m_particleBuffer = c_engine->GetRenderContext().CreateBuffer(createInfo, m_particleField.data());
+	m_particleBuffer = c_engine->GetRenderContext().CreateBuffer(createInfo, particleField.data());
 
 	// TODO
 	///size = sizeof(Vector3) *m_particlePositions.size();
@@ -89,9 +90,9 @@ void CPhysWaterSurfaceSimulator::InitializeSurface()
 	//	vertices.at(i).position = m_particlePositions.at(i);
 	//m_positionBuffer = Vulkan::Buffer::Create(context,prosper::BufferUsageFlags::StorageBufferBit | prosper::BufferUsageFlags::VertexBufferBit,size,size,vertices.data(),true,nullptr);
 
-	size = sizeof(Vector4) * m_particleField.size();
+	size = sizeof(Vector4) * particleField.size();
 	std::vector<Vector4> verts;
-	verts.resize(m_particleField.size());
+	verts.resize(particleField.size());
 
 	createInfo.usageFlags = prosper::BufferUsageFlags::StorageBufferBit | prosper::BufferUsageFlags::VertexBufferBit;
 	createInfo.size = size;
@@ -118,7 +119,7 @@ void CPhysWaterSurfaceSimulator::InitializeSurface()
 	descSetSurfaceInfo.SetBindingUniformBuffer(*m_surfaceInfoBuffer, umath::to_integral(pragma::ShaderWaterSurface::SurfaceInfoBinding::SurfaceInfo));
 
 	// Initialize edge buffer
-	std::vector<ParticleEdgeInfo> particleEdgeInfo(m_particleField.size());
+	std::vector<ParticleEdgeInfo> particleEdgeInfo(particleField.size());
 	size = sizeof(particleEdgeInfo.front()) * particleEdgeInfo.size();
 	createInfo.usageFlags = prosper::BufferUsageFlags::StorageBufferBit;
 	createInfo.size = size;
@@ -229,7 +230,7 @@ void CPhysWaterSurfaceSimulator::Draw(std::shared_ptr<prosper::IPrimaryCommandBu
 	//lines.reserve(verts.size() *2);
 	//auto prevPos = Vector3{};
 
-	std::vector<Vector4> particlePositions(m_particleField.size());
+	std::vector<Vector4> particlePositions(GetParticleCount());
 	m_positionBuffer->Read(0ull, particlePositions.size() * sizeof(particlePositions.front()), particlePositions.data());
 
 	auto numVerts = umath::min(verts.size(), GetParticleCount());
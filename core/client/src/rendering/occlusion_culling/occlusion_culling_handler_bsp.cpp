@@ -32,6 +32,12 @@ void OcclusionCullingHandlerBSP::Update(const Vector3 &camPos)
 	if(m_bLockCurrentNode)
 		return;
 	m_pCurrentNode = FindLeafNode(camPos);
+	auto cluster = m_pCurrentNode ? m_pCurrentNode->cluster : std::numeric_limits<util::BSPTree::ClusterIndex>::max();
+	if(cluster == m_currentCluster)
+		return;
+	m_currentCluster = cluster;
+	if(!m_bspTree->DecompressClusterVisibility(cluster, m_currentClusterVisibility))
+		m_currentClusterVisibility.clear();
 }
 bool OcclusionCullingHandlerBSP::ShouldExamine(CModelMesh &mesh, const Vector3 &pos, bool bViewModel, std::size_t numMeshes, const std::vector<umath::Plane> *optPlanes) const
 {
@@ -62,7 +68,7 @@ bool OcclusionCullingHandlerBSP::ShouldPass(CModelMesh &modelMesh, const Vector3
 		// Probably not a world mesh
 		return true; // TODO: Do manual culling by AABB? (calculate AABB for each cluster around all visible clusters)
 	}
-	return m_bspTree->IsClusterVisible(m_pCurrentNode->cluster, clusterIndex);
+	return util::BSPTree::IsClusterVisible(m_currentClusterVisibility, clusterIndex);
 
 	/*Vector3 min,max;
 	modelMesh.GetBounds(min,max);
@@ -106,7 +112,7 @@ static void debug_bsp_nodes(NetworkState *, const ConVar &, int32_t, int32_t val
 		Con::cwar << "Camera not located in any leaf node!" << Con::endl;
 		return;
 	}
-	auto &clusterVisibility = bspTree->GetClusterVisibility();
+	auto &clusterVisibility = static_cast<const util::BSPTree &>(*bspTree).GetClusterVisibility();
 	Con::cout << "Camera position: (" << camPos.x << " " << camPos.y << " " << camPos.z << ")" << Con::endl;
 	Con::cout << "Leaf cluster id: " << pCurrentNode->cluster << Con::endl;
 	Con::cout << "Leaf bounds: (" << pCurrentNode->min.x << "," << pCurrentNode->min.y << "," << pCurrentNode->min.z << ") (" << pCurrentNode->max.x << "," << pCurrentNode->max.y << "," << pCurrentNode->max.z << ")" << Con::endl;
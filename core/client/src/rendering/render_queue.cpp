@@ -11,6 +11,7 @@
 #include "pragma/rendering/shaders/world/c_shader_textured.hpp"
 #include "pragma/entities/components/c_render_component.hpp"
 #include "pragma/entities/environment/c_env_camera.h"
+#include <pragma/util/radix_sort.hpp>
 #include <cmaterial_manager2.hpp>
 #include <cmaterial.h>
 
@@ -104,7 +105,7 @@ prosper::ShaderGraphics *RenderQueueItem::GetShader(uint32_t &outPipelineIndex)
 
 std::shared_ptr<RenderQueue> RenderQueue::Create(std::string name) { return std::shared_ptr<RenderQueue> {new RenderQueue {std::move(name)}}; }
 
-RenderQueue::RenderQueue(std::string name) : m_name {std::move(name)} {}
+RenderQueue::RenderQueue(std::string name) : m_jobSystem {c_engine->GetJobSystem()}, m_name {std::move(name)} { m_workerItems.resize(m_jobSystem.GetWorkerCount()); }
 
 RenderQueue::~RenderQueue() {}
 
@@ -120,6 +121,8 @@ void RenderQueue::Clear()
 {
 	queue.clear();
 	sortedItemIndices.clear();
+	for(auto &items : m_workerItems)
+		items.clear();
 }
 void RenderQueue::Add(CBaseEntity &ent, RenderMeshIndex meshIdx, CMaterial &mat, prosper::PipelineID pipelineId, const CCameraComponent *optCam)
 {
@@ -132,6 +135,11 @@ void RenderQueue::Add(CBaseEntity &ent, RenderMeshIndex meshIdx, CMaterial &mat,
 }
 void RenderQueue::Add(const RenderQueueItem &item)
 {
+	auto workerIndex = m_jobSystem.GetCurrentWorkerIndex();
+	if(workerIndex < m_workerItems.size()) {
+		m_workerItems[workerIndex].push_back(item);
+		return;
+	}
 	m_queueMutex.lock();
 	Reserve();
 	queue.push_back(item);
@@ -140,6 +148,12 @@ void RenderQueue::Add(const RenderQueueItem &item)
 }
 void RenderQueue::Add(const std::vector<RenderQueueItem> &items)
 {
+	auto workerIndex = m_jobSystem.GetCurrentWorkerIndex();
+	if(workerIndex < m_workerItems.size()) {
+		auto &workerItems = m_workerItems[workerIndex];
+		workerItems.insert(workerItems.end(), items.begin(), items.end());
+		return;
+	}
 	m_queueMutex.lock();
 	auto offset = queue.size();
 	queue.resize(queue.size() + items.size());
@@ -150,11 +164,30 @@ void RenderQueue::Add(const std::vector<RenderQueueItem> &items)
 	}
 	m_queueMutex.unlock();
 }
+void RenderQueue::MergeWorkerItems()
+{
+	size_t numItems = queue.size();
+	for(auto &items : m_workerItems)
+		numItems += items.size();
+	if(numItems == queue.size())
+		return;
+	queue.reserve(numItems);
+	for(auto &items : m_workerItems) {
+		queue.insert(queue.end(), items.begin(), items.end());
+		items.clear();
+	}
+}
 void RenderQueue::Sort()
 {
-	std::sort(sortedItemIndices.begin(), sortedItemIndices.end(), [](const RenderQueueItemSortPair &a, const RenderQueueItemSortPair &b) {
-		static_assert(sizeof(decltype(a.second)) == sizeof(uint64_t));
-		return *reinterpret_cast<const uint64_t *>(&a.second) < *reinterpret_cast<const uint64_t *>(&b.second);
+	MergeWorkerItems();
+	// The keys are taken from the items, since the sort keys of some items may have been changed after they were added (e.g. distances of translucent items)
+	sortedItemIndices.resize(queue.size());
+	for(auto i = decltype(queue.size()) {0u}; i < queue.size(); ++i)
+		sortedItemIndices[i] = {static_cast<RenderQueueItemIndex>(i), queue[i].sortingKey};
+	// Has to be stable, so the meshes of an entity stay in the order they were added in, which is required for instancing
+	pragma::radix_sort(sortedItemIndices, m_sortBuffer, [](const RenderQueueItemSortPair &pair) -> uint64_t {
+		static_assert(sizeof(decltype(pair.second)) == sizeof(uint64_t));
+		return *reinterpret_cast<const uint64_t *>(&pair.second);
 	});
 }
 
@@ -8,82 +8,63 @@
 #include "stdafx_client.h"
 #include "pragma/rendering/render_queue_worker.hpp"
 #include "pragma/rendering/render_stats.hpp"
+#include <pragma/engine.h>
 
 using namespace pragma::rendering;
 
-RenderQueueWorker::RenderQueueWorker(RenderQueueWorkerManager &manager) : m_manager {manager} { StartThread(); }
+RenderQueueWorker::RenderQueueWorker(RenderQueueWorkerManager &manager) : m_manager {manager} {}
 
-void RenderQueueWorker::Stop() { m_running = false; }
 void RenderQueueWorker::SetStats(RenderQueueWorkerStats *stats) { m_stats = stats; }
 
-void RenderQueueWorker::StartThread()
+void RenderQueueWorker::Run()
 {
-	m_thread = std::thread {[this]() {
-		std::queue<RenderQueueWorkerManager::Job> jobs;
-		while(m_running) {
-			std::unique_lock<std::mutex> mlock(m_manager.m_readyJobMutex);
-			m_manager.m_readyJobCondition.wait(mlock, [this]() -> bool { return m_manager.m_workAvailable || !m_running; });
-
-			std::chrono::steady_clock::time_point t;
-			if(m_stats)
-				t = std::chrono::steady_clock::now();
-
-			++m_manager.m_numThreadsWorking;
-			while(m_manager.m_readyJobs.empty() == false && jobs.size() < m_manager.m_numJobsPerBatch) {
-				jobs.push(m_manager.m_readyJobs.front());
-				m_manager.m_readyJobs.pop();
-			}
-			if(m_manager.m_readyJobs.empty() && jobs.empty()) {
-				m_manager.m_workCompleteMutex.lock();
-				m_manager.m_workAvailable = false;
-				m_manager.m_workCompleteCondition.notify_one();
-				m_manager.m_workCompleteMutex.unlock();
-			}
-			mlock.unlock();
-
-			if(m_stats)
-				m_stats->numJobs += jobs.size();
-			while(jobs.empty() == false) {
-				jobs.front()();
-				jobs.pop();
-			}
-			if(m_stats)
-				m_stats->totalExecutionTime += std::chrono::steady_clock::now() - t;
-			if(--m_manager.m_numThreadsWorking == 0) {
-				m_manager.m_workCompleteMutex.lock();
-				m_manager.m_workCompleteCondition.notify_one();
-				m_manager.m_workCompleteMutex.unlock();
-			}
+	std::queue<RenderQueueWorkerManager::Job> jobs;
+	for(;;) {
+		std::unique_lock<std::mutex> mlock(m_manager.m_readyJobMutex);
+		while(m_manager.m_readyJobs.empty() == false && jobs.size() < std::max(m_manager.m_numJobsPerBatch, 1u)) {
+			jobs.push(std::move(m_manager.m_readyJobs.front()));
+			m_manager.m_readyJobs.pop();
 		}
-	}};
-	util::set_thread_name(m_thread, "render_queue_worker");
-}
+		if(jobs.empty()) {
+			m_active = false;
+			if(--m_manager.m_numWorkersActive == 0)
+				m_manager.m_workCompleteCondition.notify_all();
+			return;
+		}
+		mlock.unlock();
 
-RenderQueueWorker::~RenderQueueWorker()
-{
-	assert(!m_running);
-	m_manager.m_readyJobMutex.lock();
-	m_manager.m_readyJobCondition.notify_all();
-	m_manager.m_readyJobMutex.unlock();
-	if(m_thread.joinable())
-		m_thread.join();
+		std::chrono::steady_clock::time_point t;
+		if(m_stats) {
+			t = std::chrono::steady_clock::now();
+			m_stats->numJobs += jobs.size();
+		}
+		while(jobs.empty() == false) {
+			jobs.front()();
+			jobs.pop();
+		}
+		if(m_stats)
+			m_stats->totalExecutionTime += std::chrono::steady_clock::now() - t;
+	}
 }
 
 ///////////////////////
 
-RenderQueueWorkerManager::RenderQueueWorkerManager(uint32_t numWorkers) { SetWorkerCount(numWorkers); }
+RenderQueueWorkerManager::RenderQueueWorkerManager(uint32_t numWorkers) : m_jobSystem {pragma::get_engine()->GetJobSystem()}
+{
+	m_subsystem = m_jobSystem.RegisterSubsystem({"render_queue", JobSystem::Priority::High});
+	SetWorkerCount(numWorkers);
+}
 
 RenderQueueWorker &RenderQueueWorkerManager::GetWorker(uint32_t i) { return *m_workers[i]; }
 const RenderQueueWorker &RenderQueueWorkerManager::GetWorker(uint32_t i) const { return const_cast<RenderQueueWorkerManager *>(this)->GetWorker(i); }
 uint32_t RenderQueueWorkerManager::GetWorkerCount() const { return m_workers.size(); }
 void RenderQueueWorkerManager::SetWorkerCount(uint32_t numWorkers)
 {
+	numWorkers = std::max(numWorkers, 1u);
 	if(numWorkers < m_workers.size()) {
-		while(m_workers.size() > numWorkers) {
-			auto &worker = m_workers.back();
-			worker->Stop();
-			m_workers.pop_back();
-		}
+		// Workers may still be scheduled
+		WaitForCompletion();
+		m_workers.resize(numWorkers);
 		return;
 	}
 	m_workers.reserve(numWorkers);
@@ -94,32 +75,34 @@ void RenderQueueWorkerManager::SetWorkerCount(uint32_t numWorkers)
 RenderQueueWorkerManager::~RenderQueueWorkerManager()
 {
 	WaitForCompletion();
-	for(auto &worker : m_workers)
-		worker->Stop();
 	m_workers.clear();
 }
 
 void RenderQueueWorkerManager::WaitForCompletion()
 {
 	FlushPendingJobs();
-	std::unique_lock<std::mutex> mlock(m_workCompleteMutex);
-	m_workCompleteCondition.wait(mlock, [this]() -> bool { return !m_workAvailable && m_numThreadsWorking == 0; });
+	std::unique_lock<std::mutex> mlock(m_readyJobMutex);
+	m_workCompleteCondition.wait(mlock, [this]() -> bool { return m_readyJobs.empty() && m_numWorkersActive == 0; });
 }
 
 void RenderQueueWorkerManager::FlushPendingJobs()
 {
-	m_readyJobMutex.lock();
+	std::scoped_lock lock {m_readyJobMutex};
 	while(m_pendingJobs.empty() == false) {
-		m_readyJobs.push(m_pendingJobs.front());
+		m_readyJobs.push(std::move(m_pendingJobs.front()));
 		m_pendingJobs.pop();
 	}
-	m_workAvailable = !m_readyJobs.empty();
-	auto num = m_readyJobs.size();
-	if(num > m_numJobsPerBatch)
-		m_readyJobCondition.notify_all();
-	else
-		m_readyJobCondition.notify_one();
-	m_readyJobMutex.unlock();
+	// Only as many workers as there are batches are started
+	auto numBatches = (m_readyJobs.size() + std::max(m_numJobsPerBatch, 1u) - 1) / std::max(m_numJobsPerBatch, 1u);
+	for(auto &worker : m_workers) {
+		if(m_numWorkersActive >= numBatches)
+			break;
+		if(worker->m_active)
+			continue;
+		worker->m_active = true;
+		++m_numWorkersActive;
+		m_jobSystem.Schedule([worker]() { worker->Run(); }, m_subsystem);
+	}
 }
 
 void RenderQueueWorkerManager::AddJob(const Job &job)
@@ -319,10 +319,7 @@ void SceneRenderDesc::CollectRenderMeshesFromOctree(pragma::CRasterizationRender
 			auto iStart = i * numEntitiesPerWorkerJob;
 			auto iEnd = umath::min(static_cast<size_t>(iStart + numEntitiesPerWorkerJob), numObjects);
 			c_game->GetRenderQueueWorkerManager().AddJob([iStart, iEnd, shouldConsiderEntity, renderMask, optRasterizationRenderer, &objs, renderFlags, getRenderQueue, &scene, &cam, vp, fShouldCull, lodBias, baseSpecializationFlags]() {
-				// Note: We don't add individual items directly to the render queue, because that would invoke
-				// a mutex lock which can stall all of the worker threads.
-				// Instead we'll collect the entire batch of items, then add all of them to the render queue at once.
-				std::unordered_map<pragma::rendering::RenderQueue *, std::vector<pragma::rendering::RenderQueueItem>> items;
+				// Note: Items are added to the render queues directly, since every worker appends to its own buffer of the queue without locking
 				for(auto i = iStart; i < iEnd; ++i) {
 					auto *ent = objs[i];
 					assert(ent);
@@ -345,18 +342,8 @@ void SceneRenderDesc::CollectRenderMeshesFromOctree(pragma::CRasterizationRender
 						continue;
 					if(fShouldCull && ShouldCull(*renderC, fShouldCull))
 						continue;
-					AddRenderMeshesToRenderQueue(
-					  optRasterizationRenderer, renderFlags, *renderC, getRenderQueue, scene, cam, vp, fShouldCull, lodBias,
-					  [&items](pragma::rendering::RenderQueue &renderQueue, const pragma::rendering::RenderQueueItem &item) {
-						  auto &v = items[&renderQueue];
-						  if(v.size() == v.capacity())
-							  v.reserve(v.size() * 1.1f + 50);
-						  v.push_back(item);
-					  },
-					  baseSpecializationFlags);
+					AddRenderMeshesToRenderQueue(optRasterizationRenderer, renderFlags, *renderC, getRenderQueue, scene, cam, vp, fShouldCull, lodBias, nullptr, baseSpecializationFlags);
 				}
-				for(auto &pair : items)
-					pair.first->Add(pair.second);
 			});
 		}
 		auto *children = node.GetChildren();
@@ -0,0 +1,68 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __S_AI_PERCEPTION_HPP__
+#define __S_AI_PERCEPTION_HPP__
+
+#include "pragma/serverdefinitions.h"
+#include <mathutil/uvec.h>
+#include <vector>
+#include <cstdint>
+
+class BaseEntity;
+namespace pragma {
+	class SAIComponent;
+	namespace ai {
+		// Spreads the visual perception updates of all NPCs over multiple ticks and provides the scratch buffers used during an update.
+		// NPCs which are due for an update, but don't fit into the budget of the current tick, are updated on one of the next ticks instead.
+		class DLLSERVER PerceptionScheduler {
+		  public:
+			struct VisibilityCandidate {
+				BaseEntity *entity = nullptr;
+				Vector3 position {};
+				float distance = 0.f;
+			};
+			struct Statistics {
+				uint64_t updateCount = 0;
+				uint64_t deferredCount = 0;
+				uint64_t candidateCount = 0;
+				uint64_t raycastCount = 0;
+			};
+			// Candidates are gathered from the entity spatial index within the view distance of the NPC, extended by this margin, since
+			// the eye position of a target may lie outside of its bounds
+			static constexpr float QUERY_MARGIN = 128.f;
+
+			// Returns false if no more perception updates are allowed during the current tick
+			bool BeginUpdate(double curTime);
+			// 0 = unlimited
+			void SetUpdateBudget(uint32_t budget);
+			uint32_t GetUpdateBudget() const;
+			// Maximum number of line of sight traces per update, closest candidates are traced first. 0 = unlimited
+			void SetMaxRaycastsPerUpdate(uint32_t maxRaycasts);
+			uint32_t GetMaxRaycastsPerUpdate() const;
+
+			// Collects the targets that may be visible to the NPC. The candidates are sorted by distance.
+			void CollectVisibilityCandidates(SAIComponent &npc, std::vector<VisibilityCandidate> &outCandidates);
+			// Removes all candidates that are not in the line of sight of the NPC
+			void ResolveVisibility(SAIComponent &npc, std::vector<VisibilityCandidate> &candidates);
+
+			std::vector<VisibilityCandidate> &GetCandidateBuffer();
+			const Statistics &GetStatistics() const;
+			void ResetStatistics();
+		  private:
+			uint32_t m_updateBudget = 32;
+			uint32_t m_maxRaycastsPerUpdate = 0;
+			double m_budgetTime = -1.0;
+			uint32_t m_updatesThisTick = 0;
+			std::vector<BaseEntity *> m_entityBuffer;
+			std::vector<VisibilityCandidate> m_candidateBuffer;
+			Statistics m_statistics {};
+		};
+	};
+};
+
+#endif
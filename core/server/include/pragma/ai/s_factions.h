@@ -9,6 +9,8 @@
 
 #include "pragma/networkdefinitions.h"
 #include "pragma/serverdefinitions.h"
+#include <unordered_map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -21,12 +23,17 @@ class DLLSERVER Faction : public std::enable_shared_from_this<Faction> {
 	friend FactionManager;
 	DISPOSITION m_defaultDisp;
 	Faction(const std::string &name);
+	void InvalidateDispositionCache();
+	FactionManager *m_manager = nullptr;
+	uint32_t m_index = 0;
 	std::string m_name;
 	std::vector<std::string> m_classes;
 	std::array<std::vector<std::shared_ptr<FactionDisposition>>, 4> m_relationships;
   public:
+	// Classes must only be changed through AddClass and RemoveClass, which invalidate the disposition cache
 	void AddClass(std::string className);
-	std::vector<std::string> &GetClasses();
+	void RemoveClass(std::string className);
+	const std::vector<std::string> &GetClasses() const;
 	void SetDisposition(Faction &faction, DISPOSITION disp, bool revert = false, int priority = 0);
 	void SetEnemyFaction(Faction &faction, bool revert = false, int priority = 0);
 	void SetAlliedFaction(Faction &faction, bool revert = false, int priority = 0);
@@ -52,12 +59,27 @@ struct DLLSERVER FactionDisposition {
 
 class DLLSERVER FactionManager {
   protected:
+	friend Faction;
+	struct CachedDisposition {
+		DISPOSITION disposition;
+		// Faction::GetDisposition doesn't always assign a priority, in which case the caller's value has to be left untouched
+		std::optional<int> priority {};
+		bool valid = false;
+	};
 	std::vector<std::shared_ptr<Faction>> m_factions;
+	// Dispositions between faction pairs, indexed by [faction *numFactions +target]
+	std::vector<CachedDisposition> m_factionDispositions;
+	// Dispositions of each faction towards entity classes
+	std::vector<std::unordered_map<std::string, CachedDisposition>> m_classDispositions;
   public:
 	FactionManager();
 	std::shared_ptr<Faction> RegisterFaction(const std::string &name);
 	const std::vector<std::shared_ptr<Faction>> &GetFactions();
 	std::shared_ptr<Faction> FindFactionByName(const std::string &name);
+	// Same as Faction::GetDisposition, but the results are cached until the relationships or classes of any faction change
+	DISPOSITION GetDisposition(Faction &faction, Faction &target, int *priority = nullptr);
+	DISPOSITION GetDisposition(Faction &faction, const std::string &className, int *priority = nullptr);
+	void InvalidateDispositionCache();
 };
 
 #endif
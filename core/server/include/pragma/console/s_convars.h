@@ -42,6 +42,9 @@ REGISTER_SHARED_CONVAR(sv_acceleration, udm::Type::Float, "33", ConVarFlags::Arc
 REGISTER_SHARED_CONVAR(sv_acceleration_ramp_up_time, udm::Type::Float, "0", ConVarFlags::Archive | ConVarFlags::Replicated, "The time it takes to reach full acceleration.");
 
 REGISTER_CONVAR_SV(sv_allowdownload, udm::Type::Boolean, "1", ConVarFlags::Archive, "Specifies whether clients are allowed to download resources from the server.");
+REGISTER_CONVAR_SV(sv_ai_perception_budget, udm::Type::UInt32, "32", ConVarFlags::Archive, "Maximum number of NPCs which may update their visual perception per tick. NPCs beyond this limit are updated on one of the next ticks instead. 0 = unlimited.");
+REGISTER_CONVAR_SV(sv_ai_perception_max_raycasts, udm::Type::UInt32, "0", ConVarFlags::Archive,
+  "Maximum number of line of sight traces an NPC may issue per perception update. The closest potential targets are traced first. 0 = unlimited.");
 REGISTER_CONVAR_SV(sv_allowupload, udm::Type::Boolean, "1", ConVarFlags::Archive, "Specifies whether clients are allowed to upload resources to the server (e.g. spraylogos).");
 #endif
 #endif
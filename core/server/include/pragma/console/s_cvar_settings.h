@@ -14,6 +14,15 @@ REGISTER_CONVAR_SV(sv_password, udm::Type::String, "", ConVarFlags::Archive, "Se
 REGISTER_CONVAR_SV(sv_maxplayers, udm::Type::UInt32, "1", ConVarFlags::Archive, "Specifies the maximum amount of players that are allowed to join the server.");
 
 REGISTER_CONVAR_SV(sv_physics_simulation_enabled, udm::Type::Boolean, "1", ConVarFlags::Cheat, "Enables or disables physics simulation.");
+REGISTER_CONVAR_SV(sv_resource_transfer_window_size, udm::Type::UInt32, "262144", ConVarFlags::Archive, "Maximum number of resource bytes that may be sent to a client before it has to acknowledge them.");
+REGISTER_CONVAR_SV(sv_resource_transfer_max_files, udm::Type::UInt32, "4", ConVarFlags::Archive, "Maximum number of resource files that are transferred to a client concurrently.");
+REGISTER_CONVAR_SV(sv_resource_transfer_compression, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, resource fragments will be compressed with LZ4 if it reduces their size.");
+REGISTER_CONVAR_SV(sv_snapshot_relevancy_enabled, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, entities will only be included in a player's snapshot if they are potentially visible to the player.");
+REGISTER_CONVAR_SV(sv_snapshot_relevancy_max_distance, udm::Type::Float, "0", ConVarFlags::Archive, "Entities further away from a player than this distance will not be included in the player's snapshot. A value of 0 disables the distance limit. Has no effect if sv_snapshot_relevancy_enabled is disabled.");
+REGISTER_CONVAR_SV(sv_snapshot_multithreaded, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, the snapshots for multiple players will be encoded in parallel.");
+REGISTER_CONVAR_SV(sv_snapshot_delta_compression_enabled, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, entity transforms in snapshots will only be transmitted if they have changed since the last snapshot acknowledged by the client.");
+REGISTER_CONVAR_SV(sv_lag_compensation_enabled, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, hitscan bullets fired by players will be tested against the hitboxes as they were posed when the player fired, based on the player's latency.");
+REGISTER_CONVAR_SV(sv_lag_compensation_max_time, udm::Type::Float, "0.5", ConVarFlags::Archive, "Maximum amount of time (in seconds) hitboxes can be rewound for lag compensation. Players with a higher latency will be compensated by this amount only.");
 
 REGISTER_CONVAR_SV(sv_water_surface_simulation_edge_iteration_count, udm::Type::UInt32, "5", ConVarFlags::Archive, "The more iterations, the more detailed the water simulation will be, but at a great performance cost.");
 REGISTER_CONVAR_SV(sv_water_surface_simulation_shared, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, water surface simulation will be shared between client and server (Simulation is only performed once). This will only have an effect in single-player or on listen servers.");
@@ -11,6 +11,7 @@
 #include "pragma/ai/ai_memory.h"
 #include "pragma/ai/s_factions.h"
 #include "pragma/ai/s_disposition.h"
+#include "pragma/ai/s_ai_perception.hpp"
 #include "pragma/ai/ai_behavior.h"
 #include "pragma/entities/components/s_entity_component.hpp"
 #include <pragma/model/animation/play_animation_flags.hpp>
@@ -100,8 +101,10 @@ namespace pragma {
 	  private:
 		static std::vector<SAIComponent *> s_npcs;
 		static FactionManager s_factionManager;
+		static ai::PerceptionScheduler s_perceptionScheduler;
 	  public:
 		static FactionManager &GetFactionManager();
+		static ai::PerceptionScheduler &GetPerceptionScheduler();
 	  public:
 		static unsigned int GetNPCCount();
 		static const std::vector<SAIComponent *> &GetAll();
@@ -130,6 +133,7 @@ namespace pragma {
 		SAIComponent(BaseEntity &ent);
 		virtual ~SAIComponent() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		const ai::Memory::Fragment *GetPrimaryTarget() const;
 		float GetMaxViewDistance() const;
 		void SetMaxViewDistance(float dist);
@@ -170,6 +174,9 @@ namespace pragma {
 		// Returns the number of occupied memory fragments
 		uint32_t GetMemoryFragmentCount() const;
 		bool IsInViewCone(BaseEntity *ent, float *dist = nullptr);
+		// Same as IsInViewCone, but without the line of sight test
+		bool IsInViewRange(BaseEntity &ent, Vector3 &outTargetPos, float &outDist);
+		bool HasLineOfSight(BaseEntity &ent, const Vector3 &targetPos);
 		float GetMemoryDuration();
 		void SetMemoryDuration(float dur);
 		bool CanSee() const;
@@ -25,6 +25,9 @@ namespace pragma {
 	  public:
 		virtual void SendSnapshotData(NetPacket &packet, pragma::BasePlayerComponent &pl) = 0;
 		virtual bool ShouldTransmitSnapshotData() const = 0;
+		// If true, SendSnapshotData is called for every player individually, otherwise the data is written
+		// once per snapshot and shared between all players (in which case the player argument is an arbitrary recipient).
+		virtual bool IsSnapshotDataPlayerDependent() const { return false; }
 	};
 
 	/////////////////////////////
@@ -0,0 +1,78 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __S_HITBOX_BVH_COMPONENT_HPP__
+#define __S_HITBOX_BVH_COMPONENT_HPP__
+
+#include "pragma/serverdefinitions.h"
+#include "pragma/entities/components/s_entity_component.hpp"
+#include <pragma/entities/components/base_entity_component.hpp>
+#include <pragma/entities/components/hitbox_bvh_data.hpp>
+#include <pragma/physics/hitboxes.h>
+#include <optional>
+
+namespace pragma {
+	// Records the hitbox poses of the last few ticks, so that hitscan traces fired by clients can be tested
+	// against the hitboxes as the client saw them when firing (lag compensation).
+	class DLLSERVER SHitboxBvhComponent final : public BaseEntityComponent {
+	  public:
+		struct DLLSERVER Ray {
+			Vector3 origin;
+			Vector3 dir; // Has to be normalized
+			float maxDist;
+		};
+		struct DLLSERVER HitData {
+			pragma::animation::BoneId boneId;
+			HitGroup hitGroup;
+			float distance;
+			Vector3 position;
+		};
+		struct DLLSERVER EntityHitData {
+			EntityHandle entity;
+			HitData hit;
+		};
+		// Tests the rays against the hitboxes of all entities with this component, as they were posed at time t. Each entity
+		// is rewound at most once, regardless of the number of rays. outHits[i] receives the closest hit of rays[i], if any.
+		static void Raycast(Game &game, const std::vector<Ray> &rays, double t, std::vector<std::optional<EntityHitData>> &outHits, const std::function<bool(BaseEntity &)> &filter = nullptr);
+
+		SHitboxBvhComponent(BaseEntity &ent);
+		virtual void Initialize() override;
+		virtual void InitializeLuaObject(lua_State *l) override;
+		virtual void OnTick(double tDelta) override;
+
+		// Tests the rays against the hitboxes of this entity, as they were posed at time t. Times outside of the recorded
+		// history are clamped.
+		bool Raycast(const std::vector<Ray> &rays, double t, std::vector<std::optional<HitData>> &outHits);
+		// World-space bounds around all hitboxes at time t
+		bool GetHitboxBounds(double t, Vector3 &outMin, Vector3 &outMax) const;
+		bool HasPoseHistory() const;
+		const bvh::HitboxPoseHistory &GetPoseHistory() const { return m_poseHistory; }
+		void ClearPoseHistory();
+	  private:
+		struct HitboxBvhTree : public pragma::bvh::BvhTree {
+			void InitializeBvh(const std::vector<umath::ScaledTransform> &poses);
+			void Refit(const std::vector<umath::ScaledTransform> &poses);
+			std::vector<pragma::bvh::HitboxObb> primitives;
+			std::vector<HitGroup> hitGroups;
+		  private:
+			const std::vector<umath::ScaledTransform> *m_poses = nullptr;
+			virtual bool DoInitializeBvh(pragma::bvh::Executor &executor, ::bvh::v2::DefaultBuilder<pragma::bvh::Node>::Config &config) override;
+		};
+		void OnModelChanged();
+		void InitializeHitboxBvh();
+		void RecordPose(double t);
+		void UpdatePoseHistoryCapacity();
+
+		bvh::HitboxPoseHistory m_poseHistory;
+		std::unique_ptr<HitboxBvhTree> m_hitboxBvh;
+		// Scratch data for rewinding, re-used between queries
+		umath::ScaledTransform m_rewindPose;
+		std::vector<umath::ScaledTransform> m_rewindBonePoses;
+	};
+};
+
+#endif
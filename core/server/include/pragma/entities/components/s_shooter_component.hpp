@@ -25,6 +25,10 @@ namespace pragma {
 		virtual void InitializeLuaObject(lua_State *l) override;
 	  protected:
 		virtual void FireBullets(const BulletInfo &bulletInfo, DamageInfo &dmgInfo, std::vector<TraceResult> &outHitTargets, const std::function<bool(DamageInfo &, BaseEntity *)> &fCallback = nullptr, bool bMaster = true);
+		virtual RayCastHitType OnBulletHit(const BulletInfo &bulletInfo, const TraceData &data, PhysObj &phys, physics::ICollisionObject &col) override;
+	  private:
+		// If set, hitbox collision objects of lag-compensated entities are ignored by the physics trace
+		bool m_lagCompensatedTrace = false;
 	};
 };
 
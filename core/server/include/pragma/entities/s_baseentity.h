@@ -26,6 +26,7 @@ class DLLSERVER SBaseEntity : public BaseEntity {
   protected:
 	bool m_bShared;
 	Bool m_bSynchronized;
+	bool m_bSnapshotAlwaysRelevant;
 	virtual void OnComponentAdded(pragma::BaseEntityComponent &component) override;
 	virtual void OnComponentRemoved(pragma::BaseEntityComponent &component) override;
   public:
@@ -48,6 +49,9 @@ class DLLSERVER SBaseEntity : public BaseEntity {
 	BaseEntity *GetClientsideEntity() const;
 	Bool IsSynchronized() const;
 	void SetSynchronized(Bool b);
+	// If enabled, the entity will be included in the snapshots of all players, regardless of visibility or distance
+	bool IsSnapshotAlwaysRelevant() const;
+	void SetSnapshotAlwaysRelevant(bool b);
 
 	virtual pragma::ComponentHandle<pragma::BaseAnimatedComponent> GetAnimatedComponent() const override;
 	virtual pragma::ComponentHandle<pragma::BaseWeaponComponent> GetWeaponComponent() const override;
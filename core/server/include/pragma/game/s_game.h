@@ -9,6 +9,9 @@
 #include <pragma/game/game.h>
 #include "pragma/serverdefinitions.h"
 #include "pragma/entities/world.h"
+#include <pragma/networking/snapshot_delta.hpp>
+#include "pragma/networking/snapshot_relevancy.hpp"
+#include "pragma/networking/snapshot_state_table.hpp"
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -52,6 +55,25 @@ class DLLSERVER SGame : public Game {
 	std::unordered_map<std::string, udm::PProperty> m_preTransitionWorldState {};
 	// Delta landmark offset between this level and the previous level (in case there was a level change)
 	Vector3 m_deltaTransitionLandmarkOffset {};
+	// Used to quantize entity transforms for snapshots. Bounds are derived from the world once the map has been loaded.
+	pragma::networking::SnapshotQuantizer m_snapshotQuantizer {};
+	pragma::networking::SnapshotRelevancy m_snapshotRelevancy {};
+	void UpdateSnapshotQuantizationBounds();
+	// Clears all per-client snapshot baselines and relevancy caches
+	void ResetClientSnapshotStates();
+
+	// Snapshots are created in two phases: The state of all entities is gathered on the main thread first,
+	// then the packets for all clients are encoded from that state on the engine's job system.
+	struct SnapshotEncodeSettings {
+		bool deltaCompression = true;
+		bool relevancy = true;
+		float maxDistance = 0.f;
+	};
+	pragma::networking::SnapshotStateTable m_snapshotStateTable {};
+	void GatherSnapshotStates(const std::vector<pragma::SPlayerComponent *> &recipients, bool useRelevancy);
+	void GatherSnapshotState(SBaseEntity &ent, bool markedForSnapshot, bool useRelevancy);
+	void EncodeSnapshot(uint32_t clientIdx, const SnapshotEncodeSettings &settings);
+	void SendSnapshots(const std::vector<pragma::SPlayerComponent *> &recipients);
   public:
 	enum class CPUProfilingPhase : uint32_t {
 		Snapshot = 0u,
@@ -78,6 +100,7 @@ class DLLSERVER SGame : public Game {
 	virtual void RegisterLuaEntityComponents(luabind::module_ &gameMod) override;
 	virtual void RegisterLuaEntityComponent(luabind::class_<pragma::BaseEntityComponent> &classDef) override;
 	virtual bool InitializeGameMode() override;
+	virtual void InitializeWorldData(pragma::asset::WorldData &worldData) override;
 
 	const pragma::NetEventManager &GetEntityNetEventManager() const;
 	pragma::NetEventManager &GetEntityNetEventManager();
@@ -110,6 +133,7 @@ class DLLSERVER SGame : public Game {
 	virtual void RegisterLuaClasses() override;
 	void SendSnapshot();
 	void SendSnapshot(pragma::SPlayerComponent *pl);
+	const pragma::networking::SnapshotQuantizer &GetSnapshotQuantizer() const;
 	virtual std::shared_ptr<ModelMesh> CreateModelMesh() const override;
 	virtual std::shared_ptr<ModelSubMesh> CreateModelSubMesh() const override;
 	virtual void GetRegisteredEntities(std::vector<std::string> &classes, std::vector<std::string> &luaClasses) const override;
@@ -22,6 +22,7 @@ namespace pragma {
 		virtual void SendSnapshotData(NetPacket &packet, pragma::BasePlayerComponent &pl) override;
 		virtual bool ShouldTransmitNetData() const override;
 		virtual bool ShouldTransmitSnapshotData() const override;
+		virtual bool IsSnapshotDataPlayerDependent() const override;
 
 		virtual void OnMemberValueChanged(uint32_t memberIdx) override;
 	  protected:
@@ -10,6 +10,8 @@
 #include "pragma/serverdefinitions.h"
 #include "pragma/networking/enums.hpp"
 #include "pragma/networking/ip_address.hpp"
+#include <pragma/networking/snapshot_delta.hpp>
+#include "pragma/networking/snapshot_relevancy.hpp"
 #include <cinttypes>
 
 class Resource;
@@ -42,6 +44,8 @@ namespace pragma::networking {
 		const std::vector<std::shared_ptr<Resource>> &GetResourceTransfer() const;
 		bool AddResource(const std::string &fileName, bool stream = true);
 		void RemoveResource(uint32_t i);
+		// Returns the index of the resource with the specified transfer id, or -1 if there is none
+		int32_t FindResource(uint32_t transferId) const;
 		void ClearResourceTransfer();
 		bool IsInitialResourceTransferComplete() const;
 		void SetInitialResourceTransferState(TransferState state);
@@ -50,6 +54,9 @@ namespace pragma::networking {
 		bool IsTransferring() const;
 
 		uint8_t SwapSnapshotId();
+		SnapshotBaselineBuffer &GetSnapshotBaselines();
+		const SnapshotBaselineBuffer &GetSnapshotBaselines() const;
+		SnapshotRelevancy::ClientCache &GetSnapshotRelevancyCache();
 		void Reset();
 		void ScheduleResource(const std::string &fileName);
 		std::vector<std::string> &GetScheduledResources();
@@ -63,9 +70,12 @@ namespace pragma::networking {
 		mutable pragma::ComponentHandle<pragma::SPlayerComponent> m_player = {};
 		bool m_bTransferring = false;
 		std::vector<std::shared_ptr<Resource>> m_resourceTransfer;
+		uint32_t m_nextResourceTransferId = 0;
 		TransferState m_initialResourceTransferState = TransferState::Initial;
 
 		uint8_t m_snapshotId = 0;
+		SnapshotBaselineBuffer m_snapshotBaselines; // Entity states of the last snapshots sent to this client
+		SnapshotRelevancy::ClientCache m_snapshotRelevancyCache;
 		std::vector<std::string> m_scheduledResources; // Scheduled resource files for download
 
 		// TODO: Move this somewhere else?
@@ -16,14 +16,24 @@ class VFilePtrInternal;
 #pragma warning(disable : 4251)
 struct DLLSERVER Resource
 {
+	enum class State : uint8_t
+	{
+		Pending = 0, // Waiting to be announced to the client
+		Announced, // Resource info has been sent, waiting for the client's response
+		Transferring
+	};
 	Resource(std::string name,bool bStream=true);
 	~Resource();
 	bool Construct();
 	std::string name;
-	unsigned int offset;
+	uint32_t transferId = 0;
+	State state = State::Pending;
+	uint64_t size = 0;
+	uint64_t offset; // Number of bytes sent to the client
+	uint64_t ackOffset = 0; // Number of bytes the client has confirmed to have received
 	std::shared_ptr<VFilePtrInternal> file;
 	bool stream;
 };
 #pragma warning(pop)
 
-#endif
\ No newline at end of file
+#endif
@@ -9,6 +9,8 @@
 #include "pragma/networking/s_net_definitions.h"
 DECLARE_NETMESSAGE_SV(disconnect);
 DECLARE_NETMESSAGE_SV(userinput);
+DECLARE_NETMESSAGE_SV(snapshot_ack);
+DECLARE_NETMESSAGE_SV(snapshot_full_request);
 DECLARE_NETMESSAGE_SV(clientinfo);
 DECLARE_NETMESSAGE_SV(game_ready);
 DECLARE_NETMESSAGE_SV(cmd_call);
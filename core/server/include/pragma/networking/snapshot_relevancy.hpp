@@ -0,0 +1,80 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan */
+
+#ifndef __PRAGMA_SNAPSHOT_RELEVANCY_HPP__
+#define __PRAGMA_SNAPSHOT_RELEVANCY_HPP__
+
+#include "pragma/serverdefinitions.h"
+#include <pragma/util/util_bsp_tree.hpp>
+#include <mathutil/uvec.h>
+#include <vector>
+#include <memory>
+
+class SBaseEntity;
+namespace pragma::networking {
+	// Determines which entities have to be included in the snapshot of a client,
+	// based on the potentially visible set of the map and the distance to the client's view position.
+	class DLLSERVER SnapshotRelevancy {
+	  public:
+		static constexpr auto INVALID_CLUSTER = std::numeric_limits<util::BSPTree::ClusterIndex>::max();
+
+		// Relevancy state of a single client. PVS results are cached until either the client
+		// moves into a different cluster, or the clusters of an entity change.
+		struct DLLSERVER ClientCache {
+			void Invalidate();
+			bool IsDeferred(uint32_t entIdx) const;
+			void SetDeferred(uint32_t entIdx, bool deferred);
+
+			util::BSPTree::ClusterIndex viewCluster = INVALID_CLUSTER;
+			// Decompressed visibility row of the view cluster
+			std::vector<uint8_t> viewClusterVisibility;
+			struct Entry {
+				uint64_t generation = 0;
+				bool pvsVisible = false;
+			};
+			std::vector<Entry> entries; // Indexed by entity index
+			// Entities that were marked for a snapshot while they weren't relevant to this client.
+			// They will be sent once they become relevant again.
+			std::vector<bool> deferred;
+		};
+
+		// Location of an entity as required for the relevancy test
+		struct EntityInfo {
+			uint32_t index = 0;
+			Vector3 position {};
+			float radius = 0.f;
+			bool alwaysRelevant = false;
+		};
+
+		void SetBSPTree(const std::shared_ptr<util::BSPTree> &bspTree);
+		const std::shared_ptr<util::BSPTree> &GetBSPTree() const;
+		void Clear();
+		void OnEntityRemoved(uint32_t entIdx);
+
+		// Has to be called once per snapshot for every entity that may be sent, before any calls to IsRelevant.
+		// This is the only function that modifies shared state and must not be called concurrently.
+		EntityInfo UpdateEntity(SBaseEntity &ent);
+		// Has to be called once per snapshot before any calls to IsRelevant for this client
+		void UpdateClient(ClientCache &cache, const Vector3 &viewPos) const;
+		// Only modifies the client cache, so different clients can be processed concurrently.
+		// maxDistance <= 0 means no distance limit
+		bool IsRelevant(ClientCache &cache, const Vector3 &viewPos, const EntityInfo &info, float maxDistance) const;
+	  private:
+		struct EntityEntry {
+			// Bounds the clusters were determined for. These are slightly larger than the entity, so small movements don't require an update.
+			Vector3 min {};
+			Vector3 max {};
+			std::vector<util::BSPTree::ClusterIndex> clusters;
+			uint64_t generation = 0;
+		};
+		void UpdateEntityEntry(uint32_t entIdx, const Vector3 &min, const Vector3 &max);
+		std::shared_ptr<util::BSPTree> m_bspTree = nullptr;
+		std::vector<EntityEntry> m_entityEntries;
+		uint64_t m_nextGeneration = 1;
+	};
+};
+
+#endif
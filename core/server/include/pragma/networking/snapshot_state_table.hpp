@@ -0,0 +1,63 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan */
+
+#ifndef __PRAGMA_SNAPSHOT_STATE_TABLE_HPP__
+#define __PRAGMA_SNAPSHOT_STATE_TABLE_HPP__
+
+#include "pragma/serverdefinitions.h"
+#include "pragma/networking/snapshot_relevancy.hpp"
+#include <mathutil/uvec.h>
+#include <sharedutils/netpacket.hpp>
+#include <vector>
+
+class SBaseEntity;
+namespace pragma {
+	class SPlayerComponent;
+};
+namespace pragma::networking {
+	class IServerClient;
+	// Snapshot data of all entities that may have to be sent to at least one client this tick.
+	// It is gathered once on the main thread and is read-only afterwards, so the snapshots
+	// of all clients can be encoded concurrently.
+	struct DLLSERVER SnapshotStateTable {
+		// Data written by callbacks which depend on the receiving player (and may run Lua code).
+		// It is gathered for every client individually and inserted into the shared data during encoding.
+		struct ClientDependentData {
+			size_t offset = 0; // Offset into EntityState::data
+			std::vector<std::vector<uint8_t>> clientData; // Indexed by client index
+		};
+		struct EntityState {
+			SBaseEntity *entity = nullptr;
+			bool markedForSnapshot = false;
+			Vector3 position {};
+			Vector3 velocity {};
+			Vector3 angularVelocity {};
+			Quat rotation = uquat::identity();
+			SnapshotRelevancy::EntityInfo relevancyInfo {};
+			// Everything following the entity transform in the snapshot
+			std::vector<uint8_t> data;
+			std::vector<ClientDependentData> clientDependentData; // Sorted by offset
+		};
+		struct ClientState {
+			IServerClient *session = nullptr;
+			SPlayerComponent *player = nullptr;
+			Vector3 viewPos {};
+			std::vector<uint8_t> keyStack;
+			NetPacket packet {};
+		};
+		struct PlayerState {
+			SPlayerComponent *player = nullptr;
+			std::vector<uint8_t> data;
+		};
+		double time = 0.0;
+		std::vector<EntityState> entities;
+		std::vector<ClientState> clients;
+		std::vector<PlayerState> players;
+		void Clear();
+	};
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include <pragma/input/inkeys.h>
 #include <pragma/networking/enums.hpp>
 #include <sharedutils/chronoutil.h>
+#include <optional>
 #include "wmserverdata.h"
 
 #define FSYS_SEARCH_CACHE 8'192
@@ -25,6 +26,7 @@ namespace pragma {
 		class IServerClient;
 		class ClientRecipientFilter;
 		class MasterServerRegistration;
+		struct ResourceHashJob;
 		enum class Protocol : uint8_t;
 	};
 };
@@ -54,6 +56,15 @@ class DLLSERVER ServerState : public NetworkState {
 	std::deque<unsigned int> m_alsoundIndex;
 	// We need to keep shared pointer references to all serverside sounds (Network state only keeps references)
 	std::vector<std::shared_ptr<ALSound>> m_serverSounds;
+
+	// Content hashes of resource files, by canonicalized file name. Files which couldn't be hashed have no hash,
+	// in which case clients don't verify them.
+	std::unordered_map<std::string, std::optional<std::string>> m_resourceHashes;
+	// Hashes are computed on the job system, resources aren't announced to clients until their hash is available
+	std::unordered_map<std::string, std::shared_ptr<pragma::networking::ResourceHashJob>> m_pendingResourceHashes;
+	// Returns nullptr and schedules the hash computation if the hash isn't available yet
+	const std::optional<std::string> *FindResourceHash(const Resource &res);
+	void UpdateResourceHashes();
   protected:
 	virtual void implFindSimilarConVars(const std::string &input, std::vector<SimilarCmdInfo> &similarCmds) const override;
 	virtual Material *LoadMaterial(const std::string &path, bool precache, bool bReload) override;
@@ -107,7 +118,12 @@ class DLLSERVER ServerState : public NetworkState {
 	void InitResourceTransfer(pragma::networking::IServerClient &session);
 	void HandleServerNextResource(pragma::networking::IServerClient &session);
 	void HandleServerResourceStart(pragma::networking::IServerClient &session, NetPacket &packet);
-	void HandleServerResourceFragment(pragma::networking::IServerClient &session);
+	// Sends fragments of all resources that are currently being transferred, until the transfer window is full
+	void HandleServerResourceFragments(pragma::networking::IServerClient &session);
+	void HandleServerResourceAck(pragma::networking::IServerClient &session, NetPacket &packet);
+	// The client has received a corrupt fragment or file and wants the transfer to be rewound
+	void HandleServerResourceNack(pragma::networking::IServerClient &session, NetPacket &packet);
+	void HandleServerResourceAbort(pragma::networking::IServerClient &session, NetPacket &packet);
 	void HandleLuaNetPacket(pragma::networking::IServerClient &session, NetPacket &packet);
 	bool HandlePacket(pragma::networking::IServerClient &session, NetPacket &packet);
 	void ReceiveUserInput(pragma::networking::IServerClient &session, NetPacket &packet);
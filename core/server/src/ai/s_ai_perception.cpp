@@ -0,0 +1,98 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_server.h"
+#include "pragma/ai/s_ai_perception.hpp"
+#include "pragma/ai/s_disposition.h"
+#include "pragma/entities/components/s_ai_component.hpp"
+#include "pragma/entities/components/s_character_component.hpp"
+#include "pragma/game/s_game.h"
+#include <pragma/entities/entity_spatial_index.hpp>
+#include <pragma/entities/components/base_character_component.hpp>
+#include <algorithm>
+
+using namespace pragma::ai;
+
+extern DLLSERVER SGame *s_game;
+
+bool PerceptionScheduler::BeginUpdate(double curTime)
+{
+	if(curTime != m_budgetTime) {
+		m_budgetTime = curTime;
+		m_updatesThisTick = 0;
+	}
+	if(m_updateBudget > 0 && m_updatesThisTick >= m_updateBudget) {
+		++m_statistics.deferredCount;
+		return false;
+	}
+	++m_updatesThisTick;
+	++m_statistics.updateCount;
+	return true;
+}
+
+void PerceptionScheduler::SetUpdateBudget(uint32_t budget) { m_updateBudget = budget; }
+uint32_t PerceptionScheduler::GetUpdateBudget() const { return m_updateBudget; }
+void PerceptionScheduler::SetMaxRaycastsPerUpdate(uint32_t maxRaycasts) { m_maxRaycastsPerUpdate = maxRaycasts; }
+uint32_t PerceptionScheduler::GetMaxRaycastsPerUpdate() const { return m_maxRaycastsPerUpdate; }
+
+void PerceptionScheduler::CollectVisibilityCandidates(SAIComponent &npc, std::vector<VisibilityCandidate> &outCandidates)
+{
+	outCandidates.clear();
+	auto &entThis = npc.GetEntity();
+	auto charComponentThis = entThis.GetCharacterComponent();
+	if(charComponentThis.expired())
+		return;
+	auto origin = charComponentThis->GetEyePosition();
+	auto range = npc.GetMaxViewDistance() + QUERY_MARGIN;
+	m_entityBuffer.clear();
+	s_game->GetEntitySpatialIndex().FindCandidates(origin - Vector3 {range, range, range}, origin + Vector3 {range, range, range}, m_entityBuffer);
+
+	for(auto *ent : m_entityBuffer) {
+		if(ent == &entThis)
+			continue;
+		auto *charComponent = static_cast<pragma::SCharacterComponent *>(ent->GetCharacterComponent().get());
+		if(ent->IsPlayer()) {
+			if(charComponent != nullptr && charComponent->IsAlive() == false)
+				continue;
+		}
+		else if(ent->IsNPC() == false)
+			continue;
+		else if(charComponent != nullptr && charComponent->IsAlive() == false)
+			continue;
+		if(charComponent != nullptr && charComponent->GetNoTarget())
+			continue;
+		if(npc.IsInMemory(ent) || npc.GetDisposition(ent) != DISPOSITION::HATE)
+			continue;
+		VisibilityCandidate candidate {};
+		candidate.entity = ent;
+		if(npc.IsInViewRange(*ent, candidate.position, candidate.distance) == false)
+			continue;
+		outCandidates.push_back(candidate);
+	}
+	std::sort(outCandidates.begin(), outCandidates.end(), [](const VisibilityCandidate &a, const VisibilityCandidate &b) { return a.distance < b.distance; });
+	m_statistics.candidateCount += outCandidates.size();
+}
+
+void PerceptionScheduler::ResolveVisibility(SAIComponent &npc, std::vector<VisibilityCandidate> &candidates)
+{
+	auto numCandidates = candidates.size();
+	if(m_maxRaycastsPerUpdate > 0)
+		numCandidates = std::min<size_t>(numCandidates, m_maxRaycastsPerUpdate);
+	size_t numVisible = 0;
+	for(auto i = decltype(numCandidates) {0u}; i < numCandidates; ++i) {
+		auto &candidate = candidates[i];
+		++m_statistics.raycastCount;
+		if(npc.HasLineOfSight(*candidate.entity, candidate.position) == false)
+			continue;
+		candidates[numVisible++] = candidate;
+	}
+	candidates.resize(numVisible);
+}
+
+std::vector<PerceptionScheduler::VisibilityCandidate> &PerceptionScheduler::GetCandidateBuffer() { return m_candidateBuffer; }
+const PerceptionScheduler::Statistics &PerceptionScheduler::GetStatistics() const { return m_statistics; }
+void PerceptionScheduler::ResetStatistics() { m_statistics = {}; }
@@ -10,19 +10,36 @@
 #include <pragma/entities/baseentity.h>
 #include <pragma/entities/baseentity_handle.h>
 #include <algorithm>
+#include <limits>
 
 Faction::Faction(const std::string &name) : std::enable_shared_from_this<Faction>(), m_name(name), m_defaultDisp(DISPOSITION::NEUTRAL) {}
+void Faction::InvalidateDispositionCache()
+{
+	if(m_manager != nullptr)
+		m_manager->InvalidateDispositionCache();
+}
 void Faction::AddClass(std::string className)
 {
 	std::transform(className.begin(), className.end(), className.begin(), ::tolower);
 	if(HasClass(className))
 		return;
 	m_classes.push_back(className);
+	InvalidateDispositionCache();
+}
+void Faction::RemoveClass(std::string className)
+{
+	std::transform(className.begin(), className.end(), className.begin(), ::tolower);
+	auto it = std::find(m_classes.begin(), m_classes.end(), className);
+	if(it == m_classes.end())
+		return;
+	m_classes.erase(it);
+	InvalidateDispositionCache();
 }
 const std::string &Faction::GetName() const { return m_name; }
-std::vector<std::string> &Faction::GetClasses() { return m_classes; }
+const std::vector<std::string> &Faction::GetClasses() const { return m_classes; }
 void Faction::SetDisposition(Faction &faction, DISPOSITION disp, bool revert, int priority)
 {
+	InvalidateDispositionCache();
 	if(revert == true)
 		faction.SetDisposition(*this, disp, false, priority);
 	for(char i = 0; i < 4; i++) {
@@ -111,7 +128,11 @@ bool Faction::HasClass(std::string className)
 	}
 	return false;
 }
-void Faction::SetDefaultDisposition(DISPOSITION disp) { m_defaultDisp = disp; }
+void Faction::SetDefaultDisposition(DISPOSITION disp)
+{
+	m_defaultDisp = disp;
+	InvalidateDispositionCache();
+}
 DISPOSITION Faction::GetDefaultDisposition() { return m_defaultDisp; }
 bool Faction::operator==(Faction &other) { return this == &other; }
 
@@ -126,8 +147,12 @@ std::shared_ptr<Faction> FactionManager::RegisterFaction(const std::string &name
 	auto it = std::find_if(m_factions.begin(), m_factions.end(), [&lname](const std::shared_ptr<Faction> &faction) { return (faction->GetName() == lname) ? true : false; });
 	if(it != m_factions.end())
 		return *it;
-	m_factions.push_back(std::shared_ptr<Faction>(new Faction(lname)));
-	return m_factions.back();
+	auto faction = std::shared_ptr<Faction>(new Faction(lname));
+	faction->m_manager = this;
+	faction->m_index = static_cast<uint32_t>(m_factions.size());
+	m_factions.push_back(faction);
+	InvalidateDispositionCache();
+	return faction;
 }
 const std::vector<std::shared_ptr<Faction>> &FactionManager::GetFactions() { return m_factions; }
 std::shared_ptr<Faction> FactionManager::FindFactionByName(const std::string &name)
@@ -137,3 +162,50 @@ std::shared_ptr<Faction> FactionManager::FindFactionByName(const std::string &na
 	auto it = std::find_if(m_factions.begin(), m_factions.end(), [&lname](const std::shared_ptr<Faction> &faction) { return (faction->GetName() == lname) ? true : false; });
 	return (it != m_factions.end()) ? *it : nullptr;
 }
+void FactionManager::InvalidateDispositionCache()
+{
+	m_factionDispositions.clear();
+	m_classDispositions.clear();
+}
+static DISPOSITION get_disposition(const std::optional<int> &cachedPriority, DISPOSITION disposition, int *priority)
+{
+	if(priority != nullptr && cachedPriority.has_value())
+		*priority = *cachedPriority;
+	return disposition;
+}
+DISPOSITION FactionManager::GetDisposition(Faction &faction, Faction &target, int *priority)
+{
+	auto numFactions = m_factions.size();
+	if(faction.m_manager != this || target.m_manager != this)
+		return faction.GetDisposition(target, priority);
+	if(m_factionDispositions.empty())
+		m_factionDispositions.resize(numFactions * numFactions);
+	auto &cache = m_factionDispositions[faction.m_index * numFactions + target.m_index];
+	if(cache.valid == false) {
+		int prio;
+		cache.disposition = faction.GetDisposition(target, &prio);
+		cache.priority = prio;
+		cache.valid = true;
+	}
+	return get_disposition(cache.priority, cache.disposition, priority);
+}
+DISPOSITION FactionManager::GetDisposition(Faction &faction, const std::string &className, int *priority)
+{
+	if(faction.m_manager != this)
+		return faction.GetDisposition(className, priority);
+	if(m_classDispositions.empty())
+		m_classDispositions.resize(m_factions.size());
+	auto &classDispositions = m_classDispositions[faction.m_index];
+	auto it = classDispositions.find(className);
+	if(it == classDispositions.end()) {
+		constexpr auto unassigned = std::numeric_limits<int>::min();
+		auto prio = unassigned;
+		CachedDisposition cache {};
+		cache.disposition = faction.GetDisposition(className, &prio);
+		if(prio != unassigned)
+			cache.priority = prio;
+		cache.valid = true;
+		it = classDispositions.insert(std::make_pair(className, cache)).first;
+	}
+	return get_disposition(it->second.priority, it->second.disposition, priority);
+}
@@ -31,6 +31,7 @@
 #include <sharedutils/netpacket.hpp>
 #include <pragma/networking/nwm_util.h>
 #include <pragma/logging.hpp>
+#include <pragma/console/convars.h>
 
 extern DLLSERVER SGame *s_game;
 
@@ -43,6 +44,10 @@ namespace pragma {
 decltype(SAIComponent::s_npcs) SAIComponent::s_npcs {};
 decltype(SAIComponent::s_factionManager) SAIComponent::s_factionManager {};
 FactionManager &SAIComponent::GetFactionManager() { return s_factionManager; }
+decltype(SAIComponent::s_perceptionScheduler) SAIComponent::s_perceptionScheduler {};
+ai::PerceptionScheduler &SAIComponent::GetPerceptionScheduler() { return s_perceptionScheduler; }
+REGISTER_CONVAR_CALLBACK_SV(sv_ai_perception_budget, [](NetworkState *, const ConVar &, int, int val) { SAIComponent::GetPerceptionScheduler().SetUpdateBudget(umath::max(val, 0)); });
+REGISTER_CONVAR_CALLBACK_SV(sv_ai_perception_max_raycasts, [](NetworkState *, const ConVar &, int, int val) { SAIComponent::GetPerceptionScheduler().SetMaxRaycastsPerUpdate(umath::max(val, 0)); });
 const std::vector<pragma::SAIComponent *> &SAIComponent::GetAll() { return s_npcs; }
 unsigned int SAIComponent::GetNPCCount() { return CUInt32(s_npcs.size()); }
 
@@ -224,6 +229,9 @@ void SAIComponent::OnEntitySpawn()
 	info.SetPlayAsSchedule(false);
 	PlayActivity(Activity::Idle, info);
 
+	// Offset the first perception update, so NPCs spawned during the same tick don't all update on the same ticks
+	m_tNextEnemyCheck = static_cast<float>(s_game->CurTime()) + umath::random(0.f, AI_NEXT_ENEMY_CHECK_IDLE);
+
 	auto pPhysComponent = ent.GetPhysicsComponent();
 	if(pPhysComponent != nullptr)
 		pPhysComponent->DropToFloor();
@@ -352,7 +360,7 @@ void SAIComponent::OnTick(double tDelta)
 	if(m_schedule != nullptr)
 		RunSchedule();
 	auto &t = s_game->CurTime();
-	if(t >= m_tNextEnemyCheck) {
+	if(t >= m_tNextEnemyCheck && s_perceptionScheduler.BeginUpdate(t)) {
 		SelectEnemies();
 		auto state = GetNPCState();
 		if(state == NPCSTATE::ALERT || state == NPCSTATE::COMBAT)
@@ -476,33 +484,13 @@ void SAIComponent::SelectEnemies()
 	auto numPrevTargets = GetMemoryFragmentCount();
 	std::vector<TargetInfo> newTargets;
 	Listen(newTargets);
-	for(unsigned int i = 0; i < s_npcs.size(); i++) {
-		SAIComponent *npc = s_npcs[i];
-		auto &ent = npc->GetEntity();
-		if(npc != this) {
-			auto *charComponent = static_cast<pragma::SCharacterComponent *>(ent.GetCharacterComponent().get());
-			if(charComponent == nullptr || (charComponent->IsAlive() == true && charComponent->GetNoTarget() == false)) {
-				auto disp = GetDisposition(&ent);
-				float dist;
-				if(disp == DISPOSITION::HATE && !IsInMemory(&ent) && IsInViewCone(&ent, &dist)) {
-					if(Memorize(&ent, ai::Memory::MemoryType::Visual) != nullptr)
-						newTargets.push_back({&ent, dist});
-				}
-			}
-		}
-	}
-	auto &players = SPlayerComponent::GetAll();
-	for(auto *pl : players) {
-		auto &ent = pl->GetEntity();
-		auto *charComponent = static_cast<pragma::SCharacterComponent *>(ent.GetCharacterComponent().get());
-		if(charComponent != nullptr && charComponent->IsAlive() == false)
-			continue;
-		auto disp = GetDisposition(&ent);
-		float dist;
-		if(disp == DISPOSITION::HATE && charComponent->GetNoTarget() == false && !IsInMemory(&ent) && IsInViewCone(&ent, &dist)) {
-			if(Memorize(&ent, ai::Memory::MemoryType::Visual) != nullptr)
-				newTargets.push_back({&ent, dist});
-		}
+	// Only targets within the view distance are considered, and line of sight is only traced for those which pass all other tests
+	auto &candidates = s_perceptionScheduler.GetCandidateBuffer();
+	s_perceptionScheduler.CollectVisibilityCandidates(*this, candidates);
+	s_perceptionScheduler.ResolveVisibility(*this, candidates);
+	for(auto &candidate : candidates) {
+		if(Memorize(candidate.entity, ai::Memory::MemoryType::Visual) != nullptr)
+			newTargets.push_back({candidate.entity, candidate.distance});
 	}
 	SelectPrimaryTarget();
 	auto bFirst = (numPrevTargets == 0) ? true : false;
@@ -527,6 +515,12 @@ bool SAIComponent::IsObstruction(const BaseEntity &ent) const
 
 void SAIComponent::OnEntityComponentAdded(BaseEntityComponent &component) { BaseAIComponent::OnEntityComponentAdded(component); }
 
+void SAIComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseAIComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_KILLED);
+}
+
 util::EventReply SAIComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseAIComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -161,7 +161,7 @@ DISPOSITION SAIComponent::GetDisposition(std::string className, int *priority)
 	auto disp = GetDefaultDisposition();
 	if(factionThis != nullptr) {
 		bFoundFaction = true;
-		disp = factionThis->GetDisposition(className, &prio);
+		disp = s_factionManager.GetDisposition(*factionThis, className, &prio);
 	}
 	auto bFound = false;
 	for(auto i = decltype(m_classRelationships.size()) {0}; i < m_classRelationships.size(); ++i) {
@@ -193,7 +193,7 @@ DISPOSITION SAIComponent::GetDisposition(Faction &faction, int *priority)
 	auto disp = GetDefaultDisposition();
 	if(factionThis != nullptr) {
 		bFoundFaction = true;
-		disp = factionThis->GetDisposition(faction, &prio);
+		disp = s_factionManager.GetDisposition(*factionThis, faction, &prio);
 	}
 	auto bFound = false;
 	for(auto i = decltype(m_factionRelationships.size()) {0}; i < m_factionRelationships.size(); ++i) {
@@ -17,32 +17,46 @@ extern DLLSERVER SGame *s_game;
 
 bool SAIComponent::IsInViewCone(BaseEntity *ent, float *dist)
 {
+	Vector3 posEnt;
+	float d;
+	auto r = IsInViewRange(*ent, posEnt, d);
+	if(dist != nullptr && d >= 0.f)
+		*dist = d;
+	return r && HasLineOfSight(*ent, posEnt);
+}
+
+bool SAIComponent::IsInViewRange(BaseEntity &ent, Vector3 &outTargetPos, float &outDist)
+{
+	// A negative distance signals that the target is not within the view cone
+	outDist = -1.f;
 	auto &entThis = GetEntity();
 	auto charComponent = entThis.GetCharacterComponent();
-	auto pTrComponent = ent->GetTransformComponent();
+	auto pTrComponent = ent.GetTransformComponent();
 	if(charComponent.expired() || pTrComponent == nullptr)
 		return false;
 	auto dir = charComponent->GetViewForward();
 	auto pos = charComponent->GetEyePosition();
 	//auto dir = (charComponent != nullptr) ? charComponent->GetViewForward() : entThis.GetForward();
 	//auto pos = (charComponent != nullptr) ? charComponent->GetEyePosition() : entThis.GetPosition();
-	auto posEnt = pTrComponent->GetEyePosition();
-	auto dirEnt = posEnt - pos;
+	outTargetPos = pTrComponent->GetEyePosition();
+	auto dirEnt = outTargetPos - pos;
 	uvec::normalize(&dirEnt);
 	auto dot = uvec::dot(dir, dirEnt);
-	if(dot >= m_maxViewDot) {
-		auto d = glm::distance(pos, posEnt);
-		if(dist != nullptr)
-			*dist = d;
-		if(d <= m_maxViewDist) {
-			auto data = charComponent->GetAimTraceData();
-			data.SetTarget(posEnt);
-			auto res = s_game->RayCast(data);
-			if(res.hitType == RayCastHitType::None || res.entity.get() == ent)
-				return true;
-		}
-	}
-	return false;
+	if(dot < m_maxViewDot)
+		return false;
+	outDist = glm::distance(pos, outTargetPos);
+	return outDist <= m_maxViewDist;
+}
+
+bool SAIComponent::HasLineOfSight(BaseEntity &ent, const Vector3 &targetPos)
+{
+	auto charComponent = GetEntity().GetCharacterComponent();
+	if(charComponent.expired())
+		return false;
+	auto data = charComponent->GetAimTraceData();
+	data.SetTarget(targetPos);
+	auto res = s_game->RayCast(data);
+	return res.hitType == RayCastHitType::None || res.entity.get() == &ent;
 }
 
 bool SAIComponent::CanSee() const { return (GetMaxViewDistance() > 0 && GetMaxViewAngle() > 0) ? true : false; }
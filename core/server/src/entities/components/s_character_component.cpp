@@ -7,6 +7,7 @@
 #include "stdafx_server.h"
 #include "pragma/entities/components/s_character_component.hpp"
 #include "pragma/entities/components/s_weapon_component.hpp"
+#include "pragma/entities/components/s_hitbox_bvh_component.hpp"
 #include "pragma/ai/s_disposition.h"
 #include "pragma/lua/s_lentity_handles.hpp"
 #include <pragma/lua/converters/game_type_converters_t.hpp>
@@ -20,6 +21,7 @@ SCharacterComponent::SCharacterComponent(BaseEntity &ent) : BaseCharacterCompone
 void SCharacterComponent::Initialize()
 {
 	BaseCharacterComponent::Initialize();
+	GetEntity().AddComponent<SHitboxBvhComponent>();
 	auto &pFrozenProp = GetFrozenProperty();
 	auto hThis = GetHandle();
 	pFrozenProp->AddCallback([hThis, this](std::reference_wrapper<const bool> oldVal, std::reference_wrapper<const bool> val) {
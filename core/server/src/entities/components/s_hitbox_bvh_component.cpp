@@ -0,0 +1,283 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_server.h"
+#include "pragma/entities/components/s_hitbox_bvh_component.hpp"
+#include "pragma/lua/s_lentity_handles.hpp"
+#include "pragma/console/s_cvar.h"
+#include <pragma/lua/converters/game_type_converters_t.hpp>
+#include <pragma/entities/components/base_animated_component.hpp>
+#include <pragma/entities/components/base_model_component.hpp>
+#include <pragma/entities/entity_component_system_t.hpp>
+#include <pragma/entities/entity_iterator.hpp>
+#include <pragma/model/model.h>
+#include <pragma/model/animation/skeleton.hpp>
+#include <mathutil/umath_geometry.hpp>
+#include <bvh/v2/default_builder.h>
+#include <bvh/v2/stack.h>
+
+using namespace pragma;
+
+extern DLLNETWORK Engine *engine;
+
+static CVar cvLagCompensation = GetServerConVar("sv_lag_compensation_enabled");
+static CVar cvLagCompensationMaxTime = GetServerConVar("sv_lag_compensation_max_time");
+
+SHitboxBvhComponent::SHitboxBvhComponent(BaseEntity &ent) : BaseEntityComponent(ent) {}
+void SHitboxBvhComponent::InitializeLuaObject(lua_State *l) { return BaseEntityComponent::InitializeLuaObject<std::remove_reference_t<decltype(*this)>>(l); }
+
+void SHitboxBvhComponent::Initialize()
+{
+	BaseEntityComponent::Initialize();
+	GetEntity().AddComponent("animated");
+	BindEventUnhandled(BaseModelComponent::EVENT_ON_MODEL_CHANGED, [this](std::reference_wrapper<pragma::ComponentEvent> evData) { OnModelChanged(); });
+	SetTickPolicy(TickPolicy::Always);
+	InitializeHitboxBvh();
+}
+
+void SHitboxBvhComponent::OnModelChanged()
+{
+	ClearPoseHistory();
+	InitializeHitboxBvh();
+}
+
+void SHitboxBvhComponent::ClearPoseHistory() { m_poseHistory.Clear(); }
+bool SHitboxBvhComponent::HasPoseHistory() const { return m_hitboxBvh != nullptr && m_poseHistory.GetSampleCount() > 0; }
+
+void SHitboxBvhComponent::InitializeHitboxBvh()
+{
+	m_hitboxBvh = nullptr;
+	auto &mdl = GetEntity().GetModel();
+	if(!mdl)
+		return;
+	auto &hitboxes = mdl->GetHitboxes();
+	auto &reference = mdl->GetReference();
+	auto numBones = mdl->GetSkeleton().GetBoneCount();
+	auto bvhTree = std::make_unique<HitboxBvhTree>();
+	auto &hitboxObbs = bvhTree->primitives;
+	hitboxObbs.reserve(hitboxes.size());
+	bvhTree->hitGroups.reserve(hitboxes.size());
+	for(auto &[boneId, hb] : hitboxes) {
+		if(boneId >= numBones)
+			continue;
+		hitboxObbs.push_back({hb.min, hb.max});
+		hitboxObbs.back().boneId = boneId;
+		bvhTree->hitGroups.push_back(hb.group);
+	}
+	if(hitboxObbs.empty())
+		return;
+	// The tree topology is built once from the reference pose and only refit for the rewound poses
+	std::vector<umath::ScaledTransform> refPoses;
+	refPoses.resize(numBones);
+	for(auto i = decltype(numBones) {0u}; i < numBones; ++i) {
+		umath::ScaledTransform pose;
+		if(reference.GetBonePose(i, pose))
+			refPoses[i] = pose;
+	}
+	bvhTree->InitializeBvh(refPoses);
+	m_hitboxBvh = std::move(bvhTree);
+}
+
+void SHitboxBvhComponent::UpdatePoseHistoryCapacity()
+{
+	// One sample per tick, plus one so that the oldest sample still encloses the maximum rewind time
+	auto capacity = static_cast<size_t>(umath::ceil(umath::max(cvLagCompensationMaxTime->GetFloat(), 0.f) * engine->GetTickRate())) + 1;
+	m_poseHistory.SetCapacity(capacity);
+}
+
+void SHitboxBvhComponent::OnTick(double tDelta)
+{
+	BaseEntityComponent::OnTick(tDelta);
+	if(!m_hitboxBvh || !cvLagCompensation->GetBool()) {
+		if(m_poseHistory.GetSampleCount() > 0)
+			ClearPoseHistory();
+		return;
+	}
+	RecordPose(GetGame().CurTime());
+}
+
+void SHitboxBvhComponent::RecordPose(double t)
+{
+	auto animC = GetEntity().GetAnimatedComponent();
+	if(animC.expired())
+		return;
+	// Ensures the processed bone poses match the current animation state
+	animC->UpdateSkeleton();
+	UpdatePoseHistoryCapacity();
+
+	auto &bonePoses = animC->GetProcessedBones();
+	auto &sample = m_poseHistory.AddSample(t);
+	sample.pose = GetEntity().GetPose();
+	sample.bonePoses.resize(bonePoses.size());
+	std::copy(bonePoses.begin(), bonePoses.end(), sample.bonePoses.begin());
+
+	auto bounds = pragma::bvh::BBox::make_empty();
+	auto numBones = bonePoses.size();
+	for(auto &hObb : m_hitboxBvh->primitives) {
+		if(hObb.boneId >= numBones)
+			continue;
+		Vector3 center;
+		bounds.extend(hObb.ToBvhBBox(sample.pose * bonePoses[hObb.boneId], center));
+	}
+	sample.min = {bounds.min[0], bounds.min[1], bounds.min[2]};
+	sample.max = {bounds.max[0], bounds.max[1], bounds.max[2]};
+}
+
+bool SHitboxBvhComponent::GetHitboxBounds(double t, Vector3 &outMin, Vector3 &outMax) const
+{
+	const bvh::HitboxPoseHistory::Sample *sample0, *sample1;
+	float factor;
+	if(!m_hitboxBvh || !m_poseHistory.FindSamples(t, sample0, sample1, factor))
+		return false;
+	// The interpolated pose lies (approximately) within the bounds of both enclosing samples
+	outMin = uvec::min(sample0->min, sample1->min);
+	outMax = uvec::max(sample0->max, sample1->max);
+	return true;
+}
+
+bool SHitboxBvhComponent::Raycast(const std::vector<Ray> &rays, double t, std::vector<std::optional<HitData>> &outHits)
+{
+	outHits.clear();
+	outHits.resize(rays.size());
+	if(!m_hitboxBvh || !m_poseHistory.GetPoses(t, m_rewindPose, m_rewindBonePoses))
+		return false;
+	// Move the rewound bones to world space, so the rays can be tested as-is
+	for(auto &pose : m_rewindBonePoses)
+		pose = m_rewindPose * pose;
+	m_hitboxBvh->Refit(m_rewindBonePoses);
+
+	constexpr size_t stack_size = 64;
+	auto &bvh = m_hitboxBvh->bvh;
+	auto &primitives = m_hitboxBvh->primitives;
+	auto numBones = m_rewindBonePoses.size();
+	::bvh::v2::SmallStack<pragma::bvh::Bvh::Index, stack_size> stack;
+	auto hasHit = false;
+	for(size_t rayIdx = 0; rayIdx < rays.size(); ++rayIdx) {
+		auto &ray = rays[rayIdx];
+		auto bvhRay = pragma::bvh::get_ray(ray.origin, ray.dir, 0.f, ray.maxDist);
+		auto closestPrim = std::numeric_limits<size_t>::max();
+		auto closestDist = ray.maxDist;
+		bvh.intersect<false, false>(bvhRay, bvh.get_root().index, stack, [&](size_t begin, size_t end) {
+			for(size_t i = begin; i < end; ++i) {
+				size_t j = bvh.prim_ids[i];
+				auto &hObb = primitives[j];
+				if(hObb.boneId >= numBones)
+					continue;
+				auto &pose = m_rewindBonePoses[hObb.boneId];
+				float dist;
+				if(!umath::intersection::line_obb(ray.origin, ray.dir * ray.maxDist, hObb.min, hObb.max, &dist, pose.GetOrigin(), pose.GetRotation()))
+					continue;
+				dist *= ray.maxDist;
+				if(dist >= closestDist)
+					continue;
+				closestDist = dist;
+				closestPrim = j;
+				bvhRay.tmax = dist;
+			}
+			return false;
+		});
+		if(closestPrim == std::numeric_limits<size_t>::max())
+			continue;
+		auto &hObb = primitives[closestPrim];
+		outHits[rayIdx] = HitData {hObb.boneId, m_hitboxBvh->hitGroups[closestPrim], closestDist, ray.origin + ray.dir * closestDist};
+		hasHit = true;
+	}
+	return hasHit;
+}
+
+void SHitboxBvhComponent::Raycast(Game &game, const std::vector<Ray> &rays, double t, std::vector<std::optional<EntityHitData>> &outHits, const std::function<bool(BaseEntity &)> &filter)
+{
+	outHits.clear();
+	outHits.resize(rays.size());
+	// Ray distances are shortened with every hit, so that entities behind the closest hit are culled early
+	auto localRays = rays;
+	std::vector<Ray> entRays;
+	std::vector<size_t> entRayIndices;
+	std::vector<std::optional<HitData>> entHits;
+	entRays.reserve(rays.size());
+	entRayIndices.reserve(rays.size());
+
+	EntityIterator entIt {game};
+	entIt.AttachFilter<TEntityIteratorFilterComponent<SHitboxBvhComponent>>();
+	for(auto *ent : entIt) {
+		if(filter && !filter(*ent))
+			continue;
+		auto hitboxC = ent->GetComponent<SHitboxBvhComponent>();
+		Vector3 min, max;
+		if(hitboxC.expired() || !hitboxC->GetHitboxBounds(t, min, max))
+			continue;
+		entRays.clear();
+		entRayIndices.clear();
+		for(size_t i = 0; i < localRays.size(); ++i) {
+			auto &ray = localRays[i];
+			float dist;
+			if(umath::intersection::line_aabb(ray.origin, ray.dir, min, max, &dist) != umath::intersection::Result::Intersect || dist > ray.maxDist)
+				continue;
+			entRays.push_back(ray);
+			entRayIndices.push_back(i);
+		}
+		if(entRays.empty() || !hitboxC->Raycast(entRays, t, entHits))
+			continue;
+		for(size_t i = 0; i < entHits.size(); ++i) {
+			auto &hit = entHits[i];
+			if(!hit)
+				continue;
+			auto rayIdx = entRayIndices[i];
+			localRays[rayIdx].maxDist = hit->distance;
+			outHits[rayIdx] = EntityHitData {ent->GetHandle(), *hit};
+		}
+	}
+}
+
+////////////
+
+void SHitboxBvhComponent::HitboxBvhTree::InitializeBvh(const std::vector<umath::ScaledTransform> &poses)
+{
+	m_poses = &poses;
+	pragma::bvh::BvhTree::InitializeBvh();
+	m_poses = nullptr;
+}
+
+bool SHitboxBvhComponent::HitboxBvhTree::DoInitializeBvh(pragma::bvh::Executor &executor, ::bvh::v2::DefaultBuilder<pragma::bvh::Node>::Config &config)
+{
+	auto numObbs = primitives.size();
+	if(numObbs == 0)
+		return false;
+	auto numBones = m_poses->size();
+	std::vector<pragma::bvh::BBox> bboxes {numObbs};
+	std::vector<pragma::bvh::Vec> centers {numObbs};
+	executor.for_each(0, numObbs, [&](size_t begin, size_t end) {
+		for(size_t i = begin; i < end; ++i) {
+			Vector3 center {};
+			auto &hObb = primitives[i];
+			if(hObb.boneId < numBones)
+				bboxes[i] = hObb.ToBvhBBox((*m_poses)[hObb.boneId], center);
+			centers[i] = pragma::bvh::to_bvh_vector(center);
+		}
+	});
+
+	bvh = ::bvh::v2::DefaultBuilder<pragma::bvh::Node>::build(GetThreadPool(), bboxes, centers, config);
+	return true;
+}
+
+void SHitboxBvhComponent::HitboxBvhTree::Refit(const std::vector<umath::ScaledTransform> &poses)
+{
+	auto numBones = poses.size();
+	bvh.refit([this, &poses, numBones](pragma::bvh::Node &node) {
+		auto bbox = pragma::bvh::BBox::make_empty();
+		auto begin = node.index.first_id;
+		auto end = begin + node.index.prim_count;
+		for(size_t i = begin; i < end; ++i) {
+			auto &hObb = primitives[bvh.prim_ids[i]];
+			if(hObb.boneId >= numBones)
+				continue;
+			Vector3 center;
+			bbox.extend(hObb.ToBvhBBox(poses[hObb.boneId], center));
+		}
+		node.set_bbox(bbox);
+	});
+}
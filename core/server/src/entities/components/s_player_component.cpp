@@ -128,6 +128,12 @@ void SPlayerComponent::SetViewRotation(const Quat &rot)
 	ent.SendNetEvent(m_netEvSetViewOrientation, p, pragma::networking::Protocol::SlowReliable, *session);
 }
 
+void SPlayerComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BasePlayerComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_RESPAWN);
+}
+
 util::EventReply SPlayerComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BasePlayerComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -8,6 +8,9 @@
 #include "pragma/entities/components/s_shooter_component.hpp"
 #include "pragma/entities/components/s_character_component.hpp"
 #include "pragma/entities/components/s_player_component.hpp"
+#include "pragma/entities/components/s_hitbox_bvh_component.hpp"
+#include "pragma/networking/iserver_client.hpp"
+#include "pragma/console/s_cvar.h"
 #include "pragma/lua/s_lentity_handles.hpp"
 #include "pragma/networking/recipient_filter.hpp"
 #include <pragma/lua/converters/game_type_converters_t.hpp>
@@ -24,6 +27,9 @@ using namespace pragma;
 extern DLLSERVER ServerState *server;
 extern DLLSERVER SGame *s_game;
 
+static CVar cvLagCompensation = GetServerConVar("sv_lag_compensation_enabled");
+static CVar cvLagCompensationMaxTime = GetServerConVar("sv_lag_compensation_max_time");
+
 Bool SShooterComponent::ReceiveNetEvent(pragma::BasePlayerComponent &pl, pragma::NetEventId eventId, NetPacket &packet)
 {
 	if(eventId == m_netEvFireBullets)
@@ -67,6 +73,17 @@ void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, const std::fun
 }
 void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, std::vector<TraceResult> &results, bool bMaster) { FireBullets(bulletInfo, nullptr, results, bMaster); }
 
+RayCastHitType SShooterComponent::OnBulletHit(const BulletInfo &bulletInfo, const TraceData &data, PhysObj &phys, physics::ICollisionObject &col)
+{
+	if(m_lagCompensatedTrace) {
+		auto *owner = phys.GetOwner();
+		auto hitboxC = owner ? owner->GetEntity().GetComponent<SHitboxBvhComponent>() : pragma::ComponentHandle<SHitboxBvhComponent> {};
+		if(hitboxC.valid() && hitboxC->HasPoseHistory())
+			return RayCastHitType::None; // Tested against the rewound hitboxes instead
+	}
+	return BaseShooterComponent::OnBulletHit(bulletInfo, data, phys, col);
+}
+
 void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, DamageInfo &dmgInfo, std::vector<TraceResult> &outHitTargets, const std::function<bool(DamageInfo &, BaseEntity *)> &fCallback, bool bMaster)
 {
 	pragma::BasePlayerComponent *pl = nullptr;
@@ -96,9 +113,29 @@ void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, DamageInfo &dm
 	std::vector<Vector3> dstPositions;
 	dstPositions.reserve(bulletInfo.bulletCount);
 
+	// Player and NPC hitboxes are tested against the poses the entities had when the shot was fired on the client, instead of their physics hitboxes
+	auto lagCompensation = cvLagCompensation->GetBool();
+	auto tRewind = s_game->CurTime();
+	if(lagCompensation && pl != nullptr) {
+		// The client sees the world delayed by half of its round-trip time, and the shot arrives half a round trip later
+		auto *session = static_cast<pragma::SPlayerComponent *>(pl)->GetClientSession();
+		if(session)
+			tRewind -= umath::min(session->GetLatency() / 1'000.0, static_cast<double>(umath::max(cvLagCompensationMaxTime->GetFloat(), 0.f)));
+	}
+	m_lagCompensatedTrace = lagCompensation;
+	util::ScopeGuard sgLagCompensation {[this]() { m_lagCompensatedTrace = false; }};
+
 	TraceData data;
 	GetBulletTraceData(bulletInfo, data);
-	outHitTargets.reserve(bulletInfo.bulletCount);
+	std::vector<TraceResult> traceResults;
+	std::vector<size_t> traceResultOffsets;
+	std::vector<Vector3> bulletDirs;
+	std::vector<SHitboxBvhComponent::Ray> hitboxRays;
+	traceResults.reserve(bulletInfo.bulletCount);
+	traceResultOffsets.reserve(bulletInfo.bulletCount + 1);
+	bulletDirs.reserve(bulletInfo.bulletCount);
+	if(lagCompensation)
+		hitboxRays.reserve(bulletInfo.bulletCount);
 	for(auto i = decltype(bulletInfo.bulletCount) {0}; i < bulletInfo.bulletCount; ++i) {
 		auto &bulletDst = m_nextBullet->destinations[i];
 		auto bulletDir = bulletDst - origin;
@@ -108,30 +145,75 @@ void SShooterComponent::FireBullets(const BulletInfo &bulletInfo, DamageInfo &dm
 		data.SetSource(origin);
 		data.SetTarget(dst);
 		dstPositions.push_back(dst);
+		bulletDirs.push_back(bulletDir);
 
-		auto offset = outHitTargets.size();
-		auto hit = s_game->RayCast(data, &outHitTargets);
-		if(hit) {
-			for(auto i = offset; i < outHitTargets.size(); ++i) {
-				auto &result = outHitTargets.at(i);
-				if(result.entity.valid() == false)
-					continue;
-				auto pDamageableComponent = result.entity->GetComponent<pragma::DamageableComponent>();
-				if(pDamageableComponent.valid()) {
-					auto hitGroup = HitGroup::Generic;
-					if(result.collisionObj.IsValid()) {
-						auto charComponent = result.entity.get()->GetCharacterComponent();
-						if(charComponent.valid())
-							charComponent->FindHitgroup(*result.collisionObj.Get(), hitGroup);
-					}
-					dmgInfo.SetHitGroup(hitGroup);
-					dmgInfo.SetForce(bulletDir * dmgInfo.GetForce().x);
-					dmgInfo.SetHitPosition(result.position);
-					if((fCallback == nullptr || fCallback(dmgInfo, result.entity.get()) == true) && pDamageableComponent.valid())
-						pDamageableComponent->TakeDamage(dmgInfo);
-				}
+		auto offset = traceResults.size();
+		traceResultOffsets.push_back(offset);
+		s_game->RayCast(data, &traceResults);
+		if(lagCompensation) {
+			// Hitboxes behind whatever blocked the bullet can't be hit
+			auto maxDist = bulletInfo.distance;
+			for(auto j = offset; j < traceResults.size(); ++j) {
+				auto &result = traceResults[j];
+				if(result.hitType == RayCastHitType::Block)
+					maxDist = umath::min(maxDist, result.distance);
 			}
+			hitboxRays.push_back({origin, bulletDir, maxDist});
+		}
+	}
+	traceResultOffsets.push_back(traceResults.size());
+
+	// All bullets of a shot are tested at once, so every entity only has to be rewound once
+	std::vector<std::optional<SHitboxBvhComponent::EntityHitData>> hitboxHits;
+	if(!hitboxRays.empty()) {
+		auto *attacker = bulletInfo.hAttacker.get();
+		auto *inflictor = bulletInfo.hInflictor.get();
+		SHitboxBvhComponent::Raycast(*s_game, hitboxRays, tRewind, hitboxHits, [this, attacker, inflictor](BaseEntity &ent) { return &ent != &GetEntity() && &ent != attacker && &ent != inflictor; });
+	}
+
+	auto applyDamage = [&dmgInfo, &fCallback](const TraceResult &result, const Vector3 &bulletDir, std::optional<HitGroup> hitGroup) {
+		if(result.entity.valid() == false)
+			return;
+		auto pDamageableComponent = result.entity->GetComponent<pragma::DamageableComponent>();
+		if(pDamageableComponent.expired())
+			return;
+		if(!hitGroup.has_value()) {
+			hitGroup = HitGroup::Generic;
+			if(result.collisionObj.IsValid()) {
+				auto charComponent = result.entity.get()->GetCharacterComponent();
+				if(charComponent.valid())
+					charComponent->FindHitgroup(*result.collisionObj.Get(), *hitGroup);
+			}
+		}
+		dmgInfo.SetHitGroup(*hitGroup);
+		dmgInfo.SetForce(bulletDir * dmgInfo.GetForce().x);
+		dmgInfo.SetHitPosition(result.position);
+		if(fCallback == nullptr || fCallback(dmgInfo, result.entity.get()) == true)
+			pDamageableComponent->TakeDamage(dmgInfo);
+	};
+	outHitTargets.reserve(outHitTargets.size() + traceResults.size());
+	for(auto i = decltype(bulletInfo.bulletCount) {0}; i < bulletInfo.bulletCount; ++i) {
+		auto &bulletDir = bulletDirs[i];
+		auto *hitboxHit = (i < hitboxHits.size() && hitboxHits[i].has_value()) ? &*hitboxHits[i] : nullptr;
+		for(auto j = traceResultOffsets[i]; j < traceResultOffsets[i + 1]; ++j) {
+			auto &result = traceResults[j];
+			if(hitboxHit && result.distance > hitboxHit->hit.distance)
+				continue; // The bullet was stopped by a hitbox before it reached this
+			applyDamage(result, bulletDir, {});
+			outHitTargets.push_back(std::move(result));
 		}
+		if(!hitboxHit)
+			continue;
+		TraceResult result {};
+		result.hitType = RayCastHitType::Block;
+		result.entity = hitboxHit->entity;
+		result.startPosition = origin;
+		result.position = hitboxHit->hit.position;
+		result.distance = hitboxHit->hit.distance;
+		result.fraction = (bulletInfo.distance > 0.f) ? (hitboxHit->hit.distance / bulletInfo.distance) : 0.f;
+		result.normal = -bulletDir;
+		applyDamage(result, bulletDir, hitboxHit->hit.hitGroup);
+		outHitTargets.push_back(std::move(result));
 	}
 	auto &ent = static_cast<SBaseEntity &>(GetEntity());
 	if(ent.IsShared() == true) {
@@ -56,7 +56,7 @@ extern SGame *s_game;
 
 LINK_ENTITY_TO_CLASS(entity, SBaseEntity);
 
-SBaseEntity::SBaseEntity() : BaseEntity(), m_bShared(false), m_bSynchronized(true) {}
+SBaseEntity::SBaseEntity() : BaseEntity(), m_bShared(false), m_bSynchronized(true), m_bSnapshotAlwaysRelevant(false) {}
 
 void SBaseEntity::DoSpawn()
 {
@@ -109,6 +109,8 @@ BaseEntity *SBaseEntity::GetClientsideEntity() const
 
 Bool SBaseEntity::IsSynchronized() const { return (IsShared() && m_bSynchronized) ? true : false; }
 void SBaseEntity::SetSynchronized(Bool b) { m_bSynchronized = b; }
+bool SBaseEntity::IsSnapshotAlwaysRelevant() const { return m_bSnapshotAlwaysRelevant; }
+void SBaseEntity::SetSnapshotAlwaysRelevant(bool b) { m_bSnapshotAlwaysRelevant = b; }
 
 void SBaseEntity::Initialize()
 {
@@ -116,7 +118,7 @@ void SBaseEntity::Initialize()
 
 	std::string className;
 	g_ServerEntityFactories->GetClassName(typeid(*this), &className);
-	m_className = pragma::ents::register_class_name(className);
+	SetClass(className);
 
 	unsigned int ID = g_SvEntityNetworkMap->GetFactoryID(typeid(*this));
 	if(ID == 0)
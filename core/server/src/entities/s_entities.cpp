@@ -15,6 +15,7 @@
 #include "pragma/game/s_game_entities.h"
 #include <sharedutils/util_string.h>
 #include <pragma/networking/nwm_util.h>
+#include "pragma/networking/iserver.hpp"
 #include "pragma/networking/iserver_client.hpp"
 #include "pragma/networking/recipient_filter.hpp"
 #include "pragma/entities/components/s_player_component.hpp"
@@ -81,6 +82,12 @@ void SGame::RemoveEntity(BaseEntity *ent)
 	if(ent->IsPlayer())
 		m_numPlayers--;
 	unsigned int idx = ent->GetIndex();
+	m_snapshotRelevancy.OnEntityRemoved(idx);
+	// The index may be re-used by a new entity, which mustn't inherit the pending snapshot of this one
+	if(auto *sv = server->GetServer()) {
+		for(auto &cl : sv->GetClients())
+			cl->GetSnapshotRelevancyCache().SetDeferred(idx, false);
+	}
 #ifdef PRAGMA_ENABLE_VTUNE_PROFILING
 	debug::get_domain().BeginTask("remove_entity");
 #endif
@@ -219,6 +219,8 @@ bool SGame::LoadMap(const std::string &map, const Vector3 &origin, std::vector<E
 		return false;
 	server->SendPacket("map_ready", pragma::networking::Protocol::SlowReliable);
 	LoadNavMesh();
+	UpdateSnapshotQuantizationBounds();
+	ResetClientSnapshotStates();
 
 	m_flags |= GameFlags::MapLoaded;
 	CallCallbacks<void>("OnMapLoaded");
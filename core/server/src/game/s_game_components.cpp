@@ -111,6 +111,7 @@
 #include "pragma/entities/components/liquid/s_liquid_volume_component.hpp"
 #include "pragma/entities/components/liquid/s_liquid_control_component.hpp"
 #include "pragma/entities/components/liquid/s_liquid_surface_simulation_component.hpp"
+#include "pragma/entities/components/s_hitbox_bvh_component.hpp"
 // --template-include-location
 #include "pragma/entities/environment/s_env_timescale.h"
 #include <pragma/lua/converters/game_type_converters_t.hpp>
@@ -225,6 +226,7 @@ void SGame::InitializeEntityComponents(pragma::EntityComponentManager &component
 	componentManager.RegisterComponentType<pragma::SLiquidVolumeComponent>("liquid_volume");
 	componentManager.RegisterComponentType<pragma::SLiquidControlComponent>("liquid_control");
 	componentManager.RegisterComponentType<pragma::SLiquidSurfaceSimulationComponent>("liquid_surface_simulation");
+	componentManager.RegisterComponentType<pragma::SHitboxBvhComponent>("hitbox_bvh");
 	// --template-component-register-location
 }
 
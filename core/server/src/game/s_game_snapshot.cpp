@@ -9,9 +9,13 @@
 #include "pragma/entities/components/s_player_component.hpp"
 #include "pragma/networking/iserver_client.hpp"
 #include "pragma/networking/recipient_filter.hpp"
+#include "pragma/networking/iserver.hpp"
+#include "pragma/networking/snapshot_state_table.hpp"
+#include "pragma/console/s_cvar.h"
 #include "pragma/entities/player.h"
 #include <pragma/entities/baseplayer.hpp>
 #include <pragma/networking/snapshot_flags.hpp>
+#include <pragma/networking/snapshot_delta.hpp>
 #include <pragma/entities/components/velocity_component.hpp>
 #include <pragma/entities/components/base_transform_component.hpp>
 #include <pragma/entities/components/base_physics_component.hpp>
@@ -19,165 +23,442 @@
 #include <pragma/entities/entity_component_system_t.hpp>
 #include <pragma/networking/nwm_util.h>
 #include <pragma/networking/enums.hpp>
+#include <pragma/model/model.h>
+#include <pragma/asset_types/world.hpp>
+#include <pragma/util/job_system.hpp>
+#include <pragma/engine.h>
 
 extern DLLSERVER ServerState *server;
 
-void SGame::SendSnapshot(pragma::SPlayerComponent *pl)
+const pragma::networking::SnapshotQuantizer &SGame::GetSnapshotQuantizer() const { return m_snapshotQuantizer; }
+void SGame::UpdateSnapshotQuantizationBounds()
 {
-	auto *session = pl ? pl->GetClientSession() : nullptr;
-	if(session == nullptr)
+	// Some leeway for entities that are slightly outside of the world (e.g. the skybox or falling objects).
+	// Anything beyond that will be transmitted with full precision.
+	constexpr float margin = 1'024.f;
+	std::optional<std::pair<Vector3, Vector3>> bounds {};
+	for(auto &hWorld : GetWorldComponents()) {
+		if(hWorld.expired())
+			continue;
+		auto &ent = hWorld->GetEntity();
+		auto &mdl = ent.GetModel();
+		if(mdl == nullptr)
+			continue;
+		Vector3 min, max;
+		mdl->GetCollisionBounds(min, max);
+		auto &pos = ent.GetPosition();
+		min += pos;
+		max += pos;
+		if(!bounds) {
+			bounds = {min, max};
+			continue;
+		}
+		uvec::min(&bounds->first, min);
+		uvec::max(&bounds->second, max);
+	}
+	if(bounds)
+		m_snapshotQuantizer.SetBounds(bounds->first - Vector3 {margin}, bounds->second + Vector3 {margin});
+	else
+		m_snapshotQuantizer = {};
+}
+
+void SGame::ResetClientSnapshotStates()
+{
+	auto *sv = server->GetServer();
+	if(sv == nullptr)
 		return;
+	for(auto &cl : sv->GetClients()) {
+		// Previous baselines were quantized with different bounds
+		cl->GetSnapshotBaselines().Clear();
+		cl->GetSnapshotRelevancyCache() = {};
+	}
+}
+
+void SGame::InitializeWorldData(pragma::asset::WorldData &worldData)
+{
+	Game::InitializeWorldData(worldData);
+	auto *bspTree = worldData.GetBSPTree();
+	m_snapshotRelevancy.SetBSPTree(bspTree ? bspTree->shared_from_this() : nullptr);
+}
+
+static CVar cvDeltaCompression = GetServerConVar("sv_snapshot_delta_compression_enabled");
+static CVar cvRelevancyEnabled = GetServerConVar("sv_snapshot_relevancy_enabled");
+static CVar cvRelevancyMaxDistance = GetServerConVar("sv_snapshot_relevancy_max_distance");
+static CVar cvMultiThreaded = GetServerConVar("sv_snapshot_multithreaded");
+
+void pragma::networking::SnapshotStateTable::Clear()
+{
+	time = 0.0;
+	entities.clear();
+	clients.clear();
+	players.clear();
+}
+
+static std::vector<uint8_t> get_packet_data(NetPacket &packet, size_t offset, size_t size)
+{
+	auto *data = packet->GetData() + offset;
+	return std::vector<uint8_t> {data, data + size};
+}
+static void write_packet_data(NetPacket &packet, const uint8_t *data, size_t size)
+{
+	if(size > 0)
+		packet->Write(data, size);
+}
+
+static void write_snapshot_component_data(NetPacket &packet, pragma::BaseEntityComponent &component, pragma::SBaseSnapshotComponent &snapshotComponent, pragma::BasePlayerComponent &pl)
+{
+	packet->Write<pragma::ComponentId>(component.GetComponentId());
+	auto offsetComponentSize = packet->GetOffset();
+	packet->Write<uint8_t>(static_cast<uint8_t>(0u));
+
+	auto offsetComponentDataStart = packet->GetOffset();
+	snapshotComponent.SendSnapshotData(packet, pl);
+	auto szComponent = packet->GetOffset() - offsetComponentDataStart;
+	if(szComponent > std::numeric_limits<uint8_t>::max())
+		throw std::runtime_error("Component size mustn't exceed " + std::to_string(std::numeric_limits<uint8_t>::max()) + " bytes!");
+	packet->Write<uint8_t>(szComponent, &offsetComponentSize);
+}
+
+void SGame::GatherSnapshotState(SBaseEntity &ent, bool markedForSnapshot, bool useRelevancy)
+{
+	auto &table = m_snapshotStateTable;
+	auto &state = table.entities.emplace_back();
+	state.entity = &ent;
+	state.markedForSnapshot = markedForSnapshot;
+	auto pTrComponent = ent.GetTransformComponent();
+	auto pVelComponent = ent.GetComponent<pragma::VelocityComponent>();
+	if(pTrComponent != nullptr) {
+		state.position = pTrComponent->GetPosition();
+		state.rotation = pTrComponent->GetRotation();
+	}
+	if(pVelComponent.valid()) {
+		state.velocity = pVelComponent->GetVelocity();
+		state.angularVelocity = pVelComponent->GetAngularVelocity();
+	}
+	if(useRelevancy)
+		state.relevancyInfo = m_snapshotRelevancy.UpdateEntity(ent);
+	else
+		state.relevancyInfo.index = ent.GetIndex();
+
+	// Player-dependent data is written for all clients in sequence and split up afterwards
 	NetPacket packet;
-	packet->Write<uint8_t>(session->SwapSnapshotId());
-	packet->Write<double>(CurTime());
+	NetPacket clientPacket;
+	auto numClients = table.clients.size();
+	std::vector<std::pair<size_t, size_t>> clientRanges;
+	clientRanges.reserve(numClients);
+	auto addClientDependentData = [&](size_t offset) {
+		auto &data = state.clientDependentData.emplace_back();
+		data.offset = offset;
+		data.clientData.reserve(numClients);
+		for(auto &[start, size] : clientRanges)
+			data.clientData.push_back(get_packet_data(clientPacket, start, size));
+		clientRanges.clear();
+	};
 
-	std::vector<SBaseEntity *> *entities;
-	GetEntities(&entities);
-	auto numEntities = entities->size();
-	auto posNumEnts = packet->GetSize();
-	packet->Write<unsigned int>((unsigned int)(0));
-	size_t numEntitiesValid = 0;
-	for(size_t i = 0; i < numEntities; i++) {
-		SBaseEntity *ent = (*entities)[i];
-		if(ent != NULL && ent->IsShared() && ent->IsSynchronized() && ent->IsMarkedForSnapshot()) {
-			numEntitiesValid++;
-			auto pTrComponent = ent->GetTransformComponent();
-			auto pVelComponent = ent->GetComponent<pragma::VelocityComponent>();
-			nwm::write_entity(packet, ent);
-			nwm::write_vector(packet, pTrComponent != nullptr ? pTrComponent->GetPosition() : Vector3 {});
-			nwm::write_vector(packet, pVelComponent.valid() ? pVelComponent->GetVelocity() : Vector3 {});
-			nwm::write_vector(packet, pVelComponent.valid() ? pVelComponent->GetAngularVelocity() : Vector3 {});
-			nwm::write_quat(packet, pTrComponent != nullptr ? pTrComponent->GetRotation() : uquat::identity());
-
-			auto offsetEntData = packet->GetSize();
-			packet->Write<UInt8>(UInt8(0));
-			auto offset = packet->GetSize();
-			ent->SendSnapshotData(packet, *pl);
-			auto entDataSize = packet->GetSize() - offset;
+	auto hasEntData = false;
+	for(auto &clState : table.clients) {
+		auto offsetEntData = clientPacket->GetSize();
+		clientPacket->Write<UInt8>(UInt8(0));
+		auto offset = clientPacket->GetSize();
+		ent.SendSnapshotData(clientPacket, *clState.player);
+		auto entDataSize = clientPacket->GetSize() - offset;
 #ifdef _DEBUG
-			assert(entDataSize <= std::numeric_limits<UInt8>::max());
+		assert(entDataSize <= std::numeric_limits<UInt8>::max());
 #endif
-			packet->Write<UInt8>(CUInt8(entDataSize), &offsetEntData);
-
-			auto flags = pragma::SnapshotFlags::None;
-			auto offsetSnapshotFlags = packet->GetOffset();
-			packet->Write<decltype(flags)>(flags);
-
-			auto pPhysComponent = ent->GetPhysicsComponent();
-			PhysObj *physObj = pPhysComponent != nullptr ? pPhysComponent->GetPhysicsObject() : nullptr;
-			if(physObj != NULL && !physObj->IsStatic()) {
-				flags |= pragma::SnapshotFlags::PhysicsData;
-				if(physObj->IsController()) {
-					packet->Write<uint8_t>(1u);
-					auto *physController = static_cast<ControllerPhysObj *>(physObj);
-					packet->Write<Vector3>(physController->GetPosition());
-					packet->Write<Quat>(physController->GetOrientation());
-					packet->Write<Vector3>(physController->GetLinearVelocity());
-					packet->Write<Vector3>(physController->GetAngularVelocity());
-				}
-				else {
-					auto colObjs = physObj->GetCollisionObjects();
-					packet->Write<uint8_t>(static_cast<uint8_t>(colObjs.size()));
-					//auto i = 0;
-					for(auto &hObj : colObjs) {
-						Vector3 pos {0.f, 0.f, 0.f};
-						auto rot = uquat::identity();
-						Vector3 vel {0.f, 0.f, 0.f};
-						Vector3 angVel {0.f, 0.f, 0.f};
-						if(hObj.IsValid()) {
-							auto *o = hObj.Get();
-							pos = o->GetPos();
-							rot = o->GetRotation();
-							if(o->IsRigid()) {
-								auto *rigid = o->GetRigidBody();
-								vel = rigid->GetLinearVelocity();
-								angVel = rigid->GetAngularVelocity();
-							}
-						}
-						packet->Write<Vector3>(pos);
-						packet->Write<Quat>(rot);
-						packet->Write<Vector3>(vel);
-						packet->Write<Vector3>(angVel);
+		clientPacket->Write<UInt8>(CUInt8(entDataSize), &offsetEntData);
+		clientRanges.push_back({offsetEntData, clientPacket->GetSize() - offsetEntData});
+		hasEntData = hasEntData || (entDataSize > 0);
+	}
+	if(hasEntData)
+		addClientDependentData(0);
+	else {
+		// Most entities don't write any custom data, in which case we can just share it between all clients
+		packet->Write<UInt8>(UInt8(0));
+		clientRanges.clear();
+	}
+
+	auto flags = pragma::SnapshotFlags::None;
+	auto offsetSnapshotFlags = packet->GetOffset();
+	packet->Write<decltype(flags)>(flags);
+
+	auto pPhysComponent = ent.GetPhysicsComponent();
+	PhysObj *physObj = pPhysComponent != nullptr ? pPhysComponent->GetPhysicsObject() : nullptr;
+	if(physObj != NULL && !physObj->IsStatic()) {
+		flags |= pragma::SnapshotFlags::PhysicsData;
+		if(physObj->IsController()) {
+			packet->Write<uint8_t>(1u);
+			auto *physController = static_cast<ControllerPhysObj *>(physObj);
+			packet->Write<Vector3>(physController->GetPosition());
+			packet->Write<Quat>(physController->GetOrientation());
+			packet->Write<Vector3>(physController->GetLinearVelocity());
+			packet->Write<Vector3>(physController->GetAngularVelocity());
+		}
+		else {
+			auto colObjs = physObj->GetCollisionObjects();
+			packet->Write<uint8_t>(static_cast<uint8_t>(colObjs.size()));
+			//auto i = 0;
+			for(auto &hObj : colObjs) {
+				Vector3 pos {0.f, 0.f, 0.f};
+				auto rot = uquat::identity();
+				Vector3 vel {0.f, 0.f, 0.f};
+				Vector3 angVel {0.f, 0.f, 0.f};
+				if(hObj.IsValid()) {
+					auto *o = hObj.Get();
+					pos = o->GetPos();
+					rot = o->GetRotation();
+					if(o->IsRigid()) {
+						auto *rigid = o->GetRigidBody();
+						vel = rigid->GetLinearVelocity();
+						angVel = rigid->GetAngularVelocity();
 					}
 				}
+				packet->Write<Vector3>(pos);
+				packet->Write<Quat>(rot);
+				packet->Write<Vector3>(vel);
+				packet->Write<Vector3>(angVel);
 			}
+		}
+	}
 
-			auto offsetNumComponents = 0u;
-			auto numComponents = 0u;
-			auto bFirst = true;
-			for(auto &pComponent : ent->GetComponents()) {
-				if(pComponent.expired() || pComponent->ShouldTransmitSnapshotData() == false)
-					continue;
-				auto *pSnapshotComponent = dynamic_cast<pragma::SBaseSnapshotComponent *>(pComponent.get());
-				if(pSnapshotComponent == nullptr)
-					throw std::logic_error("Component must be derived from SBaseSnapshotComponent if snapshot data is enabled!");
-				if(bFirst) {
-					bFirst = false;
-					flags |= pragma::SnapshotFlags::ComponentData;
-					offsetNumComponents = packet->GetOffset();
-					packet->Write<uint8_t>(static_cast<uint8_t>(0u));
-				}
-				packet->Write<pragma::ComponentId>(pComponent->GetComponentId());
-				auto offsetComponentSize = packet->GetOffset();
-				packet->Write<uint8_t>(static_cast<uint8_t>(0u));
-
-				auto offsetComponentDataStart = packet->GetOffset();
-				pSnapshotComponent->SendSnapshotData(packet, *pl);
-				auto szComponent = packet->GetOffset() - offsetComponentDataStart;
-				if(szComponent > std::numeric_limits<uint8_t>::max())
-					throw std::runtime_error("Component size mustn't exceed " + std::to_string(std::numeric_limits<uint8_t>::max()) + " bytes!");
-				packet->Write<uint8_t>(szComponent, &offsetComponentSize);
-
-				if(++numComponents == std::numeric_limits<uint8_t>::max()) {
-					Con::cwar << Con::PREFIX_SERVER << "Attempted to send data for more than " << std::numeric_limits<uint8_t>::max() << " components for a single entity! This is not allowed!" << Con::endl;
-					break;
-				}
+	auto offsetNumComponents = 0u;
+	auto numComponents = 0u;
+	auto bFirst = true;
+	for(auto &pComponent : ent.GetComponents()) {
+		if(pComponent.expired() || pComponent->ShouldTransmitSnapshotData() == false)
+			continue;
+		auto *pSnapshotComponent = dynamic_cast<pragma::SBaseSnapshotComponent *>(pComponent.get());
+		if(pSnapshotComponent == nullptr)
+			throw std::logic_error("Component must be derived from SBaseSnapshotComponent if snapshot data is enabled!");
+		if(bFirst) {
+			bFirst = false;
+			flags |= pragma::SnapshotFlags::ComponentData;
+			offsetNumComponents = packet->GetOffset();
+			packet->Write<uint8_t>(static_cast<uint8_t>(0u));
+		}
+		if(pSnapshotComponent->IsSnapshotDataPlayerDependent()) {
+			for(auto &clState : table.clients) {
+				auto offset = clientPacket->GetSize();
+				write_snapshot_component_data(clientPacket, *pComponent, *pSnapshotComponent, *clState.player);
+				clientRanges.push_back({offset, clientPacket->GetSize() - offset});
 			}
-			packet->Write<decltype(flags)>(flags, &offsetSnapshotFlags);
-			if((flags & pragma::SnapshotFlags::ComponentData) != pragma::SnapshotFlags::None)
-				packet->Write<uint8_t>(numComponents, &offsetNumComponents);
+			addClientDependentData(packet->GetSize());
+		}
+		else
+			write_snapshot_component_data(packet, *pComponent, *pSnapshotComponent, *table.clients.front().player);
+
+		if(++numComponents == std::numeric_limits<uint8_t>::max()) {
+			Con::cwar << Con::PREFIX_SERVER << "Attempted to send data for more than " << std::numeric_limits<uint8_t>::max() << " components for a single entity! This is not allowed!" << Con::endl;
+			break;
 		}
 	}
+	packet->Write<decltype(flags)>(flags, &offsetSnapshotFlags);
+	if((flags & pragma::SnapshotFlags::ComponentData) != pragma::SnapshotFlags::None)
+		packet->Write<uint8_t>(numComponents, &offsetNumComponents);
+	state.data = get_packet_data(packet, 0, packet->GetSize());
+}
+
+void SGame::GatherSnapshotStates(const std::vector<pragma::SPlayerComponent *> &recipients, bool useRelevancy)
+{
+	auto &table = m_snapshotStateTable;
+	table.Clear();
+	table.time = CurTime();
+	for(auto *pl : recipients) {
+		auto *session = pl->GetClientSession();
+		if(session == nullptr)
+			continue;
+		auto &clState = table.clients.emplace_back();
+		clState.session = session;
+		clState.player = pl;
+		clState.viewPos = pl->GetViewPos();
+
+		NetPacket packet;
+		std::vector<InputAction> &keyStack = pl->GetKeyStack();
+		auto sz = CUChar(keyStack.size());
+		packet->Write<UChar>(sz);
+		for(UChar k = 0; k < sz; k++) // TODO: Same as above
+		{
+			InputAction &ka = keyStack[k];
+			packet->Write<unsigned short>(CUInt16(ka.action));
+			packet->Write<char>(ka.task == GLFW_PRESS);
+		}
+		clState.keyStack = get_packet_data(packet, 0, packet->GetSize());
+	}
+	if(table.clients.empty())
+		return;
+
+	for(auto *plComponent : pragma::SPlayerComponent::GetAll()) {
+		if(plComponent == NULL)
+			continue;
+		auto *ent = static_cast<Player *>(plComponent->GetBasePlayer());
+		if(ent == nullptr)
+			continue;
+		NetPacket packet;
+		nwm::write_player(packet, plComponent);
+		auto charComponent = ent->GetCharacterComponent();
+		nwm::write_quat(packet, charComponent.valid() ? charComponent->GetViewOrientation() : uquat::identity());
+		table.players.push_back({plComponent, get_packet_data(packet, 0, packet->GetSize())});
+	}
+
+	// Entities that weren't relevant to a client the last time they were marked for a snapshot
+	std::vector<bool> deferred;
+	for(auto &clState : table.clients) {
+		auto &clDeferred = clState.session->GetSnapshotRelevancyCache().deferred;
+		if(clDeferred.size() > deferred.size())
+			deferred.resize(clDeferred.size(), false);
+		for(size_t i = 0; i < clDeferred.size(); ++i) {
+			if(clDeferred[i])
+				deferred[i] = true;
+		}
+	}
+
+	std::vector<SBaseEntity *> *entities;
+	GetEntities(&entities);
+	for(auto *ent : *entities) {
+		if(ent == NULL || !ent->IsShared() || !ent->IsSynchronized())
+			continue;
+		auto marked = ent->IsMarkedForSnapshot();
+		auto idx = ent->GetIndex();
+		if(!marked && (idx >= deferred.size() || !deferred[idx]))
+			continue;
+		GatherSnapshotState(*ent, marked, useRelevancy);
+	}
+}
+
+void SGame::EncodeSnapshot(uint32_t clientIdx, const SnapshotEncodeSettings &settings)
+{
+	auto &table = m_snapshotStateTable;
+	auto &clState = table.clients[clientIdx];
+	auto *session = clState.session;
+	auto *pl = clState.player;
+	auto &packet = clState.packet;
+	auto snapshotId = session->SwapSnapshotId();
+	packet->Write<uint8_t>(snapshotId);
+	packet->Write<double>(table.time);
+
+	// Entity transforms are delta-encoded against the last snapshot the client has acknowledged.
+	// If there is none, the quantization bounds are sent instead, so the client can decode the full states.
+	auto &baselines = session->GetSnapshotBaselines();
+	auto *baseline = settings.deltaCompression ? baselines.GetLatestAcknowledged() : nullptr;
+	packet->Write<bool>(baseline != nullptr);
+	if(baseline)
+		packet->Write<uint8_t>(baseline->snapshotId);
+	else {
+		auto &bounds = m_snapshotQuantizer.GetBounds();
+		packet->Write<Vector3>(bounds.first);
+		packet->Write<Vector3>(bounds.second);
+	}
+	pragma::networking::SnapshotBaselineBuffer::EntityStates entityStates;
+
+	auto &relevancyCache = session->GetSnapshotRelevancyCache();
+	if(settings.relevancy)
+		m_snapshotRelevancy.UpdateClient(relevancyCache, clState.viewPos);
+	auto *plEnt = &pl->GetEntity();
+
+	auto posNumEnts = packet->GetSize();
+	packet->Write<unsigned int>((unsigned int)(0));
+	size_t numEntitiesValid = 0;
+	// Entities that have just become irrelevant to this client. The client has to stop extrapolating them, since it won't receive any updates for them anymore.
+	std::vector<uint32_t> outOfScope;
+	for(auto &state : table.entities) {
+		auto idx = state.relevancyInfo.index;
+		if(!state.markedForSnapshot && !relevancyCache.IsDeferred(idx))
+			continue;
+		if(settings.relevancy && state.entity != plEnt && !m_snapshotRelevancy.IsRelevant(relevancyCache, clState.viewPos, state.relevancyInfo, settings.maxDistance)) {
+			// The snapshot mark is cleared at the end of the tick, so we have to remember to send the entity once it becomes relevant to this player
+			if(!relevancyCache.IsDeferred(idx))
+				outOfScope.push_back(idx);
+			relevancyCache.SetDeferred(idx, true);
+			continue;
+		}
+		relevancyCache.SetDeferred(idx, false);
+
+		numEntitiesValid++;
+		nwm::write_entity(packet, state.entity);
+		auto quantizedState = m_snapshotQuantizer.Quantize(state.position, state.velocity, state.angularVelocity, state.rotation);
+		pragma::networking::write_entity_state_delta(packet, quantizedState, baseline ? baseline->FindEntityState(idx) : nullptr);
+		entityStates[idx] = quantizedState;
+
+		size_t offset = 0;
+		for(auto &clientData : state.clientDependentData) {
+			write_packet_data(packet, state.data.data() + offset, clientData.offset - offset);
+			auto &data = clientData.clientData[clientIdx];
+			write_packet_data(packet, data.data(), data.size());
+			offset = clientData.offset;
+		}
+		write_packet_data(packet, state.data.data() + offset, state.data.size() - offset);
+	}
 	packet->Write<UInt32>(CUInt32(numEntitiesValid), &posNumEnts);
 
-	//unsigned int numPlayers = Player::GetPlayerCount();
 	auto posNumPls = packet->GetSize();
 	packet->Write<unsigned char>((unsigned char)(0));
-	auto &players = pragma::SPlayerComponent::GetAll();
 	unsigned char numPlayersValid = 0;
-	for(auto *plComponent : players) {
-		if(plComponent != NULL && plComponent != pl) {
-			auto *ent = static_cast<Player *>(plComponent->GetBasePlayer());
-			if(ent != nullptr) {
-				numPlayersValid++;
-				nwm::write_player(packet, plComponent);
-				auto charComponent = ent->GetCharacterComponent();
-				nwm::write_quat(packet, charComponent.valid() ? charComponent->GetViewOrientation() : uquat::identity());
-				std::vector<InputAction> &keyStack = pl->GetKeyStack();
-				auto sz = CUChar(keyStack.size());
-				packet->Write<UChar>(sz);
-				for(UChar k = 0; k < sz; k++) // TODO: Same as above
-				{
-					InputAction &ka = keyStack[k];
-					packet->Write<unsigned short>(CUInt16(ka.action));
-					packet->Write<char>(ka.task == GLFW_PRESS);
-				}
-			}
-		}
+	for(auto &plState : table.players) {
+		if(plState.player == pl)
+			continue;
+		numPlayersValid++;
+		write_packet_data(packet, plState.data.data(), plState.data.size());
+		write_packet_data(packet, clState.keyStack.data(), clState.keyStack.size());
 	}
 	packet->Write<unsigned char>(numPlayersValid, &posNumPls);
-	server->SendPacket("snapshot", packet, pragma::networking::Protocol::FastUnreliable, *session);
+
+	packet->Write<uint32_t>(static_cast<uint32_t>(outOfScope.size()));
+	for(auto idx : outOfScope)
+		packet->Write<uint32_t>(idx);
+
+	// Has to happen after encoding, since the new entry may replace the baseline we've used
+	baselines.Add(snapshotId, table.time, std::move(entityStates));
+}
+
+void SGame::SendSnapshots(const std::vector<pragma::SPlayerComponent *> &recipients)
+{
+	SnapshotEncodeSettings settings {};
+	settings.deltaCompression = cvDeltaCompression->GetBool();
+	settings.relevancy = cvRelevancyEnabled->GetBool();
+	settings.maxDistance = cvRelevancyMaxDistance->GetFloat();
+
+	// Phase 1: Gather everything that requires access to the game state (and Lua) on the main thread
+	GatherSnapshotStates(recipients, settings.relevancy);
+	auto &table = m_snapshotStateTable;
+	auto numClients = static_cast<uint32_t>(table.clients.size());
+	if(numClients == 0)
+		return;
+
+	// Phase 2: Encode the snapshots. Every client only touches its own state, so they can be encoded concurrently.
+	if(numClients > 1 && cvMultiThreaded->GetBool()) {
+		pragma::get_engine()->GetJobSystem().ParallelFor(numClients, 1, [this, &settings](uint32_t start, uint32_t end) {
+			for(auto i = start; i < end; ++i)
+				EncodeSnapshot(i, settings);
+		});
+	}
+	else {
+		for(auto i = decltype(numClients) {0u}; i < numClients; ++i)
+			EncodeSnapshot(i, settings);
+	}
+
+	for(auto &clState : table.clients)
+		server->SendPacket("snapshot", clState.packet, pragma::networking::Protocol::FastUnreliable, *clState.session);
+	table.Clear();
+}
+
+void SGame::SendSnapshot(pragma::SPlayerComponent *pl)
+{
+	if(pl == nullptr)
+		return;
+	SendSnapshots({pl});
 }
 
 void SGame::SendSnapshot()
 {
 	//Con::csv<<"Sending snapshot.."<<Con::endl;
 	auto &players = pragma::SPlayerComponent::GetAll();
-	//unsigned char numPlayersValid = 0;
+	std::vector<pragma::SPlayerComponent *> recipients;
+	recipients.reserve(players.size());
 	for(auto *plComponent : players) {
 		if(plComponent != nullptr && plComponent->IsGameReady())
-			SendSnapshot(plComponent);
+			recipients.push_back(plComponent);
 	}
+	SendSnapshots(recipients);
+
 	std::vector<SBaseEntity *> *entities;
 	GetEntities(&entities);
 	for(unsigned int i = 0; i < entities->size(); i++) {
@@ -26,6 +26,8 @@ void Lua::Entity::Server::register_class(luabind::class_<SBaseEntity, BaseEntity
 	classDef.def("IsSynchronized", &SBaseEntity::IsSynchronized);
 	classDef.def("SetSynchronized", &SBaseEntity::SetSynchronized);
 	classDef.def("SetSnapshotDirty", &SBaseEntity::MarkForSnapshot);
+	classDef.def("IsSnapshotAlwaysRelevant", &SBaseEntity::IsSnapshotAlwaysRelevant);
+	classDef.def("SetSnapshotAlwaysRelevant", &SBaseEntity::SetSnapshotAlwaysRelevant);
 	classDef.def("AddNetworkedComponent", &SBaseEntity::AddNetworkedComponent);
 }
 
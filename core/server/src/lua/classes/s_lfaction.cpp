@@ -15,6 +15,7 @@ void Lua::Faction::register_class(lua_State *l, luabind::module_ &mod)
 {
 	auto classDef = luabind::class_<::Faction>("Faction");
 	classDef.def("AddClass", &::Faction::AddClass);
+	classDef.def("RemoveClass", &::Faction::RemoveClass);
 	classDef.def("GetClasses", &::Faction::GetClasses);
 	classDef.def("SetDisposition", static_cast<void (*)(lua_State *, ::Faction &, ::Faction &, uint32_t, bool, int32_t)>(&SetDisposition));
 	classDef.def("SetDisposition", static_cast<void (*)(lua_State *, ::Faction &, ::Faction &, uint32_t, bool)>(&SetDisposition));
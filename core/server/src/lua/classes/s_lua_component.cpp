@@ -87,4 +87,6 @@ void SLuaBaseEntityComponent::SendSnapshotData(NetPacket &packet, pragma::BasePl
 }
 bool SLuaBaseEntityComponent::ShouldTransmitNetData() const { return IsNetworked(); }
 bool SLuaBaseEntityComponent::ShouldTransmitSnapshotData() const { return BaseLuaBaseEntityComponent::ShouldTransmitSnapshotData(); }
+// The Lua callback receives the player and must be invoked on the main thread
+bool SLuaBaseEntityComponent::IsSnapshotDataPlayerDependent() const { return true; }
 void SLuaBaseEntityComponent::InvokeNetEventHandle(const std::string &methodName, NetPacket &packet, pragma::BasePlayerComponent *pl) { CallLuaMethod<void, luabind::object, NetPacket>(methodName, pl->GetLuaObject(), packet); }
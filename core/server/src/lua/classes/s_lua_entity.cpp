@@ -26,7 +26,7 @@ void SLuaEntity::Initialize() {
 }
 void SLuaEntity::SetupLua(const luabind::object &o, const std::string &className)
 {
-	m_className = pragma::ents::register_class_name(className);
+	SetClass(className);
 	SetLuaObject(o);
 }
 bool SLuaEntity::IsScripted() const { return true; }
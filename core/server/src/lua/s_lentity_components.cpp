@@ -76,6 +76,7 @@
 #include "pragma/entities/components/s_time_scale_component.hpp"
 #include "pragma/entities/components/s_gamemode_component.hpp"
 #include "pragma/entities/components/s_game_component.hpp"
+#include "pragma/entities/components/s_hitbox_bvh_component.hpp"
 #include "pragma/entities/environment/s_env_timescale.h"
 #include <pragma/physics/raytraces.h>
 #include <pragma/model/model.h>
@@ -307,5 +308,10 @@ void SGame::RegisterLuaEntityComponents(luabind::module_ &entsMod)
 	auto defSBot = pragma::lua::create_entity_component_class<pragma::SBotComponent, pragma::BaseBotComponent>("BotComponent");
 	entsMod[defSBot];
 
+	auto defSHitboxBvh = pragma::lua::create_entity_component_class<pragma::SHitboxBvhComponent, pragma::BaseEntityComponent>("HitboxBvhComponent");
+	defSHitboxBvh.def("ClearPoseHistory", &pragma::SHitboxBvhComponent::ClearPoseHistory);
+	defSHitboxBvh.def("HasPoseHistory", &pragma::SHitboxBvhComponent::HasPoseHistory);
+	entsMod[defSHitboxBvh];
+
 	RegisterLuaEntityComponents2_sv(l, entsMod); // Split up to prevent compiler errors
 }
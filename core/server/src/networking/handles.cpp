@@ -13,6 +13,9 @@ extern DLLNETWORK Engine *engine;
 ;
 bool ServerState::HandlePacket(pragma::networking::IServerClient &session, NetPacket &packet)
 {
+	// Any follow-up work (e.g. responses queued by the handler) should be processed by the next Think instead of
+	// waiting for the next tick. This is the receive path of every networking backend.
+	engine->WakeMainLoop();
 	unsigned int ID = packet.GetMessageID();
 	SVNetMessage *msg = GetNetMessage(ID);
 	if(msg == nullptr)
@@ -40,6 +40,7 @@ bool pragma::networking::IServerClient::AddResource(const std::string &fileName,
 	auto res = std::make_shared<Resource>(canonName, stream);
 	if(res->Construct() == false)
 		return false;
+	res->transferId = m_nextResourceTransferId++;
 	it = m_resourceTransfer.end();
 	if(stream == false) {
 		// Insert new resource before streamed resources
@@ -55,12 +56,20 @@ bool pragma::networking::IServerClient::AddResource(const std::string &fileName,
 	return true;
 }
 void pragma::networking::IServerClient::RemoveResource(uint32_t i) { m_resourceTransfer.erase(m_resourceTransfer.begin() + i); }
+int32_t pragma::networking::IServerClient::FindResource(uint32_t transferId) const
+{
+	auto it = std::find_if(m_resourceTransfer.begin(), m_resourceTransfer.end(), [transferId](const std::shared_ptr<Resource> &res) { return res->transferId == transferId; });
+	return (it != m_resourceTransfer.end()) ? static_cast<int32_t>(it - m_resourceTransfer.begin()) : -1;
+}
 void pragma::networking::IServerClient::ClearResourceTransfer() { m_resourceTransfer.clear(); }
 
 uint8_t pragma::networking::IServerClient::SwapSnapshotId()
 {
 	return m_snapshotId++; // Overflow doesn't matter
 }
+pragma::networking::SnapshotBaselineBuffer &pragma::networking::IServerClient::GetSnapshotBaselines() { return m_snapshotBaselines; }
+const pragma::networking::SnapshotBaselineBuffer &pragma::networking::IServerClient::GetSnapshotBaselines() const { return m_snapshotBaselines; }
+pragma::networking::SnapshotRelevancy::ClientCache &pragma::networking::IServerClient::GetSnapshotRelevancyCache() { return m_snapshotRelevancyCache; }
 
 void pragma::networking::IServerClient::ScheduleResource(const std::string &fileName)
 {
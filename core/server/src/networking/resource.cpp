@@ -24,5 +24,6 @@ bool Resource::Construct()
 	file = FileManager::OpenFile(name.c_str(), "rb");
 	if(file == nullptr)
 		return false;
+	size = file->GetSize();
 	return true;
 }
@@ -45,6 +45,19 @@ DLLSERVER void NET_sv_disconnect(pragma::networking::IServerClient &session, Net
 
 DLLSERVER void NET_sv_userinput(pragma::networking::IServerClient &session, NetPacket packet) { server->ReceiveUserInput(session, packet); }
 
+DLLSERVER void NET_sv_snapshot_ack(pragma::networking::IServerClient &session, NetPacket packet)
+{
+	auto snapshotId = packet->Read<uint8_t>();
+	auto t = packet->Read<double>();
+	session.GetSnapshotBaselines().Acknowledge(snapshotId, t);
+}
+
+DLLSERVER void NET_sv_snapshot_full_request(pragma::networking::IServerClient &session, NetPacket packet)
+{
+	// Without acknowledged baselines the next snapshot is sent in full
+	session.GetSnapshotBaselines().Clear();
+}
+
 DLLSERVER void NET_sv_ent_event(pragma::networking::IServerClient &session, NetPacket packet)
 {
 	if(!server->IsGameActive())
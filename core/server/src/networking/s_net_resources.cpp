@@ -22,6 +22,9 @@
 #include <pragma/entities/components/base_player_component.hpp>
 #include <material_manager2.hpp>
 #include <sharedutils/util_file.h>
+#include <pragma/networking/resource_transfer.hpp>
+#include <pragma/game/game_resources.h>
+#include "pragma/console/s_cvar.h"
 
 #define RESOURCE_TRANSFER_VERBOSE 0
 
@@ -42,6 +45,10 @@ void ServerState::SendResourceFile(const std::string &f, const std::vector<pragm
 	auto bMdl = (ufile::get_extension(f, &ext) == true && ext == "wmd") ? true : false;
 	if(bMdl == true)
 		SendRoughModel(f, clients);
+	// The file may have changed since its hash was last computed
+	auto canonName = FileManager::GetCanonicalizedPath(f);
+	m_resourceHashes.erase(canonName);
+	m_pendingResourceHashes.erase(canonName);
 	for(auto *cl : clients) {
 		auto r = cl->AddResource(f);
 		UNUSED(r);
@@ -132,99 +139,214 @@ void ServerState::SendRoughModel(const std::string &f)
 	SendRoughModel(f, clients);
 }
 
+const std::optional<std::string> *ServerState::FindResourceHash(const Resource &res)
+{
+	auto it = m_resourceHashes.find(res.name);
+	if(it != m_resourceHashes.end())
+		return &it->second;
+	if(m_pendingResourceHashes.find(res.name) != m_pendingResourceHashes.end())
+		return nullptr;
+	// The job uses its own file handle, since the resource's file is used for sending fragments on the main thread
+	m_pendingResourceHashes[res.name] = pragma::networking::schedule_resource_hash(res.name);
+	return nullptr;
+}
+
+void ServerState::UpdateResourceHashes()
+{
+	if(m_pendingResourceHashes.empty())
+		return;
+	auto anyComplete = false;
+	for(auto it = m_pendingResourceHashes.begin(); it != m_pendingResourceHashes.end();) {
+		auto &job = it->second;
+		if(job->complete == false) {
+			++it;
+			continue;
+		}
+		if(job->hash.has_value() == false)
+			Con::cwar << Con::PREFIX_SERVER << "[ResourceManager] Unable to compute hash of resource '" << it->first << "'. Clients will not be able to verify it!" << Con::endl;
+		m_resourceHashes[it->first] = std::move(job->hash);
+		it = m_pendingResourceHashes.erase(it);
+		anyComplete = true;
+	}
+	if(anyComplete == false || m_server == nullptr)
+		return;
+	// Announce the resources that were waiting for their hash
+	for(auto &hClient : m_server->GetClients()) {
+		auto *cl = hClient.get();
+		if(cl == nullptr || cl->GetInitialResourceTransferState() == pragma::networking::IServerClient::TransferState::Initial || cl->IsTransferring() == false)
+			continue;
+		HandleServerNextResource(*cl);
+	}
+}
+
+static CVar cvMaxFiles = GetServerConVar("sv_resource_transfer_max_files");
 void ServerState::HandleServerNextResource(pragma::networking::IServerClient &session)
 {
-	auto bRemoveCurrent = true;
-	if(session.IsTransferring() == false) {
-		bRemoveCurrent = false; // Transfer has just started; Don't remove first resource
+	if(session.IsTransferring() == false)
 		session.SetTransferComplete(false);
-	}
 	auto &resTransfer = session.GetResourceTransfer();
-	size_t numResources;
 	auto bComplete = session.IsInitialResourceTransferComplete();
 	if(bComplete == false && resTransfer.empty()) {
 		auto &resources = ResourceManager::GetResources();
-		numResources = resources.size();
-		if(numResources > 0) {
-			for(auto &res : resources) {
-				if(session.AddResource(res.fileName, res.stream) == false)
-					Con::cwar << Con::PREFIX_SERVER << "[ResourceManager] Unable to open file '" << res.fileName << "'. Skipping..." << Con::endl;
-			}
+		for(auto &res : resources) {
+			if(session.AddResource(res.fileName, res.stream) == false)
+				Con::cwar << Con::PREFIX_SERVER << "[ResourceManager] Unable to open file '" << res.fileName << "'. Skipping..." << Con::endl;
 		}
-		numResources = resTransfer.size();
 	}
-	else if(bRemoveCurrent == true) {
-		numResources = resTransfer.size();
-		if(numResources > 0) {
-#if RESOURCE_TRANSFER_VERBOSE == 1
-			auto &r = resTransfer[0];
-			Con::csv << "[ResourceManager] File '" << r->name << "' transferred successfully to " << session->GetIP() << ". " << (numResources - 1) << " resources left!" << Con::endl;
-#endif
-			session.RemoveResource(0);
-			numResources--;
-		}
+	// Static resources are always in front of streamed resources
+	auto hasStaticResources = (resTransfer.empty() == false && resTransfer.front()->stream == false);
+	if(bComplete == false && hasStaticResources == false) {
+		// All static resources are complete; Starting dynamic resources
+		bComplete = true;
+		session.SetInitialResourceTransferState(pragma::networking::IServerClient::TransferState::Complete);
+		Con::csv << "All resources have been sent to client '" << session.GetIdentifier() << "'!" << Con::endl;
+		NetPacket p;
+		SendPacket("resourcecomplete", p, pragma::networking::Protocol::SlowReliable, session);
 	}
-	else
-		numResources = resTransfer.size();
-	if(numResources == 0 || (resTransfer.front()->stream == true && bComplete == false) // All static resources are complete; Starting dynamic resources
-	) {
-		if(bComplete == false) {
-			session.SetInitialResourceTransferState(pragma::networking::IServerClient::TransferState::Complete);
-			Con::csv << "All resources have been sent to client '" << session.GetIdentifier() << "'!" << Con::endl;
-			NetPacket p;
-			SendPacket("resourcecomplete", p, pragma::networking::Protocol::SlowReliable, session);
-		}
-		if(numResources == 0) {
-			session.SetTransferComplete(true);
-			return;
-		}
+	if(resTransfer.empty()) {
+		session.SetTransferComplete(true);
+		return;
+	}
+
+	// Announce as many resources as we're allowed to transfer concurrently
+	auto maxFiles = static_cast<std::ptrdiff_t>(umath::max(cvMaxFiles->GetInt(), 1));
+	auto numActive = std::count_if(resTransfer.begin(), resTransfer.end(), [](const std::shared_ptr<Resource> &r) { return r->state != Resource::State::Pending; });
+	for(auto &r : resTransfer) {
+		if(numActive >= maxFiles)
+			break;
+		if(r->state != Resource::State::Pending)
+			continue;
+		// Streamed resources have to wait until the initial transfer is complete
+		if(bComplete == false && r->stream)
+			break;
+		auto *hash = FindResourceHash(*r);
+		if(hash == nullptr)
+			continue; // Will be announced by UpdateResourceHashes once the hash is available
+		r->state = Resource::State::Announced;
+		++numActive;
+		NetPacket packetRes;
+		packetRes->Write<uint32_t>(r->transferId);
+		packetRes->WriteString(r->name);
+		packetRes->Write<UInt64>(r->size);
+		// Clients skip the verification if no hash is available
+		packetRes->Write<bool>(hash->has_value());
+		if(hash->has_value())
+			packetRes->WriteString(**hash);
+		SendPacket("resourceinfo", packetRes, pragma::networking::Protocol::SlowReliable, session);
 	}
-	auto &r = resTransfer[0];
-	auto f = r->file;
-	UInt64 size = CUInt64(f->GetSize());
-	NetPacket packetRes;
-	packetRes->WriteString(r->name);
-	packetRes->Write<UInt64>(size);
-	SendPacket("resourceinfo", packetRes, pragma::networking::Protocol::SlowReliable, session);
 }
 
 void ServerState::HandleServerResourceStart(pragma::networking::IServerClient &session, NetPacket &packet)
 {
-	auto &resTransfer = session.GetResourceTransfer();
-	if(resTransfer.empty()) {
-		Con::cwar << "Attempted to send invalid resource fragment to client " << session.GetIdentifier() << Con::endl;
+	auto transferId = packet->Read<uint32_t>();
+	auto send = packet->Read<bool>();
+	auto resumeOffset = packet->Read<uint64_t>();
+	auto idx = session.FindResource(transferId);
+	if(idx == -1) {
+		Con::cwar << "Received response for unknown resource " << transferId << " from client " << session.GetIdentifier() << Con::endl;
 		return;
 	}
-	bool send = packet->Read<bool>();
-	if(send) {
-		Con::csv << "Sending file '" << resTransfer[0]->name << "' to client '" << session.GetIdentifier() << "'" << Con::endl;
-		HandleServerResourceFragment(session);
+	auto r = session.GetResourceTransfer()[idx];
+	if(send == false || resumeOffset >= r->size) {
+		session.RemoveResource(idx);
+		HandleServerNextResource(session);
+		return;
 	}
+	r->state = Resource::State::Transferring;
+	r->offset = resumeOffset;
+	r->ackOffset = resumeOffset;
+	if(resumeOffset > 0)
+		Con::csv << "Resuming transfer of file '" << r->name << "' to client '" << session.GetIdentifier() << "' at " << util::get_pretty_bytes(resumeOffset) << Con::endl;
 	else
-		HandleServerNextResource(session);
+		Con::csv << "Sending file '" << r->name << "' to client '" << session.GetIdentifier() << "'" << Con::endl;
+	HandleServerResourceFragments(session);
 }
 
-void ServerState::HandleServerResourceFragment(pragma::networking::IServerClient &session)
+static CVar cvWindowSize = GetServerConVar("sv_resource_transfer_window_size");
+static CVar cvCompression = GetServerConVar("sv_resource_transfer_compression");
+void ServerState::HandleServerResourceFragments(pragma::networking::IServerClient &session)
 {
+	auto windowSize = umath::max(static_cast<uint64_t>(umath::max(cvWindowSize->GetInt(), 0)), static_cast<uint64_t>(RESOURCE_TRANSFER_FRAGMENT_SIZE));
+	auto compress = cvCompression->GetBool();
+
 	auto &resTransfer = session.GetResourceTransfer();
-	if(resTransfer.empty()) {
-		Con::cwar << "Attempted to send invalid resource fragment to client " << session.GetIdentifier() << Con::endl;
+	uint64_t inFlight = 0;
+	for(auto &r : resTransfer) {
+		if(r->state == Resource::State::Transferring)
+			inFlight += r->offset - r->ackOffset;
+	}
+
+	// Round-robin over all active files, so small files don't have to wait for large ones
+	std::vector<uint8_t> buf(RESOURCE_TRANSFER_FRAGMENT_SIZE);
+	auto sent = true;
+	while(sent && inFlight < windowSize) {
+		sent = false;
+		for(auto &r : resTransfer) {
+			if(inFlight >= windowSize)
+				break;
+			if(r->state != Resource::State::Transferring || r->offset >= r->size)
+				continue;
+			auto read = static_cast<uint32_t>(umath::min(r->size - r->offset, static_cast<uint64_t>(RESOURCE_TRANSFER_FRAGMENT_SIZE)));
+			r->file->Seek(r->offset);
+			r->file->Read(buf.data(), read);
+			NetPacket fragment;
+			pragma::networking::write_resource_fragment(fragment, r->transferId, r->offset, buf.data(), read, compress);
+			r->offset += read;
+			inFlight += read;
+			sent = true;
+			SendPacket("resource_fragment", fragment, pragma::networking::Protocol::SlowReliable, session);
+		}
+	}
+}
+
+void ServerState::HandleServerResourceAck(pragma::networking::IServerClient &session, NetPacket &packet)
+{
+	auto transferId = packet->Read<uint32_t>();
+	auto offset = packet->Read<uint64_t>();
+	auto idx = session.FindResource(transferId);
+	if(idx == -1)
 		return;
+	auto &r = session.GetResourceTransfer()[idx];
+	if(r->state != Resource::State::Transferring)
+		return;
+	r->ackOffset = umath::clamp(offset, r->ackOffset, r->offset);
+	if(r->ackOffset >= r->size) {
+#if RESOURCE_TRANSFER_VERBOSE == 1
+		Con::csv << "[ResourceManager] File '" << r->name << "' transferred successfully to " << session.GetIdentifier() << ". " << (session.GetResourceTransfer().size() - 1) << " resources left!" << Con::endl;
+#endif
+		session.RemoveResource(idx);
+		HandleServerNextResource(session);
 	}
-	auto &r = resTransfer[0];
-	auto f = r->file;
-	f->Seek(r->offset);
-	NetPacket fragment;
-	std::array<uint8_t, RESOURCE_TRANSFER_FRAGMENT_SIZE> buf;
-	UInt64 size = CUInt64(f->GetSize());
-	auto read = CUInt32(size - r->offset);
-	if(read > RESOURCE_TRANSFER_FRAGMENT_SIZE)
-		read = RESOURCE_TRANSFER_FRAGMENT_SIZE;
-	f->Read(buf.data(), read);
-	fragment->Write<unsigned int>(read);
-	fragment->Write(buf.data(), read);
-	r->offset += read;
-	SendPacket("resource_fragment", fragment, pragma::networking::Protocol::SlowReliable, session);
+	HandleServerResourceFragments(session);
+}
+
+void ServerState::HandleServerResourceNack(pragma::networking::IServerClient &session, NetPacket &packet)
+{
+	auto transferId = packet->Read<uint32_t>();
+	auto offset = packet->Read<uint64_t>();
+	auto idx = session.FindResource(transferId);
+	if(idx == -1)
+		return;
+	auto &r = session.GetResourceTransfer()[idx];
+	if(r->state != Resource::State::Transferring)
+		return;
+	// Everything past the requested offset has to be sent again
+	r->offset = umath::min(offset, r->offset);
+	r->ackOffset = r->offset;
+	Con::cwar << "Client '" << session.GetIdentifier() << "' requested resend of file '" << r->name << "' at " << util::get_pretty_bytes(r->offset) << Con::endl;
+	HandleServerResourceFragments(session);
+}
+
+void ServerState::HandleServerResourceAbort(pragma::networking::IServerClient &session, NetPacket &packet)
+{
+	auto transferId = packet->Read<uint32_t>();
+	auto idx = session.FindResource(transferId);
+	if(idx == -1)
+		return;
+	Con::cwar << "Client '" << session.GetIdentifier() << "' aborted transfer of file '" << session.GetResourceTransfer()[idx]->name << "'!" << Con::endl;
+	session.RemoveResource(idx);
+	HandleServerNextResource(session);
+	HandleServerResourceFragments(session);
 }
 
 void ServerState::ReceiveUserInput(pragma::networking::IServerClient &client, NetPacket &packet)
@@ -280,17 +402,11 @@ void ServerState::ReceiveUserInput(pragma::networking::IServerClient &client, Ne
 extern ServerState *server;
 void NET_sv_resourceinfo_response(pragma::networking::IServerClient &session, NetPacket packet) { server->HandleServerResourceStart(session, packet); }
 
-void NET_sv_resource_request(pragma::networking::IServerClient &session, NetPacket packet)
-{
-	bool b = packet->Read<bool>();
-#if RESOURCE_TRANSFER_VERBOSE == 1
-	Con::csv << "[ResourceManager] Got resource request from client: " << session->GetIdentifier() << " (" << b << ")" << Con::endl;
-#endif
-	if(b)
-		server->HandleServerNextResource(session);
-	else
-		server->HandleServerResourceFragment(session);
-}
+void NET_sv_resource_ack(pragma::networking::IServerClient &session, NetPacket packet) { server->HandleServerResourceAck(session, packet); }
+
+void NET_sv_resource_nack(pragma::networking::IServerClient &session, NetPacket packet) { server->HandleServerResourceNack(session, packet); }
+
+void NET_sv_resource_abort(pragma::networking::IServerClient &session, NetPacket packet) { server->HandleServerResourceAbort(session, packet); }
 
 void NET_sv_resource_begin(pragma::networking::IServerClient &session, NetPacket packet)
 {
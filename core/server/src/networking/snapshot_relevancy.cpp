@@ -0,0 +1,138 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan */
+
+#include "stdafx_server.h"
+#include "pragma/networking/snapshot_relevancy.hpp"
+#include "pragma/entities/s_baseentity.h"
+#include <pragma/entities/components/base_transform_component.hpp>
+#include <unordered_set>
+
+using namespace pragma::networking;
+
+void SnapshotRelevancy::ClientCache::Invalidate()
+{
+	viewCluster = INVALID_CLUSTER;
+	viewClusterVisibility.clear();
+	entries.clear();
+}
+bool SnapshotRelevancy::ClientCache::IsDeferred(uint32_t entIdx) const { return entIdx < deferred.size() && deferred[entIdx]; }
+void SnapshotRelevancy::ClientCache::SetDeferred(uint32_t entIdx, bool d)
+{
+	if(entIdx >= deferred.size()) {
+		if(!d)
+			return;
+		deferred.resize(entIdx + 1, false);
+	}
+	deferred[entIdx] = d;
+}
+
+void SnapshotRelevancy::SetBSPTree(const std::shared_ptr<util::BSPTree> &bspTree)
+{
+	m_bspTree = (bspTree && bspTree->IsValid()) ? bspTree : nullptr;
+	m_entityEntries.clear();
+}
+const std::shared_ptr<util::BSPTree> &SnapshotRelevancy::GetBSPTree() const { return m_bspTree; }
+void SnapshotRelevancy::Clear()
+{
+	m_bspTree = nullptr;
+	m_entityEntries.clear();
+}
+void SnapshotRelevancy::OnEntityRemoved(uint32_t entIdx)
+{
+	if(entIdx >= m_entityEntries.size())
+		return;
+	// Resetting the generation makes sure cached client results for this index are discarded if it gets re-used
+	m_entityEntries[entIdx] = {};
+}
+
+void SnapshotRelevancy::UpdateClient(ClientCache &cache, const Vector3 &viewPos) const
+{
+	auto cluster = INVALID_CLUSTER;
+	if(m_bspTree) {
+		auto *node = m_bspTree->FindLeafNode(viewPos);
+		if(node)
+			cluster = node->cluster;
+	}
+	if(cluster == cache.viewCluster)
+		return;
+	// Client has moved into a different cluster, all cached visibility results are obsolete
+	cache.Invalidate();
+	cache.viewCluster = cluster;
+	if(cluster != INVALID_CLUSTER)
+		m_bspTree->DecompressClusterVisibility(cluster, cache.viewClusterVisibility);
+}
+
+void SnapshotRelevancy::UpdateEntityEntry(uint32_t entIdx, const Vector3 &min, const Vector3 &max)
+{
+	if(entIdx >= m_entityEntries.size())
+		m_entityEntries.resize(entIdx + 1);
+	auto &entry = m_entityEntries[entIdx];
+	if(entry.generation != 0 && min.x >= entry.min.x && min.y >= entry.min.y && min.z >= entry.min.z && max.x <= entry.max.x && max.y <= entry.max.y && max.z <= entry.max.z)
+		return;
+
+	constexpr float margin = 64.f;
+	entry.min = min - Vector3 {margin};
+	entry.max = max + Vector3 {margin};
+	entry.generation = m_nextGeneration++;
+	entry.clusters.clear();
+
+	std::unordered_set<util::BSPTree::ClusterIndex> clusters;
+	for(auto *node : m_bspTree->FindLeafNodesInAabb(entry.min, entry.max)) {
+		if(node->cluster == INVALID_CLUSTER)
+			continue;
+		if(clusters.insert(node->cluster).second)
+			entry.clusters.push_back(node->cluster);
+	}
+}
+
+SnapshotRelevancy::EntityInfo SnapshotRelevancy::UpdateEntity(SBaseEntity &ent)
+{
+	EntityInfo info {};
+	info.index = ent.GetIndex();
+	auto *trC = ent.GetTransformComponent();
+	if(ent.IsSnapshotAlwaysRelevant() || ent.IsWorld() || !trC) {
+		// Entities without a location are always relevant
+		info.alwaysRelevant = true;
+		return info;
+	}
+	info.position = trC->GetPosition();
+	auto [cmin, cmax] = ent.GetCollisionBounds();
+	// Collision bounds are not rotated, so we use the bounding sphere instead
+	info.radius = umath::max(uvec::length(cmin), uvec::length(cmax));
+	if(m_bspTree)
+		UpdateEntityEntry(info.index, info.position - Vector3 {info.radius}, info.position + Vector3 {info.radius});
+	return info;
+}
+
+bool SnapshotRelevancy::IsRelevant(ClientCache &cache, const Vector3 &viewPos, const EntityInfo &info, float maxDistance) const
+{
+	if(info.alwaysRelevant)
+		return true;
+	if(maxDistance > 0.f && uvec::distance(info.position, viewPos) - info.radius > maxDistance)
+		return false;
+
+	// If the client is outside of the world, or there is no visibility information, we can't make any assumptions
+	if(!m_bspTree || cache.viewCluster == INVALID_CLUSTER || info.index >= m_entityEntries.size())
+		return true;
+
+	auto &entry = m_entityEntries[info.index];
+	if(entry.generation == 0)
+		return true;
+	auto idx = info.index;
+	if(idx >= cache.entries.size())
+		cache.entries.resize(idx + 1);
+	auto &cacheEntry = cache.entries[idx];
+	if(cacheEntry.generation == entry.generation)
+		return cacheEntry.pvsVisible;
+
+	cacheEntry.generation = entry.generation;
+	if(entry.clusters.empty())
+		cacheEntry.pvsVisible = true; // Entity is entirely in solid space or outside of the world; Be conservative
+	else {
+		cacheEntry.pvsVisible = std::find_if(entry.clusters.begin(), entry.clusters.end(), [&cache](util::BSPTree::ClusterIndex cluster) { return util::BSPTree::IsClusterVisible(cache.viewClusterVisibility, cluster); }) != entry.clusters.end();
+	}
+	return cacheEntry.pvsVisible;
+}
@@ -256,6 +256,7 @@ void ServerState::Think()
 		if(m_serverReg)
 			m_serverReg->UpdateServerData();
 	}
+	UpdateResourceHashes();
 }
 
 void ServerState::Tick() { NetworkState::Tick(); }
@@ -0,0 +1,120 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __NAV_PATH_SERVICE_HPP__
+#define __NAV_PATH_SERVICE_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include "pragma/util/job_system.hpp"
+#include <mathutil/uvec.h>
+#include <condition_variable>
+#include <unordered_map>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace pragma {
+	namespace ai::navigation {
+		struct PathQuery;
+	};
+	namespace nav {
+		class Mesh;
+		// Resolves path queries on the workers of the engine job system.
+		// Each query is processed in slices of a limited number of Detour iterations, so long searches can't starve
+		// the queue, and queries with a higher priority are always sliced first. Identical requests which are still
+		// pending are merged into a single query.
+		class DLLNETWORK PathService {
+		  public:
+			enum class Priority : uint8_t { Low = 0u, Normal, High, Count };
+			struct DLLNETWORK Settings {
+				// Maximum number of job system workers processing queries at the same time
+				uint32_t workerCount = 2;
+				// Maximum number of Detour search iterations per slice
+				uint32_t iterationsPerSlice = 256;
+				// Searches in progress each occupy a query object of the navigation mesh. Once this many are in progress, new queries of
+				// the same priority are only started after one of them has been completed.
+				uint32_t maxActiveSearches = 16;
+				// Requests whose start and end positions fall into the same grid cells are merged
+				float coalesceGridSize = 8.f;
+			};
+			struct DLLNETWORK Statistics {
+				uint64_t requestCount = 0;
+				uint64_t coalescedCount = 0;
+				uint64_t completedCount = 0;
+				uint64_t failedCount = 0;
+				// Queries that were dropped because nobody was waiting for them anymore
+				uint64_t discardedCount = 0;
+				uint64_t sliceCount = 0;
+				uint32_t pendingCount = 0;
+				// Time between request and completion
+				std::chrono::steady_clock::duration totalLatency {};
+				std::chrono::steady_clock::duration maxLatency {};
+				// Time since the statistics were last reset
+				std::chrono::steady_clock::duration elapsed {};
+			};
+
+			PathService(const std::shared_ptr<Mesh> &navMesh, const Settings &settings);
+			PathService(const PathService &) = delete;
+			PathService &operator=(const PathService &) = delete;
+			~PathService();
+
+			std::shared_ptr<ai::navigation::PathQuery> RequestPath(const Vector3 &start, const Vector3 &end, Priority priority = Priority::Normal);
+			const std::shared_ptr<Mesh> &GetNavMesh() const;
+			const Settings &GetSettings() const;
+			Statistics GetStatistics() const;
+			void ResetStatistics();
+		  private:
+			struct CoalesceKey {
+				std::array<int32_t, 6> coordinates;
+				bool operator==(const CoalesceKey &other) const;
+			};
+			struct CoalesceKeyHash {
+				size_t operator()(const CoalesceKey &key) const;
+			};
+			struct Job;
+			struct Queue {
+				std::deque<std::unique_ptr<Job>> pending;
+				// Searches which have been started, but require more slices
+				std::deque<std::unique_ptr<Job>> active;
+			};
+			// Number of slices a worker job processes before it is rescheduled, so it doesn't occupy a job system worker for too long
+			static constexpr uint32_t SLICES_PER_WORKER_JOB = 8;
+			std::unique_ptr<Job> PopJob();
+			bool HasQueuedJobs() const;
+			CoalesceKey GetCoalesceKey(const Vector3 &start, const Vector3 &end) const;
+			// Has to be called with the mutex locked
+			void ScheduleWorker();
+			void RunWorker();
+			// Returns false if the query has to be continued in another slice
+			bool ProcessSlice(Job &job);
+			// Has to be called with the mutex locked
+			void FinalizeJob(Job &job);
+
+			std::shared_ptr<Mesh> m_navMesh;
+			Settings m_settings;
+			JobSystem &m_jobSystem;
+			JobSystem::SubsystemId m_subsystem = JobSystem::DEFAULT_SUBSYSTEM;
+			uint32_t m_workerCount = 0;
+			bool m_running = true;
+
+			mutable std::mutex m_mutex;
+			std::condition_variable m_condition;
+			std::array<Queue, static_cast<size_t>(Priority::Count)> m_queues;
+			uint32_t m_activeSearchCount = 0;
+			std::unordered_map<CoalesceKey, std::weak_ptr<ai::navigation::PathQuery>, CoalesceKeyHash> m_pendingQueries;
+			Statistics m_statistics {};
+			std::chrono::steady_clock::time_point m_statisticsResetTime;
+		};
+	};
+};
+
+#endif
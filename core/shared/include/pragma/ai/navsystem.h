@@ -10,6 +10,7 @@
 #include "pragma/networkdefinitions.h"
 #include <udm_types.hpp>
 #include <mathutil/glmutil.h>
+#include <shared_mutex>
 
 class Game;
 class rcContext;
@@ -21,6 +22,7 @@ struct rcPolyMeshDetail;
 typedef unsigned int dtPolyRef;
 class dtNavMesh;
 class dtNavMeshQuery;
+class dtQueryFilter;
 
 class RcNavMesh;
 class DLLNETWORK RcPathResult {
@@ -38,23 +40,49 @@ class DLLNETWORK RcPathResult {
 
 class DLLNETWORK RcNavMesh {
   public:
+	// Tile coordinates follow the Detour convention, i.e. x and y of a tile correspond to the x- and z-axis in world space
+	struct DLLNETWORK TileLayout {
+		Vector3 origin {};
+		float tileWorldSize = 0.f;
+		uint32_t tileCountX = 0;
+		uint32_t tileCountY = 0;
+		// Returns false if the box doesn't overlap any tile
+		bool GetTileRange(const Vector3 &min, const Vector3 &max, int32_t &outX0, int32_t &outY0, int32_t &outX1, int32_t &outY1) const;
+	};
+	struct DLLNETWORK Tile {
+		int32_t x = 0;
+		int32_t y = 0;
+		std::shared_ptr<rcPolyMesh> polyMesh;
+		std::shared_ptr<rcPolyMeshDetail> polyMeshDetail;
+	};
 	RcNavMesh(const std::shared_ptr<rcPolyMesh> &polyMesh, const std::shared_ptr<rcPolyMeshDetail> &polyMeshDetail, const std::shared_ptr<dtNavMesh> &navMesh);
+	RcNavMesh(const std::shared_ptr<dtNavMesh> &navMesh, const TileLayout &tileLayout, std::vector<Tile> &&tiles);
 	dtNavMesh &GetNavMesh();
+	// Only available if the mesh is not tiled
 	rcPolyMesh &GetPolyMesh();
 	rcPolyMeshDetail &GetPolyMeshDetail();
+
+	bool IsTiled() const;
+	const TileLayout &GetTileLayout() const;
+	// Only contains tiles with walkable polygons
+	std::vector<Tile> &GetTiles();
+	const std::vector<Tile> &GetTiles() const;
   private:
 	std::shared_ptr<rcPolyMesh> m_polyMesh;
 	std::shared_ptr<rcPolyMeshDetail> m_polyMeshDetail;
 	std::shared_ptr<dtNavMesh> m_navMesh;
+	TileLayout m_tileLayout {};
+	std::vector<Tile> m_tiles;
 };
 
 namespace udm {
 	struct AssetData;
+	struct LinkedPropertyWrapper;
 };
 
 namespace pragma {
 	namespace nav {
-		static constexpr uint32_t PNAV_VERSION = 1;
+		static constexpr uint32_t PNAV_VERSION = 2;
 		static constexpr auto PNAV_IDENTIFIER = "PNAV";
 		static constexpr auto PNAV_EXTENSION_BINARY = "pnav_b";
 		static constexpr auto PNAV_EXTENSION_ASCII = "pnav";
@@ -92,6 +120,9 @@ namespace pragma {
 			float sampleDetailDist = 60.f;
 			float sampleDetailMaxError = 1.f;
 			PartitionType partitionType = PartitionType::Watershed;
+			// Edge length of a tile in cells. If 0, the navigation mesh is generated as a single mesh, otherwise the tiles
+			// are generated in parallel and can be rebuilt individually (see Mesh::RebuildTiles).
+			uint32_t tileSize = 0;
 		};
 		DLLNETWORK std::shared_ptr<RcNavMesh> generate(Game &game, const Config &config, std::string *err = nullptr);
 		DLLNETWORK std::shared_ptr<RcNavMesh> generate(Game &game, const Config &config, const BaseEntity &ent, std::string *err = nullptr);
@@ -99,6 +130,11 @@ namespace pragma {
 		DLLNETWORK std::shared_ptr<RcNavMesh> load(Game &game, const std::string &fname, Config &outConfig);
 		class DLLNETWORK Mesh {
 		  public:
+			struct DLLNETWORK QuerySettings {
+				Vector3 extents {256.f, 256.f, 256.f};
+				uint32_t maxNodes = 2048;
+				uint32_t maxPathLength = 256;
+			};
 			template<class TMesh>
 			static std::shared_ptr<TMesh> Create(const std::shared_ptr<RcNavMesh> &rcMesh, const Config &config);
 			template<class TMesh>
@@ -111,19 +147,44 @@ namespace pragma {
 			bool Save(Game &game, udm::AssetDataArg outData, std::string &outErr);
 			bool Save(Game &game, const std::string &fileName, std::string &outErr);
 
+			// Regenerates all tiles overlapped by the specified box, e.g. after a door or brush entity has moved. Only supported for tiled meshes,
+			// and has to be called from the main thread. The first overload uses the geometry of the world, same as nav::generate(Game&, const Config&).
+			bool RebuildTiles(Game &game, const Vector3 &min, const Vector3 &max, std::string *err = nullptr);
+			bool RebuildTiles(Game &game, const Vector3 &min, const Vector3 &max, const std::vector<Vector3> &verts, const std::vector<int32_t> &indices, const std::vector<ConvexArea> *areas = nullptr, std::string *err = nullptr);
+			// Tiles are only replaced while this mutex is locked exclusively. Threads other than the main thread have to lock it
+			// (shared) while they access the Detour mesh.
+			std::shared_mutex &GetDetourMeshMutex() const;
+
 			const Config &GetConfig() const;
 
+			// Changing the settings only affects queries that are acquired afterwards
+			void SetQuerySettings(const QuerySettings &settings);
+			QuerySettings GetQuerySettings() const;
+			// Returns an initialized query object from the pool of this mesh, which is returned to the pool once the last reference to it has been released.
+			// A query object must only be used by one thread at a time, but any number of query objects can be used concurrently.
+			std::shared_ptr<dtNavMeshQuery> AcquireQuery();
+			// Query object that may only be used for read-only operations which don't use the node pool, e.g. dtNavMeshQuery::closestPointOnPolyBoundary
+			const std::shared_ptr<dtNavMeshQuery> &GetSharedQuery() const;
+			void InitializeQueryFilter(dtQueryFilter &filter) const;
+			bool FindNearestPoly(dtNavMeshQuery &query, const Vector3 &pos, dtPolyRef &ref, Vector3 &outPoint) const;
+
 			const std::shared_ptr<RcNavMesh> &GetRcNavMesh() const;
 			std::shared_ptr<RcNavMesh> &GetRcNavMesh();
 		  protected:
 			friend DLLNETWORK std::shared_ptr<RcNavMesh> load(Game &game, const std::string &fname, Config &outConfig);
 			Mesh(const std::shared_ptr<RcNavMesh> &rcMesh, const Config &config);
-			Mesh() = default;
+			Mesh();
 			bool LoadFromAssetData(Game &game, const udm::AssetData &data, std::string &outErr);
 			bool FindNearestPoly(const Vector3 &pos, dtPolyRef &ref);
 		  private:
+			struct QueryPool;
+			void InitializeQueries();
+			bool LoadTilesFromAssetData(const udm::LinkedPropertyWrapper &udm, std::vector<uint32_t> &surfaceMaterialTable, std::string &outErr);
 			std::shared_ptr<RcNavMesh> m_rcMesh;
 			Config m_config = {};
+			std::shared_ptr<QueryPool> m_queryPool;
+			std::shared_ptr<dtNavMeshQuery> m_sharedQuery;
+			mutable std::shared_mutex m_detourMeshMutex;
 		};
 	};
 };
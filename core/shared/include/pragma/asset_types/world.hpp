@@ -145,6 +145,14 @@ namespace pragma::asset {
 		bool Save(udm::AssetDataArg outData, const std::string &mapName, std::string &outErr);
 		bool LoadFromAssetData(udm::AssetDataArg data, EntityData::Flags entMask, std::string &outErr);
 	  private:
+#pragma pack(push, 1)
+		// Table in front of the entity blocks (version 13+), which allows entities to be filtered and
+		// addressed by offset without parsing the blocks of the ones that are skipped
+		struct EntityTableEntry {
+			uint64_t offset = 0; // Absolute file offset of the entity block
+			EntityData::Flags flags = EntityData::Flags::None;
+		};
+#pragma pack(pop)
 		WorldData(NetworkState &nw);
 		void WriteDataOffset(VFilePtrReal &f, uint64_t offsetToOffset);
 		void WriteMaterials(VFilePtrReal &f);
@@ -153,8 +161,10 @@ namespace pragma::asset {
 		void WriteEntities(VFilePtrReal &f);
 
 		std::vector<msys::MaterialHandle> ReadMaterials(VFilePtr &f);
-		void ReadBSPTree(VFilePtr &f, uint32_t version);
-		void ReadEntities(VFilePtr &f, const std::vector<msys::MaterialHandle> &materials, EntityData::Flags entMask);
+		bool ReadBSPTree(VFilePtr &f, uint32_t version);
+		void ReadClusterMeshIndices(VFilePtr &f, uint64_t numClusters);
+		void ReadEntities(VFilePtr &f, const std::vector<msys::MaterialHandle> &materials, EntityData::Flags entMask, uint32_t version);
+		void ReadEntity(VFilePtr &f, EntityData &entData);
 
 		NetworkState &m_nw;
 		std::vector<std::vector<WorldModelMeshIndex>> m_meshesPerCluster;
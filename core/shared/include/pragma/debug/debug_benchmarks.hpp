@@ -0,0 +1,38 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan */
+
+#ifndef __DEBUG_BENCHMARKS_HPP__
+#define __DEBUG_BENCHMARKS_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <cinttypes>
+
+class Game;
+
+// Micro-benchmarks for engine subsystems, available through the debug_benchmark_* console commands.
+// Results are printed to the console.
+namespace pragma::debug {
+	// Compares the scheduling data structures only: The timing wheel against a linear scan over all timers. Neither side
+	// creates Timer objects or runs callbacks, so the result is not a measurement of Game::UpdateTimers.
+	DLLNETWORK void benchmark_timers(uint32_t numTimers);
+	// Measures the cost of creating, spawning, broadcasting events to and removing entities with a large number of components,
+	// once with every component receiving all broadcasted events and once with the per-event routing
+	DLLNETWORK void benchmark_entity_spawn(Game &game, uint32_t numEntities);
+	// Compares sphere queries through the entity spatial index against testing every entity, for static and moving entities
+	DLLNETWORK void benchmark_entity_spatial_queries(Game &game, uint32_t numEntities, uint32_t numQueries);
+	// Compares a ctpl thread pool with one task per item against the job system (parallel for, thread pool wrapper and a task graph)
+	DLLNETWORK void benchmark_job_system(uint32_t numItems, uint32_t grainSize);
+	// Compares the previous water surface simulation (particle structs, one edge at a time) against the multi-threaded stencil solver
+	DLLNETWORK void benchmark_water_surface(uint32_t gridSize, uint32_t numSteps);
+	// Compares building a render queue with a mutex lock per item and a comparison sort against per-worker append buffers and a radix sort,
+	// using synthetic render items
+	DLLNETWORK void benchmark_render_queue(uint32_t numItems, uint32_t itemsPerJob);
+	// Compares the recursive bone hierarchy evaluation and per-bone skinning matrices against the structure-of-arrays pose,
+	// using a synthetic skeleton
+	DLLNETWORK void benchmark_bone_hierarchy(uint32_t numBones, uint32_t numIterations);
+};
+
+#endif
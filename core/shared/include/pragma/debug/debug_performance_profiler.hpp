@@ -123,10 +123,32 @@ namespace pragma {
 			util::Clock::time_point m_stopTime = {};
 		};
 
+		// How accurately the engine's main loop meets its tick deadlines
+		struct DLLNETWORK TickStatistics {
+			std::chrono::nanoseconds GetAverageJitter() const;
+
+			uint64_t tickCount = 0;
+			// Ticks that started more than a full tick interval after their deadline
+			uint64_t overrunCount = 0;
+			// Ticks that were dropped because the main loop fell too far behind
+			uint64_t skippedTickCount = 0;
+			// Delay between the scheduled deadline and the actual start of a tick
+			std::chrono::nanoseconds lastJitter {0};
+			std::chrono::nanoseconds maxJitter {0};
+			std::chrono::nanoseconds totalJitter {0};
+		};
+
 		class DLLNETWORK CPUProfiler : public Profiler {
 		  public:
 			CPUProfiler() = default;
 			virtual std::shared_ptr<Timer> CreateTimer() override;
+
+			void RecordTick(std::chrono::nanoseconds jitter, std::chrono::nanoseconds tickInterval);
+			void RecordSkippedTicks(uint64_t count);
+			const TickStatistics &GetTickStatistics() const;
+			void ResetTickStatistics();
+		  private:
+			TickStatistics m_tickStatistics {};
 		};
 	};
 };
@@ -23,6 +23,7 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <sharedutils/callback_handler.h>
 #include <sharedutils/scope_guard.h>
 #include <sharedutils/util_parallel_job.hpp>
@@ -51,6 +52,9 @@ namespace util {
 	class ParallelJobWrapper;
 	class FileAssetManager;
 };
+namespace pragma {
+	class JobSystem;
+};
 namespace pragma::asset {
 	class AssetManager;
 };
@@ -163,6 +167,10 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 	bool StartProfilingStage(CPUProfilingPhase stage);
 	bool StopProfilingStage(CPUProfilingPhase stage);
 
+	// Interrupts the main loop if it's currently sleeping until the next tick, so that pending events
+	// (e.g. incoming network packets) can be processed immediately. Can be called from any thread.
+	void WakeMainLoop();
+
 	upad::PackageManager *GetPADPackageManager() const;
 
 	void SetVerbose(bool bVerbose);
@@ -279,6 +287,7 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 
 	pragma::asset::AssetManager &GetAssetManager();
 	const pragma::asset::AssetManager &GetAssetManager() const;
+	pragma::JobSystem &GetJobSystem();
 
 	void AddTickEvent(const std::function<void()> &ev);
 
@@ -326,6 +335,7 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 	uint64_t m_tickCount = 0;
 	std::shared_ptr<VFilePtrInternalReal> m_logFile;
 	std::unique_ptr<pragma::asset::AssetManager> m_assetManager;
+	std::unique_ptr<pragma::JobSystem> m_jobSystem;
 
 	struct JobInfo {
 		util::ParallelJobWrapper job = {};
@@ -345,6 +355,10 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 
 	std::queue<std::function<void()>> m_tickEventQueue;
 	std::mutex m_tickEventQueueMutex;
+
+	std::mutex m_mainLoopWakeMutex;
+	std::condition_variable m_mainLoopWakeCondition;
+	bool m_mainLoopWakeRequested = false;
 	StateFlags m_stateFlags;
 	mutable upad::PackageManager *m_padPackageManager = nullptr;
 	std::unique_ptr<pragma::debug::ProfilingStageManager<pragma::debug::ProfilingStage, CPUProfilingPhase>> m_profilingStageManager = nullptr;
@@ -354,6 +368,8 @@ class DLLNETWORK Engine : public CVarHandler, public CallbackHandler {
 	void InitLaunchOptions(int argc, char *argv[]);
 	virtual void Think();
 	virtual void Tick();
+	bool ShouldSleepBetweenTicks();
+	void WaitForNextTick(std::chrono::steady_clock::time_point deadline);
 };
 REGISTER_BASIC_BITWISE_OPERATORS(Engine::StateFlags)
 
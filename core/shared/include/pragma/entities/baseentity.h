@@ -298,6 +298,8 @@ class DLLNETWORK BaseEntity : public pragma::BaseLuaHandle, public pragma::BaseE
   protected:
 	uint32_t m_spawnFlags = 0u;
 
+	// Changes the class name and keeps the game's class lookup index up to date
+	void SetClass(const std::string &className);
 	pragma::GString m_className = "BaseEntity";
 	util::Uuid m_uuid {};
 	EntityIndex m_index = 0u;
@@ -9,6 +9,7 @@
 
 #include "pragma/entities/components/base_entity_component.hpp"
 #include "pragma/ai/navsystem.h"
+#include "pragma/ai/nav_path_service.hpp"
 #include "pragma/model/animation/activities.h"
 #include <pragma/math/orientation.h>
 #include <atomic>
@@ -27,20 +28,13 @@ namespace pragma {
 			struct PathQuery {
 				PathQuery(const Vector3 &start, const Vector3 &end);
 				std::atomic<bool> complete;
-				std::shared_ptr<PathInfo> pathInfo;
+				// Identical requests may be merged into one query, so only the (read-only) result is shared.
+				// Each NPC tracks its progress along the path in its own PathInfo.
+				std::shared_ptr<RcPathResult> path;
 				Vector3 start;
 				Vector3 end;
 				util::WeakHandle<BaseAIComponent> npc = {};
 			};
-			struct NavThread {
-				std::thread thread;
-				std::atomic<bool> running = true;
-				CallbackHandle releaseCallback = {};
-				std::queue<std::shared_ptr<PathQuery>> queryQueue {};
-
-				std::mutex pendingQueueMutex = {};
-				std::queue<std::shared_ptr<PathQuery>> pendingQueue {};
-			};
 		};
 	};
 
@@ -54,6 +48,7 @@ namespace pragma {
 		static const char *MoveResultToString(MoveResult result);
 		static void ReloadNavThread(Game &game);
 		static void ReleaseNavThread();
+		static const std::shared_ptr<nav::PathService> &GetPathService();
 		struct DLLNETWORK MoveInfo {
 			MoveInfo() {}
 			MoveInfo(Activity act);
@@ -97,7 +92,7 @@ namespace pragma {
 		virtual void OnModelChanged(const std::shared_ptr<Model> &model);
 		virtual void OnEntityComponentAdded(BaseEntityComponent &component) override;
 		static std::atomic<uint32_t> s_npcCount;
-		static std::shared_ptr<ai::navigation::NavThread> s_navThread;
+		static std::shared_ptr<nav::PathService> s_pathService;
 		//
 	  protected:
 		BaseAIComponent(BaseEntity &ent);
@@ -12,6 +12,7 @@
 #include "pragma/model/animation/play_animation_flags.hpp"
 #include "pragma/model/animation/activities.h"
 #include "pragma/model/animation/animation_event.h"
+#include "pragma/model/animation/soa_pose.hpp"
 #include <sharedutils/property/util_property.hpp>
 #include <pragma/math/orientation.h>
 #include <mathutil/transform.hpp>
@@ -67,6 +68,8 @@ namespace pragma {
 			IsAnimated = BaseAnimationDirty << 1u,
 			SkeletonUpdateListenerEnabled = IsAnimated << 1u,
 			NeedsPostAnimationUpdate = SkeletonUpdateListenerEnabled << 1u,
+			BoneUpdateConditionsChecked = NeedsPostAnimationUpdate << 1u,
+			SoaPoseEnabled = BoneUpdateConditionsChecked << 1u,
 		};
 
 		struct DLLNETWORK AnimationSlotInfo {
@@ -208,6 +211,13 @@ namespace pragma {
 		void SetPostAnimationUpdateEnabled(bool enabled);
 		bool IsPostAnimationUpdateEnabled() const;
 
+		// If enabled, the global bone poses are computed from a structure-of-arrays copy of the local poses
+		// (see pragma::animation::SoaPose) instead of recursively walking the skeleton.
+		void SetSoaPoseEnabled(bool enabled);
+		bool IsSoaPoseEnabled() const;
+		const animation::SoaPose &GetSoaPose() const { return m_soaPose; }
+		animation::SoaPose &GetSoaPose() { return m_soaPose; }
+
 		bool ShouldUpdateBones() const;
 		UInt32 GetBoneCount() const;
 		const std::vector<umath::ScaledTransform> &GetBoneTransforms() const;
@@ -231,6 +241,12 @@ namespace pragma {
 		bool PreMaintainAnimations(double dt);
 		virtual bool MaintainAnimations(double dt);
 		void UpdateAnimations(double dt);
+		// Evaluates whether the animations should be updated and returns the time-scaled delta time if they should.
+		// This may invoke Lua callbacks and must be called from the main thread.
+		std::optional<double> PrepareAnimationUpdate(double dt);
+		// Updates the animations without evaluating the update conditions again. PrepareAnimationUpdate must have been called
+		// beforehand. Can be called from an animation worker thread, as long as no other thread accesses this component.
+		void UpdateAnimationsMT(double dt);
 		bool MaintainGestures(double dt);
 
 		virtual bool GetVertexTransformMatrix(const ModelSubMesh &subMesh, uint32_t vertexId, umath::ScaledTransform &outPose) const;
@@ -305,6 +321,7 @@ namespace pragma {
 		Vector3 m_animDisplacement = {};
 		std::vector<umath::ScaledTransform> m_bones = {};
 		std::vector<umath::ScaledTransform> m_processedBones = {}; // Bone positions / rotations in entity space
+		animation::SoaPose m_soaPose {};
 	  protected:
 		// We have to collect the animation events for the current frame and execute them after ALL animations have been completed (In case some events need to access animation data)
 		std::queue<AnimationEventQueueItem> m_animEventQueue = std::queue<AnimationEventQueueItem> {};
@@ -30,25 +30,25 @@ namespace pragma {
 
 		virtual ~BaseBvhComponent() override;
 		virtual bool IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, HitInfo &outHitInfo) const;
-		bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const;
-		bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max, IntersectionInfo &outIntersectionInfo) const;
-		bool IntersectionTestKDop(const std::vector<umath::Plane> &planes) const;
-		bool IntersectionTestKDop(const std::vector<umath::Plane> &planes, IntersectionInfo &outIntersectionInfo) const;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max, IntersectionInfo &outIntersectionInfo) const;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes) const;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes, IntersectionInfo &outIntersectionInfo) const;
 		void SetStaticCache(BaseStaticBvhCacheComponent *staticCache);
 		virtual bool IsStaticBvh() const { return false; }
-		const bvh::MeshRange *FindPrimitiveMeshInfo(size_t primIdx) const;
+		virtual const bvh::MeshRange *FindPrimitiveMeshInfo(size_t primIdx) const;
 
 		void SendBvhUpdateRequestOnInteraction();
 		static bool SetVertexData(pragma::bvh::MeshBvhTree &bvhData, const std::vector<bvh::Primitive> &data);
 		static void DeleteRange(pragma::bvh::MeshBvhTree &bvhData, size_t start, size_t end);
 		bool SetVertexData(const std::vector<bvh::Primitive> &data);
-		void GetVertexData(std::vector<bvh::Primitive> &outData) const;
+		virtual void GetVertexData(std::vector<bvh::Primitive> &outData) const;
 		void RebuildBvh();
 		void ClearBvh();
-		std::optional<Vector3> GetVertex(size_t idx) const;
-		size_t GetTriangleCount() const;
+		virtual std::optional<Vector3> GetVertex(size_t idx) const;
+		virtual size_t GetTriangleCount() const;
 
-		void DebugDrawBvhTree(const Vector3 &origin, const Vector3 &dir, float maxDist, float duration = 12.f) const;
+		virtual void DebugDrawBvhTree(const Vector3 &origin, const Vector3 &dir, float maxDist, float duration = 12.f) const;
 
 		// For internal use only
 		struct DLLNETWORK BvhBuildInfo {
@@ -63,7 +63,8 @@ namespace pragma {
 		BaseBvhComponent(BaseEntity &ent);
 		virtual void DoRebuildBvh() = 0;
 		const std::shared_ptr<bvh::MeshBvhTree> &GetUpdatedBvh() const;
-		std::vector<bvh::MeshRange> &GetMeshRanges();
+		// Returns nullptr if there is no BVH data, which is always the case for the static BVH cache
+		std::vector<bvh::MeshRange> *GetMeshRanges();
 		std::shared_ptr<bvh::MeshBvhTree> m_bvhData = nullptr;
 		ComponentHandle<BaseStaticBvhCacheComponent> m_staticCache;
 		mutable std::mutex m_bvhDataMutex;
@@ -197,6 +197,7 @@ namespace pragma {
 		void DetachFromGround(float duration = 0.1f);
 
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		bool Jump();
 		bool Jump(const Vector3 &velocity);
@@ -60,6 +60,7 @@ namespace pragma {
 	struct ComponentEvent;
 	class BaseEntityComponentSystem;
 	class EntityComponentManager;
+	class EntityTickScheduler;
 	struct ComponentMemberInfo;
 	using ComponentMemberIndex = uint32_t;
 
@@ -72,6 +73,7 @@ namespace pragma {
 		TickPolicy tickPolicy = TickPolicy::Never;
 		double lastTick = 0.0;
 		double nextTick = 0.0;
+		uint32_t schedulerSlot = std::numeric_limits<uint32_t>::max(); // Slot in the game's EntityTickScheduler
 	};
 
 	template<typename... Args>
@@ -95,6 +97,10 @@ namespace pragma {
 		static ComponentEventId EVENT_ON_ENTITY_COMPONENT_REMOVED;
 		static ComponentEventId EVENT_ON_MEMBERS_CHANGED;
 		static void RegisterEvents(pragma::EntityComponentManager &componentManager, TRegisterComponentEvent registerEvent);
+		// Collects the events that are handled by HandleEvent. Component types that override HandleEvent
+		// should also implement this function, otherwise they will receive all broadcasted events.
+		// Implementations must include the events of the base class.
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		static void RegisterMembers(pragma::EntityComponentManager &componentManager, TRegisterComponentMember registerMember);
 		enum class StateFlags : uint32_t {
 			None = 0u,
@@ -312,6 +318,7 @@ namespace pragma {
 		TickData m_tickData {};
 	  private:
 		friend BaseEntityComponentSystem;
+		friend EntityTickScheduler;
 
 		mutable std::unique_ptr<std::vector<CallbackInfo>> m_callbackInfos;
 		mutable std::unique_ptr<std::unordered_map<ComponentEventId, std::vector<CallbackHandle>>> m_eventCallbacks;
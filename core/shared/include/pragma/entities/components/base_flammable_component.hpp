@@ -19,6 +19,7 @@ namespace pragma {
 		virtual ~BaseFlammableComponent() override;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		const util::PBoolProperty &GetOnFireProperty() const;
 		const util::PBoolProperty &GetIgnitableProperty() const;
@@ -31,6 +31,7 @@ namespace pragma {
 		virtual void Load(udm::LinkedPropertyWrapperArg udm, uint32_t version) override;
 
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 	  protected:
 		BaseHealthComponent(BaseEntity &ent);
 		virtual void OnTakeDamage(DamageInfo &info);
@@ -24,6 +24,7 @@ namespace pragma {
 		static void RegisterEvents(pragma::EntityComponentManager &componentManager, TRegisterComponentEvent registerEvent);
 		static void RegisterMembers(pragma::EntityComponentManager &componentManager, TRegisterComponentMember registerMember);
 		virtual void Initialize() override;
+		virtual void OnRemove() override;
 		virtual ~BaseNameComponent() override;
 
 		virtual void SetName(std::string name);
@@ -124,6 +124,7 @@ namespace pragma {
 		BaseObservableComponent *GetObserverTarget() const;
 		virtual void ApplyViewRotationOffset(const EulerAngles &ang, float dur = 0.5f) = 0;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		BasePlayer *GetBasePlayer() const;
 		virtual void OnEntitySpawn() override;
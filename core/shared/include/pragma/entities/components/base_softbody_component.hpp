@@ -22,6 +22,7 @@ namespace pragma {
 		using BaseEntityComponent::BaseEntityComponent;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		virtual bool InitializeSoftBodyData();
 		virtual void ReleaseSoftBodyData();
@@ -8,13 +8,21 @@
 #define __BASE_STATIC_BVH_CACHE_COMPONENT_HPP__
 
 #include "pragma/entities/components/base_bvh_component.hpp"
+#include "pragma/entities/components/bvh_instance_tree.hpp"
 #include "pragma/util/util_thread_pool.hpp"
 #include "pragma/util/functional_parallel_worker.hpp"
 #include <unordered_set>
+#include <unordered_map>
+#include <map>
+#include <set>
 
 namespace pragma {
 	class BaseStaticBvhUserComponent;
 	struct HitInfo;
+	// Two-level BVH over all static entities: Each unique set of meshes (usually one per model) gets its own
+	// model-space mesh BVH, which is shared by all entities using it. The entities themselves are instances
+	// with a pose in a dynamic top-level tree, so adding, removing or moving an entity does not require
+	// rebuilding the BVH of any other entity.
 	class DLLNETWORK BaseStaticBvhCacheComponent : public BaseBvhComponent {
 	  public:
 		virtual void Initialize() override;
@@ -25,17 +33,44 @@ namespace pragma {
 		void SetCacheDirty();
 
 		void SetEntityDirty(BaseEntity &ent);
+		// Moves the entity's instance to its current pose, the mesh BVH is re-used as-is
+		void UpdateEntityPose(BaseEntity &ent);
 		void AddEntity(BaseEntity &ent);
 		void RemoveEntity(BaseEntity &ent, bool removeFinal = true);
 
 		virtual bool IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, HitInfo &outHitInfo) const override;
 		using BaseBvhComponent::IntersectionTest;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const override;
+		virtual bool IntersectionTestAabb(const Vector3 &min, const Vector3 &max, IntersectionInfo &outIntersectionInfo) const override;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes) const override;
+		virtual bool IntersectionTestKDop(const std::vector<umath::Plane> &planes, IntersectionInfo &outIntersectionInfo) const override;
+		// Primitive indices are global across all instances and always cover [0, GetTriangleCount()) without gaps
+		virtual const bvh::MeshRange *FindPrimitiveMeshInfo(size_t primIdx) const override;
+		virtual std::optional<Vector3> GetVertex(size_t idx) const override;
+		virtual size_t GetTriangleCount() const override;
+		// World-space primitives of all instances, in the order of their global primitive indices
+		virtual void GetVertexData(std::vector<bvh::Primitive> &outData) const override;
+		virtual void DebugDrawBvhTree(const Vector3 &origin, const Vector3 &dir, float maxDist, float duration = 12.f) const override;
 
 		virtual bool IsStaticBvh() const override { return true; }
 	  protected:
+		// Mesh BVHs are shared between all entities with the same list of meshes
+		using MeshBvhKey = std::vector<const ModelSubMesh *>;
+		struct BvhInstance {
+			BaseEntity *entity = nullptr;
+			std::shared_ptr<pragma::bvh::MeshBvhTree> meshBvh;
+			umath::ScaledTransform pose;
+			umath::ScaledTransform invPose;
+			pragma::bvh::BBox bounds;
+			// Mesh ranges of the mesh BVH, offset by primitiveOffset and with the instance entity assigned
+			std::vector<pragma::bvh::MeshRange> meshRanges;
+			size_t primitiveOffset = 0;
+			pragma::bvh::InstanceTree::NodeIndex node = pragma::bvh::InstanceTree::INVALID_NODE;
+		};
 		struct BvhPendingWorkerResult {
-			std::queue<std::function<void()>> callOnComplete;
-			std::shared_ptr<pragma::bvh::MeshBvhTree> bvhData;
+			std::set<MeshBvhKey> meshBvhKeys;
+			std::vector<std::pair<MeshBvhKey, std::shared_ptr<pragma::bvh::MeshBvhTree>>> meshBvhs;
+			std::vector<EntityHandle> entities; // Entities waiting for the mesh BVHs of this build
 			std::atomic<bool> complete = false;
 		};
 
@@ -43,16 +78,36 @@ namespace pragma {
 		void RemoveEntityFromBvh(const BaseEntity &ent);
 		void UpdateBuild();
 
-		void Build(std::vector<std::shared_ptr<ModelSubMesh>> &&meshes, std::vector<BaseEntity *> &&meshToEntity, std::vector<umath::ScaledTransform> &&meshPoses);
-
-		virtual void TestRebuildBvh() = 0;
-		bool m_staticBvhDirty = false;
+		// Collects the meshes of the entity that should be part of the static BVH (in model space)
+		virtual void GetEntityMeshes(BaseEntity &ent, std::vector<std::shared_ptr<ModelSubMesh>> &outMeshes) const = 0;
 		bool m_bvhInitialized = false; // Was the bvh initialized at least once?
 		std::shared_ptr<util::FunctionalParallelWorker> m_buildWorker = nullptr;
 		std::unordered_set<BaseStaticBvhUserComponent *> m_entities;
 		std::unique_ptr<BvhPendingWorkerResult> m_bvhPendingWorkerResult;
 		CallbackHandle m_onEndGame;
 		size_t m_currentBvhCacheVersion = 0;
+	  private:
+		std::shared_ptr<pragma::bvh::MeshBvhTree> FindMeshBvh(const MeshBvhKey &key);
+		void StartMeshBvhBuild();
+		void FinalizeMeshBvhBuild();
+		void UpdateInstance(BaseEntity &ent, const std::shared_ptr<pragma::bvh::MeshBvhTree> &meshBvh);
+		void UpdateInstancePose(BvhInstance &instance, const umath::ScaledTransform &pose);
+		void RemoveInstance(uint32_t instanceIdx);
+		bool IsCachedEntity(BaseEntity &ent) const;
+		template<typename TTestAabb, typename TTestTri>
+		bool TestInstanceIntersection(const TTestAabb &testAabb, const TTestTri &testTri, IntersectionInfo *outIntersectionInfo) const;
+
+		std::unordered_set<BaseEntity *> m_dirtyEntities;
+		std::unordered_set<BaseEntity *> m_entitiesAwaitingMeshBvh;
+		std::map<MeshBvhKey, std::vector<std::shared_ptr<ModelSubMesh>>> m_queuedMeshBvhBuilds;
+		std::map<MeshBvhKey, std::weak_ptr<pragma::bvh::MeshBvhTree>> m_meshBvhCache;
+
+		std::vector<BvhInstance> m_instances;
+		std::vector<uint32_t> m_freeInstances;
+		std::unordered_map<const BaseEntity *, uint32_t> m_entityToInstance;
+		std::map<size_t, uint32_t> m_primitiveOffsetToInstance;
+		size_t m_triangleCount = 0; // Also the primitive offset of the next instance
+		pragma::bvh::InstanceTree m_instanceTree;
 	};
 };
 
@@ -35,6 +35,7 @@ namespace pragma {
 		friend BaseStaticBvhCacheComponent;
 		void UpdateBvhStatus();
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		CallbackHandle m_cbOnPoseChanged;
 		pragma::ComponentHandle<BaseStaticBvhCacheComponent> m_staticBvhComponent {};
 		bool m_isActive = false;
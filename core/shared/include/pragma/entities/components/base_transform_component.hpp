@@ -12,6 +12,7 @@
 #include <sharedutils/property/util_property_quat.hpp>
 
 namespace pragma {
+	class EntitySpatialIndex;
 	enum class TransformChangeFlags : uint8_t { None = 0, PositionChanged = 1u, RotationChanged = PositionChanged << 1u, ScaleChanged = RotationChanged << 1u };
 	struct DLLNETWORK CEOnPoseChanged : public ComponentEvent {
 		CEOnPoseChanged(TransformChangeFlags changeFlags);
@@ -25,6 +26,7 @@ namespace pragma {
 		static void RegisterEvents(pragma::EntityComponentManager &componentManager, TRegisterComponentEvent registerEvent);
 		static void RegisterMembers(pragma::EntityComponentManager &componentManager, TRegisterComponentMember registerMember);
 		virtual void Initialize() override;
+		virtual void OnRemove() override;
 
 		void SetPosition(const Vector3 &pos);
 		const Vector3 &GetPosition() const;
@@ -93,11 +95,13 @@ namespace pragma {
 		void UpdateLastMovedTime();
 		void OnPoseChanged(TransformChangeFlags changeFlags, bool updatePhysics = true);
 	  protected:
+		friend EntitySpatialIndex;
 		BaseTransformComponent(BaseEntity &ent);
 		pragma::NetEventId m_netEvSetScale = pragma::INVALID_NET_EVENT;
 		double m_tLastMoved = 0.0; // Last time the entity moved or changed rotation
 		Vector3 m_eyeOffset = {};
 		umath::ScaledTransform m_pose {};
+		uint32_t m_spatialIndexSlot = std::numeric_limits<uint32_t>::max();
 	};
 	struct DLLNETWORK CETeleport : public ComponentEvent {
 		CETeleport(const umath::Transform &originalPose, const umath::Transform &targetPose, const umath::Transform &deltaPose);
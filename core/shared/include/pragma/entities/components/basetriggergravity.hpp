@@ -35,6 +35,7 @@ namespace pragma {
 		using BaseEntityComponent::BaseEntityComponent;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 	  protected:
 		virtual void OnResetGravity(BaseEntity *ent, GravitySettings &settings);
 		virtual void OnStartTouch(BaseEntity *ent);
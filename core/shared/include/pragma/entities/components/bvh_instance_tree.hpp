@@ -0,0 +1,87 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __BVH_INSTANCE_TREE_HPP__
+#define __BVH_INSTANCE_TREE_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include "pragma/entities/components/bvh_data.hpp"
+#include <bvh/v2/stack.h>
+#include <vector>
+#include <limits>
+
+namespace pragma::bvh {
+	// Top-level BVH over the world-space bounds of instances. Unlike the bottom-level mesh BVHs, this tree is dynamic:
+	// Instances can be inserted, removed and moved individually in O(log n) and the tree is kept balanced with
+	// AVL-style rotations, so changing one instance never requires rebuilding the whole tree.
+	class DLLNETWORK InstanceTree {
+	  public:
+		using NodeIndex = uint32_t;
+		static constexpr NodeIndex INVALID_NODE = std::numeric_limits<NodeIndex>::max();
+		struct DLLNETWORK TreeNode {
+			BBox bbox;
+			NodeIndex parent = INVALID_NODE; // Next free node if this node is unused
+			NodeIndex child0 = INVALID_NODE;
+			NodeIndex child1 = INVALID_NODE;
+			uint32_t instanceIndex = 0;
+			int32_t height = -1; // 0 for leaves, -1 for unused nodes
+			bool IsLeaf() const { return child0 == INVALID_NODE; }
+		};
+
+		NodeIndex Insert(const BBox &bbox, uint32_t instanceIndex);
+		void Remove(NodeIndex leaf);
+		// If the new bounds are still enclosed by the parent node, only the bounds of the ancestors are refit,
+		// otherwise the leaf is re-inserted. Returns true if the leaf was re-inserted.
+		bool Update(NodeIndex leaf, const BBox &bbox);
+		void Clear();
+
+		NodeIndex GetRoot() const { return m_root; }
+		const TreeNode &GetNode(NodeIndex idx) const { return m_nodes[idx]; }
+		size_t GetLeafCount() const { return m_leafCount; }
+		int32_t GetHeight() const { return (m_root != INVALID_NODE) ? m_nodes[m_root].height : 0; }
+
+		// Calls leafFn(instanceIndex) for all leaves whose bounds and ancestor bounds pass testBounds(bbox).
+		// Traversal stops if leafFn returns true.
+		template<typename TTestBounds, typename TLeafFn>
+		bool Traverse(const TTestBounds &testBounds, const TLeafFn &leafFn) const
+		{
+			if(m_root == INVALID_NODE)
+				return false;
+			::bvh::v2::SmallStack<NodeIndex, MAX_TRAVERSAL_DEPTH> stack;
+			stack.push(m_root);
+			while(!stack.is_empty()) {
+				auto &node = m_nodes[stack.pop()];
+				if(!testBounds(node.bbox))
+					continue;
+				if(node.IsLeaf()) {
+					if(leafFn(node.instanceIndex))
+						return true;
+					continue;
+				}
+				stack.push(node.child0);
+				stack.push(node.child1);
+			}
+			return false;
+		}
+	  private:
+		// The tree is balanced, so even hundreds of millions of instances stay well below this
+		static constexpr size_t MAX_TRAVERSAL_DEPTH = 128;
+		NodeIndex AllocateNode();
+		void FreeNode(NodeIndex idx);
+		void InsertLeaf(NodeIndex leaf);
+		void RemoveLeaf(NodeIndex leaf);
+		void RefitAncestors(NodeIndex idx);
+		NodeIndex Balance(NodeIndex idx);
+
+		std::vector<TreeNode> m_nodes;
+		NodeIndex m_root = INVALID_NODE;
+		NodeIndex m_freeList = INVALID_NODE;
+		size_t m_leafCount = 0;
+	};
+};
+
+#endif
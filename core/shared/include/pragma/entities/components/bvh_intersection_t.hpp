@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __BVH_INTERSECTION_T_HPP__
+#define __BVH_INTERSECTION_T_HPP__
+
+#include "pragma/entities/components/bvh_data.hpp"
+#include "pragma/entities/components/intersection_handler_component.hpp"
+#include <sharedutils/util_hash.hpp>
+#include <bvh/v2/stack.h>
+#include <tuple>
+
+namespace pragma::bvh {
+	inline void get_bvh_bounds(const BBox &bb, Vector3 &outMin, Vector3 &outMax)
+	{
+		constexpr auto epsilon = 0.001f;
+		outMin = Vector3 {umath::min(bb.min.values[0], bb.max.values[0]) - epsilon, umath::min(bb.min.values[1], bb.max.values[1]) - epsilon, umath::min(bb.min.values[2], bb.max.values[2]) - epsilon};
+		outMax = Vector3 {umath::max(bb.min.values[0], bb.max.values[0]) + epsilon, umath::max(bb.min.values[1], bb.max.values[1]) + epsilon, umath::max(bb.min.values[2], bb.max.values[2]) + epsilon};
+	}
+
+	// testAabb(min, max) -> bool
+	template<typename TTestAabb>
+	std::tuple<bool, bool, bool> test_node_aabb_intersection(const TTestAabb &testAabb, const Node &left, const Node &right)
+	{
+		Vector3 v0, v1;
+		get_bvh_bounds(left.get_bbox(), v0, v1);
+		auto hitLeft = testAabb(v0, v1);
+
+		get_bvh_bounds(right.get_bbox(), v0, v1);
+		auto hitRight = testAabb(v0, v1);
+		return std::make_tuple(hitLeft, hitRight, false);
+	}
+
+	// Traverses all nodes whose bounds pass testAabb(min, max) and tests the primitives of the reached leaves with testTri(primitive).
+	// The callbacks are template parameters so they can be inlined into the traversal loop.
+	// If the BVH is shared between several instances, 'primitiveOffset' is added to the primitive indices written to 'outIntersectionInfo'
+	// and 'entity' is used as owner of the hit meshes.
+	template<typename TTestAabb, typename TTestTri>
+	bool test_bvh_intersection(const MeshBvhTree &bvhData, const TTestAabb &testAabb, const TTestTri &testTri, size_t nodeIdx = 0, IntersectionInfo *outIntersectionInfo = nullptr, size_t primitiveOffset = 0, BaseEntity *entity = nullptr)
+	{
+		auto &bvh = bvhData.bvh;
+		constexpr size_t stack_size = 64;
+		::bvh::v2::SmallStack<Bvh::Index, stack_size> stack;
+		auto hasAnyHit = false;
+
+		auto isPrimitiveIntersectionInfo = outIntersectionInfo != nullptr && typeid(*outIntersectionInfo) == typeid(PrimitiveIntersectionInfo);
+		auto isMeshIntersectionInfo = outIntersectionInfo != nullptr && typeid(*outIntersectionInfo) == typeid(MeshIntersectionInfo);
+
+		std::unique_ptr<IntersectionCache> intersectionCache {};
+		if(isPrimitiveIntersectionInfo || isMeshIntersectionInfo)
+			intersectionCache = std::make_unique<IntersectionCache>();
+
+		auto traverse = [&]<bool ReturnOnFirstHit>() {
+			bvh.template traverse_top_down<ReturnOnFirstHit>(
+			  bvh.get_root().index, stack,
+			  [&](size_t begin, size_t end) {
+				  auto hasHit = false;
+				  for(auto i = begin; i < end; ++i) {
+					  size_t primIdx = bvh.prim_ids[i];
+
+					  if(intersectionCache) {
+						  // Only one hit per mesh is required
+						  auto skip = false;
+						  auto idx = primIdx * 3;
+						  for(auto &meshRange : intersectionCache->meshRanges) {
+							  if(idx >= meshRange.start && idx < meshRange.end) {
+								  skip = true;
+								  break;
+							  }
+						  }
+						  if(skip)
+							  continue;
+					  }
+
+					  if(!testTri(bvhData.primitives[primIdx]))
+						  continue;
+					  hasHit = true;
+					  hasAnyHit = true;
+					  if(!intersectionCache)
+						  return true;
+					  auto addPrim = true;
+					  auto *meshRange = bvhData.FindMeshRange(primIdx);
+					  if(meshRange) {
+						  intersectionCache->meshRanges.push_back({*meshRange});
+
+						  auto *meshEntity = entity ? entity : meshRange->entity;
+						  auto hash = util::hash_combine<uint64_t>(util::hash_combine<uint64_t>(0, reinterpret_cast<uint64_t>(meshRange->mesh.get())), reinterpret_cast<uint64_t>(meshEntity));
+						  auto it = intersectionCache->meshes.find(hash);
+						  if(it != intersectionCache->meshes.end())
+							  addPrim = false;
+						  else {
+							  intersectionCache->meshes.insert(hash);
+							  if(isMeshIntersectionInfo)
+								  static_cast<MeshIntersectionInfo *>(outIntersectionInfo)->meshInfos.push_back({meshRange->mesh.get(), meshEntity});
+						  }
+					  }
+					  if(addPrim && isPrimitiveIntersectionInfo) {
+						  auto *primIntersectionInfo = static_cast<PrimitiveIntersectionInfo *>(outIntersectionInfo);
+						  if(primIntersectionInfo->primitives.size() == primIntersectionInfo->primitives.capacity())
+							  primIntersectionInfo->primitives.reserve(primIntersectionInfo->primitives.size() * 1.75);
+						  primIntersectionInfo->primitives.push_back(primitiveOffset + primIdx);
+					  }
+				  }
+
+				  if(intersectionCache)
+					  intersectionCache->meshes.clear();
+				  return hasHit;
+			  },
+			  [&testAabb](const Node &left, const Node &right) { return test_node_aabb_intersection(testAabb, left, right); });
+		};
+		if(!outIntersectionInfo)
+			traverse.template operator()<true>();
+		else
+			traverse.template operator()<false>();
+		return hasAnyHit;
+	}
+};
+
+#endif
@@ -0,0 +1,64 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __HITBOX_BVH_DATA_HPP__
+#define __HITBOX_BVH_DATA_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include "pragma/entities/components/bvh_data.hpp"
+#include <panima/types.hpp>
+#include <mathutil/transform.hpp>
+#include <vector>
+
+namespace pragma::bvh {
+	struct DLLNETWORK HitboxObb {
+		HitboxObb(const Vector3 &min, const Vector3 &max);
+		pragma::bvh::BBox ToBvhBBox(const umath::ScaledTransform &pose, Vector3 &outOrigin) const;
+		umath::ScaledTransform GetPose(const std::vector<umath::ScaledTransform> &effectivePoses) const;
+		Vector3 position; // Position relative to bone
+		Vector3 halfExtents;
+		Vector3 min;
+		Vector3 max;
+
+		pragma::animation::BoneId boneId = std::numeric_limits<pragma::animation::BoneId>::max();
+	};
+
+	// Ring buffer of recent entity and bone poses, used to test hitboxes against the pose an entity had at an earlier point in time.
+	// Samples are re-used once the buffer is full, so recording a pose doesn't allocate any memory after the first few samples.
+	class DLLNETWORK HitboxPoseHistory {
+	  public:
+		struct DLLNETWORK Sample {
+			double time = 0.0;
+			umath::ScaledTransform pose;
+			std::vector<umath::ScaledTransform> bonePoses; // Entity space
+			// World-space bounds around all hitboxes
+			Vector3 min;
+			Vector3 max;
+		};
+
+		void SetCapacity(size_t capacity);
+		size_t GetCapacity() const { return m_samples.size(); }
+		size_t GetSampleCount() const { return m_sampleCount; }
+		void Clear();
+
+		// Returns the sample to write the new pose to. Samples have to be added in chronological order.
+		Sample &AddSample(double time);
+		// Index 0 is the oldest sample
+		const Sample &GetSample(size_t idx) const;
+		// Determines the two samples enclosing 'time' and the interpolation factor between them. Times outside of the recorded
+		// range are clamped to the oldest or newest sample.
+		bool FindSamples(double time, const Sample *&outSample0, const Sample *&outSample1, float &outFactor) const;
+		// Interpolates the poses at 'time'
+		bool GetPoses(double time, umath::ScaledTransform &outPose, std::vector<umath::ScaledTransform> &outBonePoses) const;
+	  private:
+		std::vector<Sample> m_samples;
+		size_t m_firstSample = 0;
+		size_t m_sampleCount = 0;
+	};
+};
+
+#endif
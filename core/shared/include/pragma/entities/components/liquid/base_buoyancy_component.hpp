@@ -21,6 +21,7 @@ namespace pragma {
 		virtual void Initialize() override;
 
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 	  protected:
 		BaseBuoyancyComponent(BaseEntity &ent);
 		virtual void OnEndTouch(BaseEntity *ent, PhysObj *phys);
@@ -11,14 +11,13 @@
 #include "pragma/types.hpp"
 #include <panima/types.hpp>
 #include <sharedutils/property/util_property.hpp>
+#include <sharedutils/util_path.hpp>
 #include <unordered_set>
+#include <unordered_map>
 
 #undef GetCurrentTime
 
 struct AnimationEvent;
-namespace util {
-	class Path;
-};
 namespace pragma {
 	class DLLNETWORK PanimaComponent final : public BaseEntityComponent {
 	  public:
@@ -50,6 +49,14 @@ namespace pragma {
 		bool UpdateAnimations(double dt);
 		bool MaintainAnimations(double dt);
 		void AdvanceAnimations(double dt);
+
+		// Multi-threaded update path, split into three phases:
+		// PrepareAnimationUpdate and FinalizeAnimationUpdate have to be called on the main thread (before/after),
+		// AdvanceAnimationsMT may be called from an animation worker thread.
+		// Returns the effective delta time if the animations should be advanced.
+		std::optional<double> PrepareAnimationUpdate(double dt);
+		void AdvanceAnimationsMT(double dt);
+		void FinalizeAnimationUpdate();
 		void DebugPrint(std::stringstream &ss);
 		void DebugPrint();
 
@@ -77,8 +84,38 @@ namespace pragma {
 		virtual void Save(udm::LinkedPropertyWrapperArg udm) override;
 		using BaseEntityComponent::Load;
 	  protected:
+		// Component member a channel path resolves to. Bindings are cached by path, so playing or reloading
+		// an animation does not have to parse the path and look up the component by name again.
+		struct ChannelBinding {
+			ComponentHandle<BaseEntityComponent> component;
+			util::Path memberPath;
+			// Reset whenever the component members change (e.g. after a model change)
+			std::optional<ComponentMemberIndex> memberIndex {};
+			bool enabled = true;
+		};
+		// Channels whose value type matches the member type exactly are grouped by value type and submitted
+		// in one loop per group, instead of through a type-erased value submitter per channel.
+		// Note: Batched channels are submitted before the channels with an individual value submitter, rather than strictly
+		// in channel order. This only makes a difference if the setter of one member changes the value of another animated member.
+		struct ChannelBatch {
+			struct Item {
+				BaseEntityComponent *component;
+				ComponentMemberIndex memberIndex;
+				uint32_t channelIndex;
+			};
+			udm::Type valueType = udm::Type::Invalid;
+			std::vector<Item> items;
+		};
+		struct ManagerChannelBatches {
+			// Animation the batches were built for. The animation of a manager can also be changed without going through
+			// PanimaComponent::PlayAnimation (e.g. from Lua), in which case the channel indices refer to a different animation.
+			const panima::Animation *animation = nullptr;
+			std::vector<ChannelBatch> batches;
+		};
 		virtual void Load(udm::LinkedPropertyWrapperArg udm, uint32_t version) override;
 		void InvokeValueSubmitters(panima::AnimationManager &manager);
+		void InvokeChannelBatches(panima::AnimationManager &manager, const panima::Animation &anim);
+		ChannelBatch &GetChannelBatch(std::vector<ChannelBatch> &batches, udm::Type valueType);
 		bool GetRawAnimatedPropertyValue(panima::AnimationManager &manager, const std::string &propName, udm::Type type, void *outValue, const ComponentMemberInfo **optOutMemberInfo, pragma::BaseEntityComponent **optOutComponent) const;
 		std::vector<std::pair<std::string, panima::PAnimationManager>>::iterator FindAnimationManager(const std::string_view &name);
 		void InitializeAnimationChannelValueSubmitters();
@@ -86,6 +123,9 @@ namespace pragma {
 		void ResetAnimation(const std::shared_ptr<Model> &mdl);
 		util::PFloatProperty m_playbackRate = nullptr;
 		std::vector<std::pair<std::string, panima::PAnimationManager>> m_animationManagers;
+		std::vector<panima::AnimationManager *> m_pendingValueSubmitters;
+		std::unordered_map<std::string, ChannelBinding> m_channelBindings;
+		std::unordered_map<const panima::AnimationManager *, ManagerChannelBatches> m_channelBatches;
 		std::unordered_set<const char *> m_disabledProperties;
 	};
 
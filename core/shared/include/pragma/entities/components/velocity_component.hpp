@@ -39,6 +39,7 @@ namespace pragma {
 		virtual void Load(udm::LinkedPropertyWrapperArg udm, uint32_t version) override;
 
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual void InitializeLuaObject(lua_State *lua) override;
 
 		// Set member variables directly, without any other influences
@@ -24,6 +24,7 @@
 #include <unordered_map>
 #include <typeindex>
 #include <queue>
+#include <atomic>
 #include <mathutil/umath.h>
 #include <sharedutils/functioncallback.h>
 #ifdef __linux__
@@ -81,14 +82,36 @@ namespace pragma {
 		ComponentFlags flags = ComponentFlags::None;
 		std::vector<ComponentMemberInfo> members;
 		std::unordered_map<std::string, ComponentMemberIndex> memberNameToIndex;
+		// Collects the events that are handled by the HandleEvent-method of this component type.
+		// If not set, the component type is assumed to handle all events. Events bound through
+		// BaseEntityComponent::BindEvent are tracked separately.
+		void (*getHandledEvents)(std::vector<ComponentEventId> &) = nullptr;
 		std::optional<ComponentMemberIndex> FindMember(const std::string &name) const;
+		// Returns nullptr if components of this type have to receive all events
+		const std::vector<ComponentEventId> *GetHandledEvents() const;
 
 		bool IsValid() const { return factory != nullptr; }
+	  private:
+		// Event ids may not be known at registration time, so the list is only collected once it's needed
+		mutable std::optional<std::vector<ComponentEventId>> m_handledEvents;
+	};
+
+	namespace detail {
+		DLLNETWORK uint32_t get_next_component_type_slot();
 	};
+	// Returns a process-wide index for the C++ component type, which is used to cache the component id of the type.
+	// Note: On some platforms each module gets its own instance of this function, so the same type may be assigned multiple slots.
+	template<class TComponent>
+	uint32_t get_component_type_slot()
+	{
+		static const auto slot = detail::get_next_component_type_slot();
+		return slot;
+	}
 
 	class DLLNETWORK EntityComponentManager {
 	  public:
-		EntityComponentManager() = default;
+		static constexpr uint32_t MAX_COMPONENT_TYPE_SLOTS = 4'096;
+		EntityComponentManager();
 		EntityComponentManager(const EntityComponentManager &) = delete;
 		EntityComponentManager &operator=(const EntityComponentManager &) = delete;
 
@@ -150,7 +173,14 @@ namespace pragma {
 
 		// Automatically called when a component was removed; Don't call this manually!
 		void DeregisterComponent(BaseEntityComponent &component);
+
+		// If disabled, components receive all broadcasted events, regardless of the events they handle. Only affects
+		// components that are created afterwards.
+		void SetEventRoutingEnabled(bool enabled);
+		bool IsEventRoutingEnabled() const;
 	  private:
+		template<class TComponent>
+		static constexpr void (*GetHandledEventsFunction())(std::vector<ComponentEventId> &);
 		ComponentId RegisterComponentType(const std::string &name, const std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> &factory, ComponentFlags flags, const std::type_index *typeIndex);
 		virtual void OnComponentTypeRegistered(const ComponentInfo &componentInfo);
 
@@ -161,18 +191,36 @@ namespace pragma {
 		std::vector<ComponentInfo> m_preRegistered;
 		std::vector<ComponentInfo> m_componentInfos;
 		std::unordered_map<std::type_index, ComponentId> m_typeIndexToComponentId;
+		// Component ids of C++ component types by type slot (see get_component_type_slot). May be filled in lazily from multiple threads.
+		std::unique_ptr<std::atomic<ComponentId>[]> m_componentTypeSlots;
 		std::unordered_map<ComponentId, std::vector<ComponentTypeLinkInfo>> m_linkedComponentTypes;
 		std::vector<std::shared_ptr<std::type_index>> m_componentIdToTypeIndex;
 		ComponentId m_nextComponentId = 0u;
 
 		// List of all created components by component id
 		mutable std::vector<ComponentContainerInfo> m_components;
+		bool m_eventRoutingEnabled = true;
 
 		std::unordered_map<ComponentEventId, ComponentEventInfo> m_componentEvents;
 	};
 };
 REGISTER_BASIC_BITWISE_OPERATORS(pragma::ComponentFlags);
 
+template<class TComponent>
+constexpr void (*pragma::EntityComponentManager::GetHandledEventsFunction())(std::vector<ComponentEventId> &)
+{
+	using THandleEvent = util::EventReply (BaseEntityComponent::*)(ComponentEventId, ComponentEvent &);
+	// If HandleEvent is not accessible from here, it has been re-declared (and overridden) by a derived class
+	if constexpr(requires { &TComponent::HandleEvent; }) {
+		if constexpr(std::is_same_v<decltype(&TComponent::HandleEvent), THandleEvent>)
+			return &BaseEntityComponent::GetHandledEvents; // HandleEvent has not been overridden
+	}
+	// HandleEvent has been overridden, so the events have to be declared explicitly by the component type
+	if constexpr(&TComponent::GetHandledEvents != &BaseEntityComponent::GetHandledEvents)
+		return &TComponent::GetHandledEvents;
+	return nullptr;
+}
+
 template<class TComponent, typename>
 pragma::ComponentId pragma::EntityComponentManager::RegisterComponentType(const std::string &name)
 {
@@ -193,7 +241,11 @@ pragma::ComponentId pragma::EntityComponentManager::RegisterComponentType(const
 		  return util::TSharedHandle<BaseEntityComponent> {new TComponent {ent}, [](pragma::BaseEntityComponent *c) { delete c; }};
 	  },
 	  flags, std::type_index(typeid(TComponent)));
+	auto slot = get_component_type_slot<TComponent>();
+	if(slot < MAX_COMPONENT_TYPE_SLOTS)
+		m_componentTypeSlots[slot].store(componentId, std::memory_order_relaxed);
 	auto &componentInfo = m_componentInfos[componentId];
+	componentInfo.getHandledEvents = GetHandledEventsFunction<TComponent>();
 	TComponent::RegisterMembers(*this, [this, &componentInfo](ComponentMemberInfo &&memberInfo) -> ComponentMemberIndex { return RegisterMember(componentInfo, std::move(memberInfo)); });
 	return componentId;
 }
@@ -201,10 +253,20 @@ pragma::ComponentId pragma::EntityComponentManager::RegisterComponentType(const
 template<class TComponent, typename>
 bool pragma::EntityComponentManager::GetComponentTypeId(ComponentId &outId) const
 {
+	auto slot = get_component_type_slot<TComponent>();
+	if(slot < MAX_COMPONENT_TYPE_SLOTS) {
+		auto id = m_componentTypeSlots[slot].load(std::memory_order_relaxed);
+		if(id != INVALID_COMPONENT_ID) {
+			outId = id;
+			return true;
+		}
+	}
 	auto it = m_typeIndexToComponentId.find(std::type_index(typeid(TComponent)));
 	if(it == m_typeIndexToComponentId.end())
 		return false;
 	outId = it->second;
+	if(slot < MAX_COMPONENT_TYPE_SLOTS)
+		m_componentTypeSlots[slot].store(outId, std::memory_order_relaxed);
 	return true;
 }
 
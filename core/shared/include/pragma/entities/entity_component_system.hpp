@@ -76,11 +76,59 @@ namespace pragma {
 		virtual void OnComponentAdded(BaseEntityComponent &component);
 		virtual void OnComponentRemoved(BaseEntityComponent &component);
 	  private:
-		std::unordered_map<ComponentId, ComponentHandle<BaseEntityComponent>> m_componentLookupTable; // Only contains one (the first) component per type; Used for fast lookups
+		friend BaseEntityComponent;
+		struct EventSubscriber {
+			BaseEntityComponent *component;
+			// Position of the component in the order in which components were added to the entity
+			uint32_t order;
+		};
+		using EventSubscriberList = std::vector<EventSubscriber>;
+		struct EventSubscription {
+			uint32_t order = 0;
+			bool allEvents = false;
+			std::vector<ComponentEventId> events;
+		};
+		void SubscribeToEvents(BaseEntityComponent &component);
+		// Called when an event has been bound to the component through BaseEntityComponent::BindEvent
+		void SubscribeToEvent(BaseEntityComponent &component, ComponentEventId eventId);
+		void UnsubscribeFromEvents(BaseEntityComponent &component);
+		EventSubscriberList &GetEventSubscribers(ComponentEventId eventId);
+		void InsertEventSubscriber(EventSubscriberList &list, const EventSubscriber &subscriber);
+		void RemoveEventSubscriber(EventSubscriberList &list, const BaseEntityComponent &component);
+		void FlushEventSubscriberChanges() const;
+
+		// Sparse set that maps component ids to the first component of that type; Used for fast lookups
+		struct ComponentSlot {
+			ComponentId componentId;
+			ComponentHandle<BaseEntityComponent> component;
+		};
+		BaseEntityComponent *FindComponentSlot(ComponentId componentId) const
+		{
+			if(componentId >= m_componentSlotIndices.size())
+				return nullptr;
+			auto idx = m_componentSlotIndices[componentId];
+			return (idx != 0) ? const_cast<BaseEntityComponent *>(m_componentSlots[idx - 1].component.get()) : nullptr;
+		}
+		void SetComponentSlot(ComponentId componentId, const ComponentHandle<BaseEntityComponent> &component);
+		void ClearComponentSlot(ComponentId componentId);
+		std::vector<uint16_t> m_componentSlotIndices; // Index into m_componentSlots +1, or 0 if there is no component of that type
+		std::vector<ComponentSlot> m_componentSlots;
 		std::vector<util::TSharedHandle<BaseEntityComponent>> m_components;
 		EntityComponentManager *m_componentManager;
 		BaseEntity *m_entity;
 		mutable StateFlags m_stateFlags = StateFlags::None;
+
+		// Only the components that are interested in an event are notified when it is broadcasted.
+		// The per-event lists also contain the components that receive all events.
+		mutable std::unordered_map<ComponentEventId, EventSubscriberList> m_eventSubscribers;
+		EventSubscriberList m_allEventSubscribers;
+		std::unordered_map<const BaseEntityComponent *, EventSubscription> m_eventSubscriptions;
+		uint32_t m_nextEventSubscriberOrder = 0;
+		// Subscriber lists must not be reordered while an event is being broadcasted, so insertions
+		// are deferred and removed subscribers are set to NULL until the broadcast has completed.
+		mutable std::vector<std::pair<ComponentEventId, EventSubscriber>> m_pendingEventSubscribers;
+		mutable uint32_t m_eventBroadcastDepth = 0;
+		mutable bool m_eventSubscribersDirty = false;
 	};
 };
 REGISTER_BASIC_BITWISE_OPERATORS(pragma::BaseEntityComponentSystem::StateFlags)
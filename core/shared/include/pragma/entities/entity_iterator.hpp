@@ -22,6 +22,17 @@ struct DLLNETWORK IEntityIteratorFilter {
 	IEntityIteratorFilter() = default;
 	IEntityIteratorFilter(Game &game) {}
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) = 0;
+	// If the filter can determine which entities may pass without testing all of them (e.g. through a lookup index),
+	// it writes them to outCandidates and returns true. The iterator will then only visit the candidates of the most
+	// selective filter, but every filter is still applied to each candidate.
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const { return false; }
+};
+
+// Filter that only passes entities within a bounded world-space region. Candidates are taken from the entity spatial index.
+struct DLLNETWORK IEntityIteratorSpatialFilter : public IEntityIteratorFilter {
+	using IEntityIteratorFilter::IEntityIteratorFilter;
+	virtual void GetBounds(Vector3 &outMin, Vector3 &outMax) const = 0;
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const override;
 };
 
 #pragma warning(push)
@@ -43,14 +54,29 @@ struct EntityContainer : public BaseEntityContainer {
   private:
 	std::vector<BaseEntity *> &ents;
 };
+// Container for filter candidates. The candidates are copied from a lookup index, so they are referenced by handle
+// in case an entity is removed while the iterator is still in use.
+struct EntityHandleContainer : public BaseEntityContainer {
+	EntityHandleContainer(std::vector<EntityHandle> &ents, std::size_t count) : BaseEntityContainer(count), ents {ents} {}
+	virtual std::size_t Size() const override;
+	virtual BaseEntity *At(std::size_t index) override;
+  private:
+	std::vector<EntityHandle> &ents;
+};
 struct EntityIteratorData {
 	EntityIteratorData(Game &game);
-	EntityIteratorData(Game &game, const std::vector<pragma::BaseEntityComponent *> &components, std::size_t count);
+	EntityIteratorData(Game &game, const std::vector<pragma::BaseEntityComponent *> &components, std::size_t count, pragma::ComponentId componentId = pragma::INVALID_COMPONENT_ID);
 	bool ShouldPass(BaseEntity &ent, std::size_t index) const;
 	std::size_t GetCount() const;
 	Game &game;
 	std::unique_ptr<BaseEntityContainer> entities = nullptr;
 	std::vector<std::shared_ptr<IEntityIteratorFilter>> filters = {};
+
+	// Candidates of the most selective filter, referenced by the container if any filter provided candidates
+	std::vector<EntityHandle> candidates = {};
+	std::vector<pragma::BaseEntityComponent *> componentCandidates = {};
+	std::vector<pragma::ComponentHandle<pragma::BaseEntityComponent>> componentCandidateHandles = {};
+	bool hasCandidates = false;
 };
 
 class EntityIterator;
@@ -138,6 +164,7 @@ class DLLNETWORK EntityIterator {
 	void SetBaseComponentType(pragma::ComponentId componentId);
 	void SetBaseComponentType(std::type_index typeIndex);
 	void SetBaseComponentType(const std::string &componentName);
+	void ApplyCandidateFilter(const IEntityIteratorFilter &filter);
 
 	std::shared_ptr<EntityIteratorData> m_iteratorData;
   private:
@@ -168,6 +195,7 @@ REGISTER_BASIC_BITWISE_OPERATORS(EntityIterator::FilterFlags)
 struct DLLNETWORK EntityIteratorFilterName : public IEntityIteratorFilter {
 	EntityIteratorFilterName(Game &game, const std::string &name, bool caseSensitive = false, bool exactMatch = true);
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const override;
   private:
 	std::string m_name;
 	bool m_bCaseSensitive = false;
@@ -184,6 +212,7 @@ struct DLLNETWORK EntityIteratorFilterModel : public IEntityIteratorFilter {
 struct DLLNETWORK EntityIteratorFilterUuid : public IEntityIteratorFilter {
 	EntityIteratorFilterUuid(Game &game, const util::Uuid &uuid);
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const override;
   private:
 	util::Uuid m_uuid;
 };
@@ -191,6 +220,7 @@ struct DLLNETWORK EntityIteratorFilterUuid : public IEntityIteratorFilter {
 struct DLLNETWORK EntityIteratorFilterClass : public IEntityIteratorFilter {
 	EntityIteratorFilterClass(Game &game, const std::string &name, bool caseSensitive = false, bool exactMatch = true);
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const override;
   private:
 	std::string m_name;
 	bool m_bCaseSensitive = false;
@@ -200,6 +230,7 @@ struct DLLNETWORK EntityIteratorFilterClass : public IEntityIteratorFilter {
 struct DLLNETWORK EntityIteratorFilterNameOrClass : public IEntityIteratorFilter {
 	EntityIteratorFilterNameOrClass(Game &game, const std::string &name, bool caseSensitive = false, bool exactMatch = true);
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const override;
   private:
 	std::string m_name;
 	bool m_bCaseSensitive = false;
@@ -209,6 +240,7 @@ struct DLLNETWORK EntityIteratorFilterNameOrClass : public IEntityIteratorFilter
 struct DLLNETWORK EntityIteratorFilterEntity : public IEntityIteratorFilter {
 	EntityIteratorFilterEntity(Game &game, const std::string &name);
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual bool GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const override;
   private:
 	std::vector<util::WeakHandle<pragma::BaseFilterComponent>> m_filterEnts;
 	pragma::ComponentId m_filterNameComponentId = pragma::INVALID_COMPONENT_ID;
@@ -240,10 +272,11 @@ struct DLLNETWORK EntityIteratorFilterUser : public IEntityIteratorFilter {
 	std::function<bool(BaseEntity &, std::size_t)> m_fUserFilter = nullptr;
 };
 
-struct DLLNETWORK EntityIteratorFilterSphere : public IEntityIteratorFilter {
+struct DLLNETWORK EntityIteratorFilterSphere : public IEntityIteratorSpatialFilter {
 	EntityIteratorFilterSphere(Game &game, const Vector3 &origin, float radius);
 
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual void GetBounds(Vector3 &outMin, Vector3 &outMax) const override;
   protected:
 	bool ShouldPass(BaseEntity &ent, std::size_t index, Vector3 &outClosestPointOnEntityBounds, float &outDistToEntity) const;
 
@@ -251,10 +284,11 @@ struct DLLNETWORK EntityIteratorFilterSphere : public IEntityIteratorFilter {
 	float m_radius = 0.f;
 };
 
-struct DLLNETWORK EntityIteratorFilterBox : public IEntityIteratorFilter {
+struct DLLNETWORK EntityIteratorFilterBox : public IEntityIteratorSpatialFilter {
 	EntityIteratorFilterBox(Game &game, const Vector3 &min, const Vector3 &max);
 
 	virtual bool ShouldPass(BaseEntity &ent, std::size_t index) override;
+	virtual void GetBounds(Vector3 &outMin, Vector3 &outMax) const override;
   private:
 	Vector3 m_min;
 	Vector3 m_max;
@@ -278,12 +312,26 @@ struct TEntityIteratorFilterComponent : public IEntityIteratorFilter {
 };
 
 struct ComponentContainer : public BaseEntityContainer {
-	ComponentContainer(const std::vector<pragma::BaseEntityComponent *> &components, std::size_t count) : BaseEntityContainer(count), components {components} {}
+	ComponentContainer(const std::vector<pragma::BaseEntityComponent *> &components, std::size_t count, pragma::ComponentId componentId = pragma::INVALID_COMPONENT_ID) : BaseEntityContainer(count), components {components}, componentId {componentId} {}
 	virtual std::size_t Size() const override;
 	virtual BaseEntity *At(std::size_t index) override;
 
 	// For internal use only!
 	const std::vector<pragma::BaseEntityComponent *> &components;
+	pragma::ComponentId componentId = pragma::INVALID_COMPONENT_ID;
+};
+
+// Component variant of EntityHandleContainer. Components that have been removed since the candidates were collected are
+// cleared from the component list before they are accessed.
+struct ComponentHandleContainer : public ComponentContainer {
+	ComponentHandleContainer(std::vector<pragma::BaseEntityComponent *> &components, const std::vector<pragma::ComponentHandle<pragma::BaseEntityComponent>> &handles, pragma::ComponentId componentId)
+	    : ComponentContainer(components, components.size(), componentId), m_components {components}, m_handles {handles}
+	{
+	}
+	virtual BaseEntity *At(std::size_t index) override;
+  private:
+	std::vector<pragma::BaseEntityComponent *> &m_components;
+	const std::vector<pragma::ComponentHandle<pragma::BaseEntityComponent>> &m_handles;
 };
 
 template<class TComponent>
@@ -371,7 +419,8 @@ template<class TFilter, typename... TARGS>
 void EntityIterator::AttachFilter(TARGS... args)
 {
 	static_assert(std::is_base_of<IEntityIteratorFilter, TFilter>::value, "TFilter must be a descendant of IEntityIteratorFilter!");
-	if(typeid(*m_iteratorData->entities) == typeid(EntityContainer)) {
+	auto &containerType = typeid(*m_iteratorData->entities);
+	if(containerType == typeid(EntityContainer) || containerType == typeid(EntityHandleContainer)) {
 		if constexpr(std::is_same_v<EntityIteratorFilterComponent, TFilter>) {
 			// If a component filter was attached, we can optimize by only iterating the components of
 			// that type (instead of iterating over all entities). In this case we don't actually need to
@@ -388,7 +437,9 @@ void EntityIterator::AttachFilter(TARGS... args)
 			return;
 		}
 	}
-	m_iteratorData->filters.emplace_back(std::make_unique<TFilter>(m_iteratorData->game, std::forward<TARGS>(args)...));
+	auto filter = std::make_shared<TFilter>(m_iteratorData->game, std::forward<TARGS>(args)...);
+	m_iteratorData->filters.push_back(filter);
+	ApplyCandidateFilter(*filter);
 }
 
 #endif
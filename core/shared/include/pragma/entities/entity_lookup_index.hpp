@@ -0,0 +1,37 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __ENTITY_LOOKUP_INDEX_HPP__
+#define __ENTITY_LOOKUP_INDEX_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+
+class BaseEntity;
+namespace pragma {
+	// Maps case-insensitive identifiers (e.g. entity names or class names) to all entities using them.
+	// Empty identifiers are not indexed.
+	class DLLNETWORK EntityLookupIndex {
+	  public:
+		using EntitySet = std::unordered_set<BaseEntity *>;
+		EntityLookupIndex() = default;
+		EntityLookupIndex(const EntityLookupIndex &) = delete;
+		EntityLookupIndex &operator=(const EntityLookupIndex &) = delete;
+
+		void Add(const std::string &key, BaseEntity &ent);
+		void Remove(const std::string &key, BaseEntity &ent);
+		// Returns nullptr if no entity uses the identifier
+		const EntitySet *Find(const std::string &key) const;
+		void Clear();
+	  private:
+		std::unordered_map<std::string, EntitySet> m_entities;
+	};
+};
+
+#endif
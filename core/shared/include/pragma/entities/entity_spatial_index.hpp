@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __ENTITY_SPATIAL_INDEX_HPP__
+#define __ENTITY_SPATIAL_INDEX_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <mathutil/uvec.h>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+class BaseEntity;
+namespace pragma {
+	class BaseTransformComponent;
+	// Broadphase index of the bounds of all entities with a transform component.
+	// Entities are stored in a multi-level loose spatial hash: Each entity is assigned to the level whose cell size fits its bounding sphere,
+	// and to the single cell of that level which contains its center. Bounds are re-evaluated lazily before the next query,
+	// so moving an entity only costs a flag check.
+	class DLLNETWORK EntitySpatialIndex {
+	  public:
+		using SlotId = uint32_t;
+		static constexpr SlotId INVALID_SLOT = std::numeric_limits<SlotId>::max();
+		static constexpr uint32_t LEVEL_COUNT = 12;
+		static constexpr float BASE_CELL_SIZE = 64.f;
+
+		EntitySpatialIndex();
+		EntitySpatialIndex(const EntitySpatialIndex &) = delete;
+		EntitySpatialIndex &operator=(const EntitySpatialIndex &) = delete;
+
+		void Add(BaseTransformComponent &component);
+		void Remove(BaseTransformComponent &component);
+		// Has to be called whenever the position, scale or collision bounds of the entity have changed
+		void MarkDirty(BaseTransformComponent &component);
+		// Collects all entities whose bounds may intersect the specified box.
+		// The result is conservative and has to be narrowed down by an exact test.
+		void FindCandidates(const Vector3 &min, const Vector3 &max, std::vector<BaseEntity *> &outEntities);
+		void Clear();
+
+		size_t GetEntityCount() const;
+	  private:
+		using CellKey = uint64_t;
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t OVERSIZED_LEVEL = LEVEL_COUNT;
+		struct Slot {
+			BaseTransformComponent *component = nullptr;
+			CellKey cell = 0;
+			uint32_t level = INVALID_INDEX;
+			uint32_t cellIndex = INVALID_INDEX;
+			bool dirty = false;
+		};
+		struct Level {
+			std::unordered_map<CellKey, std::vector<SlotId>> cells;
+			float cellSize = 0.f;
+			size_t count = 0;
+		};
+		static CellKey GetCellKey(int32_t x, int32_t y, int32_t z);
+		static void GetCellCoordinates(CellKey key, int32_t &x, int32_t &y, int32_t &z);
+		static int32_t GetCellCoordinate(float v, float cellSize);
+		void Flush();
+		void UpdateSlot(SlotId slotId);
+		void Link(SlotId slotId, uint32_t level, CellKey cell);
+		void Unlink(SlotId slotId);
+		void CollectCandidates(uint32_t level, const Vector3 &min, const Vector3 &max, std::vector<SlotId> &outSlots) const;
+
+		std::vector<Slot> m_slots;
+		std::vector<SlotId> m_freeSlots;
+		std::vector<SlotId> m_dirtySlots;
+		std::array<Level, LEVEL_COUNT> m_levels;
+		// Entities too large for any level (or with invalid bounds); these are always returned as candidates
+		std::vector<SlotId> m_oversized;
+		std::vector<SlotId> m_queryResult;
+		size_t m_count = 0;
+	};
+};
+
+#endif
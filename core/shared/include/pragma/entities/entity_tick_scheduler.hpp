@@ -0,0 +1,76 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __ENTITY_TICK_SCHEDULER_HPP__
+#define __ENTITY_TICK_SCHEDULER_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace pragma {
+	class BaseEntityComponent;
+	// Keeps track of all entity components with an active tick policy.
+	// Components that are due every tick are kept in a dense array with O(1) removal. Components whose next tick
+	// lies in the future are moved into a min-heap and don't cost anything until they are due again.
+	class DLLNETWORK EntityTickScheduler {
+	  public:
+		using SlotId = uint32_t;
+		static constexpr SlotId INVALID_SLOT = std::numeric_limits<SlotId>::max();
+
+		EntityTickScheduler() = default;
+		EntityTickScheduler(const EntityTickScheduler &) = delete;
+		EntityTickScheduler &operator=(const EntityTickScheduler &) = delete;
+
+		void Add(BaseEntityComponent &component);
+		void Remove(BaseEntityComponent &component);
+		// Has to be called whenever the next tick time of a scheduled component has changed
+		void OnNextTickChanged(BaseEntityComponent &component);
+		// Ticks all components that are due. Components that are added during this call will be ticked as well,
+		// components that are removed during this call will not be ticked anymore.
+		void Tick(double curTime, double tDelta);
+		void Clear();
+
+		size_t GetActiveCount() const;
+		size_t GetDeferredCount() const;
+	  private:
+		static constexpr uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
+		struct Slot {
+			BaseEntityComponent *component = nullptr;
+			uint32_t generation = 0;
+			uint32_t activeIndex = INVALID_INDEX;
+			bool deferred = false;
+		};
+		struct DeferredEntry {
+			double time;
+			SlotId slot;
+			uint32_t generation;
+			bool operator>(const DeferredEntry &other) const { return time > other.time; }
+		};
+		void AddActive(SlotId slotId);
+		void RemoveActive(SlotId slotId);
+		void Defer(SlotId slotId, double time);
+		void PushDeferred(const DeferredEntry &entry);
+		void CompactActive();
+		// Removes outdated entries from the heap once they outnumber the valid ones
+		void CompactDeferred();
+
+		std::vector<Slot> m_slots;
+		std::vector<SlotId> m_freeSlots;
+		// Slots of components that are checked every tick. Removed entries are set to INVALID_SLOT while ticking.
+		std::vector<SlotId> m_active;
+		std::vector<uint32_t> m_activeHoles;
+		// Min-heap of deferred components. Entries are outdated if the generation of their slot has changed since.
+		std::vector<DeferredEntry> m_deferred;
+		size_t m_deferredCount = 0; // Number of valid entries in m_deferred
+		bool m_ticking = false;
+	};
+};
+
+#endif
@@ -21,6 +21,7 @@ namespace pragma {
 		using BaseEntityComponent::BaseEntityComponent;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		Float GetFrequency() const;
 		Float GetAmplitude() const;
 		Float GetRadius() const;
@@ -30,6 +30,7 @@ namespace pragma {
 	  protected:
 		virtual void Load(udm::LinkedPropertyWrapperArg udm, uint32_t version) override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		util::PColorProperty m_ambientColor = nullptr;
 		Float m_maxExposure = 8.f;
 		pragma::NetEventId m_netEvSetAmbientColor = pragma::INVALID_NET_EVENT;
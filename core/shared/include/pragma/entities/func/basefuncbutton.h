@@ -15,6 +15,7 @@ namespace pragma {
 		using BaseEntityComponent::BaseEntityComponent;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		virtual void OnEntitySpawn() override;
 	  protected:
 		std::string m_kvUseSound;
@@ -25,6 +25,7 @@ namespace pragma {
 		virtual void Initialize() override;
 		virtual void OnEntitySpawn() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 		std::vector<util::TSharedHandle<physics::IConstraint>> &GetConstraints();
 		virtual void OnRemove();
 	  protected:
@@ -17,6 +17,7 @@ namespace pragma {
 		using BaseEntityComponent::BaseEntityComponent;
 		virtual void Initialize() override;
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 	  protected:
 		std::string m_target;
 		enum class SpawnFlags : uint32_t { FaceTargetDirectionOnTeleport = 512 };
@@ -70,6 +70,7 @@ namespace pragma {
 		virtual void OnStartTouch(BaseEntity &ent);
 		virtual void OnEndTouch(BaseEntity &ent);
 		virtual util::EventReply HandleEvent(ComponentEventId eventId, ComponentEvent &evData) override;
+		static void GetHandledEvents(std::vector<ComponentEventId> &outEvents);
 
 		void SetTriggerFlags(TriggerFlags flags);
 		TriggerFlags GetTriggerFlags() const;
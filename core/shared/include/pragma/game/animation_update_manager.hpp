@@ -8,17 +8,42 @@
 #define __ANIMATION_UPDATE_MANAGER_HPP__
 
 #include "pragma/networkdefinitions.h"
-#include "pragma/util/util_thread_pool.hpp"
+#include "pragma/util/job_system.hpp"
+#include <mathutil/transform.hpp>
 
 class Game;
+namespace util {
+	class BSPTree;
+};
 namespace pragma {
 	class PanimaComponent;
 	class BaseAnimatedComponent;
 	struct DLLNETWORK AnimationUpdateManager {
+		// Animation level of detail, determined by the distance to the nearest observer (player view) and the potentially visible set.
+		// Throttled entities accumulate the elapsed time, so their animation cycles and animation events stay in sync with full updates.
+		enum class LodTier : uint8_t {
+			Full = 0, // Updated every tick
+			Reduced,  // Updated at a lower rate, the local bone poses are interpolated towards the last evaluated pose in between
+			Cached,   // Updated at a lower rate, the last evaluated pose is re-used in between
+			Count
+		};
 		struct DLLNETWORK AnimatedEntity {
 			BaseEntity *entity = nullptr;
 			BaseAnimatedComponent *animatedC = nullptr;
 			PanimaComponent *panimaC = nullptr;
+
+			// Only used by the multi-threaded update path
+			std::optional<double> animatedDt {};
+			std::optional<double> panimaDt {};
+
+			LodTier lodTier = LodTier::Full;
+			bool lodUpdate = true;          // False if the animation update is skipped this tick
+			uint32_t lodTicksSinceUpdate = 0;
+			uint32_t lodUpdateSpan = 0;     // Number of ticks between the last two evaluated updates
+			double lodAccumulatedDt = 0.0;  // Time that has elapsed since the last update, excluding the current tick
+			// Local bone poses of the previous and the last evaluated update, only used by LodTier::Reduced
+			std::vector<umath::ScaledTransform> lodSrcPoses;
+			std::vector<umath::ScaledTransform> lodDstPoses;
 		};
 
 		AnimationUpdateManager(Game &game);
@@ -27,7 +52,15 @@ namespace pragma {
 		const std::vector<AnimatedEntity> &GetAnimatedEntities() const;
 
 		void UpdateAnimations(double dt);
+
+		void SetBSPTree(const std::shared_ptr<util::BSPTree> &bspTree);
+		static uint32_t GetLodUpdateInterval(LodTier tier);
 	  private:
+		void UpdateLodTiers(double dt);
+		LodTier DetermineLodTier(const AnimatedEntity &entInfo) const;
+		void ApplyLodInterpolation(AnimatedEntity &entInfo) const;
+		void UpdateAnimationsST(double dt);
+		void UpdateAnimationsMT(double dt);
 		void UpdateEntityAnimationDrivers(double dt);
 		void UpdateConstraints(double dt);
 
@@ -36,9 +69,17 @@ namespace pragma {
 		pragma::ComponentId m_panimaComponentId = std::numeric_limits<pragma::ComponentId>::max();
 		pragma::ComponentId m_animationDriverComponentId = std::numeric_limits<pragma::ComponentId>::max();
 		pragma::ComponentId m_constraintManagerComponentId = std::numeric_limits<pragma::ComponentId>::max();
-		pragma::ThreadPool m_threadPool;
+		JobSystem::SubsystemId m_jobSubsystem = JobSystem::DEFAULT_SUBSYSTEM;
 		std::vector<AnimatedEntity> m_animatedEntities;
 		std::vector<BaseAnimatedComponent *> m_postAnimListenerQueue;
+
+		struct LodObserver {
+			Vector3 position;
+			std::vector<uint8_t> visibleClusters; // Decompressed visibility row of the observer's cluster, empty if unknown
+		};
+		std::shared_ptr<util::BSPTree> m_bspTree = nullptr;
+		std::vector<LodObserver> m_lodObservers;
+		uint64_t m_lodTick = 0;
 	};
 };
 
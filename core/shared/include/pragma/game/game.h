@@ -21,6 +21,7 @@
 #include "pragma/lua/lua_script_watcher.h"
 #include <sharedutils/chronotime.h>
 #include "pragma/util/timertypes.h"
+#include "pragma/util/timing_wheel.hpp"
 #include <fsys/vfileptr.h>
 #include "pragma/lua/sh_lua_entity_manager.h"
 #include "pragma/util/ammo_type.h"
@@ -76,6 +77,9 @@ namespace pragma {
 	using ComponentId = uint32_t;
 	class BaseWorldComponent;
 	class BaseEntityComponent;
+	class EntityTickScheduler;
+	class EntitySpatialIndex;
+	class EntityLookupIndex;
 	class BasePhysicsComponent;
 	class EntityComponentManager;
 	class BasePlayerComponent;
@@ -342,6 +346,7 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	Timer *CreateTimer(float delay, int reps, LuaFunctionObject luaFunction, TimerType timeType = TimerType::CurTime);
 	Timer *CreateTimer(float delay, int reps, const CallbackHandle &hCallback, TimerType timeType = TimerType::CurTime);
 	void ClearTimers();
+	pragma::TimingWheel &GetTimerWheel(TimerType timeType);
 	// ConVars
 	template<class T>
 	T *GetConVar(const std::string &scmd);
@@ -363,7 +368,10 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	virtual bool IsPhysicsSimulationEnabled() const = 0;
 
 	std::vector<pragma::ComponentHandle<pragma::BasePhysicsComponent>> &GetAwakePhysicsComponents();
-	std::vector<pragma::BaseEntityComponent *> &GetEntityTickComponents() { return m_entityTickComponents; }
+	pragma::EntityTickScheduler &GetEntityTickScheduler() { return *m_entityTickScheduler; }
+	pragma::EntitySpatialIndex &GetEntitySpatialIndex() { return *m_entitySpatialIndex; }
+	pragma::EntityLookupIndex &GetEntityNameIndex() { return *m_entityNameIndex; }
+	pragma::EntityLookupIndex &GetEntityClassIndex() { return *m_entityClassIndex; }
 	std::vector<pragma::BaseGamemodeComponent *> &GetGamemodeComponents() { return m_gamemodeComponents; }
 
 	// Debug
@@ -384,14 +392,24 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	std::unordered_map<size_t, BaseEntity *> m_uuidToEnt;
 	std::queue<EntityHandle> m_entsScheduledForRemoval;
 	std::vector<pragma::ComponentHandle<pragma::BasePhysicsComponent>> m_awakePhysicsEntities;
-	std::vector<pragma::BaseEntityComponent *> m_entityTickComponents;
+	std::unique_ptr<pragma::EntityTickScheduler> m_entityTickScheduler;
+	std::unique_ptr<pragma::EntitySpatialIndex> m_entitySpatialIndex;
+	std::unique_ptr<pragma::EntityLookupIndex> m_entityNameIndex;
+	std::unique_ptr<pragma::EntityLookupIndex> m_entityClassIndex;
 	std::vector<pragma::BaseGamemodeComponent *> m_gamemodeComponents;
 	std::shared_ptr<Lua::Interface> m_lua = nullptr;
 	std::unique_ptr<pragma::lua::ClassManager> m_luaClassManager;
 	std::unique_ptr<LuaDirectoryWatcherManager> m_scriptWatcher = nullptr;
 	std::unique_ptr<SurfaceMaterialManager> m_surfaceMaterialManager = nullptr;
 	std::unordered_map<std::string, std::vector<CvarCallback>> m_cvarCallbacks;
+	// Timers are scheduled in a timing wheel per timer type, so only the timers which are due have to be processed each tick.
+	// Timer clocks are accumulated from the delta time of the respective timer type.
+	std::array<std::unique_ptr<pragma::TimingWheel>, 3> m_timerWheels;
+	std::array<double, 3> m_timerClocks {};
+	std::vector<pragma::TimingWheel::Node *> m_expiredTimers;
 	std::vector<std::unique_ptr<Timer>> m_timers;
+	std::vector<Timer *> m_removedTimers; // Timers are destroyed with the next timer update
+	uint32_t m_timerClearCount = 0; // Incremented by ClearTimers, so a timer update in progress can tell that its expired timers are gone
 	std::unordered_map<std::string, int> m_luaNetMessages;
 	std::vector<std::string> m_luaNetMessageIndex;
 	MapInfo m_mapInfo = {};
@@ -441,6 +459,9 @@ class DLLNETWORK Game : public CallbackHandler, public LuaCallbackHandler {
 	void LoadConfig();
 	void SaveConfig();
 	void UpdateTimers();
+	friend Timer;
+	void OnTimerRemoved(Timer &timer);
+	void DestroyRemovedTimers();
 	virtual void InitializeLuaScriptWatcher();
 
 	// Map
@@ -7,6 +7,7 @@
 #ifndef __GAME_RESOURCES_H__
 #define __GAME_RESOURCES_H__
 
-#define RESOURCE_TRANSFER_FRAGMENT_SIZE 2'048
+// Maximum number of uncompressed bytes per resource fragment
+#define RESOURCE_TRANSFER_FRAGMENT_SIZE 16'384
 
 #endif
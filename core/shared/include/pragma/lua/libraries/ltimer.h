@@ -20,11 +20,16 @@ namespace Lua {
 };
 
 #include "pragma/util/timertypes.h"
+#include "pragma/util/timing_wheel.hpp"
 
 class Game;
 class TimerHandle;
 class DLLNETWORK Timer {
+  public:
+	// Resolution of the timer wheels
+	static constexpr double TICKS_PER_SECOND = 1'000.0;
   private:
+	friend Game;
 	TimerType m_timeType;
 	float m_delay;
 	unsigned int m_reps;
@@ -35,9 +40,13 @@ class DLLNETWORK Timer {
 	bool m_bRunning;
 	bool m_bIsValid;
 	std::vector<std::shared_ptr<TimerHandle>> m_handles;
+	pragma::TimingWheel::Node m_wheelNode;
+	size_t m_timerIndex = 0; // Index into the game's timer list
 
 	double GetCurTime(Game *game);
-	double GetDeltaTime(Game *game);
+	void Schedule(pragma::TimingWheel &wheel);
+	// Time until the next call, or the time since the call was due if the timer has just expired
+	float GetCycleTimeLeft() const;
   protected:
 	float m_next;
 	virtual void Reset();
@@ -46,6 +55,7 @@ class DLLNETWORK Timer {
 	Timer(float delay, unsigned int reps, LuaFunctionObject luaFunction, TimerType timetype = TimerType::CurTime);
 	Timer(float delay, unsigned int reps, const CallbackHandle &hCallback, TimerType timetype = TimerType::CurTime);
 	~Timer();
+	// Called by the game once the timer is due
 	void Update(Game *game);
 	void Start(Game *game);
 	void Pause();
@@ -0,0 +1,69 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __PRAGMA_SOA_POSE_HPP__
+#define __PRAGMA_SOA_POSE_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include "panima/types.hpp"
+#include <mathutil/transform.hpp>
+#include <vector>
+#include <array>
+#include <optional>
+
+namespace pragma::animation {
+	class Skeleton;
+	// Bone pose stored as structure-of-arrays (one float stream per component), with the bones sorted
+	// by hierarchy depth. All bones of one depth level are contiguous and only depend on the previous level,
+	// so the blend, composition and skinning loops have no dependencies between iterations and can be vectorized
+	// by the compiler.
+	class DLLNETWORK SoaPose {
+	  public:
+		struct DLLNETWORK Streams {
+			void Resize(size_t n);
+			std::vector<float> px, py, pz;
+			std::vector<float> rx, ry, rz, rw;
+			std::vector<float> sx, sy, sz;
+		};
+		SoaPose() = default;
+		void Initialize(const Skeleton &skeleton);
+		bool IsInitialized(const Skeleton &skeleton) const;
+		size_t GetBoneCount() const { return m_order.size(); }
+
+		// Local poses are indexed by bone id
+		void SetLocalPoses(const std::vector<umath::ScaledTransform> &poses);
+		// Blends the local poses towards the local poses of 'other' (which must have been initialized with the same skeleton)
+		void Blend(const SoaPose &other, float factor);
+		// Computes the global (entity space) poses from the local poses
+		void ComputeGlobalPoses();
+		// Writes the global poses to 'outPoses', indexed by bone id
+		void GetGlobalPoses(std::vector<umath::ScaledTransform> &outPoses) const;
+
+		// Bind poses are indexed by bone id and are inverted internally
+		void SetBindPoses(const std::vector<umath::Transform> &bindPoses);
+		void ClearBindPoses();
+		bool HasBindPoses() const { return !m_invBindRot[0].empty(); }
+		// Computes 'globalPose * inverse(bindPose)' for every bone, indexed by bone id.
+		// The matrix for 'identityBoneId' (if specified) is set to identity.
+		void ComputeSkinningMatrices(std::vector<Mat4> &outMatrices, std::optional<BoneId> identityBoneId = {}) const;
+
+		const Streams &GetLocalStreams() const { return m_local; }
+		const Streams &GetGlobalStreams() const { return m_global; }
+	  private:
+		const Skeleton *m_skeleton = nullptr;
+		std::vector<BoneId> m_order;      // Pose index -> bone id
+		std::vector<uint32_t> m_parents;  // Pose index -> pose index of parent (only valid for non-root bones)
+		std::vector<uint32_t> m_levels;   // Start pose index of every depth level, plus the end index
+		Streams m_local;
+		Streams m_global;
+		// Inverse bind poses as row-major 3x3 rotation matrix and translation
+		std::array<std::vector<float>, 9> m_invBindRot;
+		std::array<std::vector<float>, 3> m_invBindPos;
+	};
+};
+
+#endif
@@ -0,0 +1,55 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __PRAGMA_RESOURCE_TRANSFER_HPP__
+#define __PRAGMA_RESOURCE_TRANSFER_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <mathutil/umath.h>
+#include <sharedutils/netpacket.hpp>
+#include <string>
+#include <vector>
+#include <optional>
+#include <memory>
+#include <atomic>
+
+class VFilePtrInternal;
+namespace pragma::networking {
+	enum class ResourceFragmentFlags : uint8_t {
+		None = 0u,
+		Lz4Compressed = 1u,
+	};
+
+	// A chunk of a resource file. Fragments of the same file are always sent in order (over a reliable channel),
+	// but fragments of different files may be interleaved.
+	struct DLLNETWORK ResourceFragment {
+		uint32_t transferId = 0;
+		uint64_t offset = 0;
+		std::vector<uint8_t> data; // Uncompressed data
+	};
+
+	// Compresses the data with LZ4 if 'compress' is true and the compressed data is actually smaller than the input
+	DLLNETWORK void write_resource_fragment(NetPacket &packet, uint32_t transferId, uint64_t offset, const uint8_t *data, uint32_t size, bool compress);
+	DLLNETWORK bool read_resource_fragment(NetPacket &packet, ResourceFragment &outFragment);
+
+	// Content hash (MD5 hex digest) of the file, starting at the current beginning of the file.
+	// Restores the file position afterwards.
+	DLLNETWORK std::string compute_resource_hash(VFilePtrInternal &f);
+
+	// Result of a hash computation on the job system. The hash is only valid once 'complete' is true,
+	// and has no value if the file couldn't be opened.
+	struct DLLNETWORK ResourceHashJob {
+		std::optional<std::string> hash;
+		std::atomic<bool> complete = false;
+	};
+	// Hashing large files can take a while, so it's done on the background subsystem of the job system,
+	// which threads that are waiting for other work never help with. The file is opened with its own handle.
+	DLLNETWORK std::shared_ptr<ResourceHashJob> schedule_resource_hash(const std::string &fileName);
+};
+REGISTER_BASIC_BITWISE_OPERATORS(pragma::networking::ResourceFragmentFlags)
+
+#endif
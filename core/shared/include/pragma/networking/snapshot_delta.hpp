@@ -0,0 +1,98 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __PRAGMA_SNAPSHOT_DELTA_HPP__
+#define __PRAGMA_SNAPSHOT_DELTA_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <mathutil/umath.h>
+#include <mathutil/uvec.h>
+#include <sharedutils/netpacket.hpp>
+#include <unordered_map>
+#include <array>
+
+namespace pragma::networking {
+	enum class SnapshotEntityFields : uint8_t {
+		None = 0u,
+		Position = 1u,
+		Velocity = Position << 1u,
+		AngularVelocity = Velocity << 1u,
+		Rotation = AngularVelocity << 1u,
+		// Position is outside of the quantization bounds and has been transmitted as raw floats
+		UnboundedPosition = Rotation << 1u,
+
+		All = Position | Velocity | AngularVelocity | Rotation
+	};
+
+	// Network representation of the transform of an entity. The server and client both keep these as
+	// baselines, so they have to be compared in their quantized form to avoid drift.
+	struct DLLNETWORK QuantizedEntityState {
+		std::array<uint32_t, 3> position {};
+		std::array<uint16_t, 3> velocity {};
+		std::array<uint16_t, 3> angularVelocity {};
+		uint32_t rotation = 0;
+		bool unboundedPosition = false;
+		bool operator==(const QuantizedEntityState &other) const = default;
+	};
+
+	class DLLNETWORK SnapshotQuantizer {
+	  public:
+		// Number of bits per position axis
+		static constexpr uint32_t POSITION_BITS = 24;
+		static constexpr uint32_t POSITION_MAX = (1u << POSITION_BITS) - 1u;
+
+		SnapshotQuantizer();
+		void SetBounds(const Vector3 &min, const Vector3 &max);
+		const std::pair<Vector3, Vector3> &GetBounds() const;
+
+		QuantizedEntityState Quantize(const Vector3 &pos, const Vector3 &vel, const Vector3 &angVel, const Quat &rot) const;
+		Vector3 DequantizePosition(const QuantizedEntityState &state) const;
+
+		// Smallest-three encoding: 2 bits for the index of the largest component, 10 bits for each of the remaining three
+		static uint32_t QuantizeRotation(const Quat &rot);
+		static Quat DequantizeRotation(uint32_t rot);
+		// Velocities are transmitted as half-precision floats
+		static std::array<uint16_t, 3> QuantizeVelocity(const Vector3 &vel);
+		static Vector3 DequantizeVelocity(const std::array<uint16_t, 3> &vel);
+	  private:
+		std::pair<Vector3, Vector3> m_bounds;
+	};
+
+	// Writes a field mask followed by all fields of 'state' that differ from 'baseline'.
+	// If no baseline is specified, all fields are written.
+	DLLNETWORK void write_entity_state_delta(NetPacket &packet, const QuantizedEntityState &state, const QuantizedEntityState *baseline);
+	// 'inOutState' has to be initialized with the baseline state. Returns the fields that were read from the packet.
+	DLLNETWORK SnapshotEntityFields read_entity_state_delta(NetPacket &packet, QuantizedEntityState &inOutState);
+
+	// Ring buffer of the entity states of the last snapshots sent to (server) or received from (client) a peer.
+	// Snapshot ids wrap around, so the snapshot timestamp is used to disambiguate acknowledgements.
+	class DLLNETWORK SnapshotBaselineBuffer {
+	  public:
+		static constexpr uint32_t SIZE = 32;
+		using EntityStates = std::unordered_map<uint32_t, QuantizedEntityState>;
+		struct DLLNETWORK Baseline {
+			uint8_t snapshotId = 0;
+			double timestamp = 0.0;
+			bool valid = false;
+			bool acknowledged = false;
+			EntityStates entityStates;
+
+			const QuantizedEntityState *FindEntityState(uint32_t entIdx) const;
+		};
+
+		Baseline &Add(uint8_t snapshotId, double timestamp, EntityStates &&entityStates);
+		const Baseline *Find(uint8_t snapshotId) const;
+		bool Acknowledge(uint8_t snapshotId, double timestamp);
+		const Baseline *GetLatestAcknowledged() const;
+		void Clear();
+	  private:
+		std::array<Baseline, SIZE> m_baselines {};
+	};
+};
+REGISTER_BASIC_BITWISE_OPERATORS(pragma::networking::SnapshotEntityFields)
+
+#endif
@@ -9,6 +9,7 @@
 #define __PHYS_WATER_SURFACE_SIMULATOR_HPP__
 
 #include "pragma/networkdefinitions.h"
+#include "pragma/util/job_system.hpp"
 #include <vector>
 #include <cinttypes>
 #include <mutex>
@@ -16,6 +17,7 @@
 
 class DLLNETWORK PhysWaterSurfaceSimulator : public std::enable_shared_from_this<PhysWaterSurfaceSimulator> {
   public:
+	// Memory layout of a particle as expected by the compute shaders. The CPU simulation stores the particle data as separate arrays instead.
 #pragma pack(push, 1)
 	class DLLNETWORK Particle {
 	  private:
@@ -36,13 +38,6 @@ class DLLNETWORK PhysWaterSurfaceSimulator : public std::enable_shared_from_this
 		void SetNeighbor(std::size_t idx, uint32_t ptIdx);
 	};
 #pragma pack(pop)
-#pragma pack(push, 1)
-	struct DLLNETWORK Edge {
-		Edge(uint32_t idx0, uint32_t idx1);
-		uint32_t index0 = 0;
-		uint32_t index1 = 0;
-	};
-#pragma pack(pop)
 #pragma pack(push, 1)
 	struct DLLNETWORK SplashInfo {
 		SplashInfo(const Vector3 &origin, float radius, float force, uint32_t width, uint32_t length);
@@ -59,8 +54,8 @@ class DLLNETWORK PhysWaterSurfaceSimulator : public std::enable_shared_from_this
 	virtual ~PhysWaterSurfaceSimulator();
 	uint32_t GetWidth() const;
 	uint32_t GetLength() const;
-	const std::vector<Particle> &GetParticleField() const;
-	const std::vector<Edge> &GetParticleEdges() const;
+	// Creates the particle data for the compute shaders from the current state of the simulation
+	std::vector<Particle> CreateParticleField() const;
 	std::size_t GetParticleCount() const;
 	float GetStiffness() const;
 	void SetStiffness(float stiffness);
@@ -72,7 +67,10 @@ class DLLNETWORK PhysWaterSurfaceSimulator : public std::enable_shared_from_this
 	const Vector3 &GetOrigin() const;
 	std::size_t GetParticleIndex(uint32_t x, uint32_t y) const;
 	std::pair<uint32_t, uint32_t> GetParticleCoordinates(std::size_t idx) const;
+	// If the simulation runs on the job system, this only schedules the next simulation step, unless the previous one is still in progress
 	virtual void Simulate(double dt);
+	// Blocks until the scheduled simulation step has completed
+	void WaitForSimulation();
 
 	void Initialize();
 	void CreateSplash(const Vector3 &origin, float radius, float force);
@@ -98,32 +96,39 @@ class DLLNETWORK PhysWaterSurfaceSimulator : public std::enable_shared_from_this
 	virtual void InitializeSurface();
 	SurfaceInfo m_surfaceInfo = {};
 	std::queue<SplashInfo> m_splashQueue;
-	std::vector<Edge> m_particleEdges;
+	// Heights of the last completed step. Unlike the solver heights, these are not clamped to the max wave height.
 	std::vector<float> m_particleHeights;
 	std::array<Vector2, 2> m_bounds {};
 	float m_originY = 0.f;
+	// Simulation steps are executed on the job system instead of the calling thread
 	bool m_bUseThread = true;
+	// Time of the steps which were skipped because the previous step was still in progress
+	double m_pendingSimTime = 0.0;
 
-	std::vector<Particle> &GetParticleField();
-	std::vector<Edge> &GetParticleEdges();
 	virtual uint8_t GetEdgeIterationCount() const;
 	Vector3 CalcParticlePosition(const SurfaceInfo &surfInfo, const std::vector<float> &heights, std::size_t ptIdx) const;
 
 	// Threaded data (Not thread-safe!)
-	std::vector<float> m_threadParticleHeights;
-	std::vector<Particle> m_particleField;
-	std::thread m_simThread;
-	std::atomic<bool> m_bRunThread = {true};
+	// Particle state as separate arrays, so the solver loops can be vectorized. The solver heights are clamped to the max wave height.
+	std::vector<float> m_heights;
+	std::vector<float> m_oldHeights;
+	std::vector<float> m_targetHeights;
+	std::vector<float> m_velocities;
+	pragma::JobSystem::JobHandle m_simJob {};
+	pragma::JobSystem::SubsystemId m_jobSubsystem = pragma::JobSystem::DEFAULT_SUBSYSTEM;
 	std::mutex m_splashMutex;
 	std::mutex m_settingsMutex;
 	std::mutex m_heightMutex;
 	void SimulateWaves(double dt);
-	void JoinThread();
-	void SolveDepths(const SurfaceInfo &surfInfo);
-	void SolveEdges(const SurfaceInfo &surfInfo);
-	void Integrate(const SurfaceInfo &surfInfo, double dt);
-	void VelocityFixup(const SurfaceInfo &surfInfo, double invDt);
-	void SetParticleHeight(const SurfaceInfo &surfInfo, std::size_t ptIdx, float height);
+	void ApplySplashes(const SurfaceInfo &surfInfo);
+	// The ranges are specified in rows of the particle grid
+	void SolveDepths(const SurfaceInfo &surfInfo, uint32_t rowStart, uint32_t rowEnd);
+	// Relaxes the edges to all neighbors of the particles of one color of a checkerboard pattern. Particles of the same color don't
+	// share any edges, so the rows can be processed in parallel.
+	void SolveEdges(const SurfaceInfo &surfInfo, uint32_t color, uint32_t rowStart, uint32_t rowEnd);
+	void Integrate(const SurfaceInfo &surfInfo, double dt, uint32_t rowStart, uint32_t rowEnd);
+	void VelocityFixup(const SurfaceInfo &surfInfo, double invDt, uint32_t rowStart, uint32_t rowEnd);
+	uint32_t GetRowGrainSize() const;
 	std::size_t GetParticleIndex(const SurfaceInfo &surfInfo, uint32_t x, uint32_t y) const;
 	std::pair<uint32_t, uint32_t> GetParticleCoordinates(const SurfaceInfo &surfInfo, std::size_t idx) const;
 };
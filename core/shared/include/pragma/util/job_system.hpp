@@ -0,0 +1,164 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __JOB_SYSTEM_HPP__
+#define __JOB_SYSTEM_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <array>
+#include <limits>
+#include <cstdint>
+
+namespace pragma {
+	// Engine-wide work-stealing scheduler.
+	// Every worker thread owns a deque per priority. Jobs submitted from a worker are pushed onto its own deque and
+	// executed in LIFO order, idle workers steal the oldest jobs of other workers. Jobs submitted from other threads, and jobs
+	// which are restricted to a subset of the workers, are placed in a shared queue instead.
+	// Threads which are waiting for work to complete execute other jobs in the meantime, but only jobs of the subsystem they are
+	// waiting on, or jobs of subsystems which allow helping and have at least the same priority.
+	// Jobs are allocated from a pool and recycled once they have completed, so the memory used only depends on the number of jobs
+	// that are in flight at the same time.
+	class DLLNETWORK JobSystem {
+	  public:
+		enum class Priority : uint8_t { High = 0u, Normal, Low, Count };
+		using Task = std::function<void()>;
+		using WorkerMask = uint64_t;
+		using SubsystemId = uint32_t;
+		static constexpr WorkerMask ALL_WORKERS = std::numeric_limits<WorkerMask>::max();
+		static constexpr uint32_t MAX_WORKERS = 64;
+		static constexpr uint32_t MAX_SUBSYSTEMS = 32;
+		static constexpr SubsystemId DEFAULT_SUBSYSTEM = 0;
+		// For long-running or blocking work (e.g. file hashing), which waiting threads never help with
+		static constexpr SubsystemId BACKGROUND_SUBSYSTEM = 1;
+		static constexpr uint32_t INVALID_JOB = std::numeric_limits<uint32_t>::max();
+
+		struct DLLNETWORK Subsystem {
+			std::string name;
+			Priority priority = Priority::Normal;
+			// Workers which may execute jobs of this subsystem. Threads that are waiting for a job only help with jobs which are not restricted.
+			WorkerMask workerMask = ALL_WORKERS;
+			// If false, jobs of this subsystem are only executed by idle workers, or by threads which are waiting on this subsystem.
+			// Should be disabled for long-running or blocking work, which would otherwise stall the thread that is waiting.
+			bool allowHelping = true;
+		};
+		struct DLLNETWORK JobHandle {
+			uint32_t index = INVALID_JOB;
+			uint32_t generation = 0;
+			bool IsValid() const { return index != INVALID_JOB; }
+		};
+		struct DLLNETWORK Statistics {
+			uint64_t submittedCount = 0;
+			uint64_t executedCount = 0;
+			uint64_t stolenCount = 0;
+			// Jobs executed by threads which were waiting for another job
+			uint64_t helpedCount = 0;
+			uint32_t allocatedJobCount = 0;
+		};
+
+		// A worker count of 0 uses one worker per hardware thread, minus one for the main thread
+		JobSystem(uint32_t workerCount = 0);
+		JobSystem(const JobSystem &) = delete;
+		JobSystem &operator=(const JobSystem &) = delete;
+		~JobSystem();
+
+		// Returns the id of the existing subsystem if one with the same name has already been registered
+		SubsystemId RegisterSubsystem(const Subsystem &subsystem);
+		const Subsystem &GetSubsystem(SubsystemId id) const;
+
+		// The job is not scheduled before Submit has been called, so dependencies can be added first
+		JobHandle CreateJob(Task task, SubsystemId subsystem = DEFAULT_SUBSYSTEM);
+		// 'job' will not be started before 'dependency' has completed. 'job' must not have been submitted yet.
+		void AddDependency(JobHandle job, JobHandle dependency);
+		void Submit(JobHandle job);
+		JobHandle Schedule(Task task, SubsystemId subsystem = DEFAULT_SUBSYSTEM);
+		// Returns true if the job has completed, or if the handle refers to a job that no longer exists
+		bool IsComplete(JobHandle job) const;
+		// Blocks until the job has completed. The calling thread executes other jobs in the meantime.
+		void Wait(JobHandle job);
+		// Blocks until condition returns true, executing other jobs in the meantime. The condition is re-evaluated whenever
+		// a job has completed, or NotifyWaiters has been called. 'subsystem' is the subsystem of the work that is being waited on,
+		// which determines which jobs the calling thread may help with.
+		void WaitUntil(const std::function<bool()> &condition, SubsystemId subsystem = DEFAULT_SUBSYSTEM);
+		// Has to be called if the condition of a WaitUntil call may have changed outside of a job
+		void NotifyWaiters();
+		// Calls f(start, end) for consecutive ranges of at most grainSize items. The calling thread takes part in the work and
+		// only returns once all ranges have been processed.
+		void ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)> &f, SubsystemId subsystem = DEFAULT_SUBSYSTEM);
+
+		uint32_t GetWorkerCount() const;
+		// Returns the index of the worker the calling thread belongs to, or INVALID_JOB if it isn't a worker of this job system
+		uint32_t GetCurrentWorkerIndex() const;
+		Statistics GetStatistics() const;
+		void ResetStatistics();
+	  private:
+		struct Job;
+		struct Worker;
+		// Restricts the jobs a waiting thread may execute
+		struct HelpFilter {
+			SubsystemId subsystem = DEFAULT_SUBSYSTEM;
+			Priority priority = Priority::Normal;
+			bool Accepts(const Job &job) const;
+		};
+		static constexpr uint32_t JOB_BLOCK_SIZE = 256;
+		static constexpr auto PRIORITY_COUNT = static_cast<size_t>(Priority::Count);
+
+		Job &GetJob(uint32_t index) const;
+		Job *AllocateJob();
+		void ReleaseJob(Job &job);
+		void Enqueue(Job &job);
+		// Pops the next job the specified worker may execute. Threads which are not workers pass INVALID_JOB.
+		// Waiting threads pass a filter, idle workers execute any job.
+		Job *PopJob(uint32_t workerIndex, const HelpFilter *filter = nullptr);
+		void Execute(Job &job);
+		bool RunPendingJob(uint32_t workerIndex, const HelpFilter *filter = nullptr);
+		void NotifyStateChanged(bool newWork);
+		void RunWorker(uint32_t workerIndex);
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::atomic<bool> m_stopping = false;
+
+		std::array<Subsystem, MAX_SUBSYSTEMS> m_subsystems;
+		std::atomic<uint32_t> m_subsystemCount = 0;
+		std::mutex m_subsystemMutex;
+
+		mutable std::mutex m_jobPoolMutex;
+		std::vector<std::unique_ptr<Job[]>> m_jobBlocks;
+		std::vector<Job *> m_freeJobs;
+		// Read without locking m_jobPoolMutex; blocks are never freed before the job system is destroyed
+		std::array<std::atomic<Job *>, 4096> m_jobBlockTable;
+
+		std::mutex m_globalQueueMutex;
+		std::array<std::deque<Job *>, PRIORITY_COUNT> m_globalQueues;
+		std::atomic<uint32_t> m_queuedJobCount = 0;
+
+		// Incremented whenever a job has been queued or completed. Sleeping threads only wake up once it has changed.
+		std::atomic<uint64_t> m_stateGeneration = 0;
+		std::atomic<uint32_t> m_sleepingWorkerCount = 0;
+		std::atomic<uint32_t> m_waitingThreadCount = 0;
+		std::mutex m_sleepMutex;
+		std::condition_variable m_workCondition;
+		std::condition_variable m_completionCondition;
+
+		struct {
+			std::atomic<uint64_t> submittedCount = 0;
+			std::atomic<uint64_t> executedCount = 0;
+			std::atomic<uint64_t> stolenCount = 0;
+			std::atomic<uint64_t> helpedCount = 0;
+		} m_statistics;
+	};
+};
+
+#endif
@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __PRAGMA_RADIX_SORT_HPP__
+#define __PRAGMA_RADIX_SORT_HPP__
+
+#include <algorithm>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace pragma {
+	// Stable LSD radix sort over 64-bit keys with one pass per byte. The histograms for all passes are gathered in a single
+	// pass over the items, and passes in which all keys share the same byte are skipped entirely.
+	// getKey(item) has to return the key as uint64_t. 'tmp' is used as scratch buffer and may be re-used between calls to avoid allocations.
+	template<typename T, typename TGetKey>
+	void radix_sort(std::vector<T> &items, std::vector<T> &tmp, const TGetKey &getKey)
+	{
+		constexpr size_t NUM_PASSES = sizeof(uint64_t);
+		constexpr size_t NUM_BUCKETS = 256;
+		// Below this the histograms cost more than a comparison sort
+		constexpr size_t MIN_ITEM_COUNT = 64;
+		auto n = items.size();
+		if(n < MIN_ITEM_COUNT) {
+			std::stable_sort(items.begin(), items.end(), [&getKey](const T &a, const T &b) { return getKey(a) < getKey(b); });
+			return;
+		}
+		std::array<std::array<size_t, NUM_BUCKETS>, NUM_PASSES> histograms {};
+		for(auto &item : items) {
+			auto key = static_cast<uint64_t>(getKey(item));
+			for(size_t pass = 0; pass < NUM_PASSES; ++pass)
+				++histograms[pass][(key >> (pass * 8)) & 0xFF];
+		}
+		tmp.resize(n);
+		auto *src = &items;
+		auto *dst = &tmp;
+		auto firstKey = static_cast<uint64_t>(getKey(items.front()));
+		for(size_t pass = 0; pass < NUM_PASSES; ++pass) {
+			auto &histogram = histograms[pass];
+			auto shift = pass * 8;
+			if(histogram[(firstKey >> shift) & 0xFF] == n)
+				continue;
+			size_t offset = 0;
+			for(auto &count : histogram) {
+				auto c = count;
+				count = offset;
+				offset += c;
+			}
+			auto &in = *src;
+			auto &out = *dst;
+			for(size_t i = 0; i < n; ++i) {
+				auto bucket = (static_cast<uint64_t>(getKey(in[i])) >> shift) & 0xFF;
+				out[histogram[bucket]++] = in[i];
+			}
+			std::swap(src, dst);
+		}
+		if(src != &items)
+			items.swap(tmp);
+	}
+};
+
+#endif
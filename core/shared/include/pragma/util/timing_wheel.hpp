@@ -0,0 +1,81 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#ifndef __PRAGMA_TIMING_WHEEL_HPP__
+#define __PRAGMA_TIMING_WHEEL_HPP__
+
+#include "pragma/networkdefinitions.h"
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace pragma {
+	// Hierarchical timing wheel with four levels of 256 slots each.
+	// Scheduling and unscheduling are O(1); Advancing the wheel only touches the slots
+	// that have elapsed, as well as the nodes that are due (or have to be moved to a lower level).
+	// Time is measured in integer ticks, the meaning of a tick is up to the user.
+	class DLLNETWORK TimingWheel {
+	  public:
+		static constexpr uint32_t SLOT_BITS = 8;
+		static constexpr uint32_t SLOT_COUNT = 1u << SLOT_BITS;
+		static constexpr uint32_t SLOT_MASK = SLOT_COUNT - 1u;
+		static constexpr uint32_t LEVEL_COUNT = 4;
+
+		// Intrusive list node. Must not be moved or destroyed while it is scheduled.
+		struct DLLNETWORK Node {
+			Node() = default;
+			Node(const Node &) = delete;
+			Node &operator=(const Node &) = delete;
+			~Node();
+			bool IsScheduled() const;
+			TimingWheel *GetWheel() const;
+			// Ticks until the node is due, or 0 if it isn't scheduled
+			uint64_t GetTicksLeft() const;
+			void Unschedule();
+
+			void *userData = nullptr;
+			uint64_t deadline = 0;
+		  private:
+			friend TimingWheel;
+			Node *m_prev = nullptr;
+			Node *m_next = nullptr;
+			TimingWheel *m_wheel = nullptr;
+			uint32_t m_level = 0;
+		};
+
+		TimingWheel();
+		TimingWheel(const TimingWheel &) = delete;
+		TimingWheel &operator=(const TimingWheel &) = delete;
+		~TimingWheel();
+		uint64_t GetTime() const;
+		size_t GetNodeCount() const;
+		// Nodes that are already due will expire with the next call to Advance
+		void Schedule(Node &node, uint64_t deadline);
+		// Advances the wheel to the specified time and appends all nodes that have become due to 'outExpired'.
+		// Expired nodes are no longer scheduled. The nodes are not invoked directly, so that they
+		// can safely be rescheduled (or destroyed) by the caller.
+		void Advance(uint64_t time, std::vector<Node *> &outExpired);
+		void Clear();
+	  private:
+		static void Link(Node &head, Node &node);
+		static void Unlink(Node &node);
+		static void MoveList(Node &srcHead, Node &dstHead);
+		void Insert(Node &node);
+		void Cascade(uint32_t level);
+		void Expire(Node &head, std::vector<Node *> &outExpired);
+
+		// Sentinel nodes of the circular slot lists
+		std::array<std::array<Node, SLOT_COUNT>, LEVEL_COUNT> m_slots;
+		uint64_t m_time = 0;
+		size_t m_nodeCount = 0;
+		// Used to skip over empty slots
+		std::array<size_t, LEVEL_COUNT> m_levelNodeCounts {};
+	};
+};
+
+#endif
@@ -12,6 +12,8 @@
 #include <array>
 #include <mathutil/uvec.h>
 #include <mathutil/plane.hpp>
+#include <memory>
+#include <mutex>
 
 namespace udm {
 	struct AssetData;
@@ -51,17 +53,40 @@ namespace util {
 			// Only valid if this is a non-leaf node
 			umath::Plane plane = {};
 		};
+		~BSPTree();
 		static std::shared_ptr<BSPTree> Create();
 		static std::shared_ptr<BSPTree> Load(const udm::AssetData &data, std::string &outErr);
 
+		// Returns true if bit 'clusterDst' is set in a decompressed visibility row (see DecompressClusterVisibility)
+		static bool IsClusterVisible(const std::vector<uint8_t> &visibilityRow, ClusterIndex clusterDst);
+
 		bool IsValid() const;
+		// Thread-safe. If only compressed visibility data is available, the bit is tested on the compressed row directly.
 		bool IsClusterVisible(ClusterIndex clusterSrc, ClusterIndex clusterDst) const;
 		const Node &GetRootNode() const;
 		Node &GetRootNode();
+		void SetRootNode(ChildIndex rootNode);
 		const std::vector<Node> &GetNodes() const;
 		std::vector<Node> &GetNodes();
+		// Uncompressed cluster-to-cluster bit matrix. If the tree was loaded with compressed visibility data only,
+		// the full matrix is decompressed on the first call, which is expensive for large maps.
+		// Prefer IsClusterVisible or DecompressClusterVisibility where possible.
 		const std::vector<uint8_t> &GetClusterVisibility() const;
+		// Since the returned matrix may be modified, this discards the compressed visibility data and makes the matrix authoritative.
+		// Not thread-safe.
 		std::vector<uint8_t> &GetClusterVisibility();
+
+		// Compressed visibility data: Every row (one per source cluster) is byte-aligned and runs of zero-bytes are stored
+		// as a 0 followed by the run length (1-255), like the Quake PVS. 'rowOffsets' contains the byte offset of each row
+		// in 'data'.
+		void SetCompressedClusterVisibility(std::vector<uint8_t> &&data, std::vector<uint32_t> &&rowOffsets);
+		bool HasCompressedClusterVisibility() const;
+		const std::vector<uint8_t> &GetCompressedClusterVisibility() const;
+		const std::vector<uint32_t> &GetCompressedClusterVisibilityRowOffsets() const;
+		void CompressClusterVisibility(std::vector<uint8_t> &outData, std::vector<uint32_t> &outRowOffsets) const;
+		// Decompresses the visibility row of 'clusterSrc' into 'outRow' (one bit per destination cluster)
+		bool DecompressClusterVisibility(ClusterIndex clusterSrc, std::vector<uint8_t> &outRow) const;
+		uint64_t GetClusterVisibilityRowSize() const;
 		uint64_t GetClusterCount() const;
 		void SetClusterCount(uint64_t numClusters);
 		Node *FindLeafNode(const Vector3 &pos);
@@ -72,7 +97,7 @@ namespace util {
 		bool Save(udm::AssetDataArg outData, std::string &outErr);
 		Node &CreateNode();
 	  protected:
-		BSPTree() = default;
+		BSPTree();
 		void UpdateVisibilityBounds(BSPTree::Node &node);
 		BSPTree::Node *FindLeafNode(BSPTree::Node &node, const Vector3 &point);
 		void FindLeafNodesInAabb(BSPTree::Node &node, const std::array<Vector3, 8> &aabbPoints, std::vector<BSPTree::Node *> &outNodes);
@@ -80,7 +105,11 @@ namespace util {
 		ChildIndex m_rootNode = std::numeric_limits<ChildIndex>::max();
 		std::vector<Node> m_nodes = {};
 		std::vector<uint8_t> m_clusterVisibility = {};
+		std::vector<uint8_t> m_compressedClusterVisibility = {};
+		std::vector<uint32_t> m_compressedClusterVisibilityRowOffsets = {};
 		uint64_t m_clusterCount = 0ull;
+		// Guards the lazy decompression of the full matrix
+		std::unique_ptr<std::mutex> m_clusterVisibilityMutex;
 		friend Node;
 	};
 #pragma pack(pop)
@@ -9,9 +9,12 @@
 #define __UTIL_THREAD_POOL_HPP__
 
 #include "pragma/networkdefinitions.h"
-#include <sharedutils/ctpl_stl.h>
+#include "pragma/util/job_system.hpp"
+#include <unordered_map>
 
 namespace pragma {
+	// Runs its tasks on the workers of the engine job system. The thread count only limits how many of the
+	// tasks of this pool may run at the same time.
 	class DLLNETWORK ThreadPool {
 	  public:
 		using ResultHandler = std::function<void()>;
@@ -19,16 +22,21 @@ namespace pragma {
 
 		ThreadPool(uint32_t threadCount);
 		ThreadPool(uint32_t threadCount, const std::string &name, const std::string &baseName = "tp");
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool &operator=(const ThreadPool &) = delete;
+		~ThreadPool();
 		uint32_t AddTask(const std::function<ResultHandler()> &task);
+		// Tasks added after the barrier are only started once all previous tasks have completed
 		void AddBarrier();
 		bool IsComplete() const { return m_completedTaskCount == m_totalTaskCount; }
 		bool IsComplete(uint32_t taskId) const;
+		// Tasks which haven't been started yet are discarded unless execRemainingQueue is true
 		void Stop(bool execRemainingQueue = false);
+		// The result handler of a task is released once its results have been pushed
 		void PushResults(uint32_t taskId);
 		void BatchProcess(uint32_t numJobs, uint32_t numItemsPerJob, const std::function<ResultHandler(uint32_t, uint32_t)> &f);
 
-		ctpl::thread_pool *operator->() { return &m_pool; }
-		ctpl::thread_pool &operator*() { return m_pool; }
+		uint32_t GetThreadCount() const { return m_threadCount; }
 
 		void WaitForPendingCount(uint32_t count);
 		void WaitForCompletion();
@@ -40,14 +48,29 @@ namespace pragma {
 			bool isComplete = false;
 			ResultHandler resultHandler = nullptr;
 		};
-		ctpl::thread_pool m_pool;
+		struct QueuedTask {
+			uint32_t taskId = 0;
+			std::function<ResultHandler()> task;
+			bool barrier = false;
+		};
+		// Have to be called with the mutex locked
+		void SubmitQueuedTasks();
+		void CompleteTask(uint32_t taskId, ResultHandler resultHandler);
+		void RunTask(uint32_t taskId, const std::function<ResultHandler()> &task);
+
+		JobSystem &m_jobSystem;
+		JobSystem::SubsystemId m_subsystem = JobSystem::DEFAULT_SUBSYSTEM;
+		uint32_t m_threadCount = 1;
+		bool m_stopped = false;
 
-		std::condition_variable m_taskCompleteCondition;
-		std::vector<TaskState> m_taskCompleted;
-		mutable std::mutex m_taskCompletedMutex;
+		std::deque<QueuedTask> m_queue;
+		uint32_t m_runningTaskCount = 0;
+		// Only contains tasks which are still pending, or whose results haven't been pushed yet
+		std::unordered_map<uint32_t, TaskState> m_taskStates;
+		mutable std::mutex m_mutex;
 
 		std::atomic<uint32_t> m_completedTaskCount = 0;
-		uint32_t m_totalTaskCount = 0;
+		std::atomic<uint32_t> m_totalTaskCount = 0;
 	};
 };
 
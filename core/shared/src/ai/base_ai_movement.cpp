@@ -54,13 +54,13 @@ void BaseAIComponent::UpdatePath()
 	if((charComponent.valid() && charComponent->CanMove() == false) || m_moveInfo.moveOnPath == false)
 		return;
 	if(m_navInfo.queuedPath != nullptr) {
-		if(s_navThread == nullptr)
+		if(s_pathService == nullptr)
 			m_navInfo.queuedPath = nullptr;
 		else {
 			auto bPathChanged = false;
 			if(m_navInfo.queuedPath->complete == true) {
-				if(m_navInfo.queuedPath->pathInfo != nullptr) {
-					m_navInfo.pathInfo = m_navInfo.queuedPath->pathInfo;
+				if(m_navInfo.queuedPath->path != nullptr) {
+					m_navInfo.pathInfo = std::make_shared<ai::navigation::PathInfo>(m_navInfo.queuedPath->path);
 					m_navInfo.pathState = PathResult::Success;
 				}
 				else {
@@ -104,11 +104,10 @@ void BaseAIComponent::ResetPath()
 	m_navInfo.bPathUpdateRequired = true;
 	m_navInfo.bTargetReached = false;
 	m_navInfo.pathState = PathResult::Updating;
-	if(s_navThread != nullptr) {
-		m_navInfo.queuedPath = std::make_shared<ai::navigation::PathQuery>(pTrComponent->GetPosition(), GetMoveTarget());
-		s_navThread->pendingQueueMutex.lock();
-		s_navThread->pendingQueue.push(m_navInfo.queuedPath);
-		s_navThread->pendingQueueMutex.unlock();
+	if(s_pathService != nullptr) {
+		// NPCs without a path are stuck until the query has completed, so they take precedence over NPCs which only update theirs
+		auto priority = (m_navInfo.pathInfo == nullptr) ? nav::PathService::Priority::High : nav::PathService::Priority::Normal;
+		m_navInfo.queuedPath = s_pathService->RequestPath(pTrComponent->GetPosition(), GetMoveTarget(), priority);
 	}
 }
 
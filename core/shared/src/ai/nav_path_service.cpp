@@ -0,0 +1,254 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/ai/nav_path_service.hpp"
+#include "pragma/ai/navsystem.h"
+#include "pragma/entities/components/base_ai_component.hpp"
+#include "pragma/engine.h"
+#include "DetourNavMesh.h"
+#include "DetourNavMeshQuery.h"
+#include <sharedutils/util_hash.hpp>
+#include <algorithm>
+#include <shared_mutex>
+#include <cmath>
+
+using namespace pragma::nav;
+
+struct PathService::Job {
+	std::shared_ptr<ai::navigation::PathQuery> query;
+	CoalesceKey key;
+	Priority priority = Priority::Normal;
+	bool started = false;
+	std::chrono::steady_clock::time_point requestTime;
+	// Only set while a sliced search is in progress
+	std::shared_ptr<dtNavMeshQuery> navQuery;
+	// Detour references the filter for the entire duration of a sliced search
+	dtQueryFilter filter;
+	Vector3 startPoint;
+	Vector3 endPoint;
+	std::shared_ptr<RcPathResult> result;
+};
+
+bool PathService::CoalesceKey::operator==(const CoalesceKey &other) const { return coordinates == other.coordinates; }
+size_t PathService::CoalesceKeyHash::operator()(const CoalesceKey &key) const
+{
+	util::Hash hash = 0;
+	for(auto c : key.coordinates)
+		hash = util::hash_combine<int32_t>(hash, c);
+	return hash;
+}
+
+PathService::PathService(const std::shared_ptr<Mesh> &navMesh, const Settings &settings) : m_navMesh {navMesh}, m_settings {settings}, m_jobSystem {pragma::get_engine()->GetJobSystem()}, m_statisticsResetTime {std::chrono::steady_clock::now()}
+{
+	m_settings.workerCount = std::max(m_settings.workerCount, 1u);
+	m_settings.iterationsPerSlice = std::max(m_settings.iterationsPerSlice, 1u);
+	m_settings.maxActiveSearches = std::max(m_settings.maxActiveSearches, m_settings.workerCount);
+	m_subsystem = m_jobSystem.RegisterSubsystem({"nav_path_service", JobSystem::Priority::Low});
+}
+
+PathService::~PathService()
+{
+	// Worker jobs which are still scheduled reference this service
+	std::unique_lock lock {m_mutex};
+	m_running = false;
+	m_condition.wait(lock, [this]() { return m_workerCount == 0; });
+}
+
+const std::shared_ptr<Mesh> &PathService::GetNavMesh() const { return m_navMesh; }
+const PathService::Settings &PathService::GetSettings() const { return m_settings; }
+
+PathService::CoalesceKey PathService::GetCoalesceKey(const Vector3 &start, const Vector3 &end) const
+{
+	auto gridSize = m_settings.coalesceGridSize;
+	auto toCell = [gridSize](float v) -> int32_t { return static_cast<int32_t>(std::floor(v / gridSize)); };
+	return CoalesceKey {{toCell(start.x), toCell(start.y), toCell(start.z), toCell(end.x), toCell(end.y), toCell(end.z)}};
+}
+
+std::shared_ptr<pragma::ai::navigation::PathQuery> PathService::RequestPath(const Vector3 &start, const Vector3 &end, Priority priority)
+{
+	auto coalesce = m_settings.coalesceGridSize > 0.f;
+	CoalesceKey key {};
+	if(coalesce)
+		key = GetCoalesceKey(start, end);
+
+	std::unique_lock lock {m_mutex};
+	++m_statistics.requestCount;
+	if(coalesce) {
+		auto it = m_pendingQueries.find(key);
+		if(it != m_pendingQueries.end()) {
+			auto query = it->second.lock();
+			if(query != nullptr) {
+				++m_statistics.coalescedCount;
+				return query;
+			}
+		}
+	}
+	auto query = std::make_shared<ai::navigation::PathQuery>(start, end);
+	auto job = std::make_unique<Job>();
+	job->query = query;
+	job->key = key;
+	job->priority = priority;
+	job->requestTime = std::chrono::steady_clock::now();
+	if(coalesce)
+		m_pendingQueries[key] = query;
+	m_queues[umath::to_integral(priority)].pending.push_back(std::move(job));
+	++m_statistics.pendingCount;
+	if(m_workerCount < m_settings.workerCount)
+		ScheduleWorker();
+	return query;
+}
+
+std::unique_ptr<PathService::Job> PathService::PopJob()
+{
+	for(auto it = m_queues.rbegin(); it != m_queues.rend(); ++it) {
+		auto &queue = *it;
+		// Searches in progress are continued before new ones are started if the limit has been reached, but they never hold back queries of a higher priority
+		auto useActive = (queue.active.empty() == false && (queue.pending.empty() || m_activeSearchCount >= m_settings.maxActiveSearches));
+		auto &jobs = useActive ? queue.active : queue.pending;
+		if(jobs.empty())
+			continue;
+		auto job = std::move(jobs.front());
+		jobs.pop_front();
+		if(job->started == false) {
+			job->started = true;
+			++m_activeSearchCount;
+		}
+		return job;
+	}
+	return nullptr;
+}
+
+bool PathService::HasQueuedJobs() const
+{
+	return std::any_of(m_queues.begin(), m_queues.end(), [](const Queue &queue) { return queue.pending.empty() == false || queue.active.empty() == false; });
+}
+
+void PathService::ScheduleWorker()
+{
+	++m_workerCount;
+	m_jobSystem.Schedule([this]() { RunWorker(); }, m_subsystem);
+}
+
+void PathService::RunWorker()
+{
+	std::unique_lock lock {m_mutex};
+	uint32_t numSlices = 0;
+	while(m_running && HasQueuedJobs()) {
+		if(numSlices++ == SLICES_PER_WORKER_JOB) {
+			// Give other jobs of the same priority a chance to run before the remaining queries are sliced
+			--m_workerCount;
+			ScheduleWorker();
+			return;
+		}
+		auto job = PopJob();
+		// If the job holds the only reference to the query, nobody is waiting for the result anymore
+		// (e.g. because the NPC has requested a different path in the meantime)
+		if(job->query.use_count() == 1) {
+			++m_statistics.discardedCount;
+			FinalizeJob(*job);
+			continue;
+		}
+		lock.unlock();
+		auto complete = ProcessSlice(*job);
+		lock.lock();
+		++m_statistics.sliceCount;
+		if(complete == false) {
+			// Move the search to the back of its queue, so other searches of the same priority can make progress in the meantime
+			m_queues[umath::to_integral(job->priority)].active.push_back(std::move(job));
+			continue;
+		}
+		if(job->result != nullptr) {
+			job->query->path = job->result;
+			++m_statistics.completedCount;
+		}
+		else
+			++m_statistics.failedCount;
+		job->query->complete = true;
+		auto latency = std::chrono::steady_clock::now() - job->requestTime;
+		m_statistics.totalLatency += latency;
+		m_statistics.maxLatency = std::max(m_statistics.maxLatency, latency);
+		FinalizeJob(*job);
+	}
+	--m_workerCount;
+	// Notified while the mutex is still locked, since the service may be destroyed as soon as it has been released
+	m_condition.notify_all();
+}
+
+bool PathService::ProcessSlice(Job &job)
+{
+	auto &query = *job.query;
+	// Tiles of the mesh may be rebuilt on the main thread in the meantime
+	std::shared_lock meshLock {m_navMesh->GetDetourMeshMutex()};
+	if(job.navQuery == nullptr) {
+		auto &sharedQuery = m_navMesh->GetSharedQuery();
+		job.navQuery = m_navMesh->AcquireQuery();
+		if(job.navQuery == nullptr || sharedQuery == nullptr)
+			return true;
+		dtPolyRef startRef;
+		dtPolyRef endRef;
+		if(m_navMesh->FindNearestPoly(*job.navQuery, query.start, startRef, job.startPoint) == false || m_navMesh->FindNearestPoly(*job.navQuery, query.end, endRef, job.endPoint) == false) {
+			job.navQuery = nullptr;
+			return true;
+		}
+		m_navMesh->InitializeQueryFilter(job.filter);
+		auto status = job.navQuery->initSlicedFindPath(startRef, endRef, &job.startPoint[0], &job.endPoint[0], &job.filter);
+		if(dtStatusFailed(status)) {
+			job.navQuery = nullptr;
+			return true;
+		}
+	}
+	int32_t numIterations = 0;
+	auto status = job.navQuery->updateSlicedFindPath(static_cast<int32_t>(m_settings.iterationsPerSlice), &numIterations);
+	if(dtStatusInProgress(status))
+		return false;
+	if(dtStatusSucceed(status)) {
+		auto maxPath = m_navMesh->GetQuerySettings().maxPathLength;
+		auto result = std::make_shared<RcPathResult>(*m_navMesh->GetRcNavMesh(), m_navMesh->GetSharedQuery(), job.startPoint, job.endPoint, maxPath);
+		int32_t pathCount = 0;
+		status = job.navQuery->finalizeSlicedFindPath(result->path.data(), &pathCount, static_cast<int32_t>(maxPath));
+		if(dtStatusSucceed(status)) {
+			result->pathCount = pathCount + 2;
+			job.result = result;
+		}
+	}
+	// Return the query to the pool
+	job.navQuery = nullptr;
+	return true;
+}
+
+void PathService::FinalizeJob(Job &job)
+{
+	if(m_settings.coalesceGridSize > 0.f) {
+		auto it = m_pendingQueries.find(job.key);
+		if(it != m_pendingQueries.end()) {
+			auto pendingQuery = it->second.lock();
+			if(pendingQuery == nullptr || pendingQuery == job.query)
+				m_pendingQueries.erase(it);
+		}
+	}
+	if(job.started)
+		--m_activeSearchCount;
+	--m_statistics.pendingCount;
+}
+
+PathService::Statistics PathService::GetStatistics() const
+{
+	std::scoped_lock lock {m_mutex};
+	auto stats = m_statistics;
+	stats.elapsed = std::chrono::steady_clock::now() - m_statisticsResetTime;
+	return stats;
+}
+
+void PathService::ResetStatistics()
+{
+	std::scoped_lock lock {m_mutex};
+	auto pendingCount = m_statistics.pendingCount;
+	m_statistics = {};
+	m_statistics.pendingCount = pendingCount;
+	m_statisticsResetTime = std::chrono::steady_clock::now();
+}
@@ -17,6 +17,8 @@
 #include "DetourNavMesh.h"
 #include "DetourNavMeshBuilder.h"
 #include "DetourNavMeshQuery.h"
+#include "DetourNode.h"
+#include "DetourCommon.h"
 #include <fsys/filesystem.h>
 #include <mathutil/umath.h>
 #include "pragma/model/modelmesh.h"
@@ -24,14 +26,43 @@
 #include "pragma/entities/components/base_model_component.hpp"
 #include "pragma/model/model.h"
 #include "pragma/util/util_game.hpp"
+#include "pragma/util/job_system.hpp"
+#include "pragma/engine.h"
 #include <sharedutils/scope_guard.h>
 #include <udm.hpp>
+#include <mutex>
+#include <algorithm>
+#include <optional>
 
 RcNavMesh::RcNavMesh(const std::shared_ptr<rcPolyMesh> &polyMesh, const std::shared_ptr<rcPolyMeshDetail> &polyMeshDetail, const std::shared_ptr<dtNavMesh> &navMesh) : m_polyMesh(polyMesh), m_polyMeshDetail(polyMeshDetail), m_navMesh(navMesh) {}
 
+RcNavMesh::RcNavMesh(const std::shared_ptr<dtNavMesh> &navMesh, const TileLayout &tileLayout, std::vector<Tile> &&tiles) : m_navMesh(navMesh), m_tileLayout(tileLayout), m_tiles(std::move(tiles)) {}
+
 rcPolyMesh &RcNavMesh::GetPolyMesh() { return *m_polyMesh; }
 rcPolyMeshDetail &RcNavMesh::GetPolyMeshDetail() { return *m_polyMeshDetail; }
 dtNavMesh &RcNavMesh::GetNavMesh() { return *m_navMesh; }
+bool RcNavMesh::IsTiled() const { return m_tileLayout.tileCountX > 0; }
+const RcNavMesh::TileLayout &RcNavMesh::GetTileLayout() const { return m_tileLayout; }
+std::vector<RcNavMesh::Tile> &RcNavMesh::GetTiles() { return m_tiles; }
+const std::vector<RcNavMesh::Tile> &RcNavMesh::GetTiles() const { return m_tiles; }
+
+bool RcNavMesh::TileLayout::GetTileRange(const Vector3 &min, const Vector3 &max, int32_t &outX0, int32_t &outY0, int32_t &outX1, int32_t &outY1) const
+{
+	if(tileCountX == 0 || tileCountY == 0)
+		return false;
+	auto toTile = [this](float v, float origin) { return static_cast<int64_t>(std::floor((v - origin) / tileWorldSize)); };
+	auto x0 = toTile(min.x, origin.x);
+	auto y0 = toTile(min.z, origin.z);
+	auto x1 = toTile(max.x, origin.x);
+	auto y1 = toTile(max.z, origin.z);
+	if(x1 < 0 || y1 < 0 || x0 >= tileCountX || y0 >= tileCountY)
+		return false;
+	outX0 = static_cast<int32_t>(std::max<int64_t>(x0, 0));
+	outY0 = static_cast<int32_t>(std::max<int64_t>(y0, 0));
+	outX1 = static_cast<int32_t>(std::min<int64_t>(x1, tileCountX - 1));
+	outY1 = static_cast<int32_t>(std::min<int64_t>(y1, tileCountY - 1));
+	return true;
+}
 
 ////////////////////////////////
 
@@ -100,130 +131,31 @@ static std::shared_ptr<dtNavMesh> initialize_detour_mesh(rcPolyMesh &polyMesh, r
 	return dtNav;
 }
 
-std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &config, const BaseEntity &ent, std::string *err)
+static void init_build_config(const pragma::nav::Config &config, rcConfig &cfg)
 {
-	auto &hMdl = ent.GetModel();
-	if(hMdl == nullptr)
-		return nullptr;
-	auto numTris = hMdl->GetTriangleCount();
-	std::vector<Vector3> vertices;
-	std::vector<int32_t> triangles;
-	vertices.reserve(hMdl->GetVertexCount());
-	triangles.reserve(numTris * 3u);
-	auto &colMeshes = hMdl->GetCollisionMeshes();
-	std::vector<ConvexArea> areas;
-	areas.reserve(colMeshes.size()); //numTris);
-	for(auto &colMesh : colMeshes) {
-		auto &meshVerts = colMesh->GetVertices();
-		auto &meshTris = colMesh->GetTriangles();
-		auto baseSurfMaterial = colMesh->GetSurfaceMaterial();
-		auto &surfMaterials = colMesh->GetSurfaceMaterials();
-		auto numMeshTris = meshTris.size() / 3;
-		auto idxOffset = vertices.size();
-		vertices.reserve(vertices.size() + meshVerts.size());
-		for(auto &v : meshVerts)
-			vertices.push_back(v);
-
-		triangles.reserve(triangles.size() + meshTris.size());
-		for(auto idx : meshTris)
-			triangles.push_back(idxOffset + idx);
-
-		Vector3 min, max;
-		colMesh->GetAABB(&min, &max);
-		areas.push_back({});
-		areas.back().verts.push_back(min);
-		areas.back().verts.push_back(max);
-		areas.back().area = baseSurfMaterial;
-		/*areas.reserve(areas.size() +meshTris.size() /3);
-		for(auto i=decltype(meshTris.size()){0u};i<meshTris.size();i+=3)
-		{
-			auto &v0 = meshVerts.at(meshTris.at(i));
-			auto &v1 = meshVerts.at(meshTris.at(i +1));
-			auto &v2 = meshVerts.at(meshTris.at(i +2));
-
-			areas.push_back({});
-			auto &area = areas.back();
-			area.verts = {v0,v2,v1};
-			area.area = baseSurfMaterial;
-		}*/
-	}
-
-	return generate(game, config, vertices, triangles, &areas, err);
-}
-std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &config, const std::vector<Vector3> &verts, const std::vector<int32_t> &indices, const std::vector<ConvexArea> *areas, std::string *err)
-{
-	//
-	// Step 1. Initialize build config.
-	//
-
-	// See http://digestingduck.blogspot.com/2009/08/recast-settings-uncovered.html for more information
-	auto cellSize = config.cellSize;
-	auto cellHeight = config.cellHeight;
-	auto agentHeight = config.characterHeight;
-	auto agentRadius = config.walkableRadius;
-	auto regionMinSize = config.minRegionSize;
-	auto regionMergeSize = config.mergeRegionSize;
-	auto edgeMaxLen = config.maxEdgeLength;
-	auto edgeMaxError = config.maxSimplificationError;
-
-	auto vertsPerPoly = config.vertsPerPoly;
-	auto detailSampleDist = config.sampleDetailDist;
-	auto detailSampleMaxError = config.sampleDetailMaxError;
-	auto partitionType = config.partitionType;
-
-	auto ctx = std::make_shared<rcContext>();
-	auto keepInterResults = false;
-
-	Vector3 min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
-	Vector3 max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
-	for(auto &v : verts) {
-		uvec::min(&min, v);
-		uvec::max(&max, v);
-	}
-	for(auto i = 0; i < 3; ++i) {
-		min[i] -= 0.01f;
-		max[i] += 0.01f;
-	}
-	const auto *bmin = reinterpret_cast<float *>(&min);
-	const auto *bmax = reinterpret_cast<float *>(&max);
-	const auto *fverts = reinterpret_cast<const float *>(verts.data());
-	const auto nverts = verts.size();
-	const auto *tris = indices.data();
-	const auto ntris = indices.size() / 3;
-
-	// Init build configuration from GUI
-	rcConfig cfg;
 	memset(&cfg, 0, sizeof(cfg));
-	cfg.cs = cellSize;
-	cfg.ch = cellHeight;
+	cfg.cs = config.cellSize;
+	cfg.ch = config.cellHeight;
 	cfg.walkableSlopeAngle = config.walkableSlopeAngle;
 	cfg.walkableHeight = static_cast<int32_t>(ceilf(config.characterHeight / cfg.ch));
 	cfg.walkableClimb = static_cast<int32_t>(floorf(config.maxClimbHeight / cfg.ch));
 	cfg.walkableRadius = static_cast<int32_t>(ceilf(config.walkableRadius / cfg.cs));
-	cfg.maxEdgeLen = static_cast<int32_t>(edgeMaxLen / cellSize);
-	cfg.maxSimplificationError = edgeMaxError;
-	cfg.minRegionArea = static_cast<int32_t>(rcSqr(regionMinSize));     // Note: area = size*size
-	cfg.mergeRegionArea = static_cast<int32_t>(rcSqr(regionMergeSize)); // Note: area = size*size
-	cfg.maxVertsPerPoly = static_cast<int32_t>(vertsPerPoly);
-	cfg.detailSampleDist = detailSampleDist < 0.9f ? 0 : cellSize * detailSampleDist;
-	cfg.detailSampleMaxError = cellHeight * detailSampleMaxError;
-
-	// Set the area where the navigation will be build.
-	// Here the bounds of the input mesh are used, but the
-	// area could be specified by an user defined box, etc.
-	rcVcopy(cfg.bmin, bmin);
-	rcVcopy(cfg.bmax, bmax);
-	rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
-
-	// Reset build times gathering.
-	ctx->resetTimers();
-
-	// Start the build process.
-	ctx->startTimer(RC_TIMER_TOTAL);
+	cfg.maxEdgeLen = static_cast<int32_t>(config.maxEdgeLength / config.cellSize);
+	cfg.maxSimplificationError = config.maxSimplificationError;
+	cfg.minRegionArea = static_cast<int32_t>(rcSqr(config.minRegionSize));     // Note: area = size*size
+	cfg.mergeRegionArea = static_cast<int32_t>(rcSqr(config.mergeRegionSize)); // Note: area = size*size
+	cfg.maxVertsPerPoly = static_cast<int32_t>(config.vertsPerPoly);
+	cfg.detailSampleDist = config.sampleDetailDist < 0.9f ? 0 : config.cellSize * config.sampleDetailDist;
+	cfg.detailSampleMaxError = config.cellHeight * config.sampleDetailMaxError;
+}
 
-	ctx->log(RC_LOG_PROGRESS, "Building navigation:");
-	ctx->log(RC_LOG_PROGRESS, " - %d x %d cells", cfg.width, cfg.height);
-	ctx->log(RC_LOG_PROGRESS, " - %.1fK verts, %.1fK tris", nverts / 1000.0f, ntris / 1000.0f);
+using PolyMeshPtr = std::unique_ptr<rcPolyMesh, void (*)(rcPolyMesh *)>;
+using PolyMeshDetailPtr = std::unique_ptr<rcPolyMeshDetail, void (*)(rcPolyMeshDetail *)>;
+// Runs the Recast pipeline for the specified build area (either the entire mesh or a single tile, including its border)
+static bool build_poly_mesh(rcContext &ctx, const rcConfig &cfg, pragma::nav::Config::PartitionType partitionType, const float *fverts, int32_t nverts, const int32_t *tris, int32_t ntris, const std::vector<pragma::nav::ConvexArea> *areas, PolyMeshPtr &outPolyMesh,
+  PolyMeshDetailPtr &outPolyMeshDetail)
+{
+	auto keepInterResults = false;
 
 	//
 	// Step 2. Rasterize input polygon soup.
@@ -232,12 +164,12 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	// Allocate voxel heightfield where we rasterize our input data to.
 	auto m_solid = std::shared_ptr<rcHeightfield>(rcAllocHeightfield(), [](rcHeightfield *heightfield) { rcFreeHeightField(heightfield); });
 	if(m_solid == nullptr) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
-		return nullptr;
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'solid'.");
+		return false;
 	}
-	if(rcCreateHeightfield(ctx.get(), *m_solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch) == false) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
-		return nullptr;
+	if(rcCreateHeightfield(&ctx, *m_solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch) == false) {
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Could not create solid heightfield.");
+		return false;
 	}
 
 	// Allocate array that can hold triangle area types.
@@ -248,8 +180,8 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	// Find triangles which are walkable based on their slope and rasterize them.
 	// If your input data is multiple meshes, you can transform them here, calculate
 	// the are type for each of the meshes and rasterize them.
-	rcMarkWalkableTriangles(ctx.get(), cfg.walkableSlopeAngle, fverts, nverts, tris, ntris, triAreas.data());
-	rcRasterizeTriangles(ctx.get(), fverts, nverts, tris, triAreas.data(), ntris, *m_solid, cfg.walkableClimb);
+	rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, fverts, nverts, tris, ntris, triAreas.data());
+	rcRasterizeTriangles(&ctx, fverts, nverts, tris, triAreas.data(), ntris, *m_solid, cfg.walkableClimb);
 
 	if(keepInterResults == false)
 		triAreas.clear();
@@ -261,9 +193,9 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	// Once all geoemtry is rasterized, we do initial pass of filtering to
 	// remove unwanted overhangs caused by the conservative rasterization
 	// as well as filter spans where the character cannot possibly stand.
-	rcFilterLowHangingWalkableObstacles(ctx.get(), cfg.walkableClimb, *m_solid);
-	rcFilterLedgeSpans(ctx.get(), cfg.walkableHeight, cfg.walkableClimb, *m_solid);
-	rcFilterWalkableLowHeightSpans(ctx.get(), cfg.walkableHeight, *m_solid);
+	rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *m_solid);
+	rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *m_solid);
+	rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *m_solid);
 
 	//
 	// Step 4. Partition walkable surface to simple regions.
@@ -274,21 +206,21 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	// between walkable cells will be calculated.
 	auto m_chf = std::shared_ptr<rcCompactHeightfield>(rcAllocCompactHeightfield(), [](rcCompactHeightfield *compactHeightfield) { rcFreeCompactHeightfield(compactHeightfield); });
 	if(m_chf == nullptr) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'chf'.");
-		return nullptr;
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'chf'.");
+		return false;
 	}
-	if(rcBuildCompactHeightfield(ctx.get(), cfg.walkableHeight, cfg.walkableClimb, *m_solid, *m_chf) == false) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build compact data.");
-		return nullptr;
+	if(rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *m_solid, *m_chf) == false) {
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build compact data.");
+		return false;
 	}
 
 	if(keepInterResults == false)
 		m_solid = nullptr;
 
 	// Erode the walkable area by agent radius.
-	if(rcErodeWalkableArea(ctx.get(), cfg.walkableRadius, *m_chf) == false) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not erode.");
-		return nullptr;
+	if(rcErodeWalkableArea(&ctx, cfg.walkableRadius, *m_chf) == false) {
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Could not erode.");
+		return false;
 	}
 
 	// (Optional) Mark areas.
@@ -313,8 +245,8 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 			*/
 			auto min = convexArea.verts.at(0);
 			auto max = convexArea.verts.at(1);
-			//rcMarkConvexPolyArea(ctx.get(),reinterpret_cast<const float*>(convexArea.verts.data()),convexArea.verts.size(),hMin,hMax,convexArea.area,*m_chf);
-			rcMarkBoxArea(ctx.get(), reinterpret_cast<float *>(&min), reinterpret_cast<float *>(&max), convexArea.area, *m_chf);
+			//rcMarkConvexPolyArea(&ctx,reinterpret_cast<const float*>(convexArea.verts.data()),convexArea.verts.size(),hMin,hMax,convexArea.area,*m_chf);
+			rcMarkBoxArea(&ctx, reinterpret_cast<float *>(&min), reinterpret_cast<float *>(&max), convexArea.area, *m_chf);
 		}
 	}
 
@@ -344,33 +276,33 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	//     if you have large open areas with small obstacles (not a problem if you use tiles)
 	//   * good choice to use for tiled navmesh with medium and small sized tiles
 
-	if(partitionType == Config::PartitionType::Watershed) {
+	if(partitionType == pragma::nav::Config::PartitionType::Watershed) {
 		// Prepare for region partitioning, by calculating distance field along the walkable surface.
-		if(rcBuildDistanceField(ctx.get(), *m_chf) == false) {
-			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build distance field.");
-			return nullptr;
+		if(rcBuildDistanceField(&ctx, *m_chf) == false) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build distance field.");
+			return false;
 		}
 
 		// Partition the walkable surface into simple regions without holes.
-		if(rcBuildRegions(ctx.get(), *m_chf, 0, cfg.minRegionArea, cfg.mergeRegionArea) == false) {
-			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build watershed regions.");
-			return nullptr;
+		if(rcBuildRegions(&ctx, *m_chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea) == false) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build watershed regions.");
+			return false;
 		}
 	}
-	else if(partitionType == Config::PartitionType::Monotone) {
+	else if(partitionType == pragma::nav::Config::PartitionType::Monotone) {
 		// Partition the walkable surface into simple regions without holes.
 		// Monotone partitioning does not need distancefield.
-		if(rcBuildRegionsMonotone(ctx.get(), *m_chf, 0, cfg.minRegionArea, cfg.mergeRegionArea) == false) {
-			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build monotone regions.");
-			return nullptr;
+		if(rcBuildRegionsMonotone(&ctx, *m_chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea) == false) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build monotone regions.");
+			return false;
 		}
 	}
 	else // SAMPLE_PARTITION_LAYERS
 	{
 		// Partition the walkable surface into simple regions without holes.
-		if(rcBuildLayerRegions(ctx.get(), *m_chf, 0, cfg.minRegionArea) == false) {
-			ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build layer regions.");
-			return nullptr;
+		if(rcBuildLayerRegions(&ctx, *m_chf, cfg.borderSize, cfg.minRegionArea) == false) {
+			ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build layer regions.");
+			return false;
 		}
 	}
 
@@ -381,12 +313,12 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	// Create contours.
 	auto m_cset = std::shared_ptr<rcContourSet>(rcAllocContourSet(), [](rcContourSet *contourSet) { rcFreeContourSet(contourSet); });
 	if(m_cset == nullptr) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'cset'.");
-		return nullptr;
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'cset'.");
+		return false;
 	}
-	if(rcBuildContours(ctx.get(), *m_chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *m_cset) == false) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not create contours.");
-		return nullptr;
+	if(rcBuildContours(&ctx, *m_chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *m_cset) == false) {
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Could not create contours.");
+		return false;
 	}
 
 	//
@@ -396,12 +328,12 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 	// Build polygon navmesh from the contours.
 	auto m_pmesh = std::unique_ptr<rcPolyMesh, void (*)(rcPolyMesh *)>(rcAllocPolyMesh(), [](rcPolyMesh *polyMesh) { rcFreePolyMesh(polyMesh); });
 	if(m_pmesh == nullptr) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'pmesh'.");
-		return nullptr;
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'pmesh'.");
+		return false;
 	}
-	if(rcBuildPolyMesh(ctx.get(), *m_cset, cfg.maxVertsPerPoly, *m_pmesh) == false) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not triangulate contours.");
-		return nullptr;
+	if(rcBuildPolyMesh(&ctx, *m_cset, cfg.maxVertsPerPoly, *m_pmesh) == false) {
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Could not triangulate contours.");
+		return false;
 	}
 
 	//
@@ -410,13 +342,13 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 
 	auto m_dmesh = std::unique_ptr<rcPolyMeshDetail, void (*)(rcPolyMeshDetail *)>(rcAllocPolyMeshDetail(), [](rcPolyMeshDetail *polyMesh) { rcFreePolyMeshDetail(polyMesh); });
 	if(m_dmesh == nullptr) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Out of memory 'pmdtl'.");
-		return nullptr;
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Out of memory 'pmdtl'.");
+		return false;
 	}
 
-	if(rcBuildPolyMeshDetail(ctx.get(), *m_pmesh, *m_chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *m_dmesh) == false) {
-		ctx->log(RC_LOG_ERROR, "buildNavigation: Could not build detail mesh.");
-		return nullptr;
+	if(rcBuildPolyMeshDetail(&ctx, *m_pmesh, *m_chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *m_dmesh) == false) {
+		ctx.log(RC_LOG_ERROR, "buildNavigation: Could not build detail mesh.");
+		return false;
 	}
 
 	if(keepInterResults == false) {
@@ -424,6 +356,340 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 		m_cset = nullptr;
 	}
 
+	outPolyMesh = std::move(m_pmesh);
+	outPolyMeshDetail = std::move(m_dmesh);
+	return true;
+}
+
+// Translates the surface material areas of the polygons to navigation flags
+static void update_poly_flags(Game &game, rcPolyMesh &polyMesh)
+{
+	for(auto i = decltype(polyMesh.npolys) {0}; i < polyMesh.npolys; ++i) {
+		auto &area = polyMesh.areas[i];
+		if(area == RC_WALKABLE_AREA)
+			area = 0u;
+		auto *surfMat = game.GetSurfaceMaterial(area);
+		if(surfMat != nullptr)
+			polyMesh.flags[i] = umath::to_integral(surfMat->GetNavigationFlags());
+	}
+}
+
+////////////////////////////////
+
+static bool create_tile_data(const pragma::nav::Config &config, rcPolyMesh &polyMesh, rcPolyMeshDetail &polyMeshDetail, int32_t tileX, int32_t tileY, uint8_t **outData, int32_t *outDataSize)
+{
+	dtNavMeshCreateParams params;
+	memset(&params, 0, sizeof(params));
+	params.verts = polyMesh.verts;
+	params.vertCount = polyMesh.nverts;
+	params.polys = polyMesh.polys;
+	params.polyAreas = polyMesh.areas;
+	params.polyFlags = polyMesh.flags;
+	params.polyCount = polyMesh.npolys;
+	params.nvp = polyMesh.nvp;
+	params.detailMeshes = polyMeshDetail.meshes;
+	params.detailVerts = polyMeshDetail.verts;
+	params.detailVertsCount = polyMeshDetail.nverts;
+	params.detailTris = polyMeshDetail.tris;
+	params.detailTriCount = polyMeshDetail.ntris;
+	params.walkableHeight = config.characterHeight;
+	params.walkableRadius = config.walkableRadius;
+	params.walkableClimb = config.maxClimbHeight;
+	params.tileX = tileX;
+	params.tileY = tileY;
+	params.tileLayer = 0;
+	rcVcopy(params.bmin, polyMesh.bmin);
+	rcVcopy(params.bmax, polyMesh.bmax);
+	params.cs = polyMesh.cs;
+	params.ch = polyMesh.ch;
+	params.buildBvTree = true;
+	return dtCreateNavMeshData(&params, outData, outDataSize);
+}
+
+static std::shared_ptr<dtNavMesh> create_tiled_detour_mesh(const RcNavMesh::TileLayout &layout, std::string *err)
+{
+	// Detour polygon references are 32 bits wide, the bits which are not required for the tile index are used for the polygon index
+	auto tileBits = dtIlog2(dtNextPow2(layout.tileCountX * layout.tileCountY));
+	if(tileBits > 14) {
+		if(err != nullptr)
+			*err = "Too many navigation mesh tiles, the tile size has to be increased!";
+		return nullptr;
+	}
+	dtNavMeshParams params;
+	memset(&params, 0, sizeof(params));
+	rcVcopy(params.orig, &layout.origin[0]);
+	params.tileWidth = layout.tileWorldSize;
+	params.tileHeight = layout.tileWorldSize;
+	params.maxTiles = 1 << tileBits;
+	params.maxPolys = 1 << (22 - tileBits);
+
+	auto dtNav = std::shared_ptr<dtNavMesh>(dtAllocNavMesh(), [](dtNavMesh *dtNavMesh) { dtFreeNavMesh(dtNavMesh); });
+	if(dtNav == nullptr || dtStatusFailed(dtNav->init(&params))) {
+		if(err != nullptr)
+			*err = "Could not initialize detour navigation mesh!";
+		return nullptr;
+	}
+	return dtNav;
+}
+
+struct TileBuildResult {
+	RcNavMesh::Tile tile {};
+	std::unique_ptr<uint8_t, void (*)(void *)> navData {nullptr, dtFree};
+	int32_t navDataSize = 0;
+	bool failed = false;
+};
+// Builds the tiles in the range [x0,x1]x[y0,y1] in parallel. Tiles without walkable polygons have no nav data.
+static std::vector<TileBuildResult> build_tiles(Game &game, const pragma::nav::Config &config, const RcNavMesh::TileLayout &layout, const std::vector<Vector3> &verts, const std::vector<int32_t> &indices, const std::vector<pragma::nav::ConvexArea> *areas, int32_t x0, int32_t y0,
+  int32_t x1, int32_t y1)
+{
+	rcConfig baseCfg;
+	init_build_config(config, baseCfg);
+	baseCfg.tileSize = static_cast<int32_t>(config.tileSize);
+	// The border has to be large enough that the erosion by the agent radius doesn't produce different results at the tile edges
+	baseCfg.borderSize = baseCfg.walkableRadius + 3;
+	baseCfg.width = baseCfg.tileSize + baseCfg.borderSize * 2;
+	baseCfg.height = baseCfg.tileSize + baseCfg.borderSize * 2;
+	auto borderWorldSize = baseCfg.borderSize * baseCfg.cs;
+
+	auto minHeight = std::numeric_limits<float>::max();
+	auto maxHeight = std::numeric_limits<float>::lowest();
+	for(auto &v : verts) {
+		minHeight = std::min(minHeight, v.y);
+		maxHeight = std::max(maxHeight, v.y);
+	}
+	minHeight -= 0.01f;
+	maxHeight += 0.01f;
+
+	// Assign each triangle to all tiles that it overlaps, including their borders
+	auto numTilesX = x1 - x0 + 1;
+	auto numTilesY = y1 - y0 + 1;
+	auto numTiles = static_cast<uint32_t>(numTilesX * numTilesY);
+	std::vector<std::vector<int32_t>> tileTris(numTiles);
+	auto toTile = [&layout](float v, float origin) { return static_cast<int64_t>(std::floor((v - origin) / layout.tileWorldSize)); };
+	auto numVerts = static_cast<int32_t>(verts.size());
+	for(auto i = decltype(indices.size()) {0u}; i + 2 < indices.size(); i += 3) {
+		auto *tri = &indices[i];
+		if(tri[0] < 0 || tri[0] >= numVerts || tri[1] < 0 || tri[1] >= numVerts || tri[2] < 0 || tri[2] >= numVerts)
+			continue;
+		auto &v0 = verts[tri[0]];
+		auto &v1 = verts[tri[1]];
+		auto &v2 = verts[tri[2]];
+		auto tx0 = std::max<int64_t>(toTile(std::min({v0.x, v1.x, v2.x}) - borderWorldSize, layout.origin.x), x0);
+		auto ty0 = std::max<int64_t>(toTile(std::min({v0.z, v1.z, v2.z}) - borderWorldSize, layout.origin.z), y0);
+		auto tx1 = std::min<int64_t>(toTile(std::max({v0.x, v1.x, v2.x}) + borderWorldSize, layout.origin.x), x1);
+		auto ty1 = std::min<int64_t>(toTile(std::max({v0.z, v1.z, v2.z}) + borderWorldSize, layout.origin.z), y1);
+		for(auto ty = ty0; ty <= ty1; ++ty) {
+			for(auto tx = tx0; tx <= tx1; ++tx) {
+				auto &tris = tileTris[(ty - y0) * numTilesX + (tx - x0)];
+				tris.insert(tris.end(), tri, tri + 3);
+			}
+		}
+	}
+
+	std::vector<TileBuildResult> results(numTiles);
+	auto *fverts = reinterpret_cast<const float *>(verts.data());
+	auto buildTiles = [&](uint32_t start, uint32_t end) {
+		rcContext ctx {false};
+		for(auto idx = start; idx < end; ++idx) {
+			auto &result = results[idx];
+			result.tile.x = x0 + static_cast<int32_t>(idx % numTilesX);
+			result.tile.y = y0 + static_cast<int32_t>(idx / numTilesX);
+			auto &tris = tileTris[idx];
+			if(tris.empty())
+				continue;
+			auto cfg = baseCfg;
+			cfg.bmin[0] = layout.origin.x + result.tile.x * layout.tileWorldSize - borderWorldSize;
+			cfg.bmin[1] = minHeight;
+			cfg.bmin[2] = layout.origin.z + result.tile.y * layout.tileWorldSize - borderWorldSize;
+			cfg.bmax[0] = layout.origin.x + (result.tile.x + 1) * layout.tileWorldSize + borderWorldSize;
+			cfg.bmax[1] = maxHeight;
+			cfg.bmax[2] = layout.origin.z + (result.tile.y + 1) * layout.tileWorldSize + borderWorldSize;
+
+			auto polyMesh = PolyMeshPtr {nullptr, nullptr};
+			auto polyMeshDetail = PolyMeshDetailPtr {nullptr, nullptr};
+			if(build_poly_mesh(ctx, cfg, config.partitionType, fverts, numVerts, tris.data(), static_cast<int32_t>(tris.size() / 3), areas, polyMesh, polyMeshDetail) == false || cfg.maxVertsPerPoly > DT_VERTS_PER_POLYGON) {
+				result.failed = true;
+				continue;
+			}
+			if(polyMesh->npolys == 0)
+				continue;
+			update_poly_flags(game, *polyMesh);
+			uint8_t *navData = nullptr;
+			if(create_tile_data(config, *polyMesh, *polyMeshDetail, result.tile.x, result.tile.y, &navData, &result.navDataSize) == false) {
+				result.failed = true;
+				continue;
+			}
+			result.navData.reset(navData);
+			result.tile.polyMesh = std::move(polyMesh);
+			result.tile.polyMeshDetail = std::move(polyMeshDetail);
+		}
+	};
+	// Tiles vary a lot in cost, so every tile is claimed individually
+	pragma::get_engine()->GetJobSystem().ParallelFor(numTiles, 1, buildTiles);
+	return results;
+}
+
+static std::shared_ptr<RcNavMesh> generate_tiled(Game &game, const pragma::nav::Config &config, const std::vector<Vector3> &verts, const std::vector<int32_t> &indices, const std::vector<pragma::nav::ConvexArea> *areas, std::string *err)
+{
+	if(verts.empty()) {
+		if(err != nullptr)
+			*err = "No geometry to generate navigation mesh from!";
+		return nullptr;
+	}
+	Vector3 min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+	Vector3 max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+	for(auto &v : verts) {
+		uvec::min(&min, v);
+		uvec::max(&max, v);
+	}
+	RcNavMesh::TileLayout layout {};
+	layout.origin = min - Vector3 {0.01f, 0.01f, 0.01f};
+	layout.tileWorldSize = config.tileSize * config.cellSize;
+	layout.tileCountX = std::max(static_cast<uint32_t>(std::ceil((max.x + 0.01f - layout.origin.x) / layout.tileWorldSize)), 1u);
+	layout.tileCountY = std::max(static_cast<uint32_t>(std::ceil((max.z + 0.01f - layout.origin.z) / layout.tileWorldSize)), 1u);
+	auto dtNav = create_tiled_detour_mesh(layout, err);
+	if(dtNav == nullptr)
+		return nullptr;
+
+	auto results = build_tiles(game, config, layout, verts, indices, areas, 0, 0, layout.tileCountX - 1, layout.tileCountY - 1);
+	std::vector<RcNavMesh::Tile> tiles;
+	for(auto &result : results) {
+		if(result.failed) {
+			if(err != nullptr)
+				*err = "Could not build navigation mesh tile (" + std::to_string(result.tile.x) + "," + std::to_string(result.tile.y) + ")!";
+			return nullptr;
+		}
+		if(result.navData == nullptr)
+			continue;
+		if(dtStatusFailed(dtNav->addTile(result.navData.get(), result.navDataSize, DT_TILE_FREE_DATA, 0, nullptr))) {
+			if(err != nullptr)
+				*err = "Could not add navigation mesh tile (" + std::to_string(result.tile.x) + "," + std::to_string(result.tile.y) + ")!";
+			return nullptr;
+		}
+		result.navData.release(); // Now owned by the Detour mesh
+		tiles.push_back(std::move(result.tile));
+	}
+	return std::make_shared<RcNavMesh>(dtNav, layout, std::move(tiles));
+}
+
+static bool collect_geometry(const BaseEntity &ent, std::vector<Vector3> &vertices, std::vector<int32_t> &triangles, std::vector<pragma::nav::ConvexArea> &areas)
+{
+	auto &hMdl = ent.GetModel();
+	if(hMdl == nullptr)
+		return false;
+	auto numTris = hMdl->GetTriangleCount();
+	vertices.reserve(hMdl->GetVertexCount());
+	triangles.reserve(numTris * 3u);
+	auto &colMeshes = hMdl->GetCollisionMeshes();
+	areas.reserve(colMeshes.size()); //numTris);
+	for(auto &colMesh : colMeshes) {
+		auto &meshVerts = colMesh->GetVertices();
+		auto &meshTris = colMesh->GetTriangles();
+		auto baseSurfMaterial = colMesh->GetSurfaceMaterial();
+		auto &surfMaterials = colMesh->GetSurfaceMaterials();
+		auto numMeshTris = meshTris.size() / 3;
+		auto idxOffset = vertices.size();
+		vertices.reserve(vertices.size() + meshVerts.size());
+		for(auto &v : meshVerts)
+			vertices.push_back(v);
+
+		triangles.reserve(triangles.size() + meshTris.size());
+		for(auto idx : meshTris)
+			triangles.push_back(idxOffset + idx);
+
+		Vector3 min, max;
+		colMesh->GetAABB(&min, &max);
+		areas.push_back({});
+		areas.back().verts.push_back(min);
+		areas.back().verts.push_back(max);
+		areas.back().area = baseSurfMaterial;
+		/*areas.reserve(areas.size() +meshTris.size() /3);
+		for(auto i=decltype(meshTris.size()){0u};i<meshTris.size();i+=3)
+		{
+			auto &v0 = meshVerts.at(meshTris.at(i));
+			auto &v1 = meshVerts.at(meshTris.at(i +1));
+			auto &v2 = meshVerts.at(meshTris.at(i +2));
+
+			areas.push_back({});
+			auto &area = areas.back();
+			area.verts = {v0,v2,v1};
+			area.area = baseSurfMaterial;
+		}*/
+	}
+	return true;
+}
+
+std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &config, const BaseEntity &ent, std::string *err)
+{
+	std::vector<Vector3> vertices;
+	std::vector<int32_t> triangles;
+	std::vector<ConvexArea> areas;
+	if(collect_geometry(ent, vertices, triangles, areas) == false)
+		return nullptr;
+	return generate(game, config, vertices, triangles, &areas, err);
+}
+std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &config, const std::vector<Vector3> &verts, const std::vector<int32_t> &indices, const std::vector<ConvexArea> *areas, std::string *err)
+{
+	if(config.tileSize > 0)
+		return generate_tiled(game, config, verts, indices, areas, err);
+	//
+	// Step 1. Initialize build config.
+	//
+
+	// See http://digestingduck.blogspot.com/2009/08/recast-settings-uncovered.html for more information
+	auto agentHeight = config.characterHeight;
+	auto agentRadius = config.walkableRadius;
+	auto partitionType = config.partitionType;
+
+	auto ctx = std::make_shared<rcContext>();
+
+	Vector3 min(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+	Vector3 max(std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest());
+	for(auto &v : verts) {
+		uvec::min(&min, v);
+		uvec::max(&max, v);
+	}
+	for(auto i = 0; i < 3; ++i) {
+		min[i] -= 0.01f;
+		max[i] += 0.01f;
+	}
+	const auto *bmin = reinterpret_cast<float *>(&min);
+	const auto *bmax = reinterpret_cast<float *>(&max);
+	const auto *fverts = reinterpret_cast<const float *>(verts.data());
+	const auto nverts = verts.size();
+	const auto *tris = indices.data();
+	const auto ntris = indices.size() / 3;
+
+	// Init build configuration from GUI
+	rcConfig cfg;
+	init_build_config(config, cfg);
+
+	// Set the area where the navigation will be build.
+	// Here the bounds of the input mesh are used, but the
+	// area could be specified by an user defined box, etc.
+	rcVcopy(cfg.bmin, bmin);
+	rcVcopy(cfg.bmax, bmax);
+	rcCalcGridSize(cfg.bmin, cfg.bmax, cfg.cs, &cfg.width, &cfg.height);
+
+	// Reset build times gathering.
+	ctx->resetTimers();
+
+	// Start the build process.
+	ctx->startTimer(RC_TIMER_TOTAL);
+
+	ctx->log(RC_LOG_PROGRESS, "Building navigation:");
+	ctx->log(RC_LOG_PROGRESS, " - %d x %d cells", cfg.width, cfg.height);
+	ctx->log(RC_LOG_PROGRESS, " - %.1fK verts, %.1fK tris", nverts / 1000.0f, ntris / 1000.0f);
+
+	//
+	// Step 2-7. Build the polygon mesh and the detail mesh.
+	//
+
+	auto m_pmesh = PolyMeshPtr {nullptr, nullptr};
+	auto m_dmesh = PolyMeshDetailPtr {nullptr, nullptr};
+	if(build_poly_mesh(*ctx, cfg, partitionType, fverts, static_cast<int32_t>(nverts), tris, static_cast<int32_t>(ntris), areas, m_pmesh, m_dmesh) == false)
+		return nullptr;
+
 	// At this point the navigation mesh data is ready, you can access it from m_pmesh.
 	// See duDebugDrawPolyMesh or dtCreateNavMeshData as examples how to access the data.
 
@@ -439,16 +705,7 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 		int navDataSize = 0;
 
 		// Update poly flags from areas.
-		for(auto i = decltype(m_pmesh->npolys) {0}; i < m_pmesh->npolys; ++i) {
-			auto &area = m_pmesh->areas[i];
-			if(area == RC_WALKABLE_AREA)
-				area = 0u;
-			if(area != 0u)
-				std::cout << "";
-			auto *surfMat = game.GetSurfaceMaterial(area);
-			if(surfMat != nullptr)
-				m_pmesh->flags[i] = umath::to_integral(surfMat->GetNavigationFlags());
-		}
+		update_poly_flags(game, *m_pmesh);
 
 		dtNavMeshCreateParams params;
 		memset(&params, 0, sizeof(params));
@@ -825,7 +1082,111 @@ std::shared_ptr<RcNavMesh> pragma::nav::generate(Game &game, const Config &confi
 
 std::shared_ptr<pragma::nav::Mesh> pragma::nav::Mesh::Create(const std::shared_ptr<RcNavMesh> &rcMesh, const Config &config) { return Create<Mesh>(rcMesh, config); }
 std::shared_ptr<pragma::nav::Mesh> pragma::nav::Mesh::Load(Game &game, const std::string &fname) { return Load<Mesh>(game, fname); }
-pragma::nav::Mesh::Mesh(const std::shared_ptr<RcNavMesh> &rcMesh, const Config &config) : m_rcMesh(rcMesh), m_config(config) {}
+struct pragma::nav::Mesh::QueryPool {
+	~QueryPool();
+	std::mutex mutex;
+	std::vector<dtNavMeshQuery *> freeQueries;
+	QuerySettings settings {};
+	// Incremented whenever the Detour mesh is replaced. Queries are bound to the mesh they were initialized with,
+	// so queries from an older generation must not be returned to the pool.
+	uint64_t generation = 0;
+};
+pragma::nav::Mesh::QueryPool::~QueryPool()
+{
+	for(auto *query : freeQueries)
+		dtFreeNavMeshQuery(query);
+}
+
+pragma::nav::Mesh::Mesh() : m_queryPool {std::make_shared<QueryPool>()} {}
+pragma::nav::Mesh::Mesh(const std::shared_ptr<RcNavMesh> &rcMesh, const Config &config) : m_rcMesh(rcMesh), m_config(config), m_queryPool {std::make_shared<QueryPool>()} { InitializeQueries(); }
+void pragma::nav::Mesh::InitializeQueries()
+{
+	{
+		std::scoped_lock lock {m_queryPool->mutex};
+		auto &pool = *m_queryPool;
+		for(auto *query : pool.freeQueries)
+			dtFreeNavMeshQuery(query);
+		pool.freeQueries.clear();
+		++pool.generation;
+	}
+	m_sharedQuery = nullptr;
+	if(m_rcMesh == nullptr)
+		return;
+	auto query = std::shared_ptr<dtNavMeshQuery>(dtAllocNavMeshQuery(), [](dtNavMeshQuery *query) { dtFreeNavMeshQuery(query); });
+	// The shared query is never used for searches, so it only needs a minimal node pool
+	if(query == nullptr || dtStatusFailed(query->init(&m_rcMesh->GetNavMesh(), 64)))
+		return;
+	m_sharedQuery = query;
+}
+void pragma::nav::Mesh::SetQuerySettings(const QuerySettings &settings)
+{
+	std::scoped_lock lock {m_queryPool->mutex};
+	auto &pool = *m_queryPool;
+	if(settings.maxNodes != pool.settings.maxNodes) {
+		for(auto *query : pool.freeQueries)
+			dtFreeNavMeshQuery(query);
+		pool.freeQueries.clear();
+	}
+	pool.settings = settings;
+}
+pragma::nav::Mesh::QuerySettings pragma::nav::Mesh::GetQuerySettings() const
+{
+	std::scoped_lock lock {m_queryPool->mutex};
+	return m_queryPool->settings;
+}
+std::shared_ptr<dtNavMeshQuery> pragma::nav::Mesh::AcquireQuery()
+{
+	if(m_rcMesh == nullptr)
+		return nullptr;
+	auto &pool = *m_queryPool;
+	dtNavMeshQuery *query = nullptr;
+	uint32_t maxNodes;
+	uint64_t generation;
+	{
+		std::scoped_lock lock {pool.mutex};
+		maxNodes = pool.settings.maxNodes;
+		generation = pool.generation;
+		if(pool.freeQueries.empty() == false) {
+			query = pool.freeQueries.back();
+			pool.freeQueries.pop_back();
+		}
+	}
+	if(query == nullptr) {
+		query = dtAllocNavMeshQuery();
+		if(query == nullptr)
+			return nullptr;
+		if(dtStatusFailed(query->init(&m_rcMesh->GetNavMesh(), maxNodes))) {
+			dtFreeNavMeshQuery(query);
+			return nullptr;
+		}
+	}
+	return std::shared_ptr<dtNavMeshQuery>(query, [wpPool = std::weak_ptr<QueryPool> {m_queryPool}, generation](dtNavMeshQuery *query) {
+		auto pool = wpPool.lock();
+		if(pool != nullptr) {
+			std::scoped_lock lock {pool->mutex};
+			// Queries that were initialized with outdated settings, or for a mesh that has since been replaced, are discarded
+			if(generation == pool->generation && static_cast<uint32_t>(query->getNodePool()->getMaxNodes()) == pool->settings.maxNodes) {
+				pool->freeQueries.push_back(query);
+				return;
+			}
+		}
+		dtFreeNavMeshQuery(query);
+	});
+}
+const std::shared_ptr<dtNavMeshQuery> &pragma::nav::Mesh::GetSharedQuery() const { return m_sharedQuery; }
+void pragma::nav::Mesh::InitializeQueryFilter(dtQueryFilter &filter) const
+{
+	filter.setIncludeFlags(0xFFFF); // TODO
+	filter.setExcludeFlags(0);      // TODO
+}
+bool pragma::nav::Mesh::FindNearestPoly(dtNavMeshQuery &query, const Vector3 &pos, dtPolyRef &ref, Vector3 &outPoint) const
+{
+	auto extents = GetQuerySettings().extents;
+	dtQueryFilter filter;
+	InitializeQueryFilter(filter);
+	auto status = query.findNearestPoly(&pos[0], &extents[0], &filter, &ref, &outPoint[0]);
+	return dtStatusFailed(status) == false && ref != 0;
+}
 const pragma::nav::Config &pragma::nav::Mesh::GetConfig() const { return m_config; }
 const std::shared_ptr<RcNavMesh> &pragma::nav::Mesh::GetRcNavMesh() const { return const_cast<Mesh *>(this)->GetRcNavMesh(); }
 std::shared_ptr<RcNavMesh> &pragma::nav::Mesh::GetRcNavMesh() { return m_rcMesh; }
@@ -950,26 +1311,56 @@ bool pragma::nav::Mesh::Save(Game &game, udm::AssetDataArg outData, std::string
 	udmConfig["vertsPerPoly"] = m_config.vertsPerPoly;
 	udmConfig["sampleDetailDist"] = m_config.sampleDetailDist;
 	udmConfig["partitionType"] = m_config.partitionType;
+	udmConfig["tileSize"] = m_config.tileSize;
 
 	std::vector<std::string> surfaceMaterialNames;
 	std::unordered_map<uint32_t, uint32_t> surfaceMaterialTable;
-	auto &polyMesh = navMesh.GetPolyMesh();
-	auto numAreas = polyMesh.maxpolys;
-	for(auto i = decltype(numAreas) {0}; i < numAreas; ++i) {
-		auto areaIdx = polyMesh.areas[i];
-		auto it = surfaceMaterialTable.find(areaIdx);
-		if(it != surfaceMaterialTable.end())
-			continue;
-		surfaceMaterialTable.insert(std::make_pair(areaIdx, surfaceMaterialNames.size()));
-		auto *surfMat = game.GetSurfaceMaterial(areaIdx);
-		if(surfMat != nullptr)
-			surfaceMaterialNames.push_back(surfMat->GetIdentifier());
-		else {
-			Con::cwar << "Nav mesh poly with unknown surface material index " << +areaIdx << "! Setting to 0..." << Con::endl;
-			surfaceMaterialNames.push_back("");
+	auto addSurfaceMaterials = [&game, &surfaceMaterialNames, &surfaceMaterialTable](const rcPolyMesh &polyMesh) {
+		auto numAreas = polyMesh.maxpolys;
+		for(auto i = decltype(numAreas) {0}; i < numAreas; ++i) {
+			auto areaIdx = polyMesh.areas[i];
+			auto it = surfaceMaterialTable.find(areaIdx);
+			if(it != surfaceMaterialTable.end())
+				continue;
+			surfaceMaterialTable.insert(std::make_pair(areaIdx, surfaceMaterialNames.size()));
+			auto *surfMat = game.GetSurfaceMaterial(areaIdx);
+			if(surfMat != nullptr)
+				surfaceMaterialNames.push_back(surfMat->GetIdentifier());
+			else {
+				Con::cwar << "Nav mesh poly with unknown surface material index " << +areaIdx << "! Setting to 0..." << Con::endl;
+				surfaceMaterialNames.push_back("");
+			}
+		}
+	};
+
+	if(navMesh.IsTiled()) {
+		auto &tiles = navMesh.GetTiles();
+		for(auto &tile : tiles)
+			addSurfaceMaterials(*tile.polyMesh);
+		udm["surfaceMaterials"] = surfaceMaterialNames;
+
+		auto &layout = navMesh.GetTileLayout();
+		auto udmLayout = udm["tileLayout"];
+		udmLayout["origin"] = layout.origin;
+		udmLayout["tileWorldSize"] = layout.tileWorldSize;
+		udmLayout["tileCountX"] = layout.tileCountX;
+		udmLayout["tileCountY"] = layout.tileCountY;
+
+		auto udmTiles = udm.AddArray("tiles", tiles.size());
+		for(auto i = decltype(tiles.size()) {0u}; i < tiles.size(); ++i) {
+			auto &tile = tiles[i];
+			auto udmTile = udmTiles[i];
+			udmTile["x"] = tile.x;
+			udmTile["y"] = tile.y;
+			write_poly_mesh(udmTile["polyMesh"], *tile.polyMesh, surfaceMaterialTable);
+			write_poly_mesh(udmTile["polyMeshDetail"], *tile.polyMeshDetail);
 		}
+		return true;
 	}
 
+	auto &polyMesh = navMesh.GetPolyMesh();
+	addSurfaceMaterials(polyMesh);
+
 	// Write surface material names
 	udm["surfaceMaterials"] = surfaceMaterialNames;
 	write_poly_mesh(udm["polyMesh"], polyMesh, surfaceMaterialTable);
@@ -1007,6 +1398,7 @@ bool pragma::nav::Mesh::LoadFromAssetData(Game &game, const udm::AssetData &data
 	udmConfig["vertsPerPoly"](m_config.vertsPerPoly);
 	udmConfig["sampleDetailDist"](m_config.sampleDetailDist);
 	udmConfig["partitionType"](m_config.partitionType);
+	udmConfig["tileSize"](m_config.tileSize);
 
 	std::vector<std::string> surfaceMaterialNames;
 	udm["surfaceMaterials"](surfaceMaterialNames);
@@ -1020,6 +1412,9 @@ bool pragma::nav::Mesh::LoadFromAssetData(Game &game, const udm::AssetData &data
 			Con::cwar << "Nav mesh poly with unknown surface material '" << name << "'! Setting to 0..." << Con::endl;
 	}
 
+	if(udm["tiles"])
+		return LoadTilesFromAssetData(udm, surfaceMaterialTable, outErr);
+
 	auto polyMesh = std::shared_ptr<rcPolyMesh>(rcAllocPolyMesh(), [](rcPolyMesh *polyMesh) { rcFreePolyMesh(polyMesh); });
 	if(polyMesh == nullptr) {
 		outErr = "Unable to allocate rcPolyMesh!";
@@ -1045,9 +1440,152 @@ bool pragma::nav::Mesh::LoadFromAssetData(Game &game, const udm::AssetData &data
 		return false;
 	}
 	m_rcMesh = navMesh;
+	InitializeQueries();
+	return true;
+}
+
+bool pragma::nav::Mesh::LoadTilesFromAssetData(const udm::LinkedPropertyWrapper &udm, std::vector<uint32_t> &surfaceMaterialTable, std::string &outErr)
+{
+	RcNavMesh::TileLayout layout {};
+	auto udmLayout = udm["tileLayout"];
+	udmLayout["origin"](layout.origin);
+	udmLayout["tileWorldSize"](layout.tileWorldSize);
+	udmLayout["tileCountX"](layout.tileCountX);
+	udmLayout["tileCountY"](layout.tileCountY);
+	if(layout.tileCountX == 0 || layout.tileCountY == 0 || layout.tileWorldSize <= 0.f) {
+		outErr = "Invalid tile layout!";
+		return false;
+	}
+	auto dtNav = create_tiled_detour_mesh(layout, &outErr);
+	if(dtNav == nullptr)
+		return false;
+
+	auto udmTiles = udm["tiles"];
+	auto numTiles = udmTiles.GetSize();
+	std::vector<RcNavMesh::Tile> tiles;
+	tiles.reserve(numTiles);
+	for(auto i = decltype(numTiles) {0u}; i < numTiles; ++i) {
+		auto udmTile = udmTiles[i];
+		RcNavMesh::Tile tile {};
+		udmTile["x"](tile.x);
+		udmTile["y"](tile.y);
+		tile.polyMesh = std::shared_ptr<rcPolyMesh>(rcAllocPolyMesh(), [](rcPolyMesh *polyMesh) { rcFreePolyMesh(polyMesh); });
+		tile.polyMeshDetail = std::shared_ptr<rcPolyMeshDetail>(rcAllocPolyMeshDetail(), [](rcPolyMeshDetail *polyMeshDetail) { rcFreePolyMeshDetail(polyMeshDetail); });
+		if(tile.polyMesh == nullptr || tile.polyMeshDetail == nullptr) {
+			outErr = "Unable to allocate tile meshes!";
+			return false;
+		}
+		read_poly_mesh(udmTile["polyMesh"], *tile.polyMesh, surfaceMaterialTable);
+		read_poly_mesh(udmTile["polyMeshDetail"], *tile.polyMeshDetail);
+
+		uint8_t *navData = nullptr;
+		int32_t navDataSize = 0;
+		if(create_tile_data(m_config, *tile.polyMesh, *tile.polyMeshDetail, tile.x, tile.y, &navData, &navDataSize) == false) {
+			outErr = "Could not create detour data for tile (" + std::to_string(tile.x) + "," + std::to_string(tile.y) + ")!";
+			return false;
+		}
+		if(dtStatusFailed(dtNav->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr))) {
+			dtFree(navData);
+			outErr = "Could not add tile (" + std::to_string(tile.x) + "," + std::to_string(tile.y) + ")!";
+			return false;
+		}
+		tiles.push_back(std::move(tile));
+	}
+	m_rcMesh = std::make_shared<RcNavMesh>(dtNav, layout, std::move(tiles));
+	InitializeQueries();
 	return true;
 }
 
+bool pragma::nav::Mesh::RebuildTiles(Game &game, const Vector3 &min, const Vector3 &max, std::string *err)
+{
+	auto *pWorld = game.GetWorld();
+	if(pWorld == nullptr) {
+		if(err != nullptr)
+			*err = "No world entity!";
+		return false;
+	}
+	std::vector<Vector3> vertices;
+	std::vector<int32_t> triangles;
+	std::vector<ConvexArea> areas;
+	if(collect_geometry(pWorld->GetEntity(), vertices, triangles, areas) == false) {
+		if(err != nullptr)
+			*err = "World entity has no model!";
+		return false;
+	}
+	return RebuildTiles(game, min, max, vertices, triangles, &areas, err);
+}
+
+bool pragma::nav::Mesh::RebuildTiles(Game &game, const Vector3 &min, const Vector3 &max, const std::vector<Vector3> &verts, const std::vector<int32_t> &indices, const std::vector<ConvexArea> *areas, std::string *err)
+{
+	if(m_rcMesh == nullptr || m_rcMesh->IsTiled() == false) {
+		if(err != nullptr)
+			*err = "Only tiled navigation meshes can be rebuilt partially!";
+		return false;
+	}
+	auto &layout = m_rcMesh->GetTileLayout();
+	int32_t x0, y0, x1, y1;
+	if(layout.GetTileRange(min, max, x0, y0, x1, y1) == false)
+		return true;
+	auto results = build_tiles(game, m_config, layout, verts, indices, areas, x0, y0, x1, y1);
+	for(auto &result : results) {
+		if(result.failed == false)
+			continue;
+		if(err != nullptr)
+			*err = "Could not build navigation mesh tile (" + std::to_string(result.tile.x) + "," + std::to_string(result.tile.y) + ")!";
+		return false;
+	}
+
+	// Path queries running on other threads must not access the mesh while the tiles are being swapped
+	std::unique_lock lock {m_detourMeshMutex};
+	auto &dtNav = m_rcMesh->GetNavMesh();
+	auto &tiles = m_rcMesh->GetTiles();
+	auto success = true;
+	for(auto &result : results) {
+		auto x = result.tile.x;
+		auto y = result.tile.y;
+		auto tileRef = dtNav.getTileRefAt(x, y, 0);
+		// The old tile is kept, so it can be restored if the new one can't be added. Tiles are owned by the Detour mesh
+		// (DT_TILE_FREE_DATA), in which case removeTile frees the data instead of handing it back, so we need a copy.
+		std::vector<uint8_t> oldTileData;
+		if(tileRef != 0) {
+			auto *oldDtTile = dtNav.getTileByRef(tileRef);
+			if(oldDtTile != nullptr && oldDtTile->data != nullptr)
+				oldTileData.assign(oldDtTile->data, oldDtTile->data + oldDtTile->dataSize);
+			dtNav.removeTile(tileRef, nullptr, nullptr);
+		}
+		std::optional<RcNavMesh::Tile> oldTile {};
+		auto it = std::find_if(tiles.begin(), tiles.end(), [x, y](const RcNavMesh::Tile &tile) { return tile.x == x && tile.y == y; });
+		if(it != tiles.end()) {
+			oldTile = std::move(*it);
+			tiles.erase(it);
+		}
+		if(result.navData == nullptr)
+			continue;
+		if(dtStatusFailed(dtNav.addTile(result.navData.get(), result.navDataSize, DT_TILE_FREE_DATA, 0, nullptr))) {
+			if(err != nullptr)
+				*err = "Could not add navigation mesh tile (" + std::to_string(x) + "," + std::to_string(y) + ")!";
+			success = false;
+			// Restore the old tile, otherwise the area would be left without a navigation mesh
+			if(oldTileData.empty() == false) {
+				auto *data = static_cast<uint8_t *>(dtAlloc(oldTileData.size(), DT_ALLOC_PERM));
+				if(data != nullptr) {
+					std::copy(oldTileData.begin(), oldTileData.end(), data);
+					if(dtStatusFailed(dtNav.addTile(data, static_cast<int>(oldTileData.size()), DT_TILE_FREE_DATA, 0, nullptr)))
+						dtFree(data);
+					else if(oldTile.has_value())
+						tiles.push_back(std::move(*oldTile));
+				}
+			}
+			continue;
+		}
+		result.navData.release(); // Now owned by the Detour mesh
+		tiles.push_back(std::move(result.tile));
+	}
+	return success;
+}
+
+std::shared_mutex &pragma::nav::Mesh::GetDetourMeshMutex() const { return m_detourMeshMutex; }
+
 std::shared_ptr<RcNavMesh> pragma::nav::load(Game &game, const std::string &fname, Config &outConfig)
 {
 	std::string err;
@@ -1065,93 +1603,59 @@ std::shared_ptr<RcNavMesh> pragma::nav::load(Game &game, const std::string &fnam
 
 bool pragma::nav::Mesh::FindNearestPoly(const Vector3 &pos, dtPolyRef &ref)
 {
-	if(m_rcMesh == nullptr)
-		return false;
-	auto &mesh = *m_rcMesh;
-	auto navQuery = std::unique_ptr<dtNavMeshQuery, decltype(&dtFreeNavMeshQuery)>(dtAllocNavMeshQuery(), dtFreeNavMeshQuery);
-	auto status = navQuery->init(&mesh.GetNavMesh(), 2048); // TODO
-	if(dtStatusFailed(status))
+	auto navQuery = AcquireQuery();
+	if(navQuery == nullptr)
 		return false;
-	const Vector3 extents(256.f, 256.f, 256.f); // TODO
-	dtQueryFilter filter;
-	filter.setIncludeFlags(0xFFFF); // TODO
-	filter.setExcludeFlags(0);      // TODO
 	Vector3 nearestPoint {};
-	status = navQuery->findNearestPoly(&pos[0], &extents[0], &filter, &ref, &nearestPoint[0]);
-	if(dtStatusFailed(status))
-		return false;
-	return true;
+	return FindNearestPoly(*navQuery, pos, ref, nearestPoint);
 }
 
 bool pragma::nav::Mesh::RayCast(const Vector3 &start, const Vector3 &end, Vector3 &hit)
 {
-	if(m_rcMesh == nullptr)
-		return false;
-	auto &mesh = *m_rcMesh;
-	auto navQuery = std::unique_ptr<dtNavMeshQuery, decltype(&dtFreeNavMeshQuery)>(dtAllocNavMeshQuery(), dtFreeNavMeshQuery);
-	auto status = navQuery->init(&mesh.GetNavMesh(), 2048); // TODO
-	if(dtStatusFailed(status))
+	auto navQuery = AcquireQuery();
+	if(navQuery == nullptr)
 		return false;
 	dtPolyRef startRef;
-	dtPolyRef endRef;
-	if(FindNearestPoly(start, startRef) == false || FindNearestPoly(end, endRef) == false)
+	Vector3 startPoint;
+	if(FindNearestPoly(*navQuery, start, startRef, startPoint) == false)
 		return false;
-	const Vector3 extents(256.f, 256.f, 256.f); // TODO
 	dtQueryFilter filter;
-	filter.setIncludeFlags(0xFFFF); // TODO
-	filter.setExcludeFlags(0);      // TODO
-
-	static std::unique_ptr<dtRaycastHit> rayHit = nullptr;
-	static std::array<dtPolyRef, 2048> hitRefs;
-	if(rayHit == nullptr) {
-		rayHit = std::make_unique<dtRaycastHit>();
-		rayHit->pathCount = static_cast<int32_t>(hitRefs.size());
-		rayHit->path = hitRefs.data();
-	}
+	InitializeQueryFilter(filter);
 
-	status = navQuery->raycast(startRef, &start[0], &end[0], &filter, 0, rayHit.get());
-	if(dtStatusFailed(status) || rayHit->t == 0.f)
+	// The visited polygons are not needed, so no path buffer is supplied
+	dtRaycastHit rayHit {};
+	auto status = navQuery->raycast(startRef, &start[0], &end[0], &filter, 0, &rayHit);
+	if(dtStatusFailed(status) || rayHit.t == 0.f)
 		return false;
-	if(rayHit->t > 1.f)
+	if(rayHit.t > 1.f)
 		hit = end;
 	else
-		hit = start + (end - start) * rayHit->t;
+		hit = start + (end - start) * rayHit.t;
 	return true;
 }
 
 std::shared_ptr<RcPathResult> pragma::nav::Mesh::FindPath(const Vector3 &start, const Vector3 &end)
 {
-	if(m_rcMesh == nullptr)
-		return nullptr;
-	auto &mesh = *m_rcMesh;
-	auto navQuery = std::shared_ptr<dtNavMeshQuery>(dtAllocNavMeshQuery(), [](dtNavMeshQuery *navQuery) { dtFreeNavMeshQuery(navQuery); });
-	auto status = navQuery->init(&mesh.GetNavMesh(), 2048); // TODO
-	if(dtStatusFailed(status)) {
-		//Con::cerr<<"FAILED #1: "<<start.x<<","<<start.y<<","<<start.z<<" => "<<end.x<<","<<end.y<<","<<end.z<<Con::endl;
+	auto navQuery = AcquireQuery();
+	if(navQuery == nullptr || m_sharedQuery == nullptr)
 		return nullptr;
-	}
-	const Vector3 extents(256.f, 256.f, 256.f); // TODO
-	dtQueryFilter filter;
-	filter.setIncludeFlags(0xFFFF); // TODO
-	filter.setExcludeFlags(0);      // TODO
 	dtPolyRef startRef;
 	Vector3 startPoint;
-	auto statusStart = navQuery->findNearestPoly(&start[0], &extents[0], &filter, &startRef, &startPoint[0]);
-	if(dtStatusFailed(statusStart) == false && startRef != 0) {
-		dtPolyRef endRef;
-		Vector3 endPoint;
-		auto statusEnd = navQuery->findNearestPoly(&end[0], &extents[0], &filter, &endRef, &endPoint[0]);
-		if(!dtStatusFailed(statusEnd) && endRef != 0) {
-			int maxPath = 128;                                                                      // TODO
-			auto r = std::make_shared<RcPathResult>(mesh, navQuery, startPoint, endPoint, maxPath); // TODO
-			int32_t pathCount = 0;
-			auto findStatus = navQuery->findPath(startRef, endRef, &startPoint[0], &endPoint[0], &filter, &r->path[0], &pathCount, maxPath);
-			r->pathCount = pathCount + 2;
-			return r;
-		}
-	}
-	//Con::cerr<<"FAILED #2: "<<start.x<<","<<start.y<<","<<start.z<<" => "<<end.x<<","<<end.y<<","<<end.z<<Con::endl;
-	return nullptr;
+	dtPolyRef endRef;
+	Vector3 endPoint;
+	if(FindNearestPoly(*navQuery, start, startRef, startPoint) == false || FindNearestPoly(*navQuery, end, endRef, endPoint) == false)
+		return nullptr;
+	dtQueryFilter filter;
+	InitializeQueryFilter(filter);
+	auto maxPath = GetQuerySettings().maxPathLength;
+	// The result only needs the query for read-only operations, so it can use the shared query and the pooled one can be released immediately
+	auto r = std::make_shared<RcPathResult>(*m_rcMesh, m_sharedQuery, startPoint, endPoint, maxPath);
+	int32_t pathCount = 0;
+	auto findStatus = navQuery->findPath(startRef, endRef, &startPoint[0], &endPoint[0], &filter, r->path.data(), &pathCount, maxPath);
+	if(dtStatusFailed(findStatus))
+		return nullptr;
+	r->pathCount = pathCount + 2;
+	return r;
 }
 
 ////////////////////////////////////
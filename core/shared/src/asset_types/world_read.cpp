@@ -51,13 +51,15 @@ bool pragma::asset::WorldData::Read(VFilePtr &f, EntityData::Flags entMask, std:
 	auto headerData = f->Read<HeaderData>();
 
 	auto materials = ReadMaterials(f);
-	if(umath::is_flag_set(headerData.flags, DataFlags::HasBSPTree))
-		ReadBSPTree(f, version);
+	if(umath::is_flag_set(headerData.flags, DataFlags::HasBSPTree) && ReadBSPTree(f, version) == false) {
+		// Skip the remaining BSP data
+		f->Seek(umath::is_flag_set(headerData.flags, DataFlags::HasLightmapAtlas) ? headerData.offsetLightMapData : headerData.offsetEntities);
+	}
 	if(umath::is_flag_set(headerData.flags, DataFlags::HasLightmapAtlas)) {
 		m_lightMapIntensity = f->Read<float>();
 		m_lightMapExposure = f->Read<float>();
 	}
-	ReadEntities(f, materials, entMask);
+	ReadEntities(f, materials, entMask, version);
 	return true;
 }
 std::vector<msys::MaterialHandle> pragma::asset::WorldData::ReadMaterials(VFilePtr &f)
@@ -73,9 +75,37 @@ std::vector<msys::MaterialHandle> pragma::asset::WorldData::ReadMaterials(VFileP
 	}
 	return materials;
 }
-void pragma::asset::WorldData::ReadBSPTree(VFilePtr &f, uint32_t version)
+bool pragma::asset::WorldData::ReadBSPTree(VFilePtr &f, uint32_t version)
 {
 	m_bspTree = util::BSPTree::Create();
+	if(version >= 13) {
+		// Flat node array in memory layout, followed by the compressed visibility rows
+		auto nodeSize = f->Read<uint32_t>();
+		auto rootNode = f->Read<uint32_t>();
+		auto numNodes = f->Read<uint32_t>();
+		if(nodeSize != sizeof(util::BSPTree::Node)) {
+			Con::cwar << "Unable to load BSP tree: Node size mismatch (" << nodeSize << " != " << sizeof(util::BSPTree::Node) << ")!" << Con::endl;
+			m_bspTree = nullptr;
+			return false;
+		}
+		auto &nodes = m_bspTree->GetNodes();
+		nodes.resize(numNodes);
+		f->Read(nodes.data(), nodes.size() * sizeof(nodes.front()));
+		m_bspTree->SetRootNode(rootNode);
+
+		auto numClusters = f->Read<uint64_t>();
+		auto compressedSize = f->Read<uint32_t>();
+		std::vector<uint32_t> rowOffsets;
+		rowOffsets.resize(numClusters);
+		f->Read(rowOffsets.data(), rowOffsets.size() * sizeof(rowOffsets.front()));
+		std::vector<uint8_t> compressedClusterData;
+		compressedClusterData.resize(compressedSize);
+		f->Read(compressedClusterData.data(), compressedClusterData.size() * sizeof(compressedClusterData.front()));
+		m_bspTree->SetClusterCount(numClusters);
+		m_bspTree->SetCompressedClusterVisibility(std::move(compressedClusterData), std::move(rowOffsets));
+		ReadClusterMeshIndices(f, numClusters);
+		return true;
+	}
 	auto &nodes = m_bspTree->GetNodes();
 	std::function<void(util::BSPTree::Node &)> fReadNode = nullptr;
 	fReadNode = [this, &fReadNode, &nodes, &f](util::BSPTree::Node &node) {
@@ -114,8 +144,12 @@ void pragma::asset::WorldData::ReadBSPTree(VFilePtr &f, uint32_t version)
 	f->Read(compressedClusterData.data(), compressedClusterData.size() * sizeof(compressedClusterData.front()));
 	m_bspTree->SetClusterCount(numClusters);
 
-	if(version <= 11)
-		return;
+	if(version > 11)
+		ReadClusterMeshIndices(f, numClusters);
+	return true;
+}
+void pragma::asset::WorldData::ReadClusterMeshIndices(VFilePtr &f, uint64_t numClusters)
+{
 	auto hasClusterMeshList = f->Read<bool>();
 	if(hasClusterMeshList == false)
 		return;
@@ -127,67 +161,95 @@ void pragma::asset::WorldData::ReadBSPTree(VFilePtr &f, uint32_t version)
 		f->Read(meshIndices.data(), meshIndices.size() * sizeof(meshIndices.front()));
 	}
 }
-void pragma::asset::WorldData::ReadEntities(VFilePtr &f, const std::vector<msys::MaterialHandle> &materials, EntityData::Flags entMask)
+void pragma::asset::WorldData::ReadEntities(VFilePtr &f, const std::vector<msys::MaterialHandle> &materials, EntityData::Flags entMask, uint32_t version)
 {
 	auto numEnts = f->Read<uint32_t>();
+	if(version >= 13) {
+		// The entity table lets us filter by flags and jump straight to the entity blocks we actually need.
+		// Entities that pass the mask are still read in full here, they are not loaded on demand.
+		std::vector<EntityTableEntry> entityTable;
+		entityTable.resize(numEnts);
+		f->Read(entityTable.data(), entityTable.size() * sizeof(entityTable.front()));
+		m_entities.reserve(numEnts);
+		for(auto i = decltype(numEnts) {0u}; i < numEnts; ++i) {
+			auto &tableEntry = entityTable[i];
+			if(entMask != EntityData::Flags::None && (tableEntry.flags & entMask) == EntityData::Flags::None)
+				continue;
+			f->Seek(tableEntry.offset);
+			auto entData = EntityData::Create();
+			m_entities.push_back(entData);
+			entData->m_mapIndex = i + 1; // Map indices always start at 1!
+			ReadEntity(f, *entData);
+		}
+		return;
+	}
 	m_entities.reserve(numEnts);
 	for(auto i = decltype(numEnts) {0u}; i < numEnts; ++i) {
-		auto entData = EntityData::Create();
 		auto startOffset = f->Tell();
 		auto offsetToEndOfEntity = startOffset + f->Read<uint64_t>();
-		auto offsetMeshes = f->Tell();
-		offsetMeshes += f->Read<uint64_t>();
-
-		auto offsetLeaves = f->Tell();
-		offsetLeaves += f->Read<uint64_t>();
-
-		entData->SetFlags(static_cast<EntityData::Flags>(f->Read<uint64_t>()));
-		if(entMask != EntityData::Flags::None && (entData->GetFlags() & entMask) == EntityData::Flags::None) {
+		f->Seek(startOffset + sizeof(uint64_t) * 3);
+		auto flags = static_cast<EntityData::Flags>(f->Read<uint64_t>());
+		if(entMask != EntityData::Flags::None && (flags & entMask) == EntityData::Flags::None) {
 			// We don't need this entity; Skip it
 			f->Seek(offsetToEndOfEntity);
 			continue;
 		}
+		f->Seek(startOffset);
+		auto entData = EntityData::Create();
 		m_entities.push_back(entData);
 		entData->m_mapIndex = i + 1; // Map indices always start at 1!
-		entData->SetClassName(f->ReadString());
-		auto pose = umath::ScaledTransform();
-		pose.SetOrigin(f->Read<Vector3>());
-		entData->SetPose(pose);
-
-		auto numKeyValues = f->Read<uint32_t>();
-		auto &keyValues = entData->GetKeyValues();
-		keyValues.reserve(numKeyValues);
-		for(auto i = decltype(numKeyValues) {0u}; i < numKeyValues; ++i) {
-			auto key = f->ReadString();
-			auto val = f->ReadString();
-			keyValues[key] = val;
-		}
+		ReadEntity(f, *entData);
+	}
+}
+void pragma::asset::WorldData::ReadEntity(VFilePtr &f, EntityData &entData)
+{
+	auto startOffset = f->Tell();
+	auto offsetToEndOfEntity = startOffset + f->Read<uint64_t>();
+	auto offsetMeshes = f->Tell();
+	offsetMeshes += f->Read<uint64_t>();
+
+	auto offsetLeaves = f->Tell();
+	offsetLeaves += f->Read<uint64_t>();
+
+	entData.SetFlags(static_cast<EntityData::Flags>(f->Read<uint64_t>()));
+	entData.SetClassName(f->ReadString());
+	auto pose = umath::ScaledTransform();
+	pose.SetOrigin(f->Read<Vector3>());
+	entData.SetPose(pose);
+
+	auto numKeyValues = f->Read<uint32_t>();
+	auto &keyValues = entData.GetKeyValues();
+	keyValues.reserve(numKeyValues);
+	for(auto i = decltype(numKeyValues) {0u}; i < numKeyValues; ++i) {
+		auto key = f->ReadString();
+		auto val = f->ReadString();
+		keyValues[key] = val;
+	}
 
-		auto numOutputs = f->Read<uint32_t>();
-		auto &outputs = entData->GetOutputs();
-		outputs.resize(numOutputs);
-		for(auto &output : outputs) {
-			output.name = f->ReadString();
-			output.target = f->ReadString();
-			output.input = f->ReadString();
-			output.param = f->ReadString();
-			output.delay = f->Read<float>();
-			output.times = f->Read<int>();
-		}
+	auto numOutputs = f->Read<uint32_t>();
+	auto &outputs = entData.GetOutputs();
+	outputs.resize(numOutputs);
+	for(auto &output : outputs) {
+		output.name = f->ReadString();
+		output.target = f->ReadString();
+		output.input = f->ReadString();
+		output.param = f->ReadString();
+		output.delay = f->Read<float>();
+		output.times = f->Read<int>();
+	}
 
-		auto &components = entData->GetComponents();
-		auto numComponents = f->Read<uint32_t>();
-		components.reserve(numComponents);
-		for(auto &c : components) {
-			auto componentType = f->ReadString();
-			entData->AddComponent(componentType);
-		}
+	auto &components = entData.GetComponents();
+	auto numComponents = f->Read<uint32_t>();
+	components.reserve(numComponents);
+	for(auto &c : components) {
+		auto componentType = f->ReadString();
+		entData.AddComponent(componentType);
+	}
 
-		auto numLeaves = f->Read<uint32_t>();
-		auto &leaves = entData->GetLeaves();
-		leaves.resize(numLeaves);
-		f->Read(leaves.data(), leaves.size() * sizeof(leaves.front()));
+	auto numLeaves = f->Read<uint32_t>();
+	auto &leaves = entData.GetLeaves();
+	leaves.resize(numLeaves);
+	f->Read(leaves.data(), leaves.size() * sizeof(leaves.front()));
 
-		f->Seek(offsetToEndOfEntity);
-	}
+	f->Seek(offsetToEndOfEntity);
 }
@@ -82,10 +82,12 @@ static void preprocess_bsp_data(util::BSPTree &bspTree, std::vector<std::vector<
 
 		// List of clusters visible from every other cluster
 		outClusterToClusterVisibility.resize(numClusters);
+		std::vector<uint8_t> row;
 		for(auto cluster0 = decltype(numClusters) {0u}; cluster0 < numClusters; ++cluster0) {
 			auto &visibleClusters = outClusterToClusterVisibility.at(cluster0);
+			bspTree.DecompressClusterVisibility(cluster0, row);
 			for(auto cluster1 = decltype(numClusters) {0u}; cluster1 < numClusters; ++cluster1) {
-				if(bspTree.IsClusterVisible(cluster0, cluster1) == false)
+				if(util::BSPTree::IsClusterVisible(row, cluster1) == false)
 					continue;
 				if(visibleClusters.size() == visibleClusters.capacity())
 					visibleClusters.reserve(visibleClusters.size() * 1.5f + 50);
@@ -356,7 +358,7 @@ void pragma::asset::WorldData::Write(VFilePtrReal &f)
 	f->Write(header.data(), header.size());
 
 	f->Write<uint32_t>(WLD_VERSION);
-	static_assert(WLD_VERSION == 12);
+	static_assert(WLD_VERSION == 13);
 	auto offsetToDataFlags = f->Tell();
 	f->Write<DataFlags>(DataFlags::None);
 	auto offsetMaterials = f->Tell();
@@ -442,53 +444,54 @@ void pragma::asset::WorldData::WriteBSPTree(VFilePtrReal &f)
 	std::vector<std::vector<uint16_t>> clusterToClusterVisibility;
 	preprocess_bsp_data(bspTree, clusterNodes, clusterToClusterVisibility);
 
-	auto &bspNodes = bspTree.GetNodes();
-	auto numClusters = bspTree.GetClusterCount();
-	auto &clusterVisibility = bspTree.GetClusterVisibility();
-	std::function<void(const util::BSPTree::Node &)> fWriteNode = nullptr;
-	fWriteNode = [&f, &fWriteNode, &clusterVisibility, &clusterToClusterVisibility, &bspNodes, &clusterNodes, &bspTree, numClusters](const util::BSPTree::Node &node) {
-		f->Write<bool>(node.leaf);
-		f->Write<Vector3>(node.min);
-		f->Write<Vector3>(node.max);
-		f->Write<int32_t>(node.firstFace);
-		f->Write<int32_t>(node.numFaces);
-		f->Write<int32_t>(node.originalNodeIndex);
-		if(node.leaf) {
-			f->Write<uint16_t>(node.cluster);
-			auto itNode = std::find_if(bspNodes.begin(), bspNodes.end(), [&node](const util::BSPTree::Node &nodeOther) { return &nodeOther == &node; });
-			// Calculate AABB encompassing all nodes visible by this node
-			auto min = node.min;
-			auto max = node.max;
-			if(itNode != bspNodes.end() && node.cluster != std::numeric_limits<uint16_t>::max()) {
-				for(auto clusterDst : clusterToClusterVisibility.at(node.cluster)) {
-					for(auto nodeOtherIdx : clusterNodes.at(clusterDst)) {
-						auto &nodeOther = bspNodes.at(nodeOtherIdx);
-						uvec::to_min_max(min, max, nodeOther.min, nodeOther.max);
-					}
+	// The nodes are written as a flat array in their in-memory layout, so they can be loaded with a single read
+	auto nodes = bspTree.GetNodes();
+	for(auto &node : nodes) {
+		if(!node.leaf)
+			continue;
+		// Calculate AABB encompassing all nodes visible by this node
+		auto min = node.min;
+		auto max = node.max;
+		if(node.cluster != std::numeric_limits<uint16_t>::max()) {
+			for(auto clusterDst : clusterToClusterVisibility.at(node.cluster)) {
+				for(auto nodeOtherIdx : clusterNodes.at(clusterDst)) {
+					auto &nodeOther = nodes.at(nodeOtherIdx);
+					uvec::to_min_max(min, max, nodeOther.min, nodeOther.max);
 				}
 			}
-			uvec::to_min_max(min, max); // Vertex conversion rotates the vectors, which will change the signs, so we have to re-order the vector components
-			f->Write<Vector3>(min);
-			f->Write<Vector3>(max);
-			return;
 		}
-		f->Write<Vector3>(node.plane.GetNormal());
-		f->Write<float>(node.plane.GetDistance());
-
-		fWriteNode(bspNodes[node.children.at(0)]);
-		fWriteNode(bspNodes[node.children.at(1)]);
-	};
-	fWriteNode(bspTree.GetRootNode());
-
+		uvec::to_min_max(min, max); // Vertex conversion rotates the vectors, which will change the signs, so we have to re-order the vector components
+		node.minVisible = min;
+		node.maxVisible = max;
+	}
+	f->Write<uint32_t>(sizeof(util::BSPTree::Node));
+	f->Write<uint32_t>(bspTree.GetRootNode().index);
+	f->Write<uint32_t>(nodes.size());
+	f->Write(nodes.data(), nodes.size() * sizeof(nodes.front()));
+
+	// Visibility rows are stored compressed and only decompressed on demand
+	std::vector<uint8_t> compressedVisibility;
+	std::vector<uint32_t> rowOffsets;
+	bspTree.CompressClusterVisibility(compressedVisibility, rowOffsets);
 	f->Write<uint64_t>(bspTree.GetClusterCount());
-	f->Write(clusterVisibility.data(), clusterVisibility.size() * sizeof(clusterVisibility.front()));
+	f->Write<uint32_t>(compressedVisibility.size());
+	f->Write(rowOffsets.data(), rowOffsets.size() * sizeof(rowOffsets.front()));
+	f->Write(compressedVisibility.data(), compressedVisibility.size() * sizeof(compressedVisibility.front()));
 }
 
 void pragma::asset::WorldData::WriteEntities(VFilePtrReal &f)
 {
 	f->Write<uint32_t>(m_entities.size());
+	auto offsetEntityTable = f->Tell();
+	std::vector<EntityTableEntry> entityTable {m_entities.size()};
+	f->Write(entityTable.data(), entityTable.size() * sizeof(entityTable.front()));
 
+	uint32_t entIdx = 0;
 	for(auto &entData : m_entities) {
+		auto &tableEntry = entityTable[entIdx++];
+		tableEntry.offset = f->Tell();
+		tableEntry.flags = entData->GetFlags();
+
 		auto offsetEndOfEntity = f->Tell();
 		f->Write<uint64_t>(0u); // Offset to end of entity
 		auto offsetEntityMeshes = f->Tell();
@@ -542,6 +545,11 @@ void pragma::asset::WorldData::WriteEntities(VFilePtrReal &f)
 		f->Write<uint64_t>(cur - offsetEndOfEntity);
 		f->Seek(cur);
 	}
+
+	auto cur = f->Tell();
+	f->Seek(offsetEntityTable);
+	f->Write(entityTable.data(), entityTable.size() * sizeof(entityTable.front()));
+	f->Seek(cur);
 }
 
 bool pragma::asset::WorldData::SaveLightmapAtlas(const std::string &mapName)
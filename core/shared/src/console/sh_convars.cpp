@@ -19,6 +19,8 @@
 #include <sharedutils/util_file.h>
 #include <pragma/engine_version.h>
 #include <pragma/asset/util_asset.hpp>
+#include <pragma/debug/debug_benchmarks.hpp>
+#include <pragma/entities/components/base_ai_component.hpp>
 #include <map>
 
 #define DLLSPEC_ISTEAMWORKS DLLNETWORK
@@ -50,7 +52,24 @@ REGISTER_ENGINE_CONVAR(sh_mount_external_game_resources, udm::Type::Boolean, "1"
 REGISTER_ENGINE_CONVAR(sh_lua_remote_debugging, udm::Type::UInt8, "0", ConVarFlags::Archive,
   "0 = Remote debugging is disabled; 1 = Remote debugging is enabled serverside; 2 = Remote debugging is enabled clientside.\nCannot be changed during an active game. Also requires the \"-luaext\" launch parameter.\nRemote debugging cannot be enabled clientside and serverside at the same time.");
 REGISTER_ENGINE_CONVAR(lua_open_editor_on_error, udm::Type::Boolean, "1", ConVarFlags::Archive, "1 = Whenever there's a Lua error, the engine will attempt to automatically open a Lua IDE and open the file and line which caused the error.");
+REGISTER_ENGINE_CONVAR(sh_animation_update_multithreaded, udm::Type::Boolean, "0", ConVarFlags::Archive,
+  "If enabled, entity animations will be updated in parallel on the animation worker threads. Animation drivers, constraints and animation events are still executed on the main thread afterwards.");
+REGISTER_ENGINE_CONVAR(sh_animation_lod_enabled, udm::Type::Boolean, "0", ConVarFlags::Archive,
+  "If enabled, animated entities that are far away from all players, or outside of their potentially visible set, are updated at a lower rate. Throttled entities keep their animation timing and events.");
+REGISTER_ENGINE_CONVAR(sh_animation_lod_reduced_distance, udm::Type::Float, "1024", ConVarFlags::Archive, "Distance to the nearest player beyond which animations are updated at the rate of sh_animation_lod_reduced_interval, with interpolated poses in between.");
+REGISTER_ENGINE_CONVAR(sh_animation_lod_cached_distance, udm::Type::Float, "3072", ConVarFlags::Archive,
+  "Distance to the nearest player beyond which animations are updated at the rate of sh_animation_lod_cached_interval, with the last pose being re-used in between. This also applies to entities that aren't potentially visible to any player.");
+REGISTER_ENGINE_CONVAR(sh_animation_lod_reduced_interval, udm::Type::UInt8, "2", ConVarFlags::Archive, "Number of ticks between animation updates for entities in the reduced animation LOD tier.");
+REGISTER_ENGINE_CONVAR(sh_animation_lod_cached_interval, udm::Type::UInt8, "8", ConVarFlags::Archive, "Number of ticks between animation updates for entities in the cached animation LOD tier.");
 REGISTER_ENGINE_CONVAR(steam_steamworks_enabled, udm::Type::Boolean, "1", ConVarFlags::Archive, "Enables or disables steamworks.");
+REGISTER_ENGINE_CONVAR(sh_tick_sleep_mode, udm::Type::UInt8, "1", ConVarFlags::Archive,
+  "Determines whether the main loop sleeps until the next tick instead of busy-waiting. 0 = Never sleep, 1 = Only sleep on dedicated servers, 2 = Always sleep (caps the client frame rate to the tick rate).");
+REGISTER_ENGINE_CONVAR(sh_tick_sleep_spin_time, udm::Type::UInt32, "1000", ConVarFlags::Archive,
+  "Time in microseconds before the next tick at which the main loop stops sleeping and spins instead. Higher values improve tick precision on systems with a coarse sleep granularity, at the cost of CPU time.");
+REGISTER_ENGINE_CONVAR(sh_tick_sleep_wake_on_network, udm::Type::Boolean, "1", ConVarFlags::Archive, "If enabled, a sleeping main loop will wake up early to process incoming network packets.");
+REGISTER_ENGINE_CONVAR(sh_nav_path_workers, udm::Type::UInt8, "2", ConVarFlags::Archive, "Number of worker threads which resolve NPC path queries. Changes take effect once the navigation mesh has been reloaded.");
+REGISTER_ENGINE_CONVAR(sh_nav_path_slice_iterations, udm::Type::UInt32, "256", ConVarFlags::Archive,
+  "Maximum number of search iterations a path query may run before other pending queries get their turn. Changes take effect once the navigation mesh has been reloaded.");
 static void cvar_steam_steamworks_enabled(bool val)
 {
 	static std::weak_ptr<util::Library> wpSteamworks = {};
@@ -316,6 +335,57 @@ static void debug_profiling_print(NetworkState *, pragma::BasePlayerComponent *,
 }
 REGISTER_ENGINE_CONCOMMAND(debug_profiling_print, debug_profiling_print, ConVarFlags::None, "Prints the last profiled times.");
 
+static void debug_tick_statistics(NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv)
+{
+	auto &profiler = engine->GetProfiler();
+	if(argv.empty() == false && argv.front() == "reset") {
+		profiler.ResetTickStatistics();
+		return;
+	}
+	auto &stats = profiler.GetTickStatistics();
+	auto toMs = [](std::chrono::nanoseconds t) { return util::round_string(std::chrono::duration<double, std::milli> {t}.count(), 3) + " ms"; };
+	Con::cout << "-------- Tick Statistics --------" << Con::endl;
+	Con::cout << "Ticks: " << stats.tickCount << Con::endl;
+	Con::cout << "Overruns: " << stats.overrunCount << Con::endl;
+	Con::cout << "Skipped ticks: " << stats.skippedTickCount << Con::endl;
+	Con::cout << "Last jitter: " << toMs(stats.lastJitter) << Con::endl;
+	Con::cout << "Average jitter: " << toMs(stats.GetAverageJitter()) << Con::endl;
+	Con::cout << "Max jitter: " << toMs(stats.maxJitter) << Con::endl;
+	Con::cout << "---------------------------------" << Con::endl;
+}
+REGISTER_ENGINE_CONCOMMAND(debug_tick_statistics, debug_tick_statistics, ConVarFlags::None, "Prints how accurately the main loop meets its tick deadlines. Use 'debug_tick_statistics reset' to reset the statistics.");
+
+static void debug_nav_path_statistics(NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv)
+{
+	auto &pathService = pragma::BaseAIComponent::GetPathService();
+	if(pathService == nullptr) {
+		Con::cwar << "No navigation mesh has been loaded!" << Con::endl;
+		return;
+	}
+	if(argv.empty() == false && argv.front() == "reset") {
+		pathService->ResetStatistics();
+		return;
+	}
+	auto stats = pathService->GetStatistics();
+	auto toMs = [](std::chrono::nanoseconds t) { return util::round_string(std::chrono::duration<double, std::milli> {t}.count(), 3) + " ms"; };
+	auto numResolved = stats.completedCount + stats.failedCount;
+	auto elapsed = std::chrono::duration<double> {stats.elapsed}.count();
+	Con::cout << "-------- Path Statistics --------" << Con::endl;
+	Con::cout << "Workers: " << pathService->GetSettings().workerCount << Con::endl;
+	Con::cout << "Requests: " << stats.requestCount << Con::endl;
+	Con::cout << "Coalesced requests: " << stats.coalescedCount << Con::endl;
+	Con::cout << "Completed: " << stats.completedCount << Con::endl;
+	Con::cout << "Failed: " << stats.failedCount << Con::endl;
+	Con::cout << "Discarded: " << stats.discardedCount << Con::endl;
+	Con::cout << "Pending: " << stats.pendingCount << Con::endl;
+	Con::cout << "Slices: " << stats.sliceCount << Con::endl;
+	Con::cout << "Average latency: " << toMs((numResolved > 0) ? stats.totalLatency / static_cast<int64_t>(numResolved) : std::chrono::steady_clock::duration {0}) << Con::endl;
+	Con::cout << "Max latency: " << toMs(stats.maxLatency) << Con::endl;
+	Con::cout << "Throughput: " << util::round_string((elapsed > 0.0) ? numResolved / elapsed : 0.0, 2) << " paths/s" << Con::endl;
+	Con::cout << "---------------------------------" << Con::endl;
+}
+REGISTER_ENGINE_CONCOMMAND(debug_nav_path_statistics, debug_nav_path_statistics, ConVarFlags::None, "Prints the latency and throughput of NPC path queries. Use 'debug_nav_path_statistics reset' to reset the statistics.");
+
 static void debug_profiling_physics_start(NetworkState *nw, pragma::BasePlayerComponent *, std::vector<std::string> &)
 {
 	auto *game = nw->GetGameState();
@@ -336,6 +406,79 @@ static void debug_profiling_physics_end(NetworkState *nw, pragma::BasePlayerComp
 }
 REGISTER_ENGINE_CONCOMMAND(debug_profiling_physics_end, debug_profiling_physics_end, ConVarFlags::None, "Prints physics profiling information for the last simulation step.");
 
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_timers,
+  [](NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto numTimers = argv.empty() ? 100'000u : util::to_uint(argv.front());
+	  pragma::debug::benchmark_timers(numTimers);
+  },
+  ConVarFlags::None, "Compares the timing wheel used for game timers against a linear scan over all timers (scheduling only, without timer objects or callbacks). Usage: debug_benchmark_timers <numTimers>");
+
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_entity_spawn,
+  [](NetworkState *nw, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto *game = nw ? nw->GetGameState() : nullptr;
+	  if(game == nullptr) {
+		  Con::cwar << "No active game!" << Con::endl;
+		  return;
+	  }
+	  auto numEntities = argv.empty() ? 1'000u : util::to_uint(argv.front());
+	  pragma::debug::benchmark_entity_spawn(*game, numEntities);
+  },
+  ConVarFlags::None, "Measures the cost of creating, spawning, broadcasting events to and removing entities with 20+ components, with and without the component event routing. Usage: debug_benchmark_entity_spawn <numEntities>");
+
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_entity_spatial_queries,
+  [](NetworkState *nw, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto *game = nw ? nw->GetGameState() : nullptr;
+	  if(game == nullptr) {
+		  Con::cwar << "No active game!" << Con::endl;
+		  return;
+	  }
+	  auto numEntities = (argv.size() > 0) ? util::to_uint(argv[0]) : 10'000u;
+	  auto numQueries = (argv.size() > 1) ? util::to_uint(argv[1]) : 1'000u;
+	  pragma::debug::benchmark_entity_spatial_queries(*game, numEntities, numQueries);
+  },
+  ConVarFlags::None, "Compares entity sphere queries through the spatial index against testing every entity. Usage: debug_benchmark_entity_spatial_queries <numEntities> <numQueries>");
+
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_job_system,
+  [](NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto numItems = (argv.size() > 0) ? util::to_uint(argv[0]) : 100'000u;
+	  auto grainSize = (argv.size() > 1) ? util::to_uint(argv[1]) : 64u;
+	  pragma::debug::benchmark_job_system(numItems, grainSize);
+  },
+  ConVarFlags::None, "Compares the job system against a thread pool with one task per batch. Usage: debug_benchmark_job_system <numItems> <grainSize>");
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_water_surface,
+  [](NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto numSteps = (argv.size() > 1) ? util::to_uint(argv[1]) : 50u;
+	  if(argv.size() > 0) {
+		  pragma::debug::benchmark_water_surface(util::to_uint(argv[0]), numSteps);
+		  return;
+	  }
+	  pragma::debug::benchmark_water_surface(256, numSteps);
+	  pragma::debug::benchmark_water_surface(1'024, numSteps);
+  },
+  ConVarFlags::None, "Compares the previous water surface simulation against the multi-threaded stencil solver. Runs a 256x256 and a 1024x1024 grid if no size is specified. Usage: debug_benchmark_water_surface <gridSize> <numSteps>");
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_render_queue,
+  [](NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto numItems = (argv.size() > 0) ? util::to_uint(argv[0]) : 50'000u;
+	  auto itemsPerJob = (argv.size() > 1) ? util::to_uint(argv[1]) : 64u;
+	  pragma::debug::benchmark_render_queue(numItems, itemsPerJob);
+  },
+  ConVarFlags::None, "Compares building and sorting render queues with a mutex and a comparison sort against per-worker buffers and a radix sort, using synthetic items. Usage: debug_benchmark_render_queue <numItems> <itemsPerJob>");
+
+REGISTER_ENGINE_CONCOMMAND(
+  debug_benchmark_bone_hierarchy,
+  [](NetworkState *, pragma::BasePlayerComponent *, std::vector<std::string> &argv) {
+	  auto numBones = (argv.size() > 0) ? util::to_uint(argv[0]) : 200u;
+	  auto numIterations = (argv.size() > 1) ? util::to_uint(argv[1]) : 10'000u;
+	  pragma::debug::benchmark_bone_hierarchy(numBones, numIterations);
+  },
+  ConVarFlags::None, "Compares the recursive bone hierarchy evaluation against the structure-of-arrays pose, using a synthetic skeleton. Usage: debug_benchmark_bone_hierarchy <numBones> <numIterations>");
+
 //////////////// SERVER ////////////////
 
 REGISTER_SHARED_CONVAR(rcon_password, udm::Type::String, "", ConVarFlags::Password, "Specifies a password which can be used to run console commands remotely on a server. If no password is specified, this feature is disabled.");
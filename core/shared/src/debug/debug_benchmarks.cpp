@@ -0,0 +1,635 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan */
+
+#include "stdafx_shared.h"
+#include "pragma/debug/debug_benchmarks.hpp"
+#include "pragma/util/timing_wheel.hpp"
+#include "pragma/game/game.h"
+#include "pragma/entities/baseentity.h"
+#include "pragma/entities/entity_component_manager.hpp"
+#include "pragma/entities/entity_iterator.hpp"
+#include "pragma/entities/components/base_transform_component.hpp"
+#include "pragma/entities/components/basetoggle.h"
+#include "pragma/util/job_system.hpp"
+#include "pragma/util/util_thread_pool.hpp"
+#include "pragma/physics/phys_water_surface_simulator.hpp"
+#include "pragma/physics/phys_liquid.hpp"
+#include "pragma/util/radix_sort.hpp"
+#include "pragma/model/animation/skeleton.hpp"
+#include "pragma/model/animation/bone.hpp"
+#include "pragma/model/animation/soa_pose.hpp"
+#include "pragma/engine.h"
+#include <sharedutils/ctpl_stl.h>
+#include <sharedutils/util_string.h>
+#include <sharedutils/scope_guard.h>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <mutex>
+#include <memory>
+#include <array>
+#include <algorithm>
+
+static double to_ms(std::chrono::steady_clock::duration d) { return std::chrono::duration<double, std::milli>(d).count(); }
+
+void pragma::debug::benchmark_timers(uint32_t numTimers)
+{
+	// Simulates 10 seconds of game time at 60 ticks per second. Timers are due within the first 5 seconds
+	// and every fourth timer is removed before it expires.
+	// Note: The linear scan is a simplified model of the previous Game::UpdateTimers, which also called Timer::Update
+	// for every timer. Timer objects and callbacks are left out on both sides.
+	constexpr double tickRate = 60.0;
+	constexpr uint32_t numTicks = 600;
+	constexpr double ticksPerSecond = 1'000.0;
+	std::mt19937 rng {123};
+	std::uniform_real_distribution<double> dis {0.0, 5.0};
+	std::vector<double> delays(numTimers);
+	for(auto &d : delays)
+		d = dis(rng);
+
+	// Linear scan (model of the previous implementation)
+	struct LinearTimer {
+		double next = 0.0;
+		bool valid = true;
+	};
+	size_t numCalledLinear = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	{
+		std::vector<std::unique_ptr<LinearTimer>> timers;
+		timers.reserve(numTimers);
+		for(auto d : delays)
+			timers.push_back(std::make_unique<LinearTimer>(LinearTimer {d}));
+		for(auto i = decltype(numTimers) {0u}; i < numTimers; i += 4)
+			timers[i]->valid = false;
+		for(auto tick = decltype(numTicks) {0u}; tick < numTicks; ++tick) {
+			for(size_t i = 0; i < timers.size();) {
+				auto &timer = *timers[i];
+				if(timer.valid == false) {
+					timers.erase(timers.begin() + i);
+					continue;
+				}
+				timer.next -= 1.0 / tickRate;
+				if(timer.next <= 0.0) {
+					++numCalledLinear;
+					timer.valid = false;
+				}
+				++i;
+			}
+		}
+	}
+	auto tLinear = std::chrono::steady_clock::now() - t0;
+
+	// Timing wheel
+	size_t numCalledWheel = 0;
+	t0 = std::chrono::steady_clock::now();
+	{
+		pragma::TimingWheel wheel {};
+		std::vector<std::unique_ptr<pragma::TimingWheel::Node>> timers;
+		timers.reserve(numTimers);
+		for(auto d : delays) {
+			timers.push_back(std::make_unique<pragma::TimingWheel::Node>());
+			wheel.Schedule(*timers.back(), static_cast<uint64_t>(std::ceil(d * ticksPerSecond)));
+		}
+		for(auto i = decltype(numTimers) {0u}; i < numTimers; i += 4)
+			timers[i]->Unschedule();
+		std::vector<pragma::TimingWheel::Node *> expired;
+		auto clock = 0.0;
+		for(auto tick = decltype(numTicks) {0u}; tick < numTicks; ++tick) {
+			clock += 1.0 / tickRate;
+			expired.clear();
+			wheel.Advance(static_cast<uint64_t>(clock * ticksPerSecond), expired);
+			numCalledWheel += expired.size();
+		}
+	}
+	auto tWheel = std::chrono::steady_clock::now() - t0;
+
+	Con::cout << "Timer scheduling benchmark (" << numTimers << " timers, " << numTicks << " ticks, data structures only):" << Con::endl;
+	Con::cout << "Linear scan (model): " << util::round_string(to_ms(tLinear), 2) << " ms (" << numCalledLinear << " calls)" << Con::endl;
+	Con::cout << "Timing wheel: " << util::round_string(to_ms(tWheel), 2) << " ms (" << numCalledWheel << " calls)" << Con::endl;
+}
+
+void pragma::debug::benchmark_entity_spawn(Game &game, uint32_t numEntities)
+{
+	// Components that are available on both the server and the client and don't require any additional setup
+	constexpr std::array<const char *, 28> componentNames = {"transform", "model", "animated", "physics", "render", "color", "surface", "radius", "name", "observable", "sound_emitter", "health", "damageable", "velocity", "gravity", "io", "usable",
+	  "submergible", "flammable", "attachment", "child", "parent", "logic", "origin", "panima", "composite", "score", "field_angle"};
+	auto &componentManager = game.GetEntityComponentManager();
+	std::vector<pragma::ComponentId> componentIds;
+	componentIds.reserve(componentNames.size());
+	for(auto *name : componentNames) {
+		pragma::ComponentId id;
+		if(componentManager.GetComponentTypeId(name, id, false))
+			componentIds.push_back(id);
+	}
+
+	// Broadcasts an event that none of the components handle, which is where the event routing makes the largest difference
+	constexpr uint32_t numBroadcasts = 10;
+	struct Result {
+		size_t numEntities = 0;
+		std::chrono::steady_clock::duration create {};
+		std::chrono::steady_clock::duration spawn {};
+		std::chrono::steady_clock::duration broadcast {};
+		std::chrono::steady_clock::duration remove {};
+	};
+	auto run = [&game, &componentIds, numEntities]() -> Result {
+		Result result {};
+		std::vector<EntityHandle> ents;
+		ents.reserve(numEntities);
+		auto t0 = std::chrono::steady_clock::now();
+		for(auto i = decltype(numEntities) {0u}; i < numEntities; ++i) {
+			auto *ent = game.CreateEntity("entity");
+			if(ent == nullptr)
+				continue;
+			for(auto id : componentIds)
+				ent->AddComponent(id);
+			ents.push_back(ent->GetHandle());
+		}
+		result.create = std::chrono::steady_clock::now() - t0;
+
+		t0 = std::chrono::steady_clock::now();
+		for(auto &hEnt : ents) {
+			if(hEnt.valid())
+				hEnt->Spawn();
+		}
+		result.spawn = std::chrono::steady_clock::now() - t0;
+
+		t0 = std::chrono::steady_clock::now();
+		for(auto &hEnt : ents) {
+			if(!hEnt.valid())
+				continue;
+			for(uint32_t i = 0; i < numBroadcasts; ++i)
+				hEnt->BroadcastEvent(pragma::BaseToggleComponent::EVENT_ON_TURN_ON);
+		}
+		result.broadcast = std::chrono::steady_clock::now() - t0;
+
+		t0 = std::chrono::steady_clock::now();
+		for(auto &hEnt : ents) {
+			if(hEnt.valid())
+				hEnt->Remove();
+		}
+		result.remove = std::chrono::steady_clock::now() - t0;
+		result.numEntities = ents.size();
+		return result;
+	};
+
+	// Old routing: Every component receives every broadcasted event
+	auto wasRoutingEnabled = componentManager.IsEventRoutingEnabled();
+	componentManager.SetEventRoutingEnabled(false);
+	auto resultAll = run();
+	// New routing: Components only receive the events they handle
+	componentManager.SetEventRoutingEnabled(true);
+	auto resultRouted = run();
+	componentManager.SetEventRoutingEnabled(wasRoutingEnabled);
+
+	Con::cout << "Entity spawn benchmark (" << resultRouted.numEntities << " entities, " << componentIds.size() << " components each):" << Con::endl;
+	auto print = [](const std::string &name, std::chrono::steady_clock::duration tAll, std::chrono::steady_clock::duration tRouted, size_t n) {
+		n = std::max<size_t>(n, 1);
+		Con::cout << name << ": " << util::round_string(to_ms(tAll) * 1'000.0 / n, 2) << " us per entity (all components) / " << util::round_string(to_ms(tRouted) * 1'000.0 / n, 2) << " us per entity (routed)" << Con::endl;
+	};
+	print("Create", resultAll.create, resultRouted.create, resultRouted.numEntities);
+	print("Spawn", resultAll.spawn, resultRouted.spawn, resultRouted.numEntities);
+	print("Broadcast x" + std::to_string(numBroadcasts), resultAll.broadcast, resultRouted.broadcast, resultRouted.numEntities);
+	print("Remove", resultAll.remove, resultRouted.remove, resultRouted.numEntities);
+}
+
+void pragma::debug::benchmark_entity_spatial_queries(Game &game, uint32_t numEntities, uint32_t numQueries)
+{
+	// Entities are distributed over an area the size of a typical map, queries have roughly the radius of a splash damage
+	const Vector3 worldMin {-4'096.f, 0.f, -4'096.f};
+	const Vector3 worldMax {4'096.f, 512.f, 4'096.f};
+	constexpr float queryRadius = 256.f;
+	std::mt19937 rng {123};
+	std::uniform_real_distribution<float> disX {worldMin.x, worldMax.x};
+	std::uniform_real_distribution<float> disY {worldMin.y, worldMax.y};
+	std::uniform_real_distribution<float> disZ {worldMin.z, worldMax.z};
+	std::uniform_real_distribution<float> disMove {-16.f, 16.f};
+
+	std::vector<EntityHandle> ents;
+	ents.reserve(numEntities);
+	for(auto i = decltype(numEntities) {0u}; i < numEntities; ++i) {
+		auto *ent = game.CreateEntity("entity");
+		if(ent == nullptr)
+			continue;
+		ent->AddComponent("transform");
+		auto *trComponent = ent->GetTransformComponent();
+		if(trComponent)
+			trComponent->SetPosition({disX(rng), disY(rng), disZ(rng)});
+		ent->Spawn();
+		ents.push_back(ent->GetHandle());
+	}
+	util::ScopeGuard sg {[&ents]() {
+		for(auto &hEnt : ents) {
+			if(hEnt.valid())
+				hEnt->Remove();
+		}
+	}};
+	std::vector<Vector3> queryOrigins(numQueries);
+	for(auto &origin : queryOrigins)
+		origin = {disX(rng), disY(rng), disZ(rng)};
+
+	// Testing every entity (previous implementation)
+	size_t numHitsLinear = 0;
+	auto t0 = std::chrono::steady_clock::now();
+	for(auto &origin : queryOrigins) {
+		EntityIteratorFilterSphere filter {game, origin, queryRadius};
+		for(auto *ent : EntityIterator {game}) {
+			if(filter.ShouldPass(*ent, 0))
+				++numHitsLinear;
+		}
+	}
+	auto tLinear = std::chrono::steady_clock::now() - t0;
+
+	// Spatial index
+	auto runIndexedQueries = [&game, &queryOrigins]() -> size_t {
+		size_t numHits = 0;
+		for(auto &origin : queryOrigins) {
+			EntityIterator entIt {game};
+			entIt.AttachFilter<EntityIteratorFilterSphere>(origin, queryRadius);
+			for(auto it = entIt.begin(); it != entIt.end(); ++it)
+				++numHits;
+		}
+		return numHits;
+	};
+	// The first query links all newly created entities into the index
+	runIndexedQueries();
+	t0 = std::chrono::steady_clock::now();
+	auto numHitsIndexed = runIndexedQueries();
+	auto tIndexed = std::chrono::steady_clock::now() - t0;
+
+	// Spatial index with all entities moving before the queries, which includes the cost of updating the index
+	t0 = std::chrono::steady_clock::now();
+	for(auto &hEnt : ents) {
+		auto *trComponent = hEnt.valid() ? hEnt->GetTransformComponent() : nullptr;
+		if(trComponent)
+			trComponent->SetPosition(trComponent->GetPosition() + Vector3 {disMove(rng), disMove(rng), disMove(rng)});
+	}
+	auto tMove = std::chrono::steady_clock::now() - t0;
+	t0 = std::chrono::steady_clock::now();
+	auto numHitsMoving = runIndexedQueries();
+	auto tMoving = std::chrono::steady_clock::now() - t0;
+
+	Con::cout << "Entity spatial query benchmark (" << ents.size() << " entities, " << numQueries << " sphere queries with radius " << queryRadius << "):" << Con::endl;
+	Con::cout << "All entities: " << util::round_string(to_ms(tLinear), 2) << " ms (" << numHitsLinear << " hits)" << Con::endl;
+	Con::cout << "Spatial index: " << util::round_string(to_ms(tIndexed), 2) << " ms (" << numHitsIndexed << " hits)" << Con::endl;
+	Con::cout << "Spatial index after moving all entities: " << util::round_string(to_ms(tMoving), 2) << " ms (" << numHitsMoving << " hits, moving took " << util::round_string(to_ms(tMove), 2) << " ms)" << Con::endl;
+}
+
+void pragma::debug::benchmark_job_system(uint32_t numItems, uint32_t grainSize)
+{
+	grainSize = std::max(grainSize, 1u);
+	auto &jobSystem = pragma::get_engine()->GetJobSystem();
+	auto numThreads = jobSystem.GetWorkerCount();
+	// Small, uneven workload per item, similar to updating the animations of a single entity
+	std::vector<float> results(numItems);
+	auto work = [&results](uint32_t start, uint32_t end) {
+		for(auto i = start; i < end; ++i) {
+			auto v = static_cast<float>(i);
+			for(auto j = 0u; j < 64u + (i % 64u); ++j)
+				v = std::sin(v) + std::cos(v * 0.5f);
+			results[i] = v;
+		}
+	};
+	auto numBatches = (numItems + grainSize - 1) / grainSize;
+
+	// ctpl thread pool with one task per batch (previous implementation of the thread pool)
+	auto t0 = std::chrono::steady_clock::now();
+	{
+		ctpl::thread_pool pool {static_cast<int>(numThreads)};
+		std::vector<std::future<void>> futures;
+		futures.reserve(numBatches);
+		for(auto i = decltype(numBatches) {0u}; i < numBatches; ++i)
+			futures.push_back(pool.push([&work, i, grainSize, numItems](int) { work(i * grainSize, std::min(i * grainSize + grainSize, numItems)); }));
+		for(auto &f : futures)
+			f.wait();
+	}
+	auto tCtpl = std::chrono::steady_clock::now() - t0;
+
+	jobSystem.ResetStatistics();
+	t0 = std::chrono::steady_clock::now();
+	{
+		pragma::ThreadPool pool {numThreads, "benchmark"};
+		pool.BatchProcess(numItems, grainSize, [&work](uint32_t start, uint32_t end) -> pragma::ThreadPool::ResultHandler {
+			work(start, end);
+			return nullptr;
+		});
+		pool.WaitForCompletion();
+	}
+	auto tThreadPool = std::chrono::steady_clock::now() - t0;
+
+	t0 = std::chrono::steady_clock::now();
+	jobSystem.ParallelFor(numItems, grainSize, work);
+	auto tParallelFor = std::chrono::steady_clock::now() - t0;
+
+	// Every batch is a separate job, the final job depends on all of them
+	t0 = std::chrono::steady_clock::now();
+	{
+		auto finalJob = jobSystem.CreateJob([]() {});
+		for(auto i = decltype(numBatches) {0u}; i < numBatches; ++i) {
+			auto job = jobSystem.CreateJob([&work, i, grainSize, numItems]() { work(i * grainSize, std::min(i * grainSize + grainSize, numItems)); });
+			jobSystem.AddDependency(finalJob, job);
+			jobSystem.Submit(job);
+		}
+		jobSystem.Submit(finalJob);
+		jobSystem.Wait(finalJob);
+	}
+	auto tGraph = std::chrono::steady_clock::now() - t0;
+	auto stats = jobSystem.GetStatistics();
+
+	Con::cout << "Job system benchmark (" << numItems << " items, " << numBatches << " batches, " << numThreads << " workers):" << Con::endl;
+	Con::cout << "ctpl thread pool: " << util::round_string(to_ms(tCtpl), 2) << " ms" << Con::endl;
+	Con::cout << "Thread pool (job system): " << util::round_string(to_ms(tThreadPool), 2) << " ms" << Con::endl;
+	Con::cout << "Parallel for: " << util::round_string(to_ms(tParallelFor), 2) << " ms" << Con::endl;
+	Con::cout << "Task graph: " << util::round_string(to_ms(tGraph), 2) << " ms" << Con::endl;
+	Con::cout << "Jobs executed: " << stats.executedCount << ", stolen: " << stats.stolenCount << ", executed while waiting: " << stats.helpedCount << ", allocated: " << stats.allocatedJobCount << Con::endl;
+}
+
+namespace {
+	class BenchmarkWaterSurfaceSimulator : public PhysWaterSurfaceSimulator {
+	  public:
+		BenchmarkWaterSurfaceSimulator(uint32_t gridSize, uint32_t spacing, uint8_t edgeIterationCount)
+		    : PhysWaterSurfaceSimulator {Vector2 {0.f, 0.f}, Vector2 {static_cast<float>(gridSize * spacing), static_cast<float>(gridSize * spacing)}, 0.f, spacing, PHYS_LIQUID_DEFAULT_STIFFNESS, PHYS_LIQUID_DEFAULT_PROPAGATION}, m_edgeIterationCount {edgeIterationCount}
+		{
+		}
+	  protected:
+		virtual uint8_t GetEdgeIterationCount() const override { return m_edgeIterationCount; }
+	  private:
+		uint8_t m_edgeIterationCount = 0;
+	};
+};
+
+void pragma::debug::benchmark_water_surface(uint32_t gridSize, uint32_t numSteps)
+{
+	gridSize = std::max(gridSize, 2u);
+	constexpr uint32_t spacing = 10;
+	constexpr uint8_t edgeIterationCount = 5;
+	constexpr float dt = 0.01f;
+	constexpr float maxHeight = 100.f;
+	auto numParticles = static_cast<size_t>(gridSize) * gridSize;
+	auto splashOrigin = Vector3 {gridSize * spacing * 0.5f, 0.f, gridSize * spacing * 0.5f};
+	auto splashRadius = gridSize * spacing * 0.1f;
+	constexpr float splashForce = 50.f;
+
+	// Particle structs with an edge list, relaxed one edge at a time on a single thread (previous implementation)
+	struct Particle {
+		std::array<uint32_t, 4> neighbors;
+		float height = 0.f;
+		float oldHeight = 0.f;
+		float targetHeight = 0.f;
+		float velocity = 0.f;
+	};
+	struct Edge {
+		uint32_t index0;
+		uint32_t index1;
+	};
+	auto t0 = std::chrono::steady_clock::now();
+	float checksumAos = 0.f;
+	{
+		std::vector<Particle> particles(numParticles);
+		std::vector<float> threadHeights(numParticles);
+		std::vector<Edge> edges;
+		edges.reserve(numParticles * 4);
+		auto getIndex = [gridSize](uint32_t x, uint32_t y) { return y * gridSize + x; };
+		for(auto x = 0u; x < gridSize; ++x) {
+			for(auto y = 0u; y < gridSize; ++y) {
+				auto idx = getIndex(x, y);
+				if(y > 0)
+					edges.push_back({idx, getIndex(x, y - 1)});
+				if(y < gridSize - 1)
+					edges.push_back({idx, getIndex(x, y + 1)});
+				if(x > 0)
+					edges.push_back({idx, getIndex(x - 1, y)});
+				if(x < gridSize - 1)
+					edges.push_back({idx, getIndex(x + 1, y)});
+			}
+		}
+		auto setHeight = [&particles, &threadHeights, maxHeight](size_t idx, float h) {
+			particles.at(idx).height = std::min(h, maxHeight);
+			threadHeights.at(idx) = h;
+		};
+		for(auto step = 0u; step < numSteps; ++step) {
+			if(step == 0) {
+				for(size_t i = 0; i < particles.size(); ++i) {
+					auto pos = Vector3 {static_cast<float>((i / gridSize) * spacing), threadHeights.at(i), static_cast<float>((i % gridSize) * spacing)};
+					auto l = uvec::length(pos - splashOrigin);
+					if(l < splashRadius) {
+						auto &pt = particles.at(i);
+						pt.oldHeight = pt.height;
+						setHeight(i, pt.height + splashForce * (splashRadius - l) / splashRadius);
+					}
+				}
+			}
+			for(size_t i = 0; i < particles.size(); ++i)
+				setHeight(i, particles.at(i).height + dt * particles.at(i).velocity);
+			for(auto it = 0u; it < edgeIterationCount; ++it) {
+				for(auto &edge : edges) {
+					auto &pt0 = particles.at(edge.index0);
+					auto &pt1 = particles.at(edge.index1);
+					auto d = (pt1.height - pt0.height) * PHYS_LIQUID_DEFAULT_PROPAGATION;
+					setHeight(edge.index0, pt0.height + d);
+					setHeight(edge.index1, pt1.height - d);
+				}
+			}
+			for(size_t i = 0; i < particles.size(); ++i)
+				setHeight(i, particles.at(i).height + (particles.at(i).targetHeight - particles.at(i).height) * PHYS_LIQUID_DEFAULT_STIFFNESS);
+			for(auto &pt : particles) {
+				pt.velocity = (pt.height - pt.oldHeight) / dt;
+				pt.oldHeight = pt.height;
+			}
+		}
+		for(auto &pt : particles)
+			checksumAos += std::abs(pt.height);
+	}
+	auto tAos = std::chrono::steady_clock::now() - t0;
+
+	t0 = std::chrono::steady_clock::now();
+	float checksumSoa = 0.f;
+	{
+		BenchmarkWaterSurfaceSimulator sim {gridSize, spacing, edgeIterationCount};
+		sim.SetMaxWaveHeight(maxHeight);
+		sim.Initialize();
+		sim.CreateSplash(splashOrigin, splashRadius, splashForce);
+		for(auto step = 0u; step < numSteps; ++step) {
+			sim.Simulate(dt);
+			sim.WaitForSimulation();
+		}
+		sim.LockParticleHeights();
+		for(size_t i = 0; i < sim.GetParticleCount(); ++i)
+			checksumSoa += std::abs(sim.CalcParticlePosition(i).y);
+		sim.UnlockParticleHeights();
+	}
+	auto tSoa = std::chrono::steady_clock::now() - t0;
+
+	Con::cout << "Water surface benchmark (" << gridSize << "x" << gridSize << " particles, " << numSteps << " steps, " << static_cast<uint32_t>(edgeIterationCount) << " edge iterations, " << pragma::get_engine()->GetJobSystem().GetWorkerCount() << " workers):" << Con::endl;
+	Con::cout << "Particle structs with edge list: " << util::round_string(to_ms(tAos), 2) << " ms (" << util::round_string(to_ms(tAos) / numSteps, 3) << " ms per step, sum of heights: " << checksumAos << ")" << Con::endl;
+	Con::cout << "Particle arrays with red-black stencil: " << util::round_string(to_ms(tSoa), 2) << " ms (" << util::round_string(to_ms(tSoa) / numSteps, 3) << " ms per step, sum of heights: " << checksumSoa << ")" << Con::endl;
+}
+
+void pragma::debug::benchmark_render_queue(uint32_t numItems, uint32_t itemsPerJob)
+{
+	itemsPerJob = std::max(itemsPerJob, 1u);
+	auto &jobSystem = pragma::get_engine()->GetJobSystem();
+	auto numWorkers = jobSystem.GetWorkerCount();
+	// Synthetic render items with keys laid out like the opaque sorting keys of render queues (instantiable, distance, material, shader)
+	struct Item {
+		uint32_t entity;
+		uint32_t mesh;
+		uint64_t sortingKey;
+	};
+	std::mt19937 rng {123};
+	std::uniform_int_distribution<uint32_t> disMaterial {0, 499};
+	std::uniform_int_distribution<uint32_t> disShader {0, 31};
+	constexpr uint32_t meshesPerEntity = 4;
+	std::vector<Item> srcItems(numItems);
+	for(auto i = decltype(numItems) {0u}; i < numItems; ++i) {
+		uint64_t key = (i % 3 != 0) ? 1 : 0;
+		key |= static_cast<uint64_t>(disMaterial(rng)) << 33;
+		key |= static_cast<uint64_t>(disShader(rng)) << 49;
+		srcItems[i] = {i / meshesPerEntity, i % meshesPerEntity, key};
+	}
+	using SortPair = std::pair<uint32_t, uint64_t>;
+
+	// One mutex lock per item (previous implementation)
+	std::vector<Item> queue;
+	std::vector<SortPair> sortedItemIndices;
+	std::mutex queueMutex;
+	auto t0 = std::chrono::steady_clock::now();
+	jobSystem.ParallelFor(numItems, itemsPerJob, [&](uint32_t start, uint32_t end) {
+		for(auto i = start; i < end; ++i) {
+			std::scoped_lock lock {queueMutex};
+			queue.push_back(srcItems[i]);
+			sortedItemIndices.push_back({static_cast<uint32_t>(queue.size() - 1), srcItems[i].sortingKey});
+		}
+	});
+	auto tBuildMutex = std::chrono::steady_clock::now() - t0;
+
+	t0 = std::chrono::steady_clock::now();
+	std::sort(sortedItemIndices.begin(), sortedItemIndices.end(), [](const SortPair &a, const SortPair &b) { return a.second < b.second; });
+	auto tSortComparison = std::chrono::steady_clock::now() - t0;
+
+	// One append buffer per worker, merged once all items have been added. The calling thread isn't a worker and uses the last buffer.
+	queue.clear();
+	std::vector<std::vector<Item>> workerItems(numWorkers + 1);
+	t0 = std::chrono::steady_clock::now();
+	jobSystem.ParallelFor(numItems, itemsPerJob, [&](uint32_t start, uint32_t end) {
+		auto workerIndex = std::min(jobSystem.GetCurrentWorkerIndex(), numWorkers);
+		auto &items = workerItems[workerIndex];
+		for(auto i = start; i < end; ++i)
+			items.push_back(srcItems[i]);
+	});
+	queue.reserve(numItems);
+	for(auto &items : workerItems)
+		queue.insert(queue.end(), items.begin(), items.end());
+	auto tBuildWorkerBuffers = std::chrono::steady_clock::now() - t0;
+
+	sortedItemIndices.resize(queue.size());
+	for(size_t i = 0; i < queue.size(); ++i)
+		sortedItemIndices[i] = {static_cast<uint32_t>(i), queue[i].sortingKey};
+	std::vector<SortPair> sortBuffer;
+	t0 = std::chrono::steady_clock::now();
+	pragma::radix_sort(sortedItemIndices, sortBuffer, [](const SortPair &pair) { return pair.second; });
+	auto tSortRadix = std::chrono::steady_clock::now() - t0;
+
+	// Instancing requires the meshes of an entity to stay in the order they were added in if they share the same key
+	auto stable = true;
+	for(size_t i = 1; i < sortedItemIndices.size(); ++i) {
+		if(sortedItemIndices[i - 1].second == sortedItemIndices[i].second && sortedItemIndices[i - 1].first > sortedItemIndices[i].first) {
+			stable = false;
+			break;
+		}
+	}
+
+	Con::cout << "Render queue benchmark (" << numItems << " items, " << itemsPerJob << " items per job, " << numWorkers << " workers):" << Con::endl;
+	Con::cout << "Build with mutex per item: " << util::round_string(to_ms(tBuildMutex), 2) << " ms" << Con::endl;
+	Con::cout << "Build with worker buffers: " << util::round_string(to_ms(tBuildWorkerBuffers), 2) << " ms" << Con::endl;
+	Con::cout << "Comparison sort: " << util::round_string(to_ms(tSortComparison), 2) << " ms" << Con::endl;
+	Con::cout << "Radix sort: " << util::round_string(to_ms(tSortRadix), 2) << " ms (stable: " << (stable ? "yes" : "no") << ")" << Con::endl;
+}
+
+static void get_global_bone_transforms(std::vector<umath::ScaledTransform> &transforms, const std::unordered_map<pragma::animation::BoneId, std::shared_ptr<pragma::animation::Bone>> &childBones, const umath::ScaledTransform &tParent = {})
+{
+	for(auto &pair : childBones) {
+		auto &t = transforms[pair.first];
+		t.SetOrigin(t.GetOrigin() * tParent.GetScale());
+		t = tParent * t;
+		get_global_bone_transforms(transforms, pair.second->children, t);
+	}
+}
+void pragma::debug::benchmark_bone_hierarchy(uint32_t numBones, uint32_t numIterations)
+{
+	if(numBones == 0)
+		return;
+	// Random hierarchy in which every bone is attached to an earlier one, with up to four roots
+	std::mt19937 rng {123};
+	std::uniform_real_distribution<float> dis {-1.f, 1.f};
+	std::uniform_real_distribution<float> disScale {0.9f, 1.1f};
+	auto randomRotation = [&]() { return uquat::get_normal(Quat {dis(rng), dis(rng), dis(rng), dis(rng)}); };
+	pragma::animation::Skeleton skeleton {};
+	for(auto i = decltype(numBones) {0u}; i < numBones; ++i) {
+		auto *bone = new pragma::animation::Bone {};
+		auto id = skeleton.AddBone(bone);
+		auto &pBone = skeleton.GetBones()[id];
+		if(id < 4) {
+			skeleton.GetRootBones()[id] = pBone;
+			continue;
+		}
+		auto parentId = std::uniform_int_distribution<uint32_t> {0u, id - 1}(rng);
+		auto &parent = skeleton.GetBones()[parentId];
+		pBone->parent = parent;
+		parent->children[id] = pBone;
+	}
+	std::vector<umath::ScaledTransform> localPoses(numBones);
+	std::vector<umath::ScaledTransform> targetPoses(numBones);
+	std::vector<umath::Transform> bindPoses(numBones);
+	for(uint32_t i = 0; i < numBones; ++i) {
+		localPoses[i] = {Vector3 {dis(rng), dis(rng), dis(rng)}, randomRotation(), Vector3 {disScale(rng), disScale(rng), disScale(rng)}};
+		targetPoses[i] = {Vector3 {dis(rng), dis(rng), dis(rng)}, randomRotation(), Vector3 {disScale(rng), disScale(rng), disScale(rng)}};
+		bindPoses[i] = {Vector3 {dis(rng), dis(rng), dis(rng)}, randomRotation()};
+	}
+	constexpr float blendFactor = 0.3f;
+
+	// Per-bone blend, recursive composition and per-bone skinning matrices (previous implementation)
+	std::vector<umath::ScaledTransform> poses;
+	std::vector<Mat4> matrices(numBones);
+	auto t0 = std::chrono::steady_clock::now();
+	for(auto it = decltype(numIterations) {0u}; it < numIterations; ++it) {
+		poses = localPoses;
+		for(uint32_t i = 0; i < numBones; ++i)
+			poses[i].Interpolate(targetPoses[i], blendFactor);
+		get_global_bone_transforms(poses, skeleton.GetRootBones());
+		for(uint32_t i = 0; i < numBones; ++i)
+			matrices[i] = poses[i].ToMatrix() * bindPoses[i].GetInverse().ToMatrix();
+	}
+	auto tScalar = std::chrono::steady_clock::now() - t0;
+
+	pragma::animation::SoaPose pose {};
+	pragma::animation::SoaPose targetPose {};
+	pose.Initialize(skeleton);
+	targetPose.Initialize(skeleton);
+	targetPose.SetLocalPoses(targetPoses);
+	pose.SetBindPoses(bindPoses);
+	std::vector<Mat4> soaMatrices(numBones);
+	t0 = std::chrono::steady_clock::now();
+	for(auto it = decltype(numIterations) {0u}; it < numIterations; ++it) {
+		pose.SetLocalPoses(localPoses);
+		pose.Blend(targetPose, blendFactor);
+		pose.ComputeGlobalPoses();
+		pose.ComputeSkinningMatrices(soaMatrices);
+	}
+	auto tSoa = std::chrono::steady_clock::now() - t0;
+
+	// Blending uses nlerp instead of slerp, so the results only match approximately
+	auto maxError = 0.f;
+	for(uint32_t i = 0; i < numBones; ++i) {
+		for(uint8_t c = 0; c < 4; ++c) {
+			for(uint8_t r = 0; r < 4; ++r)
+				maxError = umath::max(maxError, umath::abs(matrices[i][c][r] - soaMatrices[i][c][r]));
+		}
+	}
+
+	Con::cout << "Bone hierarchy benchmark (" << numBones << " bones, " << numIterations << " iterations):" << Con::endl;
+	Con::cout << "Recursive: " << util::round_string(to_ms(tScalar), 2) << " ms" << Con::endl;
+	Con::cout << "Structure of arrays: " << util::round_string(to_ms(tSoa), 2) << " ms (max. matrix deviation: " << maxError << ")" << Con::endl;
+}
@@ -7,6 +7,7 @@
 
 #include "stdafx_shared.h"
 #include "pragma/debug/debug_performance_profiler.hpp"
+#include <algorithm>
 
 using namespace pragma::debug;
 
@@ -91,3 +92,23 @@ bool ProfilingStage::Stop() { return GetTimer().Stop(); }
 /////////////////
 
 std::shared_ptr<pragma::debug::Timer> CPUProfiler::CreateTimer() { return CPUTimer::Create(); }
+void CPUProfiler::RecordTick(std::chrono::nanoseconds jitter, std::chrono::nanoseconds tickInterval)
+{
+	jitter = std::max(jitter, std::chrono::nanoseconds {0});
+	++m_tickStatistics.tickCount;
+	if(jitter >= tickInterval)
+		++m_tickStatistics.overrunCount;
+	m_tickStatistics.lastJitter = jitter;
+	m_tickStatistics.maxJitter = std::max(m_tickStatistics.maxJitter, jitter);
+	m_tickStatistics.totalJitter += jitter;
+}
+void CPUProfiler::RecordSkippedTicks(uint64_t count) { m_tickStatistics.skippedTickCount += count; }
+const TickStatistics &CPUProfiler::GetTickStatistics() const { return m_tickStatistics; }
+void CPUProfiler::ResetTickStatistics() { m_tickStatistics = {}; }
+
+std::chrono::nanoseconds TickStatistics::GetAverageJitter() const
+{
+	if(tickCount == 0)
+		return std::chrono::nanoseconds {0};
+	return totalJitter / tickCount;
+}
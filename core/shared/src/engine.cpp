@@ -31,6 +31,7 @@
 #include <util_zip.h>
 #include <pragma/game/game_resources.hpp>
 #include <pragma/util/resource_watcher.h>
+#include <pragma/util/job_system.hpp>
 #include <util_pad.hpp>
 #include <material_manager2.hpp>
 #include <pragma/networking/iserver.hpp>
@@ -131,6 +132,7 @@ Engine::Engine(int, char *[]) : CVarHandler(), m_logFile(nullptr), m_tickRate(En
 	// Link package system to file system
 	m_padPackageManager = upad::link_to_file_system();
 	m_assetManager = std::make_unique<pragma::asset::AssetManager>();
+	m_jobSystem = std::make_unique<pragma::JobSystem>();
 
 	RegisterCallback<void>("Think");
 
@@ -149,6 +151,7 @@ Engine::Engine(int, char *[]) : CVarHandler(), m_logFile(nullptr), m_tickRate(En
 
 pragma::asset::AssetManager &Engine::GetAssetManager() { return *m_assetManager; }
 const pragma::asset::AssetManager &Engine::GetAssetManager() const { return const_cast<Engine *>(this)->GetAssetManager(); }
+pragma::JobSystem &Engine::GetJobSystem() { return *m_jobSystem; }
 
 void Engine::ClearConsole() { std::system("cls"); }
 
@@ -902,7 +905,8 @@ void Engine::Start()
 	//const double FRAMES_PER_SECOND = GetTickRate();
 	//const double SKIP_TICKS = 1000 /FRAMES_PER_SECOND;
 	const int MAX_FRAMESKIP = 5;
-	long long nextTick = GetTickCount();
+	using Clock = std::chrono::steady_clock;
+	auto nextTick = Clock::now();
 	int loops;
 	do {
 		StartProfilingStage(CPUProfilingPhase::Think);
@@ -911,22 +915,72 @@ void Engine::Start()
 
 		loops = 0;
 		auto tickRate = GetTickRate();
-		auto skipTicks = static_cast<long long>(1'000 / tickRate);
+		auto skipTicks = std::chrono::milliseconds {1'000 / tickRate};
 
-		auto t = GetTickCount();
+		auto t = Clock::now();
 		while(t > nextTick && loops < MAX_FRAMESKIP) {
+			m_cpuProfiler->RecordTick(Clock::now() - nextTick, skipTicks);
 			Tick();
 
 			m_lastTick = static_cast<long long>(m_ctTick());
 			nextTick += skipTicks; //SKIP_TICKS);
 			loops++;
 		}
-		if(t > nextTick)
-			nextTick = t; // This should only happen after loading times
+		if(t > nextTick) {
+			// This should only happen after loading times
+			m_cpuProfiler->RecordSkippedTicks((t - nextTick) / skipTicks);
+			nextTick = t;
+		}
+		if(ShouldSleepBetweenTicks())
+			WaitForNextTick(nextTick);
 	} while(IsRunning());
 	Close();
 }
 
+static auto cvTickSleepMode = GetConVar("sh_tick_sleep_mode");
+static auto cvTickSleepSpinTime = GetConVar("sh_tick_sleep_spin_time");
+static auto cvTickSleepWakeOnNetwork = GetConVar("sh_tick_sleep_wake_on_network");
+bool Engine::ShouldSleepBetweenTicks()
+{
+	switch(cvTickSleepMode->GetInt()) {
+	case 0:
+		return false;
+	case 1:
+		// The client has to render frames in between ticks
+		return IsServerOnly();
+	default:
+		return true;
+	}
+}
+
+void Engine::WaitForNextTick(std::chrono::steady_clock::time_point deadline)
+{
+	// OS sleeps are too coarse to hit the deadline precisely, so we wake up a little early and spin for the remainder
+	auto spinTime = std::chrono::microseconds {cvTickSleepSpinTime->GetInt()};
+	auto wokenUp = false;
+	if(cvTickSleepWakeOnNetwork->GetBool()) {
+		std::unique_lock lock {m_mainLoopWakeMutex};
+		m_mainLoopWakeCondition.wait_until(lock, deadline - spinTime, [this]() { return m_mainLoopWakeRequested; });
+		wokenUp = m_mainLoopWakeRequested;
+		m_mainLoopWakeRequested = false;
+	}
+	else
+		std::this_thread::sleep_until(deadline - spinTime);
+	if(wokenUp)
+		return; // Events will be handled by the next Think, after which we'll go back to sleep
+	while(std::chrono::steady_clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+void Engine::WakeMainLoop()
+{
+	{
+		std::scoped_lock lock {m_mainLoopWakeMutex};
+		m_mainLoopWakeRequested = true;
+	}
+	m_mainLoopWakeCondition.notify_one();
+}
+
 void Engine::UpdateTickCount() { m_ctTick.Update(); }
 
 #ifdef _WIN32
@@ -1090,7 +1144,11 @@ bool Engine::IsActiveState(NetworkState *state) { return state == GetActiveState
 
 void Engine::AddLaunchConVar(std::string cvar, std::string val) { m_launchCommands.push_back({cvar, {val}}); }
 
-void Engine::ShutDown() { umath::set_flag(m_stateFlags, StateFlags::Running, false); }
+void Engine::ShutDown()
+{
+	umath::set_flag(m_stateFlags, StateFlags::Running, false);
+	WakeMainLoop();
+}
 
 void Engine::HandleLocalHostPlayerClientPacket(NetPacket &p) {}
 void Engine::HandleLocalHostPlayerServerPacket(NetPacket &p) { return GetServerStateInterface().handle_local_host_player_server_packet(p); }
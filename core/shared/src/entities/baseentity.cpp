@@ -22,6 +22,7 @@
 #include "pragma/entities/baseentity_events.hpp"
 #include "pragma/entities/entity_component_system_t.hpp"
 #include "pragma/util/global_string_table.hpp"
+#include "pragma/entities/entity_lookup_index.hpp"
 
 void BaseEntity::SetEnabled(bool enabled)
 {
@@ -143,10 +144,12 @@ void BaseEntity::OnRemove()
 	ClearComponents();
 	pragma::BaseLuaHandle::InvalidateHandle();
 
-	auto &uuidMap = GetNetworkState()->GetGameState()->GetEntityUuidMap();
+	auto *game = GetNetworkState()->GetGameState();
+	auto &uuidMap = game->GetEntityUuidMap();
 	auto it = uuidMap.find(util::get_uuid_hash(m_uuid));
-	if(it != uuidMap.end())
+	if(it != uuidMap.end() && it->second == this)
 		uuidMap.erase(it);
+	game->GetEntityClassIndex().Remove(m_className.c_str(), *this);
 }
 
 void BaseEntity::Construct(unsigned int idx)
@@ -182,7 +185,7 @@ void BaseEntity::SetKeyValue(std::string key, std::string val)
 	if(key == "spawnflags")
 		m_spawnFlags = util::to_int(val);
 	else if(key == "uuid")
-		m_uuid = util::uuid_string_to_bytes(val);
+		SetUuid(util::uuid_string_to_bytes(val));
 }
 void BaseEntity::SetSpawnFlags(uint32_t spawnFlags) { m_spawnFlags = spawnFlags; }
 unsigned int BaseEntity::GetSpawnFlags() const { return m_spawnFlags; }
@@ -218,7 +221,7 @@ void BaseEntity::SetUuid(const util::Uuid &uuid)
 {
 	auto &uuidMap = GetNetworkState()->GetGameState()->GetEntityUuidMap();
 	auto it = uuidMap.find(util::get_uuid_hash(m_uuid));
-	if(it != uuidMap.end())
+	if(it != uuidMap.end() && it->second == this)
 		uuidMap.erase(it);
 	m_uuid = uuid;
 	uuidMap[util::get_uuid_hash(m_uuid)] = this;
@@ -226,8 +229,10 @@ void BaseEntity::SetUuid(const util::Uuid &uuid)
 
 void BaseEntity::Initialize()
 {
-	auto &uuidMap = GetNetworkState()->GetGameState()->GetEntityUuidMap();
+	auto *game = GetNetworkState()->GetGameState();
+	auto &uuidMap = game->GetEntityUuidMap();
 	uuidMap[util::get_uuid_hash(m_uuid)] = this;
+	game->GetEntityClassIndex().Add(m_className.c_str(), *this);
 
 	InitializeLuaObject(GetLuaState());
 
@@ -236,6 +241,13 @@ void BaseEntity::Initialize()
 }
 
 pragma::GString BaseEntity::GetClass() const { return m_className; }
+void BaseEntity::SetClass(const std::string &className)
+{
+	auto &classIndex = GetNetworkState()->GetGameState()->GetEntityClassIndex();
+	classIndex.Remove(m_className.c_str(), *this);
+	m_className = pragma::ents::register_class_name(className);
+	classIndex.Add(m_className.c_str(), *this);
+}
 
 void BaseEntity::SetPose(const umath::Transform &outTransform)
 {
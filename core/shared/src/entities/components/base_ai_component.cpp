@@ -32,7 +32,7 @@
 using namespace pragma;
 
 decltype(BaseAIComponent::s_npcCount) BaseAIComponent::s_npcCount = {0};
-decltype(BaseAIComponent::s_navThread) BaseAIComponent::s_navThread = nullptr;
+decltype(BaseAIComponent::s_pathService) BaseAIComponent::s_pathService = nullptr;
 
 ai::navigation::PathQuery::PathQuery(const Vector3 &_start, const Vector3 &_end) : start(_start), end(_end), complete(false) {}
 
@@ -113,62 +113,23 @@ bool BaseAIComponent::TurnStep(const Vector3 &target, const float *turnSpeed)
 	return TurnStep(target, turnAngle, turnSpeed);
 }
 
-void BaseAIComponent::ReleaseNavThread()
-{
-	if(s_navThread == nullptr)
-		return;
-	s_navThread->running = false;
-	if(s_navThread->thread.joinable())
-		s_navThread->thread.join();
-	if(s_navThread->releaseCallback.IsValid())
-		s_navThread->releaseCallback.Remove();
-	s_navThread = nullptr;
-}
+void BaseAIComponent::ReleaseNavThread() { s_pathService = nullptr; }
 
 void BaseAIComponent::ReloadNavThread(Game &game)
 {
 	ReleaseNavThread();
 
-	auto wpNavMesh = std::weak_ptr<pragma::nav::Mesh>(game.GetNavMesh());
-	if(wpNavMesh.expired() == true)
+	auto &navMesh = game.GetNavMesh();
+	if(navMesh == nullptr)
 		return;
-	s_navThread = std::make_shared<ai::navigation::NavThread>();
-	auto cb = FunctionCallback<void>::Create(nullptr);
-	cb.get<Callback<void>>()->SetFunction([cb]() mutable {
-		if(cb.IsValid())
-			cb.Remove();
-	});
-	game.AddCallback("EndGame", cb);
-	s_navThread->releaseCallback = cb;
-
-	s_navThread->thread = std::thread([wpNavMesh]() {
-		while(s_navThread->running == true) {
-			s_navThread->pendingQueueMutex.lock();
-			while(s_navThread->pendingQueue.empty() == false) {
-				auto query = s_navThread->pendingQueue.front();
-				s_navThread->pendingQueue.pop();
-				s_navThread->queryQueue.push(query);
-			}
-			s_navThread->pendingQueueMutex.unlock();
-
-			auto bEmpty = s_navThread->queryQueue.empty();
-			if(bEmpty == false) {
-				auto item = s_navThread->queryQueue.front();
-				auto navMesh = wpNavMesh.lock();
-				std::shared_ptr<RcPathResult> path = nullptr;
-				if(navMesh != nullptr && (path = navMesh->FindPath(item->start, item->end)) != nullptr)
-					item->pathInfo = std::make_shared<ai::navigation::PathInfo>(path);
-				s_navThread->queryQueue.pop();
-				item->complete = true;
-
-				bEmpty = s_navThread->queryQueue.empty();
-			}
-			if(bEmpty == true)
-				std::this_thread::sleep_for(std::chrono::milliseconds(100));
-		}
-	});
+	nav::PathService::Settings settings {};
+	settings.workerCount = game.GetConVarInt("sh_nav_path_workers");
+	settings.iterationsPerSlice = game.GetConVarInt("sh_nav_path_slice_iterations");
+	s_pathService = std::make_shared<nav::PathService>(navMesh, settings);
 }
 
+const std::shared_ptr<nav::PathService> &BaseAIComponent::GetPathService() { return s_pathService; }
+
 void BaseAIComponent::Initialize()
 {
 	BaseEntityComponent::Initialize();
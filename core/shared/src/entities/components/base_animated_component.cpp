@@ -134,14 +134,26 @@ void BaseAnimatedComponent::OnRemove()
 bool BaseAnimatedComponent::IsAnimated() const { return umath::is_flag_set(m_stateFlags, StateFlags::IsAnimated); }
 void BaseAnimatedComponent::UpdateAnimations(double dt)
 {
-	if(ShouldUpdateBones() == false) {
-		m_stateFlags &= ~StateFlags::IsAnimated;
+	auto effectiveDt = PrepareAnimationUpdate(dt);
+	if(!effectiveDt)
 		return;
+	UpdateAnimationsMT(*effectiveDt);
+}
+std::optional<double> BaseAnimatedComponent::PrepareAnimationUpdate(double dt)
+{
+	if(ShouldUpdateBones() == false) {
+		m_stateFlags &= ~(StateFlags::IsAnimated | StateFlags::BoneUpdateConditionsChecked);
+		return {};
 	}
-	m_stateFlags |= StateFlags::IsAnimated;
+	m_stateFlags |= StateFlags::IsAnimated | StateFlags::BoneUpdateConditionsChecked;
 	auto &ent = GetEntity();
 	auto pTimeScaleComponent = ent.GetTimeScaleComponent();
-	MaintainAnimations(dt * (pTimeScaleComponent.valid() ? pTimeScaleComponent->GetEffectiveTimeScale() : 1.f));
+	return dt * (pTimeScaleComponent.valid() ? pTimeScaleComponent->GetEffectiveTimeScale() : 1.f);
+}
+void BaseAnimatedComponent::UpdateAnimationsMT(double dt)
+{
+	MaintainAnimations(dt);
+	umath::set_flag(m_stateFlags, StateFlags::BoneUpdateConditionsChecked, false);
 }
 
 void BaseAnimatedComponent::ResetAnimation(const std::shared_ptr<Model> &mdl)
@@ -225,6 +237,7 @@ std::optional<ComponentMemberIndex> BaseAnimatedComponent::DoGetMemberIndex(cons
 void BaseAnimatedComponent::OnModelChanged(const std::shared_ptr<Model> &mdl)
 {
 	ResetAnimation(mdl);
+	m_soaPose = {};
 	BroadcastEvent(EVENT_ON_ANIMATION_RESET);
 
 	util::ScopeGuard sg {[this]() { OnMembersChanged(); }};
@@ -740,7 +753,11 @@ bool BaseAnimatedComponent::MaintainAnimation(AnimationSlotInfo &animInfo, doubl
 	return true;
 }
 
-void BaseAnimatedComponent::SetBindPose(const Frame &frame) { m_bindPose = frame.shared_from_this(); }
+void BaseAnimatedComponent::SetBindPose(const Frame &frame)
+{
+	m_bindPose = frame.shared_from_this();
+	m_soaPose.ClearBindPoses();
+}
 const Frame *BaseAnimatedComponent::GetBindPose() const { return m_bindPose.get(); }
 
 bool BaseAnimatedComponent::MaintainGestures(double dt)
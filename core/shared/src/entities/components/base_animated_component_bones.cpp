@@ -469,6 +469,15 @@ bool BaseAnimatedComponent::UpdateBonePoses()
 		return false;
 	umath::set_flag(m_stateFlags, StateFlags::AbsolutePosesDirty, false);
 	auto &skeleton = hModel->GetSkeleton();
+	if(IsSoaPoseEnabled()) {
+		if(!m_soaPose.IsInitialized(skeleton))
+			m_soaPose.Initialize(skeleton);
+		m_soaPose.SetLocalPoses(m_bones);
+		m_soaPose.ComputeGlobalPoses();
+		m_processedBones.resize(m_bones.size());
+		m_soaPose.GetGlobalPoses(m_processedBones);
+		return true;
+	}
 	m_processedBones = m_bones;
 	get_global_bone_transforms(m_processedBones, skeleton.GetRootBones());
 	return true;
@@ -489,3 +498,13 @@ void BaseAnimatedComponent::PostAnimationsUpdated() { InvokeEventCallbacks(EVENT
 
 void BaseAnimatedComponent::SetPostAnimationUpdateEnabled(bool enabled) { umath::set_flag(m_stateFlags, StateFlags::NeedsPostAnimationUpdate, enabled); }
 bool BaseAnimatedComponent::IsPostAnimationUpdateEnabled() const { return umath::is_flag_set(m_stateFlags, StateFlags::NeedsPostAnimationUpdate); }
+
+void BaseAnimatedComponent::SetSoaPoseEnabled(bool enabled)
+{
+	if(enabled == IsSoaPoseEnabled())
+		return;
+	umath::set_flag(m_stateFlags, StateFlags::SoaPoseEnabled, enabled);
+	m_soaPose = {};
+	SetAbsolutePosesDirty();
+}
+bool BaseAnimatedComponent::IsSoaPoseEnabled() const { return umath::is_flag_set(m_stateFlags, StateFlags::SoaPoseEnabled); }
@@ -88,6 +88,8 @@ void BaseBvhComponent::DebugDrawBvhTree(const Vector3 &origin, const Vector3 &di
 	constexpr size_t stack_size = 64;
 	constexpr bool use_robust_traversal = false;
 
+	if(!m_bvhData)
+		return;
 	::bvh::v2::SmallStack<bvh::Bvh::Index, stack_size> stack;
 	auto ray = pragma::bvh::get_ray(origin, dir, 0.f, maxDist);
 	auto &bvh = m_bvhData->bvh;
@@ -101,12 +103,12 @@ void BaseBvhComponent::DebugDrawBvhTree(const Vector3 &origin, const Vector3 &di
 		  bvh::debug::draw_node(game, b, pose, col, duration);
 	  });
 }
-size_t BaseBvhComponent::GetTriangleCount() const { return m_bvhData->primitives.size(); }
+size_t BaseBvhComponent::GetTriangleCount() const { return m_bvhData ? m_bvhData->primitives.size() : 0; }
 std::optional<Vector3> BaseBvhComponent::GetVertex(size_t idx) const
 {
 	std::scoped_lock lock {m_bvhDataMutex};
 	auto primIdx = idx / 3;
-	if(primIdx >= m_bvhData->primitives.size())
+	if(!m_bvhData || primIdx >= m_bvhData->primitives.size())
 		return {};
 	auto &prim = m_bvhData->primitives[primIdx];
 	auto subIdx = idx % 3;
@@ -124,6 +126,10 @@ std::optional<Vector3> BaseBvhComponent::GetVertex(size_t idx) const
 void BaseBvhComponent::GetVertexData(std::vector<pragma::bvh::Primitive> &outData) const
 {
 	std::scoped_lock lock {m_bvhDataMutex};
+	if(!m_bvhData) {
+		outData.clear();
+		return;
+	}
 	outData.resize(m_bvhData->primitives.size());
 	memcpy(outData.data(), m_bvhData->primitives.data(), util::size_of_container(outData));
 }
@@ -175,6 +181,8 @@ bool BaseBvhComponent::SetVertexData(const std::vector<pragma::bvh::Primitive> &
 #ifdef PRAGMA_ENABLE_VTUNE_PROFILING
 	::debug::get_domain().EndTask();
 #endif
+	if(!m_bvhData)
+		return false;
 	return SetVertexData(*m_bvhData, data);
 }
 
@@ -249,7 +257,7 @@ std::shared_ptr<pragma::bvh::MeshBvhTree> BaseBvhComponent::RebuildBvh(const std
 	return std::move(bvhData);
 }
 
-std::vector<pragma::bvh::MeshRange> &BaseBvhComponent::GetMeshRanges() { return m_bvhData->meshRanges; }
+std::vector<pragma::bvh::MeshRange> *BaseBvhComponent::GetMeshRanges() { return m_bvhData ? &m_bvhData->meshRanges : nullptr; }
 
 const std::shared_ptr<pragma::bvh::MeshBvhTree> &BaseBvhComponent::GetUpdatedBvh() const
 {
@@ -355,7 +363,7 @@ bool BaseBvhComponent::IntersectionTest(const Vector3 &origin, const Vector3 &di
 	return false;
 }
 
-const pragma::bvh::MeshRange *BaseBvhComponent::FindPrimitiveMeshInfo(size_t primIdx) const { return m_bvhData->FindMeshRange(primIdx); }
+const pragma::bvh::MeshRange *BaseBvhComponent::FindPrimitiveMeshInfo(size_t primIdx) const { return m_bvhData ? m_bvhData->FindMeshRange(primIdx) : nullptr; }
 
 BaseBvhComponent::BaseBvhComponent(BaseEntity &ent) : BaseEntityComponent(ent) {}
 BaseBvhComponent::~BaseBvhComponent() {}
@@ -298,6 +298,12 @@ void BaseCharacterComponent::SetViewOrientation(const Quat &orientation)
 		*m_turnYaw = angView.y;
 }
 
+void BaseCharacterComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseActorComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseTransformComponent::EVENT_ON_TELEPORT);
+}
+
 util::EventReply BaseCharacterComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
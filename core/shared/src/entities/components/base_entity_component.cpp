@@ -6,6 +6,7 @@
  */
 
 #include "stdafx_shared.h"
+#include "pragma/entities/entity_tick_scheduler.hpp"
 #include "pragma/entities/components/base_entity_component.hpp"
 #include "pragma/entities/entity_component_manager.hpp"
 #include "pragma/entities/components/basetoggle.h"
@@ -66,6 +67,11 @@ void BaseEntityComponent::RegisterEvents(pragma::EntityComponentManager &compone
 	EVENT_ON_ENTITY_COMPONENT_REMOVED = registerEvent("ON_ENTITY_COMPONENT_REMOVED", ComponentEventInfo::Type::Broadcast);
 	EVENT_ON_MEMBERS_CHANGED = registerEvent("ON_MEMBERS_CHANGED", ComponentEventInfo::Type::Broadcast);
 }
+void BaseEntityComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	outEvents.push_back(BaseEntity::EVENT_ON_SPAWN);
+	outEvents.push_back(BaseEntity::EVENT_ON_POST_SPAWN);
+}
 
 spdlog::logger &BaseEntityComponent::InitLogger() const
 {
@@ -569,8 +575,7 @@ void BaseEntityComponent::CleanUp()
 		m_boundEvents = nullptr;
 	}
 	if(umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled)) {
-		auto &logicComponents = GetEntity().GetNetworkState()->GetGameState()->GetEntityTickComponents();
-		*std::find(logicComponents.begin(), logicComponents.end(), this) = nullptr;
+		GetEntity().GetNetworkState()->GetGameState()->GetEntityTickScheduler().Remove(*this);
 		umath::set_flag(m_stateFlags, StateFlags::IsLogicEnabled, false);
 	}
 }
@@ -742,8 +747,10 @@ CallbackHandle BaseEntityComponent::BindEvent(ComponentEventId eventId, const st
 	}
 	auto &boundEvents = GetBoundEvents();
 	auto itEv = boundEvents.find(eventId);
-	if(itEv == boundEvents.end())
+	if(itEv == boundEvents.end()) {
 		itEv = boundEvents.insert(std::make_pair(eventId, std::vector<CallbackHandle> {})).first;
+		static_cast<BaseEntityComponentSystem &>(ent).SubscribeToEvent(*this, eventId);
+	}
 	itEv->second.push_back(hCallback);
 	return itEv->second.back();
 }
@@ -898,17 +905,17 @@ void BaseEntityComponent::UpdateTickPolicy()
 {
 	if(!GetEntity().IsSpawned())
 		return;
-	auto &logicComponents = GetEntity().GetNetworkState()->GetGameState()->GetEntityTickComponents();
+	auto &scheduler = GetEntity().GetNetworkState()->GetGameState()->GetEntityTickScheduler();
 	if(ShouldThink()) {
 		if(umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled))
 			return;
-		logicComponents.push_back(this);
+		scheduler.Add(*this);
 		umath::set_flag(m_stateFlags, StateFlags::IsLogicEnabled);
 		return;
 	}
 	if(!umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled))
 		return;
-	logicComponents.erase(std::find(logicComponents.begin(), logicComponents.end(), this));
+	scheduler.Remove(*this);
 	umath::set_flag(m_stateFlags, StateFlags::IsLogicEnabled, false);
 }
 void BaseEntityComponent::SetTickPolicy(TickPolicy policy)
@@ -923,7 +930,12 @@ void BaseEntityComponent::SetTickPolicy(TickPolicy policy)
 }
 
 double BaseEntityComponent::GetNextTick() const { return m_tickData.nextTick; }
-void BaseEntityComponent::SetNextTick(double t) { m_tickData.nextTick = t; }
+void BaseEntityComponent::SetNextTick(double t)
+{
+	m_tickData.nextTick = t;
+	if(umath::is_flag_set(m_stateFlags, StateFlags::IsLogicEnabled))
+		GetEntity().GetNetworkState()->GetGameState()->GetEntityTickScheduler().OnNextTickChanged(*this);
+}
 
 double BaseEntityComponent::LastTick() const { return m_tickData.lastTick; }
 
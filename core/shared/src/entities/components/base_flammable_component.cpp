@@ -62,6 +62,11 @@ void BaseFlammableComponent::OnTick(double dt)
 			Extinguish();
 	}
 }
+void BaseFlammableComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(SubmergibleComponent::EVENT_ON_WATER_SUBMERGED);
+}
 util::EventReply BaseFlammableComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -73,6 +73,12 @@ void BaseHealthComponent::Initialize()
 	ent.AddComponent("damageable");
 }
 
+void BaseHealthComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(DamageableComponent::EVENT_ON_TAKE_DAMAGE);
+}
+
 util::EventReply BaseHealthComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
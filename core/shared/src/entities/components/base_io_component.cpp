@@ -116,20 +116,23 @@ bool BaseIOComponent::FireSingleOutput(Output &output, BaseEntity *activator, Io
 	else if(output.entities == "!player")
 		game->GetPlayers(&ents);
 	else {
-		std::string className = output.entities;
-		ustring::to_lower(className);
 		EntityIterator entIt {*game};
-		entIt.AttachFilter<EntityIteratorFilterUser>([&className, &output](BaseEntity &ent, std::size_t index) -> bool {
-			if(ustring::compare(ent.GetClass().c_str(), className.c_str(), false))
-				return true;
-			auto pNameComponent = static_cast<pragma::BaseNameComponent *>(ent.FindComponent("name").get());
-			return pNameComponent != nullptr && ustring::compare(pNameComponent->GetName(), output.entities, false);
-		});
+		entIt.AttachFilter<EntityIteratorFilterNameOrClass>(output.entities, false, false);
 		for(auto *ent : entIt)
 			ents.push_back(ent);
 	}
 	EntityHandle hThis = entThis.GetHandle();
+	// Firing an input may remove any of the other targets, so they have to be referenced by handle
+	std::vector<EntityHandle> targets;
+	targets.reserve(ents.size());
 	for(auto *ent : ents) {
+		if(ent)
+			targets.push_back(ent->GetHandle());
+	}
+	for(auto &hTarget : targets) {
+		if(!hTarget.valid())
+			continue;
+		auto *ent = hTarget.get();
 		auto *pIoComponent = static_cast<BaseIOComponent *>(ent->FindComponent("io").get());
 		if(pIoComponent == nullptr)
 			continue;
@@ -10,6 +10,7 @@
 #include "pragma/entities/components/base_io_component.hpp"
 #include "pragma/entities/baseentity_events.hpp"
 #include "pragma/entities/entity_component_manager_t.hpp"
+#include "pragma/entities/entity_lookup_index.hpp"
 #include <sharedutils/datastream.h>
 #include <udm.hpp>
 
@@ -45,11 +46,23 @@ void BaseNameComponent::Initialize()
 		return util::EventReply::Handled;
 	});
 	m_cbOnNameChanged = m_name->AddCallback([this](std::reference_wrapper<const std::string> oldName, std::reference_wrapper<const std::string> newName) {
+		auto &ent = GetEntity();
+		auto &nameIndex = ent.GetNetworkState()->GetGameState()->GetEntityNameIndex();
+		nameIndex.Remove(oldName.get(), ent);
+		nameIndex.Add(newName.get(), ent);
+
 		pragma::CEOnNameChanged onNameChanged {newName.get()};
 		BroadcastEvent(EVENT_ON_NAME_CHANGED, onNameChanged);
 	});
 }
 
+void BaseNameComponent::OnRemove()
+{
+	BaseEntityComponent::OnRemove();
+	auto &ent = GetEntity();
+	ent.GetNetworkState()->GetGameState()->GetEntityNameIndex().Remove(GetName(), ent);
+}
+
 const std::string &BaseNameComponent::GetName() const { return *m_name; }
 void BaseNameComponent::SetName(std::string name) { *m_name = name; }
 const util::PStringProperty &BaseNameComponent::GetNameProperty() const { return m_name; }
@@ -8,6 +8,7 @@
 #include "stdafx_shared.h"
 #include "pragma/entities/components/base_physics_component.hpp"
 #include "pragma/entities/components/base_transform_component.hpp"
+#include "pragma/entities/entity_spatial_index.hpp"
 #include "pragma/entities/components/velocity_component.hpp"
 #include "pragma/game/game_limits.h"
 #include "pragma/util/bulletinfo.h"
@@ -459,8 +460,13 @@ void BasePhysicsComponent::GetCollisionBounds(Vector3 *min, Vector3 *max) const
 
 void BasePhysicsComponent::SetCollisionBounds(const Vector3 &min, const Vector3 &max)
 {
-	if(min.x != m_colMin.x || min.y != m_colMin.y || min.z != m_colMin.z || max.x != m_colMax.x || max.y != m_colMax.y || max.z != m_colMax.z)
-		GetEntity().SetStateFlag(BaseEntity::StateFlags::CollisionBoundsChanged);
+	if(min.x != m_colMin.x || min.y != m_colMin.y || min.z != m_colMin.z || max.x != m_colMax.x || max.y != m_colMax.y || max.z != m_colMax.z) {
+		auto &ent = GetEntity();
+		ent.SetStateFlag(BaseEntity::StateFlags::CollisionBoundsChanged);
+		auto *pTrComponent = ent.GetTransformComponent();
+		if(pTrComponent)
+			ent.GetNetworkState()->GetGameState()->GetEntitySpatialIndex().MarkDirty(*pTrComponent);
+	}
 	m_colMin = min;
 	m_colMax = max;
 	auto extents = (max - min) * 0.5f;
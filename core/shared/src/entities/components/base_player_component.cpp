@@ -86,6 +86,13 @@ void BasePlayerComponent::SetViewRotation(const Quat &rot)
 	if(charComponent.valid())
 		charComponent->SetViewOrientation(rot);
 }
+void BasePlayerComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_KILLED);
+	outEvents.push_back(BaseCharacterComponent::EVENT_ON_RESPAWN);
+	outEvents.push_back(BaseHealthComponent::EVENT_ON_TAKEN_DAMAGE);
+}
 util::EventReply BasePlayerComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -72,6 +72,11 @@ bool BaseSoftBodyComponent::InitializeSoftBodyData()
 const BaseSoftBodyComponent::SoftBodyData *BaseSoftBodyComponent::GetSoftBodyData() const { return const_cast<BaseSoftBodyComponent *>(this)->GetSoftBodyData(); }
 BaseSoftBodyComponent::SoftBodyData *BaseSoftBodyComponent::GetSoftBodyData() { return m_softBodyData.get(); }
 void BaseSoftBodyComponent::ReleaseSoftBodyData() { m_softBodyData = nullptr; }
+void BaseSoftBodyComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BasePhysicsComponent::EVENT_ON_PHYSICS_DESTROYED);
+}
 util::EventReply BaseSoftBodyComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -8,14 +8,53 @@
 #include "stdafx_shared.h"
 #include "pragma/entities/components/base_static_bvh_cache_component.hpp"
 #include "pragma/entities/components/base_static_bvh_user_component.hpp"
+#include "pragma/entities/components/bvh_intersection_t.hpp"
 #include "pragma/entities/entity_component_manager_t.hpp"
 #include "pragma/util/functional_parallel_worker.hpp"
 #include "pragma/logging.hpp"
+#include <bvh/v2/stack.h>
 
 using namespace pragma;
 
 static spdlog::logger &LOGGER = pragma::register_logger("bvh");
 
+// The key is the full mesh list rather than a hash of it, so different mesh lists can never share a mesh BVH
+static std::vector<const ModelSubMesh *> get_mesh_bvh_key(const std::vector<std::shared_ptr<ModelSubMesh>> &meshes)
+{
+	std::vector<const ModelSubMesh *> key;
+	key.reserve(meshes.size());
+	for(auto &mesh : meshes)
+		key.push_back(mesh.get());
+	return key;
+}
+
+static void transform_bounds(const umath::ScaledTransform &pose, const Vector3 &min, const Vector3 &max, Vector3 &outMin, Vector3 &outMax)
+{
+	outMin = Vector3 {std::numeric_limits<float>::max()};
+	outMax = Vector3 {std::numeric_limits<float>::lowest()};
+	for(uint8_t i = 0; i < 8; ++i) {
+		Vector3 corner {(i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z};
+		corner = pose * corner;
+		uvec::min(&outMin, corner);
+		uvec::max(&outMax, corner);
+	}
+}
+
+static bool intersect_ray_bounds(const Vector3 &origin, const Vector3 &invDir, float tMin, float tMax, const pragma::bvh::BBox &bbox)
+{
+	for(uint8_t i = 0; i < 3; ++i) {
+		auto t0 = (bbox.min[i] - origin[i]) * invDir[i];
+		auto t1 = (bbox.max[i] - origin[i]) * invDir[i];
+		if(t0 > t1)
+			std::swap(t0, t1);
+		tMin = umath::max(tMin, t0);
+		tMax = umath::min(tMax, t1);
+		if(tMin > tMax)
+			return false;
+	}
+	return true;
+}
+
 BaseStaticBvhCacheComponent::BaseStaticBvhCacheComponent(BaseEntity &ent) : BaseBvhComponent(ent) {}
 BaseStaticBvhCacheComponent::~BaseStaticBvhCacheComponent()
 {
@@ -43,113 +82,250 @@ void BaseStaticBvhCacheComponent::OnRemove()
 		ent->SetStaticBvhCacheComponent(nullptr);
 }
 
-bool BaseStaticBvhCacheComponent::IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, pragma::HitInfo &outHitInfo) const
+std::shared_ptr<pragma::bvh::MeshBvhTree> BaseStaticBvhCacheComponent::FindMeshBvh(const MeshBvhKey &key)
 {
-	//const_cast<BaseStaticBvhCacheComponent *>(this)->UpdateBuild();
-	//if(m_buildWorker)
-	//	m_buildWorker->WaitForTask();
-	return BaseBvhComponent::IntersectionTest(origin, dir, minDist, maxDist, outHitInfo);
+	auto it = m_meshBvhCache.find(key);
+	if(it == m_meshBvhCache.end())
+		return nullptr;
+	auto meshBvh = it->second.lock();
+	if(!meshBvh)
+		m_meshBvhCache.erase(it); // No instance is using the mesh BVH anymore
+	return meshBvh;
 }
 
-void BaseStaticBvhCacheComponent::Build(std::vector<std::shared_ptr<ModelSubMesh>> &&meshes, std::vector<BaseEntity *> &&meshToEntity, std::vector<umath::ScaledTransform> &&meshPoses)
+bool BaseStaticBvhCacheComponent::IsCachedEntity(BaseEntity &ent) const
 {
-	LOGGER.info("Building new static BVH cache...");
-	m_bvhInitialized = true;
+	auto *c = static_cast<BaseStaticBvhUserComponent *>(ent.FindComponent("static_bvh_user").get());
+	return c && m_entities.find(c) != m_entities.end();
+}
+
+void BaseStaticBvhCacheComponent::StartMeshBvhBuild()
+{
+	LOGGER.info("Building {} new mesh BVHs for static BVH cache...", m_queuedMeshBvhBuilds.size());
 	if(!m_buildWorker) {
 		m_buildWorker = std::make_unique<util::FunctionalParallelWorker>(true);
 		m_buildWorker->Start();
 	}
-	// m_bvhDataMutex.lock();
-	// m_bvhData = nullptr; // No longer valid
-	// m_bvhDataMutex.unlock();
-	m_buildWorker->CancelTask();
 	m_bvhPendingWorkerResult = std::unique_ptr<BvhPendingWorkerResult> {new BvhPendingWorkerResult {}};
-	m_buildWorker->ResetTask([this, meshes = std::move(meshes), meshPoses = std::move(meshPoses), meshToEntity = std::move(meshToEntity)](util::FunctionalParallelWorker &worker) {
-		std::vector<size_t> meshIndices;
+	auto &pendingResult = *m_bvhPendingWorkerResult;
+
+	std::vector<std::pair<MeshBvhKey, std::vector<std::shared_ptr<ModelSubMesh>>>> builds;
+	builds.reserve(m_queuedMeshBvhBuilds.size());
+	for(auto &[key, meshes] : m_queuedMeshBvhBuilds) {
+		pendingResult.meshBvhKeys.insert(key);
+		builds.push_back({key, std::move(meshes)});
+	}
+	m_queuedMeshBvhBuilds.clear();
+
+	pendingResult.entities.reserve(m_entitiesAwaitingMeshBvh.size());
+	for(auto *ent : m_entitiesAwaitingMeshBvh) {
+		pendingResult.entities.push_back(ent->GetHandle());
+		auto *c = static_cast<BaseStaticBvhUserComponent *>(ent->FindComponent("static_bvh_user").get());
+		if(c && c->HasDynamicBvhSubstitute())
+			c->InitializeDynamicBvhSubstitute(m_currentBvhCacheVersion + 1);
+	}
+	m_entitiesAwaitingMeshBvh.clear();
+
+	m_buildWorker->ResetTask([&pendingResult, builds = std::move(builds)](util::FunctionalParallelWorker &worker) {
 		BaseBvhComponent::BvhBuildInfo buildInfo {};
-		buildInfo.isCancelled = [this]() -> bool { return m_buildWorker->IsTaskCancelled(); };
-		buildInfo.poses = &meshPoses;
-		auto bvhData = BaseBvhComponent::RebuildBvh(meshes, &buildInfo, &meshIndices);
-		if(!bvhData)
-			return;
-		if(worker.IsTaskCancelled())
-			return;
-		auto &meshRanges = get_bvh_mesh_ranges(*bvhData);
-		for(uint32_t i = 0; auto &range : meshRanges) {
-			range.entity = meshToEntity[meshIndices[i++]];
-			if(worker.IsTaskCancelled())
+		buildInfo.isCancelled = [&worker]() -> bool { return worker.IsTaskCancelled(); };
+		std::vector<std::pair<MeshBvhKey, std::shared_ptr<pragma::bvh::MeshBvhTree>>> meshBvhs;
+		meshBvhs.reserve(builds.size());
+		for(auto &[key, meshes] : builds) {
+			// Built in model space without poses, so the result can be shared by all instances
+			auto meshBvh = BaseBvhComponent::RebuildBvh(meshes, &buildInfo);
+			if(!meshBvh || worker.IsTaskCancelled())
 				return;
+			meshBvhs.push_back({key, std::move(meshBvh)});
 		}
-		if(worker.IsTaskCancelled())
-			return;
-		m_bvhPendingWorkerResult->bvhData = std::move(bvhData);
-		m_bvhPendingWorkerResult->complete = true;
+		pendingResult.meshBvhs = std::move(meshBvhs);
+		pendingResult.complete = true;
 	});
 
 	SetTickPolicy(TickPolicy::Always);
 }
 
+void BaseStaticBvhCacheComponent::FinalizeMeshBvhBuild()
+{
+	auto pendingResult = std::move(m_bvhPendingWorkerResult);
+	m_bvhPendingWorkerResult = nullptr;
+
+	++m_currentBvhCacheVersion;
+	LOGGER.info("Finalizing {} new mesh BVHs for static BVH cache (version {})...", pendingResult->meshBvhs.size(), m_currentBvhCacheVersion);
+	for(auto &[key, meshBvh] : pendingResult->meshBvhs)
+		m_meshBvhCache[key] = meshBvh;
+	for(auto &hEnt : pendingResult->entities) {
+		if(!hEnt.valid() || !IsCachedEntity(*hEnt.get()))
+			continue;
+		m_dirtyEntities.insert(hEnt.get());
+	}
+	// The mesh BVHs are only kept alive by their instances, so the instances have to be created before pendingResult goes out of scope
+	UpdateBuild();
+
+	for(auto *userC : m_entities) {
+		if(userC->HasDynamicBvhSubstitute() && userC->GetStaticBvhCacheVersion() <= m_currentBvhCacheVersion) {
+			LOGGER.info("Destroying dynamic BVH substitution for entity {}...", userC->GetEntity().ToString());
+			userC->DestroyDynamicBvhSubstitute(); // We no longer need the dynamic BVH for this, the entity should be up-to-date with the static BVH
+		}
+	}
+}
+
 void BaseStaticBvhCacheComponent::SetCacheDirty()
 {
-	if(m_staticBvhDirty)
-		return;
 	LOGGER.info("Marking static BVH cache as dirty...");
-	m_staticBvhDirty = true;
+	for(auto *c : m_entities)
+		m_dirtyEntities.insert(&c->GetEntity());
 	SetTickPolicy(TickPolicy::Always);
 }
 void BaseStaticBvhCacheComponent::OnTick(double tDelta)
 {
-	if(m_bvhPendingWorkerResult) {
-		if(m_bvhPendingWorkerResult->complete) {
-			auto pendingResult = std::move(m_bvhPendingWorkerResult);
-			m_bvhPendingWorkerResult = nullptr;
-
-			LOGGER.info("Finalizing new static BVH cache (version {})...", m_currentBvhCacheVersion);
-			m_bvhDataMutex.lock();
-			m_bvhData = pendingResult->bvhData;
-			m_bvhDataMutex.unlock();
-
-			while(!pendingResult->callOnComplete.empty()) {
-				auto &f = pendingResult->callOnComplete.front();
-				f();
-				pendingResult->callOnComplete.pop();
+	if(m_bvhPendingWorkerResult && m_bvhPendingWorkerResult->complete)
+		FinalizeMeshBvhBuild();
+	UpdateBuild();
+	if(!m_bvhPendingWorkerResult && m_dirtyEntities.empty())
+		SetTickPolicy(TickPolicy::Never);
+}
+void BaseStaticBvhCacheComponent::UpdateBuild()
+{
+	if(!m_dirtyEntities.empty()) {
+		auto dirtyEntities = std::move(m_dirtyEntities);
+		m_dirtyEntities.clear();
+		std::vector<std::shared_ptr<ModelSubMesh>> meshes;
+		for(auto *ent : dirtyEntities) {
+			meshes.clear();
+			GetEntityMeshes(*ent, meshes);
+			if(meshes.empty()) {
+				RemoveEntityFromBvh(*ent);
+				continue;
+			}
+			auto key = get_mesh_bvh_key(meshes);
+			auto meshBvh = FindMeshBvh(key);
+			if(meshBvh) {
+				UpdateInstance(*ent, meshBvh);
+				continue;
 			}
 
-			++m_currentBvhCacheVersion;
-			for(auto *userC : m_entities) {
-				if(userC->HasDynamicBvhSubstitute() && userC->GetStaticBvhCacheVersion() <= m_currentBvhCacheVersion) {
-					LOGGER.info("Destroying dynamic BVH substitution for entity {}...", userC->GetEntity().ToString());
-					userC->DestroyDynamicBvhSubstitute(); // We no longer need the dynamic BVH for this, the entity should be up-to-date with the static BVH
-				}
+			// The mesh BVH has to be built first. Until it is available, the entity is removed from the cache and uses a dynamic BVH instead.
+			RemoveEntityFromBvh(*ent);
+			if(m_bvhPendingWorkerResult && m_bvhPendingWorkerResult->meshBvhKeys.contains(key))
+				m_bvhPendingWorkerResult->entities.push_back(ent->GetHandle());
+			else {
+				m_queuedMeshBvhBuilds.try_emplace(key, meshes);
+				m_entitiesAwaitingMeshBvh.insert(ent);
 			}
+			if(!m_bvhInitialized)
+				continue;
+			auto *c = static_cast<BaseStaticBvhUserComponent *>(ent->FindComponent("static_bvh_user").get());
+			if(!c)
+				continue;
+			if(!c->HasDynamicBvhSubstitute())
+				LOGGER.info("Initializing dynamic BVH substitution for entity {}...", ent->ToString());
+			// If the mesh BVH is not being built yet, the final version is assigned once the build has been started
+			auto version = (m_bvhPendingWorkerResult && m_bvhPendingWorkerResult->meshBvhKeys.contains(key)) ? (m_currentBvhCacheVersion + 1) : std::numeric_limits<size_t>::max();
+			c->InitializeDynamicBvhSubstitute(version);
 		}
 	}
-	else {
-		SetTickPolicy(TickPolicy::Never);
-		UpdateBuild();
-	}
+	m_bvhInitialized = true;
+	if(!m_bvhPendingWorkerResult && !m_queuedMeshBvhBuilds.empty())
+		StartMeshBvhBuild();
 }
-void BaseStaticBvhCacheComponent::UpdateBuild()
+void BaseStaticBvhCacheComponent::SetEntityDirty(BaseEntity &ent)
+{
+	// If the entity is already part of the cache, it can be moved right away, the meshes are re-validated on the next tick
+	UpdateEntityPose(ent);
+	m_dirtyEntities.insert(&ent);
+	SetTickPolicy(TickPolicy::Always);
+}
+void BaseStaticBvhCacheComponent::UpdateEntityPose(BaseEntity &ent)
 {
-	if(!m_staticBvhDirty)
+	std::scoped_lock lock {m_bvhDataMutex};
+	auto it = m_entityToInstance.find(&ent);
+	if(it == m_entityToInstance.end())
 		return;
-	m_staticBvhDirty = false;
-	TestRebuildBvh();
+	auto &instance = m_instances[it->second];
+	UpdateInstancePose(instance, ent.GetPose());
+	m_instanceTree.Update(instance.node, instance.bounds);
 }
-void BaseStaticBvhCacheComponent::SetEntityDirty(BaseEntity &ent)
+void BaseStaticBvhCacheComponent::UpdateInstancePose(BvhInstance &instance, const umath::ScaledTransform &pose)
 {
-	SetCacheDirty();
+	instance.pose = pose;
+	instance.invPose = pose.GetInverse();
 
-	if(!m_bvhInitialized)
+	Vector3 min, max;
+	pragma::bvh::get_bvh_bounds(instance.meshBvh->bvh.get_root().get_bbox(), min, max);
+	Vector3 worldMin, worldMax;
+	transform_bounds(pose, min, max, worldMin, worldMax);
+	instance.bounds = {pragma::bvh::to_bvh_vector(worldMin), pragma::bvh::to_bvh_vector(worldMax)};
+}
+void BaseStaticBvhCacheComponent::UpdateInstance(BaseEntity &ent, const std::shared_ptr<pragma::bvh::MeshBvhTree> &meshBvh)
+{
+	std::scoped_lock lock {m_bvhDataMutex};
+	auto it = m_entityToInstance.find(&ent);
+	if(it != m_entityToInstance.end()) {
+		auto &instance = m_instances[it->second];
+		if(instance.meshBvh == meshBvh) {
+			UpdateInstancePose(instance, ent.GetPose());
+			m_instanceTree.Update(instance.node, instance.bounds);
+			return;
+		}
+		RemoveInstance(it->second);
+	}
+	if(meshBvh->primitives.empty())
 		return;
 
-	// Immediately remove entity from BVH
-	RemoveEntityFromBvh(ent);
+	uint32_t instanceIdx;
+	if(!m_freeInstances.empty()) {
+		instanceIdx = m_freeInstances.back();
+		m_freeInstances.pop_back();
+	}
+	else {
+		instanceIdx = m_instances.size();
+		m_instances.push_back({});
+	}
+	auto &instance = m_instances[instanceIdx];
+	instance.entity = &ent;
+	instance.meshBvh = meshBvh;
+	instance.primitiveOffset = m_triangleCount;
+	instance.meshRanges = meshBvh->meshRanges;
+	for(auto &range : instance.meshRanges) {
+		range.entity = &ent;
+		range.start += instance.primitiveOffset * 3;
+		range.end += instance.primitiveOffset * 3;
+	}
+	UpdateInstancePose(instance, ent.GetPose());
+	instance.node = m_instanceTree.Insert(instance.bounds, instanceIdx);
 
-	auto *c = static_cast<BaseStaticBvhUserComponent *>(ent.AddComponent("static_bvh_user").get());
-	if(c) {
-		LOGGER.info("Initializing dynamic BVH substitution for entity {} (static BVH cache version {})...", ent.ToString(), m_currentBvhCacheVersion + 1);
-		c->InitializeDynamicBvhSubstitute(m_currentBvhCacheVersion + 1); // Temporarily initialize a dynamic BVH until the new static BVH has been built
+	m_entityToInstance[&ent] = instanceIdx;
+	m_primitiveOffsetToInstance[instance.primitiveOffset] = instanceIdx;
+	m_triangleCount += meshBvh->primitives.size();
+}
+void BaseStaticBvhCacheComponent::RemoveInstance(uint32_t instanceIdx)
+{
+	auto &instance = m_instances[instanceIdx];
+	auto primitiveOffset = instance.primitiveOffset;
+	auto numPrimitives = instance.meshBvh->primitives.size();
+	m_instanceTree.Remove(instance.node);
+	m_entityToInstance.erase(instance.entity);
+	m_primitiveOffsetToInstance.erase(primitiveOffset);
+	m_triangleCount -= numPrimitives;
+	instance = {};
+	m_freeInstances.push_back(instanceIdx);
+
+	// Move all instances after the removed one down, so that the global primitive indices stay contiguous
+	auto it = m_primitiveOffsetToInstance.upper_bound(primitiveOffset);
+	std::vector<uint32_t> movedInstances;
+	movedInstances.reserve(std::distance(it, m_primitiveOffsetToInstance.end()));
+	for(auto itMoved = it; itMoved != m_primitiveOffsetToInstance.end(); ++itMoved)
+		movedInstances.push_back(itMoved->second);
+	m_primitiveOffsetToInstance.erase(it, m_primitiveOffsetToInstance.end());
+	for(auto idx : movedInstances) {
+		auto &movedInstance = m_instances[idx];
+		movedInstance.primitiveOffset -= numPrimitives;
+		for(auto &range : movedInstance.meshRanges) {
+			range.start -= numPrimitives * 3;
+			range.end -= numPrimitives * 3;
+		}
+		m_primitiveOffsetToInstance[movedInstance.primitiveOffset] = idx;
 	}
 }
 void BaseStaticBvhCacheComponent::AddEntity(BaseEntity &ent)
@@ -174,33 +350,202 @@ void BaseStaticBvhCacheComponent::RemoveEntity(BaseEntity &ent, bool removeFinal
 	auto it = m_entities.find(c);
 	if(it == m_entities.end())
 		return;
-	SetCacheDirty();
 	m_entities.erase(it);
+	m_dirtyEntities.erase(&ent);
+	m_entitiesAwaitingMeshBvh.erase(&ent);
 	RemoveEntityFromBvh(ent);
 }
 void BaseStaticBvhCacheComponent::RemoveEntityFromBvh(const BaseEntity &ent)
 {
-	m_bvhDataMutex.lock();
-	if(m_bvhData) {
-		LOGGER.info("Removing entity {} from static BVH cache...", ent.ToString());
+	std::scoped_lock lock {m_bvhDataMutex};
+	auto it = m_entityToInstance.find(&ent);
+	if(it == m_entityToInstance.end())
+		return;
+	LOGGER.info("Removing entity {} from static BVH cache...", ent.ToString());
+	RemoveInstance(it->second);
+}
+
+template<typename TTestAabb, typename TTestTri>
+bool BaseStaticBvhCacheComponent::TestInstanceIntersection(const TTestAabb &testAabb, const TTestTri &testTri, IntersectionInfo *outIntersectionInfo) const
+{
+	std::scoped_lock lock {m_bvhDataMutex};
+	auto hasHit = false;
+	m_instanceTree.Traverse(
+	  [&testAabb](const pragma::bvh::BBox &bbox) -> bool {
+		  Vector3 min, max;
+		  pragma::bvh::get_bvh_bounds(bbox, min, max);
+		  return testAabb(min, max);
+	  },
+	  [this, &testAabb, &testTri, outIntersectionInfo, &hasHit](uint32_t instanceIdx) -> bool {
+		  auto &instance = m_instances[instanceIdx];
+		  auto &pose = instance.pose;
+		  // The mesh BVH is in model space, so its nodes and triangles have to be moved into world space for the tests
+		  auto res = pragma::bvh::test_bvh_intersection(
+		    *instance.meshBvh,
+		    [&pose, &testAabb](const Vector3 &min, const Vector3 &max) -> bool {
+			    Vector3 worldMin, worldMax;
+			    transform_bounds(pose, min, max, worldMin, worldMax);
+			    return testAabb(worldMin, worldMax);
+		    },
+		    [&pose, &testTri](const pragma::bvh::Primitive &prim) -> bool {
+			    return testTri(pragma::bvh::create_triangle(pose * pragma::bvh::from_bvh_vector(prim.p0), pose * pragma::bvh::from_bvh_vector(prim.p1), pose * pragma::bvh::from_bvh_vector(prim.p2)));
+		    },
+		    0, outIntersectionInfo, instance.primitiveOffset, instance.entity);
+		  if(!res)
+			  return false;
+		  hasHit = true;
+		  return outIntersectionInfo == nullptr; // Any hit will do if no intersection info was requested
+	  });
+	return hasHit;
+}
+
+static bool test_aabb_aabb(const Vector3 &min, const Vector3 &max, const Vector3 &aabbMin, const Vector3 &aabbMax) { return umath::intersection::aabb_aabb(min, max, aabbMin, aabbMax) != umath::intersection::Intersect::Outside; }
+static bool test_aabb_triangle(const Vector3 &min, const Vector3 &max, const pragma::bvh::Primitive &prim)
+{
+	return umath::intersection::aabb_triangle(min, max, pragma::bvh::from_bvh_vector(prim.p0), pragma::bvh::from_bvh_vector(prim.p1), pragma::bvh::from_bvh_vector(prim.p2));
+}
+static bool test_kdop_aabb(const std::vector<umath::Plane> &kdop, const Vector3 &aabbMin, const Vector3 &aabbMax) { return umath::intersection::aabb_in_plane_mesh(aabbMin, aabbMax, kdop.begin(), kdop.end()) != umath::intersection::Intersect::Outside; }
+static bool test_kdop_triangle(const std::vector<umath::Plane> &kdop, const pragma::bvh::Primitive &prim)
+{
+	// Use AABB approximation for intersection check
+	Vector3 v0, v1;
+	pragma::bvh::get_bvh_bounds(prim.get_bbox(), v0, v1);
+	return test_kdop_aabb(kdop, v0, v1);
+}
+
+bool BaseStaticBvhCacheComponent::IntersectionTestAabb(const Vector3 &min, const Vector3 &max) const { return TestInstanceIntersection([&min, &max](const Vector3 &aabbMin, const Vector3 &aabbMax) { return test_aabb_aabb(min, max, aabbMin, aabbMax); }, [&min, &max](const pragma::bvh::Primitive &prim) { return test_aabb_triangle(min, max, prim); }, nullptr); }
+bool BaseStaticBvhCacheComponent::IntersectionTestAabb(const Vector3 &min, const Vector3 &max, IntersectionInfo &outIntersectionInfo) const
+{
+	return TestInstanceIntersection([&min, &max](const Vector3 &aabbMin, const Vector3 &aabbMax) { return test_aabb_aabb(min, max, aabbMin, aabbMax); }, [&min, &max](const pragma::bvh::Primitive &prim) { return test_aabb_triangle(min, max, prim); }, &outIntersectionInfo);
+}
+bool BaseStaticBvhCacheComponent::IntersectionTestKDop(const std::vector<umath::Plane> &planes) const
+{
+	return TestInstanceIntersection([&planes](const Vector3 &aabbMin, const Vector3 &aabbMax) { return test_kdop_aabb(planes, aabbMin, aabbMax); }, [&planes](const pragma::bvh::Primitive &prim) { return test_kdop_triangle(planes, prim); }, nullptr);
+}
+bool BaseStaticBvhCacheComponent::IntersectionTestKDop(const std::vector<umath::Plane> &planes, IntersectionInfo &outIntersectionInfo) const
+{
+	return TestInstanceIntersection([&planes](const Vector3 &aabbMin, const Vector3 &aabbMax) { return test_kdop_aabb(planes, aabbMin, aabbMax); }, [&planes](const pragma::bvh::Primitive &prim) { return test_kdop_triangle(planes, prim); }, &outIntersectionInfo);
+}
 
-		// Delete the entity from the current BVH
-		auto &meshRanges = get_bvh_mesh_ranges(*m_bvhData);
-		auto it = std::find_if(meshRanges.begin(), meshRanges.end(), [&ent](const pragma::bvh::MeshRange &range) { return range.entity == &ent; });
-		if(it != meshRanges.end()) {
-			auto &meshRange = *it;
-			BaseBvhComponent::DeleteRange(*m_bvhData, meshRange.start, meshRange.end);
+bool BaseStaticBvhCacheComponent::IntersectionTest(const Vector3 &origin, const Vector3 &dir, float minDist, float maxDist, pragma::HitInfo &outHitInfo) const
+{
+	std::scoped_lock lock {m_bvhDataMutex};
+	Vector3 invDir {1.f / dir.x, 1.f / dir.y, 1.f / dir.z};
+	auto closestDist = maxDist;
+	const BvhInstance *hitInstance = nullptr;
+	pragma::bvh::MeshBvhTree::HitData hitData;
+	m_instanceTree.Traverse([&origin, &invDir, minDist, &closestDist](const pragma::bvh::BBox &bbox) -> bool { return intersect_ray_bounds(origin, invDir, minDist, closestDist, bbox); },
+	  [this, &origin, &dir, minDist, &closestDist, &hitInstance, &hitData](uint32_t instanceIdx) -> bool {
+		  auto &instance = m_instances[instanceIdx];
+		  // The direction is not re-normalized, which keeps the hit distance in world units
+		  auto localOrigin = instance.invPose * origin;
+		  auto localDir = (instance.invPose * (origin + dir)) - localOrigin;
+		  pragma::bvh::MeshBvhTree::HitData instanceHitData;
+		  if(!instance.meshBvh->Raycast(localOrigin, localDir, minDist, closestDist, instanceHitData))
+			  return false;
+		  closestDist = minDist + (closestDist - minDist) * instanceHitData.t;
+		  hitInstance = &instance;
+		  hitData = instanceHitData;
+		  return false;
+	  });
+	if(!hitInstance)
+		return false;
+	auto *meshRange = hitInstance->meshBvh->FindMeshRange(hitData.primitiveIndex);
+	assert(meshRange != nullptr);
+
+	auto &hitInfo = outHitInfo;
+	hitInfo.primitiveIndex = hitData.primitiveIndex - meshRange->start / 3;
+	hitInfo.distance = closestDist;
+	hitInfo.u = hitData.u;
+	hitInfo.v = hitData.v;
+	hitInfo.t = (maxDist > minDist) ? ((closestDist - minDist) / (maxDist - minDist)) : 0.f;
+	hitInfo.mesh = meshRange->mesh;
+	hitInfo.entity = hitInstance->entity->GetHandle();
+	return true;
+}
+
+const pragma::bvh::MeshRange *BaseStaticBvhCacheComponent::FindPrimitiveMeshInfo(size_t primIdx) const
+{
+	auto it = m_primitiveOffsetToInstance.upper_bound(primIdx);
+	if(it == m_primitiveOffsetToInstance.begin())
+		return nullptr;
+	--it;
+	auto &instance = m_instances[it->second];
+	if(primIdx >= instance.primitiveOffset + instance.meshBvh->primitives.size())
+		return nullptr;
+	pragma::bvh::MeshRange search {};
+	search.start = primIdx * 3;
+	auto itRange = std::upper_bound(instance.meshRanges.begin(), instance.meshRanges.end(), search);
+	if(itRange == instance.meshRanges.begin())
+		return nullptr;
+	--itRange;
+	return &*itRange;
+}
+
+std::optional<Vector3> BaseStaticBvhCacheComponent::GetVertex(size_t idx) const
+{
+	std::scoped_lock lock {m_bvhDataMutex};
+	auto primIdx = idx / 3;
+	auto it = m_primitiveOffsetToInstance.upper_bound(primIdx);
+	if(it == m_primitiveOffsetToInstance.begin())
+		return {};
+	--it;
+	auto &instance = m_instances[it->second];
+	auto localPrimIdx = primIdx - instance.primitiveOffset;
+	if(localPrimIdx >= instance.meshBvh->primitives.size())
+		return {};
+	auto &prim = instance.meshBvh->primitives[localPrimIdx];
+	auto &v = (idx % 3 == 0) ? prim.p0 : ((idx % 3 == 1) ? prim.p1 : prim.p2);
+	return instance.pose * pragma::bvh::from_bvh_vector(v);
+}
+
+size_t BaseStaticBvhCacheComponent::GetTriangleCount() const { return m_triangleCount; }
+
+void BaseStaticBvhCacheComponent::GetVertexData(std::vector<pragma::bvh::Primitive> &outData) const
+{
+	std::scoped_lock lock {m_bvhDataMutex};
+	outData.clear();
+	outData.reserve(m_triangleCount);
+	for(auto &pair : m_primitiveOffsetToInstance) {
+		auto &instance = m_instances[pair.second];
+		for(auto &prim : instance.meshBvh->primitives) {
+			auto &pose = instance.pose;
+			outData.push_back(pragma::bvh::create_triangle(pose * pragma::bvh::from_bvh_vector(prim.p0), pose * pragma::bvh::from_bvh_vector(prim.p1), pose * pragma::bvh::from_bvh_vector(prim.p2)));
 		}
 	}
-	m_bvhDataMutex.unlock();
+}
 
-	if(m_bvhPendingWorkerResult) {
-		// A new BVH is currently being built, we'll have to remove the entity once it is complete
-		auto hEnt = ent.GetHandle();
-		m_bvhPendingWorkerResult->callOnComplete.push([this, hEnt]() {
-			if(hEnt.IsValid() == false)
-				return;
-			RemoveEntityFromBvh(*hEnt.get());
-		});
-	}
+void BaseStaticBvhCacheComponent::DebugDrawBvhTree(const Vector3 &origin, const Vector3 &dir, float maxDist, float duration) const
+{
+	constexpr size_t stack_size = 64;
+	constexpr bool use_robust_traversal = false;
+
+	std::scoped_lock lock {m_bvhDataMutex};
+	auto &game = GetGame();
+	Vector3 invDir {1.f / dir.x, 1.f / dir.y, 1.f / dir.z};
+	// Instance nodes are drawn in world space, the nodes of the mesh BVHs with the pose of their instance
+	m_instanceTree.Traverse(
+	  [&game, &origin, &invDir, maxDist, duration](const pragma::bvh::BBox &bbox) -> bool {
+		  if(!intersect_ray_bounds(origin, invDir, 0.f, maxDist, bbox))
+			  return false;
+		  bvh::debug::draw_node(game, bbox, {}, Color {0, 255, 255, 64}, duration);
+		  return true;
+	  },
+	  [this, &game, &origin, &dir, maxDist, duration](uint32_t instanceIdx) -> bool {
+		  auto &instance = m_instances[instanceIdx];
+		  auto localOrigin = instance.invPose * origin;
+		  auto localDir = (instance.invPose * (origin + dir)) - localOrigin;
+		  ::bvh::v2::SmallStack<bvh::Bvh::Index, stack_size> stack;
+		  auto ray = pragma::bvh::get_ray(localOrigin, localDir, 0.f, maxDist);
+		  auto &bvh = instance.meshBvh->bvh;
+		  auto &pose = instance.pose;
+		  bvh.intersect<false, use_robust_traversal>(
+		    ray, bvh.get_root().index, stack, [&](size_t begin, size_t end) { return false; },
+		    [&game, &pose, duration](const bvh::Node &a, const bvh::Node &b) {
+			    auto col = Color {255, 0, 255, 64};
+			    bvh::debug::draw_node(game, a, pose, col, duration);
+			    bvh::debug::draw_node(game, b, pose, col, duration);
+		    });
+		  return false;
+	  });
 }
@@ -30,7 +30,7 @@ void BaseStaticBvhUserComponent::Initialize()
 			m_cbOnPoseChanged.Remove();
 		m_cbOnPoseChanged = pTrComponent->AddEventCallback(BaseTransformComponent::EVENT_ON_POSE_CHANGED, [this, &trC](std::reference_wrapper<pragma::ComponentEvent> evData) -> util::EventReply {
 			if(m_staticBvhComponent.valid())
-				m_staticBvhComponent->SetEntityDirty(GetEntity());
+				m_staticBvhComponent->UpdateEntityPose(GetEntity()); // The mesh BVH stays valid, only the instance has to be moved
 			return util::EventReply::Unhandled;
 		});
 	}
@@ -92,6 +92,12 @@ void BaseStaticBvhUserComponent::OnEntityComponentRemoved(BaseEntityComponent &c
 		UpdateBvhStatus();
 }
 bool BaseStaticBvhUserComponent::IsActive() const { return m_isActive; }
+void BaseStaticBvhUserComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BasePhysicsComponent::EVENT_ON_PHYSICS_INITIALIZED);
+	outEvents.push_back(BasePhysicsComponent::EVENT_ON_PHYSICS_DESTROYED);
+}
 util::EventReply BaseStaticBvhUserComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(eventId == BasePhysicsComponent::EVENT_ON_PHYSICS_INITIALIZED || eventId == BasePhysicsComponent::EVENT_ON_PHYSICS_DESTROYED)
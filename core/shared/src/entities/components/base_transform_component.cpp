@@ -15,6 +15,7 @@
 #include "pragma/entities/components/component_member_flags.hpp"
 #include "pragma/entities/baseentity_events.hpp"
 #include "pragma/entities/entity_component_manager_t.hpp"
+#include "pragma/entities/entity_spatial_index.hpp"
 #include "pragma/lua/luacallback.h"
 #include "pragma/lua/luafunction_call.h"
 #include "pragma/model/model.h"
@@ -76,6 +77,7 @@ void BaseTransformComponent::Initialize()
 {
 	BaseEntityComponent::Initialize();
 	m_netEvSetScale = SetupNetEvent("set_scale");
+	GetEntity().GetNetworkState()->GetGameState()->GetEntitySpatialIndex().Add(*this);
 
 	BindEventUnhandled(BaseModelComponent::EVENT_ON_MODEL_CHANGED, [this](std::reference_wrapper<pragma::ComponentEvent> evData) -> util::EventReply {
 		auto &mdl = static_cast<CEOnModelChanged &>(evData.get()).model;
@@ -110,6 +112,11 @@ void BaseTransformComponent::Initialize()
 		return util::EventReply::Handled;
 	});
 }
+void BaseTransformComponent::OnRemove()
+{
+	BaseEntityComponent::OnRemove();
+	GetEntity().GetNetworkState()->GetGameState()->GetEntitySpatialIndex().Remove(*this);
+}
 void BaseTransformComponent::Teleport(const umath::Transform &targetPose)
 {
 	umath::Transform curPose = GetPose();
@@ -126,7 +133,10 @@ void BaseTransformComponent::OnPoseChanged(TransformChangeFlags changeFlags, boo
 		ent.SetStateFlag(BaseEntity::StateFlags::PositionChanged);
 	if(umath::is_flag_set(changeFlags, TransformChangeFlags::RotationChanged))
 		ent.SetStateFlag(BaseEntity::StateFlags::RotationChanged);
-	m_tLastMoved = ent.GetNetworkState()->GetGameState()->CurTime();
+	auto *game = ent.GetNetworkState()->GetGameState();
+	m_tLastMoved = game->CurTime();
+	if((changeFlags & (TransformChangeFlags::PositionChanged | TransformChangeFlags::ScaleChanged)) != TransformChangeFlags::None)
+		game->GetEntitySpatialIndex().MarkDirty(*this);
 	if(updatePhysics) {
 		auto pPhysComponent = ent.GetPhysicsComponent();
 		auto *pPhys = pPhysComponent ? pPhysComponent->GetPhysicsObject() : nullptr;
@@ -7,6 +7,7 @@
 
 #include "stdafx_shared.h"
 #include "pragma/entities/components/bvh_data.hpp"
+#include "pragma/entities/components/bvh_intersection_t.hpp"
 #include "pragma/entities/components/c_hitbox_bvh_component.hpp"
 #include "pragma/entities/components/intersection_handler_component.hpp"
 #include "pragma/model/model.h"
@@ -27,111 +28,6 @@ pragma::bvh::Primitive pragma::bvh::create_triangle(const Vector3 &a, const Vect
 
 std::vector<pragma::bvh::MeshRange> &pragma::bvh::get_bvh_mesh_ranges(pragma::bvh::MeshBvhTree &bvhData) { return bvhData.meshRanges; }
 
-static void get_bvh_bounds(const pragma::bvh::BBox &bb, Vector3 &outMin, Vector3 &outMax)
-{
-	constexpr auto epsilon = 0.001f;
-	outMin = Vector3 {umath::min(bb.min.values[0], bb.max.values[0]) - epsilon, umath::min(bb.min.values[1], bb.max.values[1]) - epsilon, umath::min(bb.min.values[2], bb.max.values[2]) - epsilon};
-	outMax = Vector3 {umath::max(bb.min.values[0], bb.max.values[0]) + epsilon, umath::max(bb.min.values[1], bb.max.values[1]) + epsilon, umath::max(bb.min.values[2], bb.max.values[2]) + epsilon};
-}
-std::tuple<bool, bool, bool> pragma::bvh::test_node_aabb_intersection(const std::function<bool(const Vector3 &, const Vector3 &)> &testAabb, const pragma::bvh::Node &left, const pragma::bvh::Node &right)
-{
-	bool hit_left, hit_right;
-	{
-		Vector3 v0_l, v1_l;
-		get_bvh_bounds(left.get_bbox(), v0_l, v1_l);
-		hit_left = testAabb(v0_l, v1_l);
-	}
-
-	{
-		Vector3 v0_r, v1_r;
-		get_bvh_bounds(right.get_bbox(), v0_r, v1_r);
-		hit_right = testAabb(v0_r, v1_r);
-	}
-	return std::make_tuple(hit_left, hit_right, false);
-}
-bool pragma::bvh::test_bvh_intersection(const pragma::bvh::MeshBvhTree &bvhData, const std::function<bool(const Vector3 &, const Vector3 &)> &testAabb, const std::function<bool(const pragma::bvh::Primitive &)> &testTri, size_t nodeIdx, IntersectionInfo *outIntersectionInfo)
-{
-	auto &bvh = bvhData.bvh;
-	auto &node = bvh.nodes[nodeIdx];
-	constexpr size_t stack_size = 64;
-	::bvh::v2::SmallStack<bvh::Bvh::Index, stack_size> stack;
-	auto hasAnyHit = false;
-
-	auto isPrimitiveIntersectionInfo = outIntersectionInfo != nullptr && typeid(*outIntersectionInfo) == typeid(PrimitiveIntersectionInfo);
-	auto isMeshIntersectionInfo = outIntersectionInfo != nullptr && typeid(*outIntersectionInfo) == typeid(MeshIntersectionInfo);
-
-	std::unique_ptr<IntersectionCache> intersectionCache {};
-	if(isPrimitiveIntersectionInfo || isMeshIntersectionInfo)
-		intersectionCache = std::make_unique<IntersectionCache>();
-
-	auto traverse = [&]<bool ReturnOnFirstHit>() {
-		bvh.traverse_top_down<ReturnOnFirstHit>(
-		  bvh.get_root().index, stack,
-		  [outIntersectionInfo, isPrimitiveIntersectionInfo, isMeshIntersectionInfo, &intersectionCache, &bvhData, &testTri, &hasAnyHit](size_t begin, size_t end) {
-			  auto hasHit = false;
-			  for(auto i = begin; i < end; ++i) {
-				  auto primIdx = i;
-
-				  if(intersectionCache) {
-					  auto skip = false;
-					  auto idx = primIdx * 3;
-					  for(auto &meshRange : intersectionCache->meshRanges) {
-						  if(idx >= meshRange.start && idx < meshRange.end) {
-							  skip = true;
-							  break;
-						  }
-					  }
-					  if(skip)
-						  continue;
-				  }
-
-				  auto &prim = bvhData.primitives[primIdx];
-				  auto &p1 = prim.p1;
-				  auto &p2 = prim.p2;
-				  auto res = testTri(prim);
-				  if(res) {
-					  hasHit = true;
-					  hasAnyHit = true;
-					  if(!intersectionCache)
-						  return true;
-					  auto addPrim = true;
-					  if(intersectionCache) {
-						  auto *meshRange = bvhData.FindMeshRange(primIdx);
-						  if(meshRange) {
-							  intersectionCache->meshRanges.push_back({*meshRange});
-
-							  auto hash = util::hash_combine<uint64_t>(util::hash_combine<uint64_t>(0, reinterpret_cast<uint64_t>(meshRange->mesh.get())), reinterpret_cast<uint64_t>(meshRange->entity));
-							  auto it = intersectionCache->meshes.find(hash);
-							  if(it != intersectionCache->meshes.end())
-								  addPrim = false;
-							  else {
-								  intersectionCache->meshes.insert(hash);
-								  if(isMeshIntersectionInfo)
-									  static_cast<MeshIntersectionInfo *>(outIntersectionInfo)->meshInfos.push_back({meshRange->mesh.get(), meshRange->entity});
-							  }
-						  }
-					  }
-					  if(addPrim && isPrimitiveIntersectionInfo) {
-						  auto *primIntersectionInfo = static_cast<PrimitiveIntersectionInfo *>(outIntersectionInfo);
-						  if(primIntersectionInfo->primitives.size() == primIntersectionInfo->primitives.capacity())
-							  primIntersectionInfo->primitives.reserve(primIntersectionInfo->primitives.size() * 1.75);
-						  primIntersectionInfo->primitives.push_back(primIdx);
-					  }
-				  }
-			  }
-
-			  if(intersectionCache)
-				  intersectionCache->meshes.clear();
-			  return hasHit;
-		  },
-		  [&testAabb](const Node &left, const Node &right) { return test_node_aabb_intersection(testAabb, left, right); });
-	};
-	if(!outIntersectionInfo)
-		traverse.template operator()<true>();
-	else
-		traverse.template operator()<false>();
-	return hasAnyHit;
-}
 bool pragma::bvh::test_bvh_intersection_with_obb(const pragma::bvh::MeshBvhTree &bvhData, const Vector3 &origin, const Quat &rot, const Vector3 &min, const Vector3 &max, size_t nodeIdx, IntersectionInfo *outIntersectionInfo)
 {
 	auto planes = umath::geometry::get_obb_planes(origin, rot, min, max);
@@ -0,0 +1,284 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/components/bvh_instance_tree.hpp"
+
+using namespace pragma::bvh;
+
+static BBox merge_bounds(const BBox &a, const BBox &b)
+{
+	auto bbox = a;
+	bbox.extend(b);
+	return bbox;
+}
+
+static bool contains_bounds(const BBox &outer, const BBox &inner)
+{
+	for(size_t i = 0; i < 3; ++i) {
+		if(inner.min[i] < outer.min[i] || inner.max[i] > outer.max[i])
+			return false;
+	}
+	return true;
+}
+
+InstanceTree::NodeIndex InstanceTree::AllocateNode()
+{
+	if(m_freeList == INVALID_NODE) {
+		m_nodes.push_back({});
+		return static_cast<NodeIndex>(m_nodes.size() - 1);
+	}
+	auto idx = m_freeList;
+	m_freeList = m_nodes[idx].parent;
+	m_nodes[idx] = {};
+	return idx;
+}
+
+void InstanceTree::FreeNode(NodeIndex idx)
+{
+	auto &node = m_nodes[idx];
+	node.parent = m_freeList;
+	node.child0 = INVALID_NODE;
+	node.child1 = INVALID_NODE;
+	node.height = -1;
+	m_freeList = idx;
+}
+
+void InstanceTree::Clear()
+{
+	m_nodes.clear();
+	m_root = INVALID_NODE;
+	m_freeList = INVALID_NODE;
+	m_leafCount = 0;
+}
+
+InstanceTree::NodeIndex InstanceTree::Insert(const BBox &bbox, uint32_t instanceIndex)
+{
+	auto leaf = AllocateNode();
+	auto &node = m_nodes[leaf];
+	node.bbox = bbox;
+	node.instanceIndex = instanceIndex;
+	node.height = 0;
+	InsertLeaf(leaf);
+	++m_leafCount;
+	return leaf;
+}
+
+void InstanceTree::Remove(NodeIndex leaf)
+{
+	RemoveLeaf(leaf);
+	FreeNode(leaf);
+	--m_leafCount;
+}
+
+bool InstanceTree::Update(NodeIndex leaf, const BBox &bbox)
+{
+	auto parent = m_nodes[leaf].parent;
+	if(parent == INVALID_NODE || contains_bounds(m_nodes[parent].bbox, bbox)) {
+		// The topology is still valid, we only have to shrink the bounds of the ancestors
+		m_nodes[leaf].bbox = bbox;
+		for(auto idx = parent; idx != INVALID_NODE; idx = m_nodes[idx].parent) {
+			auto &node = m_nodes[idx];
+			node.bbox = merge_bounds(m_nodes[node.child0].bbox, m_nodes[node.child1].bbox);
+		}
+		return false;
+	}
+	RemoveLeaf(leaf);
+	m_nodes[leaf].bbox = bbox;
+	InsertLeaf(leaf);
+	return true;
+}
+
+void InstanceTree::InsertLeaf(NodeIndex leaf)
+{
+	if(m_root == INVALID_NODE) {
+		m_root = leaf;
+		m_nodes[leaf].parent = INVALID_NODE;
+		return;
+	}
+
+	// Find the best sibling by descending along the child with the lowest increase in surface area
+	auto leafBox = m_nodes[leaf].bbox;
+	auto idx = m_root;
+	while(!m_nodes[idx].IsLeaf()) {
+		auto &node = m_nodes[idx];
+		auto area = node.bbox.get_half_area();
+		auto combinedArea = merge_bounds(node.bbox, leafBox).get_half_area();
+
+		// Cost of creating a new parent for this node and the new leaf
+		auto cost = 2.f * combinedArea;
+		// Minimum cost of pushing the leaf further down the tree
+		auto inheritanceCost = 2.f * (combinedArea - area);
+		auto getChildCost = [this, &leafBox, inheritanceCost](NodeIndex childIdx) {
+			auto &child = m_nodes[childIdx];
+			auto mergedArea = merge_bounds(leafBox, child.bbox).get_half_area();
+			if(child.IsLeaf())
+				return mergedArea + inheritanceCost;
+			return (mergedArea - child.bbox.get_half_area()) + inheritanceCost;
+		};
+		auto cost0 = getChildCost(node.child0);
+		auto cost1 = getChildCost(node.child1);
+		if(cost < cost0 && cost < cost1)
+			break;
+		idx = (cost0 < cost1) ? node.child0 : node.child1;
+	}
+
+	auto sibling = idx;
+	auto oldParent = m_nodes[sibling].parent;
+	auto newParent = AllocateNode();
+	auto &parentNode = m_nodes[newParent];
+	parentNode.parent = oldParent;
+	parentNode.bbox = merge_bounds(leafBox, m_nodes[sibling].bbox);
+	parentNode.height = m_nodes[sibling].height + 1;
+	parentNode.child0 = sibling;
+	parentNode.child1 = leaf;
+	if(oldParent != INVALID_NODE) {
+		auto &oldParentNode = m_nodes[oldParent];
+		if(oldParentNode.child0 == sibling)
+			oldParentNode.child0 = newParent;
+		else
+			oldParentNode.child1 = newParent;
+	}
+	else
+		m_root = newParent;
+	m_nodes[sibling].parent = newParent;
+	m_nodes[leaf].parent = newParent;
+
+	RefitAncestors(m_nodes[leaf].parent);
+}
+
+void InstanceTree::RemoveLeaf(NodeIndex leaf)
+{
+	if(leaf == m_root) {
+		m_root = INVALID_NODE;
+		return;
+	}
+	auto parent = m_nodes[leaf].parent;
+	auto grandParent = m_nodes[parent].parent;
+	auto sibling = (m_nodes[parent].child0 == leaf) ? m_nodes[parent].child1 : m_nodes[parent].child0;
+	m_nodes[leaf].parent = INVALID_NODE;
+	if(grandParent == INVALID_NODE) {
+		m_root = sibling;
+		m_nodes[sibling].parent = INVALID_NODE;
+		FreeNode(parent);
+		return;
+	}
+	// Replace the parent with the sibling
+	auto &grandParentNode = m_nodes[grandParent];
+	if(grandParentNode.child0 == parent)
+		grandParentNode.child0 = sibling;
+	else
+		grandParentNode.child1 = sibling;
+	m_nodes[sibling].parent = grandParent;
+	FreeNode(parent);
+	RefitAncestors(grandParent);
+}
+
+void InstanceTree::RefitAncestors(NodeIndex idx)
+{
+	while(idx != INVALID_NODE) {
+		idx = Balance(idx);
+		auto &node = m_nodes[idx];
+		auto &child0 = m_nodes[node.child0];
+		auto &child1 = m_nodes[node.child1];
+		node.height = 1 + umath::max(child0.height, child1.height);
+		node.bbox = merge_bounds(child0.bbox, child1.bbox);
+		idx = node.parent;
+	}
+}
+
+// Performs a left or right rotation if node A is imbalanced and returns the new root of the sub-tree
+InstanceTree::NodeIndex InstanceTree::Balance(NodeIndex iA)
+{
+	auto &a = m_nodes[iA];
+	if(a.IsLeaf() || a.height < 2)
+		return iA;
+	auto iB = a.child0;
+	auto iC = a.child1;
+	auto &b = m_nodes[iB];
+	auto &c = m_nodes[iC];
+	auto balance = c.height - b.height;
+
+	auto replaceChild = [this](NodeIndex parent, NodeIndex oldChild, NodeIndex newChild) {
+		if(parent == INVALID_NODE) {
+			m_root = newChild;
+			return;
+		}
+		auto &parentNode = m_nodes[parent];
+		if(parentNode.child0 == oldChild)
+			parentNode.child0 = newChild;
+		else
+			parentNode.child1 = newChild;
+	};
+
+	// Rotate C up
+	if(balance > 1) {
+		auto iF = c.child0;
+		auto iG = c.child1;
+		auto &f = m_nodes[iF];
+		auto &g = m_nodes[iG];
+
+		c.child0 = iA;
+		c.parent = a.parent;
+		a.parent = iC;
+		replaceChild(c.parent, iA, iC);
+
+		if(f.height > g.height) {
+			c.child1 = iF;
+			a.child1 = iG;
+			g.parent = iA;
+			a.bbox = merge_bounds(b.bbox, g.bbox);
+			c.bbox = merge_bounds(a.bbox, f.bbox);
+			a.height = 1 + umath::max(b.height, g.height);
+			c.height = 1 + umath::max(a.height, f.height);
+		}
+		else {
+			c.child1 = iG;
+			a.child1 = iF;
+			f.parent = iA;
+			a.bbox = merge_bounds(b.bbox, f.bbox);
+			c.bbox = merge_bounds(a.bbox, g.bbox);
+			a.height = 1 + umath::max(b.height, f.height);
+			c.height = 1 + umath::max(a.height, g.height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if(balance < -1) {
+		auto iD = b.child0;
+		auto iE = b.child1;
+		auto &d = m_nodes[iD];
+		auto &e = m_nodes[iE];
+
+		b.child0 = iA;
+		b.parent = a.parent;
+		a.parent = iB;
+		replaceChild(b.parent, iA, iB);
+
+		if(d.height > e.height) {
+			b.child1 = iD;
+			a.child0 = iE;
+			e.parent = iA;
+			a.bbox = merge_bounds(c.bbox, e.bbox);
+			b.bbox = merge_bounds(a.bbox, d.bbox);
+			a.height = 1 + umath::max(c.height, e.height);
+			b.height = 1 + umath::max(a.height, d.height);
+		}
+		else {
+			b.child1 = iE;
+			a.child0 = iD;
+			d.parent = iA;
+			a.bbox = merge_bounds(c.bbox, d.bbox);
+			b.bbox = merge_bounds(a.bbox, e.bbox);
+			a.height = 1 + umath::max(c.height, d.height);
+			b.height = 1 + umath::max(a.height, e.height);
+		}
+		return iB;
+	}
+	return iA;
+}
@@ -82,6 +82,11 @@ void ConstraintChildOfComponent::Initialize()
 	GetEntity().AddComponent<ConstraintComponent>();
 	BindEventUnhandled(ConstraintComponent::EVENT_APPLY_CONSTRAINT, [this](std::reference_wrapper<pragma::ComponentEvent> evData) { ApplyConstraint(); });
 }
+void ConstraintChildOfComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(ConstraintComponent::EVENT_ON_PARTICIPANTS_FLAGGED_DIRTY);
+}
 util::EventReply ConstraintChildOfComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -0,0 +1,116 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/components/hitbox_bvh_data.hpp"
+#include <mathutil/umath_geometry.hpp>
+
+pragma::bvh::HitboxObb::HitboxObb(const Vector3 &min, const Vector3 &max) : min {min}, max {max} { umath::geometry::calc_aabb_extents(min, max, position, halfExtents); }
+
+umath::ScaledTransform pragma::bvh::HitboxObb::GetPose(const std::vector<umath::ScaledTransform> &effectivePoses) const
+{
+	auto pose = effectivePoses[boneId];
+	pose.TranslateLocal(position);
+	return pose;
+}
+
+pragma::bvh::BBox pragma::bvh::HitboxObb::ToBvhBBox(const umath::ScaledTransform &pose, Vector3 &outOrigin) const
+{
+	auto [aabbMin, aabbMax] = umath::geometry::calc_aabb_around_obb(pose, position, halfExtents);
+	outOrigin = (aabbMin + aabbMax) * 0.5f;
+	return pragma::bvh::BBox {pragma::bvh::to_bvh_vector(aabbMin), pragma::bvh::to_bvh_vector(aabbMax)};
+}
+
+void pragma::bvh::HitboxPoseHistory::SetCapacity(size_t capacity)
+{
+	if(capacity == m_samples.size())
+		return;
+	// Keep the most recent samples
+	std::vector<Sample> samples;
+	samples.resize(capacity);
+	auto numKeep = umath::min(m_sampleCount, capacity);
+	for(size_t i = 0; i < numKeep; ++i)
+		samples[i] = std::move(m_samples[(m_firstSample + m_sampleCount - numKeep + i) % m_samples.size()]);
+	m_samples = std::move(samples);
+	m_firstSample = 0;
+	m_sampleCount = numKeep;
+}
+
+void pragma::bvh::HitboxPoseHistory::Clear()
+{
+	m_firstSample = 0;
+	m_sampleCount = 0;
+}
+
+pragma::bvh::HitboxPoseHistory::Sample &pragma::bvh::HitboxPoseHistory::AddSample(double time)
+{
+	if(m_samples.empty())
+		SetCapacity(1);
+	size_t idx;
+	if(m_sampleCount < m_samples.size())
+		idx = (m_firstSample + m_sampleCount++) % m_samples.size();
+	else {
+		// Overwrite the oldest sample
+		idx = m_firstSample;
+		m_firstSample = (m_firstSample + 1) % m_samples.size();
+	}
+	auto &sample = m_samples[idx];
+	sample.time = time;
+	return sample;
+}
+
+const pragma::bvh::HitboxPoseHistory::Sample &pragma::bvh::HitboxPoseHistory::GetSample(size_t idx) const { return m_samples[(m_firstSample + idx) % m_samples.size()]; }
+
+bool pragma::bvh::HitboxPoseHistory::FindSamples(double time, const Sample *&outSample0, const Sample *&outSample1, float &outFactor) const
+{
+	if(m_sampleCount == 0)
+		return false;
+	outFactor = 0.f;
+	auto &oldest = GetSample(0);
+	if(time <= oldest.time) {
+		outSample0 = outSample1 = &oldest;
+		return true;
+	}
+	auto &newest = GetSample(m_sampleCount - 1);
+	if(time >= newest.time) {
+		outSample0 = outSample1 = &newest;
+		return true;
+	}
+	// Samples are sorted by time
+	size_t first = 0;
+	size_t last = m_sampleCount - 1;
+	while(last - first > 1) {
+		auto mid = (first + last) / 2;
+		if(GetSample(mid).time <= time)
+			first = mid;
+		else
+			last = mid;
+	}
+	outSample0 = &GetSample(first);
+	outSample1 = &GetSample(last);
+	auto dt = outSample1->time - outSample0->time;
+	if(dt > 0.0)
+		outFactor = static_cast<float>((time - outSample0->time) / dt);
+	return true;
+}
+
+bool pragma::bvh::HitboxPoseHistory::GetPoses(double time, umath::ScaledTransform &outPose, std::vector<umath::ScaledTransform> &outBonePoses) const
+{
+	const Sample *sample0, *sample1;
+	float factor;
+	if(!FindSamples(time, sample0, sample1, factor))
+		return false;
+	outPose = sample0->pose;
+	outBonePoses = sample0->bonePoses;
+	// Bone counts only differ if the model has changed in between, in which case we can't interpolate
+	if(sample0 == sample1 || factor == 0.f || sample0->bonePoses.size() != sample1->bonePoses.size())
+		return true;
+	outPose.Interpolate(sample1->pose, factor);
+	for(size_t i = 0; i < outBonePoses.size(); ++i)
+		outBonePoses[i].Interpolate(sample1->bonePoses[i], factor);
+	return true;
+}
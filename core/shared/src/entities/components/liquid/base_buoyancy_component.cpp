@@ -67,6 +67,12 @@ void BaseBuoyancyComponent::OnEntityComponentAdded(BaseEntityComponent &componen
 		m_liquidControl = pLiquidControl->GetHandle<BaseLiquidControlComponent>();
 }
 
+void BaseBuoyancyComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseTouchComponent::EVENT_CAN_TRIGGER);
+}
+
 util::EventReply BaseBuoyancyComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
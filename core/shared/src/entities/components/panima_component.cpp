@@ -103,6 +103,7 @@ void PanimaComponent::RemoveAnimationManager(const std::string_view &name)
 	auto it = FindAnimationManager(name);
 	if(it == m_animationManagers.end())
 		return;
+	m_channelBatches.erase(it->second.get());
 	m_animationManagers.erase(it);
 }
 void PanimaComponent::RemoveAnimationManager(const panima::AnimationManager &player)
@@ -110,6 +111,7 @@ void PanimaComponent::RemoveAnimationManager(const panima::AnimationManager &pla
 	auto it = std::find_if(m_animationManagers.begin(), m_animationManagers.end(), [&player](const std::pair<std::string, panima::PAnimationManager> &pair) { return pair.second.get() == &player; });
 	if(it == m_animationManagers.end())
 		return;
+	m_channelBatches.erase(it->second.get());
 	m_animationManagers.erase(it);
 }
 
@@ -163,7 +165,7 @@ static bool is_vector_component(const std::string &str)
 
 void PanimaComponent::DebugPrint(std::stringstream &ss)
 {
-	auto printAnimManager = [&ss](const std::string &name, const panima::AnimationManager &manager) {
+	auto printAnimManager = [this, &ss](const std::string &name, const panima::AnimationManager &manager) {
 		auto *anim = manager.GetCurrentAnimation();
 		ss << "AnimationManager[" << name << "]:\n";
 		ss << "\tCurrent Animation: " << (anim ? anim->GetName() : "NULL") << "\n";
@@ -185,6 +187,13 @@ void PanimaComponent::DebugPrint(std::stringstream &ss)
 				ss << "\t\t\tValue type: " << magic_enum::enum_name(channel->GetValueType()) << "\n";
 				ss << "\t\t\tNumber of times/values: " << channel->GetTimeCount() << "/" << channel->GetValueCount() << "\n";
 				auto hasSubmitter = (i < channelValueSubmitters.size() && channelValueSubmitters[i] != nullptr);
+				auto itBatches = m_channelBatches.find(&manager);
+				if(!hasSubmitter && itBatches != m_channelBatches.end()) {
+					auto &batches = itBatches->second.batches;
+					hasSubmitter = std::any_of(batches.begin(), batches.end(), [i](const ChannelBatch &batch) {
+						return std::find_if(batch.items.begin(), batch.items.end(), [i](const ChannelBatch::Item &item) { return item.channelIndex == i; }) != batch.items.end();
+					});
+				}
 				ss << "\t\t\tHas submitter: " << (hasSubmitter ? "true" : "false") << "\n";
 
 				udm::visit_ng(channel->GetValueType(), [&channel, &player, &ss](auto tag) {
@@ -263,11 +272,13 @@ void PanimaComponent::SetPropertyEnabled(const std::string &propName, bool enabl
 		auto it = m_disabledProperties.find(pragma::register_global_string(normalizedPath));
 		if(it != m_disabledProperties.end()) {
 			m_disabledProperties.erase(it);
+			m_channelBindings.clear();
 			InitializeAnimationChannelValueSubmitters();
 		}
 		return;
 	}
 	m_disabledProperties.insert(pragma::register_global_string(normalizedPath));
+	m_channelBindings.clear();
 	InitializeAnimationChannelValueSubmitters();
 }
 bool PanimaComponent::IsPropertyEnabled(const std::string &propName) const
@@ -378,11 +389,17 @@ void PanimaComponent::InitializeAnimationChannelValueSubmitters(panima::Animatio
 	auto &channelValueSubmitters = manager.GetChannelValueSubmitters();
 	if(!anim) {
 		channelValueSubmitters.clear();
+		m_channelBatches.erase(&manager);
 		return;
 	}
 	auto &channels = anim->GetChannels();
 	channelValueSubmitters.clear();
 	channelValueSubmitters.resize(channels.size(), panima::ChannelValueSubmitter {});
+	auto &managerBatches = m_channelBatches[&manager];
+	managerBatches.animation = anim;
+	auto &batches = managerBatches.batches;
+	for(auto &batch : batches)
+		batch.items.clear();
 	uint32_t numInvalidChannels = 0;
 	auto shouldPrintWarning = [&numInvalidChannels]() {
 		if(numInvalidChannels >= 5) {
@@ -394,40 +411,54 @@ void PanimaComponent::InitializeAnimationChannelValueSubmitters(panima::Animatio
 		++numInvalidChannels;
 		return true;
 	};
-	// TODO: Reload this when animation has changed, or if component data has changed (e.g. animated component has changed model and therefore bone positions and rotational data)
 	for(auto it = channels.begin(); it != channels.end(); ++it) {
 		auto &channel = *it;
 		auto &path = channel->targetPath;
-		if(!IsPropertyEnabled(path.path.GetString()))
-			continue;
-		size_t offset = 0;
-		if(path.path.GetComponent(offset, &offset) != "ec") // First path component denotes the type, which always has to be 'ec' for entity component in this case
-		{
-			if(shouldPrintWarning())
-				Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but path is not a valid entity component URI!" << Con::endl;
-			continue;
-		}
-		auto componentPath = ParseComponentChannelPath(path);
-		if(!componentPath.has_value()) {
-			if(shouldPrintWarning())
-				Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but could not determine path components!" << Con::endl;
-			continue;
-		}
-		auto &componentTypeName = componentPath->first;
-		// TODO: Needs to be updated whenever a new component has been added to the entity
-		auto hComponent = GetEntity().FindComponent(componentTypeName);
-		if(hComponent.expired()) {
-			if(shouldPrintWarning())
-				Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but entity has no component of type '" << componentTypeName << "'!" << Con::endl;
-			continue;
+		auto &pathStr = path.path.GetString();
+		auto itBinding = m_channelBindings.find(pathStr);
+		if(itBinding != m_channelBindings.end() && itBinding->second.enabled && itBinding->second.component.expired())
+			itBinding = m_channelBindings.end();
+		if(itBinding == m_channelBindings.end()) {
+			ChannelBinding binding {};
+			binding.enabled = IsPropertyEnabled(pathStr);
+			if(binding.enabled) {
+				size_t offset = 0;
+				if(path.path.GetComponent(offset, &offset) != "ec") // First path component denotes the type, which always has to be 'ec' for entity component in this case
+				{
+					if(shouldPrintWarning())
+						Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but path is not a valid entity component URI!" << Con::endl;
+					continue;
+				}
+				auto componentPath = ParseComponentChannelPath(path);
+				if(!componentPath.has_value()) {
+					if(shouldPrintWarning())
+						Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but could not determine path components!" << Con::endl;
+					continue;
+				}
+				auto &componentTypeName = componentPath->first;
+				// TODO: Needs to be updated whenever a new component has been added to the entity
+				auto hComponent = GetEntity().FindComponent(componentTypeName);
+				if(hComponent.expired()) {
+					if(shouldPrintWarning())
+						Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but entity has no component of type '" << componentTypeName << "'!" << Con::endl;
+					continue;
+				}
+				auto &memberName = componentPath->second;
+				if(memberName.IsEmpty()) {
+					if(shouldPrintWarning())
+						Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but no member name has been specified!" << Con::endl;
+					continue;
+				}
+				binding.component = hComponent;
+				binding.memberPath = std::move(memberName);
+			}
+			itBinding = m_channelBindings.insert_or_assign(pathStr, std::move(binding)).first;
 		}
-		auto &memberName = componentPath->second;
-		if(memberName.IsEmpty()) {
-			if(shouldPrintWarning())
-				Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', but no member name has been specified!" << Con::endl;
+		auto &binding = itBinding->second;
+		if(!binding.enabled)
 			continue;
-		}
-		auto memberPath = memberName;
+		auto &hComponent = binding.component;
+		auto memberPath = binding.memberPath;
 		auto channelIdx = it - channels.begin();
 		CEAnim2InitializeChannelValueSubmitter evData {memberPath};
 		if(hComponent->InvokeEventCallbacks(EVENT_INITIALIZE_CHANNEL_VALUE_SUBMITTER, evData) == util::EventReply::Handled) {
@@ -437,10 +468,12 @@ void PanimaComponent::InitializeAnimationChannelValueSubmitters(panima::Animatio
 			continue;
 		}
 
-		auto memberIdx = hComponent->GetMemberIndex(memberPath.GetString());
+		if(!binding.memberIndex.has_value())
+			binding.memberIndex = hComponent->GetMemberIndex(memberPath.GetString());
+		auto &memberIdx = binding.memberIndex;
 		if(!memberIdx.has_value()) {
 			if(shouldPrintWarning())
-				Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', entity component has no member with name '" << memberName << "'!" << Con::endl;
+				Con::cwar << "Attempted to play animation channel with path '" << path.ToUri() << "', entity component has no member with name '" << memberPath << "'!" << Con::endl;
 			continue;
 		}
 		auto channelValueType = channel->GetValueType();
@@ -454,6 +487,13 @@ void PanimaComponent::InitializeAnimationChannelValueSubmitters(panima::Animatio
 
 		auto &component = *hComponent;
 		auto *valueComponents = path.GetComponents();
+		if((!valueComponents || valueComponents->empty()) && udm::is_ng_type(channelValueType) && ents::member_type_to_udm_type(valueType) == channelValueType) {
+			auto isAnimatable = udm::visit_ng(channelValueType, [](auto tag) { return is_animatable_type_v<typename decltype(tag)::type>; });
+			if(isAnimatable) {
+				GetChannelBatch(batches, channelValueType).items.push_back({&component, *memberIdx, static_cast<uint32_t>(channelIdx)});
+				continue;
+			}
+		}
 		auto vsGetMemberChannelSubmitter = [valueComponents, &path, &memberIdx, channelIdx, &channelValueSubmitters, &component]<typename TMember>(auto tag) mutable {
 			using TChannel = typename decltype(tag)::type;
 			constexpr auto setMemberValue = [](const pragma::ComponentMemberInfo &memberInfo, pragma::BaseEntityComponent &component, const void *value, void *userData) { memberInfo.setterFunction(memberInfo, component, value); };
@@ -589,7 +629,11 @@ void PanimaComponent::ReloadAnimation(panima::AnimationManager &manager)
 	PlayAnimation(manager, *const_cast<panima::Animation *>(anim));
 	manager->SetCurrentTime(t);
 }
-void PanimaComponent::ClearAnimationManagers() { m_animationManagers.clear(); }
+void PanimaComponent::ClearAnimationManagers()
+{
+	m_animationManagers.clear();
+	m_channelBatches.clear();
+}
 bool PanimaComponent::UpdateAnimations(double dt)
 {
 	if(GetPlaybackRate() == 0.f)
@@ -626,11 +670,60 @@ void PanimaComponent::SetCurrentTimeFraction(panima::AnimationManager &manager,
 	manager->SetCurrentTimeFraction(t, true);
 	InvokeValueSubmitters(manager);
 }
+PanimaComponent::ChannelBatch &PanimaComponent::GetChannelBatch(std::vector<ChannelBatch> &batches, udm::Type valueType)
+{
+	auto it = std::find_if(batches.begin(), batches.end(), [valueType](const ChannelBatch &batch) { return batch.valueType == valueType; });
+	if(it != batches.end())
+		return *it;
+	batches.push_back({});
+	auto &batch = batches.back();
+	batch.valueType = valueType;
+	return batch;
+}
+void PanimaComponent::InvokeChannelBatches(panima::AnimationManager &manager, const panima::Animation &anim)
+{
+	auto it = m_channelBatches.find(&manager);
+	if(it == m_channelBatches.end() || it->second.animation != &anim)
+		return;
+	auto &channels = anim.GetChannels();
+	auto t = manager->GetCurrentTime();
+	for(auto &batch : it->second.batches) {
+		if(batch.items.empty())
+			continue;
+		// The type is only dispatched once per batch, the channels of the batch are then sampled and submitted in one loop
+		udm::visit_ng(batch.valueType, [&batch, &channels, &manager, t](auto tag) {
+			using T = typename decltype(tag)::type;
+			if constexpr(is_animatable_type_v<T>) {
+				for(auto &item : batch.items) {
+					if(item.channelIndex >= channels.size())
+						continue;
+					auto &channel = *channels[item.channelIndex];
+					if(channel.GetTimeCount() == 0)
+						continue;
+					auto *memberInfo = item.component->GetMemberInfo(item.memberIndex);
+					if(!memberInfo)
+						continue;
+					auto &pivotTimeIndex = manager->GetLastChannelTimestampIndex(item.channelIndex);
+					auto value = channel.GetInterpolatedValue<T>(t, pivotTimeIndex, memberInfo->interpolationFunction);
+					channel.ApplyValueExpression<T>(t, pivotTimeIndex, value);
+					memberInfo->setterFunction(*memberInfo, *item.component, &value);
+				}
+			}
+		});
+	}
+}
 void PanimaComponent::InvokeValueSubmitters(panima::AnimationManager &manager)
 {
 	auto *anim = manager.GetCurrentAnimation();
 	if(!anim)
 		return;
+	auto itBatches = m_channelBatches.find(&manager);
+	if(itBatches != m_channelBatches.end() && itBatches->second.animation != anim) {
+		// The animation has been changed on the manager directly, the channel bindings have to be re-initialized
+		// before they can be used with the channels of the new animation
+		InitializeAnimationChannelValueSubmitters(manager);
+	}
+	InvokeChannelBatches(manager, *anim);
 	auto &channelValueSubmitters = manager.GetChannelValueSubmitters();
 	auto &channels = anim->GetChannels();
 	auto n = umath::min(channelValueSubmitters.size(), channels.size());
@@ -660,13 +753,53 @@ void PanimaComponent::AdvanceAnimations(double dt)
 		InvokeValueSubmitters(*manager);
 	}
 }
+std::optional<double> PanimaComponent::PrepareAnimationUpdate(double dt)
+{
+	if(GetPlaybackRate() == 0.f)
+		return {};
+	CEAnim2MaintainAnimations evData {dt};
+	if(InvokeEventCallbacks(EVENT_MAINTAIN_ANIMATIONS, evData) == util::EventReply::Handled) {
+		InvokeEventCallbacks(EVENT_ON_ANIMATIONS_UPDATED);
+		return {};
+	}
+	auto &ent = GetEntity();
+	auto pTimeScaleComponent = ent.GetTimeScaleComponent();
+	dt *= (pTimeScaleComponent.valid() ? pTimeScaleComponent->GetEffectiveTimeScale() : 1.f);
+	dt *= GetPlaybackRate();
+	return dt;
+}
+void PanimaComponent::AdvanceAnimationsMT(double dt)
+{
+	// Value submitters may write to arbitrary component members, so we only collect
+	// the managers here and invoke the submitters in FinalizeAnimationUpdate.
+	m_pendingValueSubmitters.clear();
+	for(auto &pair : m_animationManagers) {
+		auto &manager = pair.second;
+		auto change = (*manager)->Advance(dt, true /* forceUpdate */);
+		if(!change)
+			continue;
+		m_pendingValueSubmitters.push_back(manager.get());
+	}
+}
+void PanimaComponent::FinalizeAnimationUpdate()
+{
+	for(auto *manager : m_pendingValueSubmitters)
+		InvokeValueSubmitters(*manager);
+	m_pendingValueSubmitters.clear();
+	InvokeEventCallbacks(EVENT_ON_ANIMATIONS_UPDATED);
+}
 void PanimaComponent::InitializeLuaObject(lua_State *l) { pragma::BaseLuaHandle::InitializeLuaObject<std::remove_reference_t<decltype(*this)>>(l); }
 
 void PanimaComponent::Initialize()
 {
 	BaseEntityComponent::Initialize();
 
-	BindEventUnhandled(BaseEntityComponent::EVENT_ON_MEMBERS_CHANGED, [this](std::reference_wrapper<pragma::ComponentEvent> evData) { InitializeAnimationChannelValueSubmitters(); });
+	BindEventUnhandled(BaseEntityComponent::EVENT_ON_MEMBERS_CHANGED, [this](std::reference_wrapper<pragma::ComponentEvent> evData) {
+		// Member indices may have changed, but the component bindings are still valid
+		for(auto &pair : m_channelBindings)
+			pair.second.memberIndex = {};
+		InitializeAnimationChannelValueSubmitters();
+	});
 }
 
 void PanimaComponent::OnEntitySpawn()
@@ -37,6 +37,13 @@ void VelocityComponent::InitializeLuaObject(lua_State *l) { pragma::BaseLuaHandl
 const util::PVector3Property &VelocityComponent::GetVelocityProperty() const { return m_velocity; }
 const util::PVector3Property &VelocityComponent::GetAngularVelocityProperty() const { return m_angVelocity; }
 
+void VelocityComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(DamageableComponent::EVENT_ON_TAKE_DAMAGE);
+	outEvents.push_back(BaseTransformComponent::EVENT_ON_TELEPORT);
+}
+
 util::EventReply VelocityComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -176,6 +176,12 @@ void ComponentMemberInfo::SetName(const pragma::GString &name)
 
 //////////////
 
+uint32_t pragma::detail::get_next_component_type_slot()
+{
+	static std::atomic<uint32_t> nextSlot = 0;
+	return nextSlot++;
+}
+
 ComponentInfo::ComponentInfo(const ComponentInfo &other) { operator=(other); }
 ComponentInfo::ComponentInfo(ComponentInfo &&other) { operator=(std::move(other)); }
 ComponentInfo &ComponentInfo::operator=(const ComponentInfo &other)
@@ -186,6 +192,8 @@ ComponentInfo &ComponentInfo::operator=(const ComponentInfo &other)
 	flags = other.flags;
 	members = other.members;
 	memberNameToIndex = other.memberNameToIndex;
+	getHandledEvents = other.getHandledEvents;
+	m_handledEvents = other.m_handledEvents;
 	onCreateCallbacks = nullptr;
 	if(other.onCreateCallbacks) {
 		onCreateCallbacks = std::make_unique<std::vector<CallbackHandle>>();
@@ -205,12 +213,24 @@ ComponentInfo &ComponentInfo::operator=(ComponentInfo &&other)
 	id = other.id;
 	flags = other.flags, members = std::move(other.members);
 	memberNameToIndex = std::move(other.memberNameToIndex);
+	getHandledEvents = other.getHandledEvents;
+	m_handledEvents = std::move(other.m_handledEvents);
 	onCreateCallbacks = std::move(other.onCreateCallbacks);
 #ifdef _MSVC_VER
 	static_assert(sizeof(*this) == 200);
 #endif
 	return *this;
 }
+const std::vector<ComponentEventId> *ComponentInfo::GetHandledEvents() const
+{
+	if(getHandledEvents == nullptr)
+		return nullptr;
+	if(!m_handledEvents) {
+		m_handledEvents = std::vector<ComponentEventId> {};
+		getHandledEvents(*m_handledEvents);
+	}
+	return &*m_handledEvents;
+}
 std::optional<ComponentMemberIndex> ComponentInfo::FindMember(const std::string &name) const
 {
 	auto hash = get_component_member_name_hash(name);
@@ -329,6 +349,11 @@ CallbackHandle EntityComponentManager::AddCreationCallback(const std::string &co
 		id = PreRegisterComponentType(componentName);
 	return AddCreationCallback(id, onCreate);
 }
+EntityComponentManager::EntityComponentManager() : m_componentTypeSlots {std::make_unique<std::atomic<ComponentId>[]>(MAX_COMPONENT_TYPE_SLOTS)}
+{
+	for(auto i = decltype(MAX_COMPONENT_TYPE_SLOTS) {0u}; i < MAX_COMPONENT_TYPE_SLOTS; ++i)
+		m_componentTypeSlots[i].store(INVALID_COMPONENT_ID, std::memory_order_relaxed);
+}
 ComponentId EntityComponentManager::RegisterComponentType(const std::string &name, const std::function<util::TSharedHandle<BaseEntityComponent>(BaseEntity &)> &factory, ComponentFlags flags, const std::type_index *typeIndex)
 {
 	if(typeIndex != nullptr) {
@@ -505,6 +530,8 @@ const std::vector<BaseEntityComponent *> &EntityComponentManager::GetComponents(
 	return info.GetComponents();
 }
 void EntityComponentManager::DeregisterComponent(BaseEntityComponent &component) { m_components.at(component.GetComponentId()).Pop(component); }
+void EntityComponentManager::SetEventRoutingEnabled(bool enabled) { m_eventRoutingEnabled = enabled; }
+bool EntityComponentManager::IsEventRoutingEnabled() const { return m_eventRoutingEnabled; }
 
 ////////////////////
 
@@ -11,7 +11,9 @@
 #include "pragma/entities/entity_component_system.hpp"
 #include "pragma/entities/components/base_generic_component.hpp"
 #include "pragma/entities/components/base_entity_component_member_register.hpp"
+#include <sharedutils/scope_guard.h>
 #include <unordered_set>
+#include <algorithm>
 
 using namespace pragma;
 static std::vector<BaseEntityComponentSystem *> g_systemsScheduledForCleanup; // TODO: It would be cleaner to have one instance of this per game state
@@ -42,7 +44,7 @@ void BaseEntityComponentSystem::ClearComponents()
 				continue;
 			RemoveComponent(c->GetComponentId());
 		}
-		if(m_componentLookupTable.empty())
+		if(m_componentSlots.empty())
 			break;
 		// The removal of an entity component may have caused another component to be created, so we may have to do
 		// multiple iterations to properly remove them all.
@@ -55,30 +57,36 @@ void BaseEntityComponentSystem::ClearComponents()
 		}
 	}
 	m_components.clear();
+	if(m_eventBroadcastDepth == 0) {
+		m_eventSubscribers.clear();
+		m_allEventSubscribers.clear();
+		m_eventSubscriptions.clear();
+		m_pendingEventSubscribers.clear();
+	}
 }
 util::EventReply BaseEntityComponentSystem::BroadcastEvent(ComponentEventId ev, ComponentEvent &evData, const BaseEntityComponent *src) const
 {
 	// Note: This function must only be called from one thread at a time.
 	// For this reason multi-threaded events should never be broadcasted, and should
 	// always use InvokeEventCallbacks instead.
-	auto &components = const_cast<BaseEntityComponentSystem *>(this)->m_components;
+	auto it = m_eventSubscribers.find(ev);
+	auto &subscribers = (it != m_eventSubscribers.end()) ? it->second : const_cast<BaseEntityComponentSystem *>(this)->m_allEventSubscribers;
 
-	// During the loop, an event callback may create other components, which would invalidate our iterator.
-	// We'll track how many components we have to catch events like that.
-	auto numInitialComponents = components.size();
-	auto numComponents = numInitialComponents;
-	for(auto it = components.begin(); it != components.begin() + numInitialComponents; ++it) {
-		auto &component = *it;
-		if(component == nullptr || component.get() == src)
+	// During the loop, an event callback may add or remove components. Removed components are set to NULL
+	// and added components are appended to the end of the list, so we only have to process the subscribers
+	// that existed when the broadcast started.
+	++m_eventBroadcastDepth;
+	util::ScopeGuard sg {[this]() {
+		if(--m_eventBroadcastDepth == 0 && m_eventSubscribersDirty)
+			FlushEventSubscriberChanges();
+	}};
+	auto numSubscribers = subscribers.size();
+	for(size_t i = 0; i < numSubscribers; ++i) {
+		auto *component = subscribers[i].component;
+		if(component == nullptr || component == src)
 			continue;
-		auto idx = (it - components.begin());
 		if(component->HandleEvent(ev, evData) == util::EventReply::Handled)
 			return util::EventReply::Handled;
-		if(components.size() != numComponents) {
-			// Iterator has been invalidated. This can happen because a new component has been added.
-			it = components.begin() + idx;
-			numComponents = components.size();
-		}
 	}
 	return util::EventReply::Unhandled;
 }
@@ -87,6 +95,113 @@ util::EventReply BaseEntityComponentSystem::BroadcastEvent(ComponentEventId even
 	CEGenericComponentEvent ev {};
 	return BroadcastEvent(eventId, ev);
 }
+void BaseEntityComponentSystem::SubscribeToEvents(BaseEntityComponent &component)
+{
+	auto &subscription = m_eventSubscriptions[&component];
+	subscription.order = m_nextEventSubscriberOrder++;
+	auto *info = component.GetComponentInfo();
+	auto *handledEvents = (info && m_componentManager->IsEventRoutingEnabled()) ? info->GetHandledEvents() : nullptr;
+	if(handledEvents == nullptr) {
+		subscription.allEvents = true;
+		EventSubscriber subscriber {&component, subscription.order};
+		// The component was added last, so this is always an append
+		m_allEventSubscribers.push_back(subscriber);
+		for(auto &pair : m_eventSubscribers)
+			InsertEventSubscriber(pair.second, subscriber);
+		return;
+	}
+	for(auto eventId : *handledEvents)
+		SubscribeToEvent(component, eventId);
+	if(component.m_boundEvents) {
+		for(auto &pair : *component.m_boundEvents)
+			SubscribeToEvent(component, pair.first);
+	}
+}
+void BaseEntityComponentSystem::SubscribeToEvent(BaseEntityComponent &component, ComponentEventId eventId)
+{
+	auto it = m_eventSubscriptions.find(&component);
+	if(it == m_eventSubscriptions.end())
+		return; // Component hasn't been added yet; Its bound events will be subscribed to by SubscribeToEvents
+	auto &subscription = it->second;
+	if(subscription.allEvents || std::find(subscription.events.begin(), subscription.events.end(), eventId) != subscription.events.end())
+		return;
+	subscription.events.push_back(eventId);
+	EventSubscriber subscriber {&component, subscription.order};
+	auto &list = GetEventSubscribers(eventId);
+	if(m_eventBroadcastDepth > 0 && list.empty() == false && list.back().order > subscriber.order) {
+		// Inserting the subscriber in the middle of the list could cause a broadcast in progress to skip or repeat components
+		m_pendingEventSubscribers.push_back({eventId, subscriber});
+		m_eventSubscribersDirty = true;
+		return;
+	}
+	InsertEventSubscriber(list, subscriber);
+}
+void BaseEntityComponentSystem::UnsubscribeFromEvents(BaseEntityComponent &component)
+{
+	auto it = m_eventSubscriptions.find(&component);
+	if(it == m_eventSubscriptions.end())
+		return;
+	auto &subscription = it->second;
+	if(subscription.allEvents) {
+		RemoveEventSubscriber(m_allEventSubscribers, component);
+		for(auto &pair : m_eventSubscribers)
+			RemoveEventSubscriber(pair.second, component);
+	}
+	else {
+		for(auto eventId : subscription.events) {
+			auto itList = m_eventSubscribers.find(eventId);
+			if(itList != m_eventSubscribers.end())
+				RemoveEventSubscriber(itList->second, component);
+		}
+	}
+	m_pendingEventSubscribers.erase(std::remove_if(m_pendingEventSubscribers.begin(), m_pendingEventSubscribers.end(), [&component](const std::pair<ComponentEventId, EventSubscriber> &pair) { return pair.second.component == &component; }),
+	  m_pendingEventSubscribers.end());
+	m_eventSubscriptions.erase(it);
+}
+BaseEntityComponentSystem::EventSubscriberList &BaseEntityComponentSystem::GetEventSubscribers(ComponentEventId eventId)
+{
+	auto it = m_eventSubscribers.find(eventId);
+	if(it == m_eventSubscribers.end()) {
+		// Components that receive all events are subscribed to every event
+		it = m_eventSubscribers.insert(std::make_pair(eventId, m_allEventSubscribers)).first;
+	}
+	return it->second;
+}
+void BaseEntityComponentSystem::InsertEventSubscriber(EventSubscriberList &list, const EventSubscriber &subscriber)
+{
+	// Subscribers have to be notified in the same order in which the components were added to the entity
+	if(list.empty() || list.back().order < subscriber.order) {
+		list.push_back(subscriber);
+		return;
+	}
+	auto it = std::upper_bound(list.begin(), list.end(), subscriber.order, [](uint32_t order, const EventSubscriber &other) { return order < other.order; });
+	list.insert(it, subscriber);
+}
+void BaseEntityComponentSystem::RemoveEventSubscriber(EventSubscriberList &list, const BaseEntityComponent &component)
+{
+	auto it = std::find_if(list.begin(), list.end(), [&component](const EventSubscriber &subscriber) { return subscriber.component == &component; });
+	if(it == list.end())
+		return;
+	if(m_eventBroadcastDepth > 0) {
+		it->component = nullptr;
+		m_eventSubscribersDirty = true;
+		return;
+	}
+	list.erase(it);
+}
+void BaseEntityComponentSystem::FlushEventSubscriberChanges() const
+{
+	auto &self = const_cast<BaseEntityComponentSystem &>(*this);
+	auto fRemoveInvalid = [](EventSubscriberList &list) { list.erase(std::remove_if(list.begin(), list.end(), [](const EventSubscriber &subscriber) { return subscriber.component == nullptr; }), list.end()); };
+	fRemoveInvalid(self.m_allEventSubscribers);
+	for(auto &pair : m_eventSubscribers)
+		fRemoveInvalid(pair.second);
+	auto pending = std::move(m_pendingEventSubscribers);
+	m_pendingEventSubscribers.clear();
+	for(auto &pair : pending)
+		self.InsertEventSubscriber(self.GetEventSubscribers(pair.first), pair.second);
+	m_eventSubscribersDirty = false;
+}
 pragma::ComponentHandle<pragma::BaseEntityComponent> BaseEntityComponentSystem::AddComponent(ComponentId componentId, bool bForceCreateNew)
 {
 	if(bForceCreateNew == false) {
@@ -102,9 +217,9 @@ pragma::ComponentHandle<pragma::BaseEntityComponent> BaseEntityComponentSystem::
 	if(m_components.size() == m_components.capacity())
 		m_components.reserve(m_components.size() + 5u);
 	m_components.push_back(ptrComponent);
-	auto it = m_componentLookupTable.find(componentId);
-	if(it == m_componentLookupTable.end())
-		m_componentLookupTable.insert(std::make_pair(componentId, ptrComponent));
+	SubscribeToEvents(*ptrComponent);
+	if(FindComponentSlot(componentId) == nullptr)
+		SetComponentSlot(componentId, ptrComponent);
 
 	ptrComponent->Initialize();
 
@@ -206,6 +321,7 @@ void BaseEntityComponentSystem::RemoveComponent(pragma::BaseEntityComponent &com
 	// Clear the component. We can't erase it from m_components safely, so we just invalidate it
 	// for now. m_components will get cleaned up at a later date
 	*it = util::TSharedHandle<BaseEntityComponent> {};
+	UnsubscribeFromEvents(component);
 	if(!umath::is_flag_set(m_stateFlags, StateFlags::ComponentCleanupRequired)) {
 		if(!umath::is_flag_set(m_stateFlags, StateFlags::IsBeingRemoved)) { // No point for cleanup if we're already being removed
 			umath::set_flag(m_stateFlags, StateFlags::ComponentCleanupRequired, true);
@@ -228,15 +344,14 @@ void BaseEntityComponentSystem::RemoveComponent(pragma::BaseEntityComponent &com
 	// Safe to free now
 	tmpHandle = util::TSharedHandle<BaseEntityComponent> {};
 
-	auto itType = m_componentLookupTable.find(componentId);
-	if(itType != m_componentLookupTable.end()) {
+	if(componentId < m_componentSlotIndices.size() && m_componentSlotIndices[componentId] != 0) {
 		// Find a different component of the same type
 		auto it = std::find_if(m_components.begin(), m_components.end(), [componentId](const util::TSharedHandle<BaseEntityComponent> &ptrComponent) { return ptrComponent.valid() && ptrComponent->GetComponentId() == componentId; });
 		if(it == m_components.end()) {
-			m_componentLookupTable.erase(itType);
+			ClearComponentSlot(componentId);
 			return;
 		}
-		itType->second = *it;
+		SetComponentSlot(componentId, *it);
 	}
 }
 void BaseEntityComponentSystem::RemoveComponent(ComponentId componentId)
@@ -256,21 +371,45 @@ void BaseEntityComponentSystem::RemoveComponent(const std::string &name)
 }
 void BaseEntityComponentSystem::OnComponentAdded(BaseEntityComponent &component) {}
 void BaseEntityComponentSystem::OnComponentRemoved(BaseEntityComponent &component) {}
-bool pragma::BaseEntityComponentSystem::HasComponent(ComponentId componentId) const
-{
-	auto it = m_componentLookupTable.find(componentId);
-	return it != m_componentLookupTable.end() && it->second.expired() == false;
-}
+bool pragma::BaseEntityComponentSystem::HasComponent(ComponentId componentId) const { return FindComponentSlot(componentId) != nullptr; }
 
 const std::vector<util::TSharedHandle<BaseEntityComponent>> &BaseEntityComponentSystem::GetComponents() const { return const_cast<BaseEntityComponentSystem *>(this)->GetComponents(); }
 std::vector<util::TSharedHandle<BaseEntityComponent>> &BaseEntityComponentSystem::GetComponents() { return m_components; }
 
 pragma::ComponentHandle<BaseEntityComponent> BaseEntityComponentSystem::FindComponent(ComponentId componentId) const
 {
-	auto it = m_componentLookupTable.find(componentId);
-	if(it == m_componentLookupTable.end())
+	if(componentId >= m_componentSlotIndices.size())
 		return {};
-	return it->second;
+	auto idx = m_componentSlotIndices[componentId];
+	if(idx == 0)
+		return {};
+	return m_componentSlots[idx - 1].component;
+}
+void BaseEntityComponentSystem::SetComponentSlot(ComponentId componentId, const ComponentHandle<BaseEntityComponent> &component)
+{
+	if(componentId >= m_componentSlotIndices.size())
+		m_componentSlotIndices.resize(componentId + 1, 0);
+	auto &idx = m_componentSlotIndices[componentId];
+	if(idx != 0) {
+		m_componentSlots[idx - 1].component = component;
+		return;
+	}
+	m_componentSlots.push_back({componentId, component});
+	idx = static_cast<uint16_t>(m_componentSlots.size());
+}
+void BaseEntityComponentSystem::ClearComponentSlot(ComponentId componentId)
+{
+	if(componentId >= m_componentSlotIndices.size())
+		return;
+	auto idx = m_componentSlotIndices[componentId];
+	if(idx == 0)
+		return;
+	m_componentSlotIndices[componentId] = 0;
+	if(idx != m_componentSlots.size()) {
+		auto &slot = m_componentSlots[idx - 1] = std::move(m_componentSlots.back());
+		m_componentSlotIndices[slot.componentId] = idx;
+	}
+	m_componentSlots.pop_back();
 }
 pragma::ComponentHandle<BaseEntityComponent> BaseEntityComponentSystem::FindComponent(const std::string &name) const
 {
@@ -8,10 +8,14 @@
 #include "stdafx_shared.h"
 #include "pragma/entities/entity_iterator.hpp"
 #include "pragma/entities/entity_component_manager.hpp"
+#include <algorithm>
 
 std::size_t EntityContainer::Size() const { return ents.size(); }
 BaseEntity *EntityContainer::At(std::size_t index) { return ents.at(index); }
 
+std::size_t EntityHandleContainer::Size() const { return ents.size(); }
+BaseEntity *EntityHandleContainer::At(std::size_t index) { return ents.at(index).get(); }
+
 std::size_t ComponentContainer::Size() const { return components.size(); }
 BaseEntity *ComponentContainer::At(std::size_t index)
 {
@@ -19,10 +23,17 @@ BaseEntity *ComponentContainer::At(std::size_t index)
 	return (component != nullptr) ? &component->GetEntity() : nullptr;
 }
 
+BaseEntity *ComponentHandleContainer::At(std::size_t index)
+{
+	if(!m_handles.at(index).valid())
+		m_components[index] = nullptr;
+	return ComponentContainer::At(index);
+}
+
 /////////////////
 
 EntityIteratorData::EntityIteratorData(Game &game) : game(game), entities(std::make_unique<EntityContainer>(game.GetBaseEntities(), game.GetBaseEntityCount())) {}
-EntityIteratorData::EntityIteratorData(Game &game, const std::vector<pragma::BaseEntityComponent *> &components, std::size_t count) : game(game), entities(std::make_unique<ComponentContainer>(components, count)) {}
+EntityIteratorData::EntityIteratorData(Game &game, const std::vector<pragma::BaseEntityComponent *> &components, std::size_t count, pragma::ComponentId componentId) : game(game), entities(std::make_unique<ComponentContainer>(components, count, componentId)) {}
 std::size_t EntityIteratorData::GetCount() const { return entities->Count(); }
 bool EntityIteratorData::ShouldPass(BaseEntity &ent, std::size_t index) const
 {
@@ -92,7 +103,7 @@ EntityIterator::EntityIterator(Game &game, pragma::ComponentId componentId, Filt
 	if(componentId != pragma::INVALID_COMPONENT_ID) {
 		std::size_t count;
 		auto &components = game.GetEntityComponentManager().GetComponents(componentId, count);
-		m_iteratorData = std::make_shared<EntityIteratorData>(game, components, count); // AttachFilter<EntityIteratorFilterComponent>(componentId);
+		m_iteratorData = std::make_shared<EntityIteratorData>(game, components, count, componentId); // AttachFilter<EntityIteratorFilterComponent>(componentId);
 	}
 	if(m_iteratorData == nullptr)
 		return;
@@ -105,7 +116,7 @@ EntityIterator::EntityIterator(Game &game, const std::string &componentName, Fil
 	if(game.GetEntityComponentManager().GetComponentTypeId(componentName, componentId) == true && componentId != pragma::INVALID_COMPONENT_ID) {
 		std::size_t count;
 		auto &components = game.GetEntityComponentManager().GetComponents(componentId, count);
-		m_iteratorData = std::make_shared<EntityIteratorData>(game, components, count);
+		m_iteratorData = std::make_shared<EntityIteratorData>(game, components, count, componentId);
 	}
 	if(m_iteratorData == nullptr)
 		return;
@@ -122,7 +133,16 @@ void EntityIterator::SetBaseComponentType(pragma::ComponentId componentId)
 		return;
 	std::size_t count;
 	auto &components = m_iteratorData->game.GetEntityComponentManager().GetComponents(componentId, count);
-	m_iteratorData->entities = std::make_unique<ComponentContainer>(components, count);
+	m_iteratorData->entities = std::make_unique<ComponentContainer>(components, count, componentId);
+	if(m_iteratorData->hasCandidates) {
+		// The candidates have been replaced by the component list, so the filters have to be re-evaluated
+		m_iteratorData->hasCandidates = false;
+		m_iteratorData->candidates.clear();
+		m_iteratorData->componentCandidates.clear();
+		m_iteratorData->componentCandidateHandles.clear();
+		for(auto &filter : m_iteratorData->filters)
+			ApplyCandidateFilter(*filter);
+	}
 }
 void EntityIterator::SetBaseComponentType(std::type_index typeIndex)
 {
@@ -141,3 +161,54 @@ void EntityIterator::SetBaseComponentType(const std::string &componentName)
 	componentManager.GetComponentTypeId(componentName, componentId);
 	SetBaseComponentType(componentId);
 }
+void EntityIterator::ApplyCandidateFilter(const IEntityIteratorFilter &filter)
+{
+	if(!m_iteratorData)
+		return;
+	auto &itData = *m_iteratorData;
+	auto &container = *itData.entities;
+	auto componentId = pragma::INVALID_COMPONENT_ID;
+	auto &containerType = typeid(container);
+	if(containerType == typeid(ComponentContainer) || containerType == typeid(ComponentHandleContainer)) {
+		componentId = static_cast<ComponentContainer &>(container).componentId;
+		if(componentId == pragma::INVALID_COMPONENT_ID)
+			return;
+	}
+	else if(containerType != typeid(EntityContainer) && containerType != typeid(EntityHandleContainer))
+		return;
+
+	std::vector<BaseEntity *> candidates;
+	if(filter.GetCandidates(itData.game, candidates) == false)
+		return;
+	// Only narrow down the iterated entities if the filter is more selective than the current set
+	if(candidates.size() >= container.Count())
+		return;
+	// Keep the same order as iterating over all entities would
+	std::sort(candidates.begin(), candidates.end(), [](const BaseEntity *a, const BaseEntity *b) { return a->GetLocalIndex() < b->GetLocalIndex(); });
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	itData.hasCandidates = true;
+	if(componentId == pragma::INVALID_COMPONENT_ID) {
+		std::vector<EntityHandle> handles;
+		handles.reserve(candidates.size());
+		for(auto *ent : candidates)
+			handles.push_back(ent->GetHandle());
+		itData.candidates = std::move(handles);
+		itData.entities = std::make_unique<EntityHandleContainer>(itData.candidates, itData.candidates.size());
+		return;
+	}
+	std::vector<pragma::BaseEntityComponent *> componentCandidates;
+	std::vector<pragma::ComponentHandle<pragma::BaseEntityComponent>> componentCandidateHandles;
+	componentCandidates.reserve(candidates.size());
+	componentCandidateHandles.reserve(candidates.size());
+	for(auto *ent : candidates) {
+		auto *component = ent->FindComponent(componentId).get();
+		if(!component)
+			continue;
+		componentCandidates.push_back(component);
+		componentCandidateHandles.push_back(component->GetHandle());
+	}
+	itData.componentCandidates = std::move(componentCandidates);
+	itData.componentCandidateHandles = std::move(componentCandidateHandles);
+	itData.entities = std::make_unique<ComponentHandleContainer>(itData.componentCandidates, itData.componentCandidateHandles, componentId);
+}
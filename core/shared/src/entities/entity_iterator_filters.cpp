@@ -13,9 +13,22 @@
 #include "pragma/entities/components/base_name_component.hpp"
 #include "pragma/entities/components/base_model_component.hpp"
 #include "pragma/entities/basefilterentity.h"
+#include "pragma/entities/entity_lookup_index.hpp"
+#include "pragma/entities/entity_spatial_index.hpp"
 #include "pragma/asset/util_asset.hpp"
 #include <pragma/math/intersection.h>
 
+// Wildcard patterns can't be resolved through the lookup indices and require testing every entity
+static bool is_wildcard_pattern(const std::string &name) { return name.find_first_of("*?") != std::string::npos; }
+static void get_lookup_candidates(const pragma::EntityLookupIndex &index, const std::string &key, std::vector<BaseEntity *> &outCandidates)
+{
+	auto *ents = index.Find(key);
+	if(ents)
+		outCandidates.insert(outCandidates.end(), ents->begin(), ents->end());
+}
+
+/////////////////
+
 EntityIteratorFilterName::EntityIteratorFilterName(Game &game, const std::string &name, bool caseSensitive, bool exactMatch) : m_name(name), m_bCaseSensitive(caseSensitive), m_bExactMatch(exactMatch) {}
 bool EntityIteratorFilterName::ShouldPass(BaseEntity &ent, std::size_t index)
 {
@@ -24,6 +37,13 @@ bool EntityIteratorFilterName::ShouldPass(BaseEntity &ent, std::size_t index)
 		return false;
 	return m_bExactMatch ? ustring::match(pNameComponent->GetName(), m_name, m_bCaseSensitive) : ustring::compare(pNameComponent->GetName(), m_name, m_bCaseSensitive);
 }
+bool EntityIteratorFilterName::GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const
+{
+	if(m_name.empty() || (m_bExactMatch && is_wildcard_pattern(m_name)))
+		return false;
+	get_lookup_candidates(game.GetEntityNameIndex(), m_name, outCandidates);
+	return true;
+}
 
 /////////////////
 
@@ -40,11 +60,25 @@ bool EntityIteratorFilterModel::ShouldPass(BaseEntity &ent, std::size_t index)
 
 EntityIteratorFilterUuid::EntityIteratorFilterUuid(Game &game, const util::Uuid &uuid) : m_uuid {uuid} {}
 bool EntityIteratorFilterUuid::ShouldPass(BaseEntity &ent, std::size_t index) { return ent.GetUuid() == m_uuid; }
+bool EntityIteratorFilterUuid::GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const
+{
+	auto *ent = game.FindEntityByUniqueId(m_uuid);
+	if(ent)
+		outCandidates.push_back(ent);
+	return true;
+}
 
 /////////////////
 
 EntityIteratorFilterClass::EntityIteratorFilterClass(Game &game, const std::string &name, bool caseSensitive, bool exactMatch) : m_name(name), m_bCaseSensitive(caseSensitive), m_bExactMatch(exactMatch) {}
 bool EntityIteratorFilterClass::ShouldPass(BaseEntity &ent, std::size_t index) { return m_bExactMatch ? ustring::match(*ent.GetClass(), m_name.c_str(), m_bCaseSensitive) : ustring::compare(ent.GetClass().c_str(), m_name.c_str(), m_bCaseSensitive); }
+bool EntityIteratorFilterClass::GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const
+{
+	if(m_name.empty() || (m_bExactMatch && is_wildcard_pattern(m_name)))
+		return false;
+	get_lookup_candidates(game.GetEntityClassIndex(), m_name, outCandidates);
+	return true;
+}
 
 /////////////////
 
@@ -56,6 +90,14 @@ bool EntityIteratorFilterNameOrClass::ShouldPass(BaseEntity &ent, std::size_t in
 	auto pNameComponent = static_cast<pragma::BaseNameComponent *>(ent.FindComponent("name").get());
 	return pNameComponent != nullptr && (m_bExactMatch ? ustring::match(pNameComponent->GetName(), m_name, m_bCaseSensitive) : ustring::compare(pNameComponent->GetName(), m_name, m_bCaseSensitive));
 }
+bool EntityIteratorFilterNameOrClass::GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const
+{
+	if(m_name.empty() || (m_bExactMatch && is_wildcard_pattern(m_name)))
+		return false;
+	get_lookup_candidates(game.GetEntityClassIndex(), m_name, outCandidates);
+	get_lookup_candidates(game.GetEntityNameIndex(), m_name, outCandidates);
+	return true;
+}
 
 /////////////////
 
@@ -89,6 +131,15 @@ bool EntityIteratorFilterEntity::ShouldPass(BaseEntity &ent, std::size_t index)
 	auto pNameComponent = static_cast<pragma::BaseNameComponent *>(ent.FindComponent("name").get());
 	return pNameComponent != nullptr && ustring::compare(pNameComponent->GetName(), m_name, false);
 }
+bool EntityIteratorFilterEntity::GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const
+{
+	// Filter entities can pass arbitrary entities
+	if(m_name.empty() || m_filterEnts.empty() == false)
+		return false;
+	get_lookup_candidates(game.GetEntityClassIndex(), m_name, outCandidates);
+	get_lookup_candidates(game.GetEntityNameIndex(), m_name, outCandidates);
+	return true;
+}
 
 /////////////////
 
@@ -196,6 +247,22 @@ bool EntityIteratorFilterSphere::ShouldPass(BaseEntity &ent, std::size_t index)
 	return ShouldPass(ent, index, r, d);
 }
 
+bool IEntityIteratorSpatialFilter::GetCandidates(Game &game, std::vector<BaseEntity *> &outCandidates) const
+{
+	Vector3 min, max;
+	GetBounds(min, max);
+	game.GetEntitySpatialIndex().FindCandidates(min, max, outCandidates);
+	return true;
+}
+
+/////////////////
+
+void EntityIteratorFilterSphere::GetBounds(Vector3 &outMin, Vector3 &outMax) const
+{
+	outMin = m_origin - Vector3 {m_radius, m_radius, m_radius};
+	outMax = m_origin + Vector3 {m_radius, m_radius, m_radius};
+}
+
 /////////////////
 
 EntityIteratorFilterBox::EntityIteratorFilterBox(Game &game, const Vector3 &min, const Vector3 &max) : m_min(min), m_max(max) {}
@@ -210,7 +277,14 @@ bool EntityIteratorFilterBox::ShouldPass(BaseEntity &ent, std::size_t index)
 	Vector3 entMax {};
 	if(pPhysComponent != nullptr)
 		pPhysComponent->GetCollisionBounds(&entMin, &entMax);
-	return umath::intersection::aabb_aabb(m_min, m_max, entMin, entMax) != umath::intersection::Intersect::Outside;
+	auto &pos = pTrComponent->GetPosition();
+	return umath::intersection::aabb_aabb(m_min, m_max, entMin + pos, entMax + pos) != umath::intersection::Intersect::Outside;
+}
+
+void EntityIteratorFilterBox::GetBounds(Vector3 &outMin, Vector3 &outMax) const
+{
+	outMin = m_min;
+	outMax = m_max;
 }
 
 /////////////////
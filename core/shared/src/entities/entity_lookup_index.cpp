@@ -0,0 +1,47 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/entity_lookup_index.hpp"
+#include <sharedutils/util_string.h>
+
+using namespace pragma;
+
+void EntityLookupIndex::Add(const std::string &key, BaseEntity &ent)
+{
+	if(key.empty())
+		return;
+	auto lkey = key;
+	ustring::to_lower(lkey);
+	m_entities[lkey].insert(&ent);
+}
+
+void EntityLookupIndex::Remove(const std::string &key, BaseEntity &ent)
+{
+	if(key.empty())
+		return;
+	auto lkey = key;
+	ustring::to_lower(lkey);
+	auto it = m_entities.find(lkey);
+	if(it == m_entities.end())
+		return;
+	it->second.erase(&ent);
+	if(it->second.empty())
+		m_entities.erase(it);
+}
+
+const EntityLookupIndex::EntitySet *EntityLookupIndex::Find(const std::string &key) const
+{
+	if(key.empty())
+		return nullptr;
+	auto lkey = key;
+	ustring::to_lower(lkey);
+	auto it = m_entities.find(lkey);
+	return (it != m_entities.end()) ? &it->second : nullptr;
+}
+
+void EntityLookupIndex::Clear() { m_entities.clear(); }
@@ -0,0 +1,270 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/entity_spatial_index.hpp"
+#include "pragma/entities/components/base_transform_component.hpp"
+#include "pragma/entities/components/base_physics_component.hpp"
+#include <cmath>
+
+using namespace pragma;
+
+static constexpr uint32_t CELL_COORDINATE_BITS = 21;
+static constexpr int32_t CELL_COORDINATE_MIN = -(1 << (CELL_COORDINATE_BITS - 1));
+static constexpr int32_t CELL_COORDINATE_MAX = (1 << (CELL_COORDINATE_BITS - 1)) - 1;
+static constexpr uint64_t CELL_COORDINATE_MASK = (1ull << CELL_COORDINATE_BITS) - 1;
+
+EntitySpatialIndex::EntitySpatialIndex()
+{
+	auto cellSize = BASE_CELL_SIZE;
+	for(auto &level : m_levels) {
+		level.cellSize = cellSize;
+		cellSize *= 2.f;
+	}
+}
+
+EntitySpatialIndex::CellKey EntitySpatialIndex::GetCellKey(int32_t x, int32_t y, int32_t z)
+{
+	return ((static_cast<uint64_t>(x) & CELL_COORDINATE_MASK) << (CELL_COORDINATE_BITS * 2)) | ((static_cast<uint64_t>(y) & CELL_COORDINATE_MASK) << CELL_COORDINATE_BITS) | (static_cast<uint64_t>(z) & CELL_COORDINATE_MASK);
+}
+
+void EntitySpatialIndex::GetCellCoordinates(CellKey key, int32_t &x, int32_t &y, int32_t &z)
+{
+	auto signExtend = [](uint64_t v) -> int32_t {
+		v &= CELL_COORDINATE_MASK;
+		if(v & (1ull << (CELL_COORDINATE_BITS - 1)))
+			v |= ~CELL_COORDINATE_MASK;
+		return static_cast<int32_t>(static_cast<int64_t>(v));
+	};
+	x = signExtend(key >> (CELL_COORDINATE_BITS * 2));
+	y = signExtend(key >> CELL_COORDINATE_BITS);
+	z = signExtend(key);
+}
+
+int32_t EntitySpatialIndex::GetCellCoordinate(float v, float cellSize)
+{
+	auto c = std::floor(v / cellSize);
+	// Coordinates outside of the representable range are clamped to the outermost cells, which keeps the
+	// result conservative. The negated comparison also catches NaN values.
+	if(!(c >= static_cast<float>(CELL_COORDINATE_MIN)))
+		return CELL_COORDINATE_MIN;
+	if(c > static_cast<float>(CELL_COORDINATE_MAX))
+		return CELL_COORDINATE_MAX;
+	return static_cast<int32_t>(c);
+}
+
+void EntitySpatialIndex::Add(BaseTransformComponent &component)
+{
+	if(component.m_spatialIndexSlot != INVALID_SLOT)
+		return;
+	SlotId slotId;
+	if(m_freeSlots.empty() == false) {
+		slotId = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slotId = static_cast<SlotId>(m_slots.size());
+		m_slots.push_back({});
+	}
+	auto &slot = m_slots[slotId];
+	slot.component = &component;
+	// The entity will be linked into its cell the next time the index is queried
+	slot.dirty = true;
+	m_dirtySlots.push_back(slotId);
+	component.m_spatialIndexSlot = slotId;
+	++m_count;
+}
+
+void EntitySpatialIndex::Remove(BaseTransformComponent &component)
+{
+	auto slotId = component.m_spatialIndexSlot;
+	if(slotId == INVALID_SLOT)
+		return;
+	Unlink(slotId);
+	// Stale entries in m_dirtySlots are skipped during the next flush
+	m_slots[slotId] = {};
+	m_freeSlots.push_back(slotId);
+	component.m_spatialIndexSlot = INVALID_SLOT;
+	--m_count;
+}
+
+void EntitySpatialIndex::MarkDirty(BaseTransformComponent &component)
+{
+	auto slotId = component.m_spatialIndexSlot;
+	if(slotId == INVALID_SLOT)
+		return;
+	auto &slot = m_slots[slotId];
+	if(slot.dirty)
+		return;
+	slot.dirty = true;
+	m_dirtySlots.push_back(slotId);
+}
+
+void EntitySpatialIndex::Flush()
+{
+	for(auto slotId : m_dirtySlots) {
+		auto &slot = m_slots[slotId];
+		if(slot.component == nullptr || slot.dirty == false)
+			continue;
+		UpdateSlot(slotId);
+	}
+	m_dirtySlots.clear();
+}
+
+void EntitySpatialIndex::UpdateSlot(SlotId slotId)
+{
+	auto &slot = m_slots[slotId];
+	slot.dirty = false;
+	auto &trComponent = *slot.component;
+	auto center = trComponent.GetPosition();
+	auto radius = 0.f;
+	// Same bounding sphere as used by EntityIteratorFilterSphere, which also encloses the collision bounds
+	auto pPhysComponent = trComponent.GetEntity().GetPhysicsComponent();
+	if(pPhysComponent) {
+		Vector3 colCenter;
+		radius = pPhysComponent->GetCollisionRadius(&colCenter);
+		center += colCenter;
+	}
+
+	auto level = OVERSIZED_LEVEL;
+	if(std::isfinite(center.x) && std::isfinite(center.y) && std::isfinite(center.z) && std::isfinite(radius)) {
+		for(auto i = decltype(m_levels.size()) {0u}; i < m_levels.size(); ++i) {
+			if(radius <= m_levels[i].cellSize * 0.5f) {
+				level = static_cast<uint32_t>(i);
+				break;
+			}
+		}
+	}
+	CellKey cell = 0;
+	if(level != OVERSIZED_LEVEL) {
+		auto cellSize = m_levels[level].cellSize;
+		cell = GetCellKey(GetCellCoordinate(center.x, cellSize), GetCellCoordinate(center.y, cellSize), GetCellCoordinate(center.z, cellSize));
+	}
+	if(slot.level == level && slot.cell == cell)
+		return;
+	Unlink(slotId);
+	Link(slotId, level, cell);
+}
+
+void EntitySpatialIndex::Link(SlotId slotId, uint32_t level, CellKey cell)
+{
+	auto &slot = m_slots[slotId];
+	std::vector<SlotId> *list;
+	if(level == OVERSIZED_LEVEL)
+		list = &m_oversized;
+	else {
+		auto &lv = m_levels[level];
+		list = &lv.cells[cell];
+		++lv.count;
+	}
+	slot.level = level;
+	slot.cell = cell;
+	slot.cellIndex = static_cast<uint32_t>(list->size());
+	list->push_back(slotId);
+}
+
+void EntitySpatialIndex::Unlink(SlotId slotId)
+{
+	auto &slot = m_slots[slotId];
+	if(slot.level == INVALID_INDEX)
+		return;
+	std::vector<SlotId> *list;
+	Level *lv = nullptr;
+	std::unordered_map<CellKey, std::vector<SlotId>>::iterator itCell;
+	if(slot.level == OVERSIZED_LEVEL)
+		list = &m_oversized;
+	else {
+		lv = &m_levels[slot.level];
+		itCell = lv->cells.find(slot.cell);
+		assert(itCell != lv->cells.end());
+		list = &itCell->second;
+		--lv->count;
+	}
+	auto lastSlotId = list->back();
+	(*list)[slot.cellIndex] = lastSlotId;
+	m_slots[lastSlotId].cellIndex = slot.cellIndex;
+	list->pop_back();
+	if(lv && list->empty())
+		lv->cells.erase(itCell);
+	slot.level = INVALID_INDEX;
+	slot.cellIndex = INVALID_INDEX;
+	slot.cell = 0;
+}
+
+void EntitySpatialIndex::CollectCandidates(uint32_t level, const Vector3 &min, const Vector3 &max, std::vector<SlotId> &outSlots) const
+{
+	auto &lv = m_levels[level];
+	// Entities may extend up to half a cell beyond the cell that contains their center
+	auto cellSize = lv.cellSize;
+	auto halfCellSize = cellSize * 0.5f;
+	auto x0 = GetCellCoordinate(min.x - halfCellSize, cellSize);
+	auto y0 = GetCellCoordinate(min.y - halfCellSize, cellSize);
+	auto z0 = GetCellCoordinate(min.z - halfCellSize, cellSize);
+	auto x1 = GetCellCoordinate(max.x + halfCellSize, cellSize);
+	auto y1 = GetCellCoordinate(max.y + halfCellSize, cellSize);
+	auto z1 = GetCellCoordinate(max.z + halfCellSize, cellSize);
+	if(x1 < x0 || y1 < y0 || z1 < z0)
+		return;
+	auto numCells = static_cast<uint64_t>(x1 - x0 + 1) * static_cast<uint64_t>(y1 - y0 + 1) * static_cast<uint64_t>(z1 - z0 + 1);
+	if(numCells > lv.cells.size()) {
+		// The query covers more cells than are occupied, so it's cheaper to test the occupied cells instead
+		for(auto &[key, slots] : lv.cells) {
+			int32_t x, y, z;
+			GetCellCoordinates(key, x, y, z);
+			if(x < x0 || x > x1 || y < y0 || y > y1 || z < z0 || z > z1)
+				continue;
+			outSlots.insert(outSlots.end(), slots.begin(), slots.end());
+		}
+		return;
+	}
+	for(auto x = x0; x <= x1; ++x) {
+		for(auto y = y0; y <= y1; ++y) {
+			for(auto z = z0; z <= z1; ++z) {
+				auto it = lv.cells.find(GetCellKey(x, y, z));
+				if(it == lv.cells.end())
+					continue;
+				outSlots.insert(outSlots.end(), it->second.begin(), it->second.end());
+			}
+		}
+	}
+}
+
+void EntitySpatialIndex::FindCandidates(const Vector3 &min, const Vector3 &max, std::vector<BaseEntity *> &outEntities)
+{
+	Flush();
+	m_queryResult.clear();
+	for(auto i = decltype(m_levels.size()) {0u}; i < m_levels.size(); ++i) {
+		if(m_levels[i].count == 0)
+			continue;
+		CollectCandidates(static_cast<uint32_t>(i), min, max, m_queryResult);
+	}
+	m_queryResult.insert(m_queryResult.end(), m_oversized.begin(), m_oversized.end());
+
+	outEntities.reserve(outEntities.size() + m_queryResult.size());
+	for(auto slotId : m_queryResult)
+		outEntities.push_back(&m_slots[slotId].component->GetEntity());
+}
+
+void EntitySpatialIndex::Clear()
+{
+	for(auto &slot : m_slots) {
+		if(slot.component)
+			slot.component->m_spatialIndexSlot = INVALID_SLOT;
+	}
+	m_slots.clear();
+	m_freeSlots.clear();
+	m_dirtySlots.clear();
+	for(auto &level : m_levels) {
+		level.cells.clear();
+		level.count = 0;
+	}
+	m_oversized.clear();
+	m_queryResult.clear();
+	m_count = 0;
+}
+
+size_t EntitySpatialIndex::GetEntityCount() const { return m_count; }
@@ -0,0 +1,194 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/entities/entity_tick_scheduler.hpp"
+#include "pragma/entities/components/base_entity_component.hpp"
+#include <algorithm>
+
+using namespace pragma;
+
+void EntityTickScheduler::Add(BaseEntityComponent &component)
+{
+	auto &tickData = component.m_tickData;
+	if(tickData.schedulerSlot != INVALID_SLOT)
+		return;
+	SlotId slotId;
+	if(m_freeSlots.empty() == false) {
+		slotId = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else {
+		slotId = static_cast<SlotId>(m_slots.size());
+		m_slots.push_back({});
+	}
+	m_slots[slotId].component = &component;
+	tickData.schedulerSlot = slotId;
+	// If the next tick lies in the future, the component will be deferred the first time it is visited
+	AddActive(slotId);
+}
+
+void EntityTickScheduler::Remove(BaseEntityComponent &component)
+{
+	auto &tickData = component.m_tickData;
+	auto slotId = tickData.schedulerSlot;
+	if(slotId == INVALID_SLOT)
+		return;
+	auto &slot = m_slots[slotId];
+	if(slot.activeIndex != INVALID_INDEX)
+		RemoveActive(slotId);
+	auto wasDeferred = slot.deferred;
+	if(wasDeferred) {
+		// The heap entry will be discarded once it comes up
+		slot.deferred = false;
+		--m_deferredCount;
+	}
+	++slot.generation;
+	slot.component = nullptr;
+	m_freeSlots.push_back(slotId);
+	tickData.schedulerSlot = INVALID_SLOT;
+	if(wasDeferred)
+		CompactDeferred();
+}
+
+void EntityTickScheduler::OnNextTickChanged(BaseEntityComponent &component)
+{
+	auto slotId = component.m_tickData.schedulerSlot;
+	if(slotId == INVALID_SLOT)
+		return;
+	auto &slot = m_slots[slotId];
+	if(slot.deferred == false)
+		return; // Active components check their next tick time every tick anyway
+	// Invalidates the previous heap entry
+	++slot.generation;
+	PushDeferred({component.GetNextTick(), slotId, slot.generation});
+}
+
+void EntityTickScheduler::AddActive(SlotId slotId)
+{
+	m_slots[slotId].activeIndex = static_cast<uint32_t>(m_active.size());
+	m_active.push_back(slotId);
+}
+
+void EntityTickScheduler::RemoveActive(SlotId slotId)
+{
+	auto &slot = m_slots[slotId];
+	auto idx = slot.activeIndex;
+	slot.activeIndex = INVALID_INDEX;
+	if(m_ticking) {
+		// Swapping would change the order of the elements that haven't been visited yet, so we leave a hole
+		// and close it after the loop.
+		m_active[idx] = INVALID_SLOT;
+		m_activeHoles.push_back(idx);
+		return;
+	}
+	if(idx != m_active.size() - 1) {
+		m_active[idx] = m_active.back();
+		m_slots[m_active[idx]].activeIndex = idx;
+	}
+	m_active.pop_back();
+}
+
+void EntityTickScheduler::Defer(SlotId slotId, double time)
+{
+	RemoveActive(slotId);
+	auto &slot = m_slots[slotId];
+	slot.deferred = true;
+	++slot.generation;
+	++m_deferredCount;
+	PushDeferred({time, slotId, slot.generation});
+}
+
+void EntityTickScheduler::PushDeferred(const DeferredEntry &entry)
+{
+	m_deferred.push_back(entry);
+	std::push_heap(m_deferred.begin(), m_deferred.end(), std::greater<DeferredEntry> {});
+	CompactDeferred();
+}
+
+void EntityTickScheduler::CompactDeferred()
+{
+	// Components that change their next tick time often (or are removed while deferred) would otherwise
+	// grow the heap indefinitely, since outdated entries are only discarded once they are due.
+	constexpr size_t minCompactSize = 64;
+	if(m_deferred.size() < minCompactSize || m_deferred.size() - m_deferredCount <= m_deferredCount)
+		return;
+	m_deferred.erase(std::remove_if(m_deferred.begin(), m_deferred.end(),
+	                   [this](const DeferredEntry &entry) {
+		                   auto &slot = m_slots[entry.slot];
+		                   return slot.deferred == false || slot.generation != entry.generation;
+	                   }),
+	  m_deferred.end());
+	std::make_heap(m_deferred.begin(), m_deferred.end(), std::greater<DeferredEntry> {});
+}
+
+void EntityTickScheduler::CompactActive()
+{
+	// Fill the holes from the back, starting with the highest index, so we never move a hole into a hole
+	std::sort(m_activeHoles.begin(), m_activeHoles.end(), std::greater<uint32_t> {});
+	for(auto idx : m_activeHoles) {
+		if(idx != m_active.size() - 1) {
+			m_active[idx] = m_active.back();
+			m_slots[m_active[idx]].activeIndex = idx;
+		}
+		m_active.pop_back();
+	}
+	m_activeHoles.clear();
+}
+
+void EntityTickScheduler::Tick(double curTime, double tDelta)
+{
+	m_ticking = true;
+	// Wake up deferred components that are due
+	while(m_deferred.empty() == false && m_deferred.front().time <= curTime) {
+		std::pop_heap(m_deferred.begin(), m_deferred.end(), std::greater<DeferredEntry> {});
+		auto entry = m_deferred.back();
+		m_deferred.pop_back();
+		auto &slot = m_slots[entry.slot];
+		if(slot.deferred == false || slot.generation != entry.generation)
+			continue; // Outdated entry
+		slot.deferred = false;
+		--m_deferredCount;
+		AddActive(entry.slot);
+	}
+
+	// Note: New components may be appended to m_active during the loop, which have to be ticked as well.
+	for(size_t i = 0; i < m_active.size(); ++i) {
+		auto slotId = m_active[i];
+		if(slotId == INVALID_SLOT)
+			continue;
+		auto *c = m_slots[slotId].component;
+		auto nextTick = c->GetNextTick();
+		if(curTime < nextTick) {
+			Defer(slotId, nextTick);
+			continue;
+		}
+		if(c->Tick(tDelta) == false) {
+			// The component is still valid, but doesn't want to tick anymore
+			Remove(*c);
+		}
+	}
+	m_ticking = false;
+	CompactActive();
+}
+
+void EntityTickScheduler::Clear()
+{
+	for(auto &slot : m_slots) {
+		if(slot.component)
+			slot.component->m_tickData.schedulerSlot = INVALID_SLOT;
+	}
+	m_slots.clear();
+	m_freeSlots.clear();
+	m_active.clear();
+	m_activeHoles.clear();
+	m_deferred.clear();
+	m_deferredCount = 0;
+}
+
+size_t EntityTickScheduler::GetActiveCount() const { return m_active.size() - m_activeHoles.size(); }
+size_t EntityTickScheduler::GetDeferredCount() const { return m_deferredCount; }
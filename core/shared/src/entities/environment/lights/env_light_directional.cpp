@@ -57,6 +57,12 @@ void BaseEnvLightDirectionalComponent::Load(udm::LinkedPropertyWrapperArg udm, u
 	udm["ambientColor"](color);
 	*m_ambientColor = Color {color};
 }
+void BaseEnvLightDirectionalComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseEnvLightComponent::EVENT_CALC_LIGHT_DIRECTION_TO_POINT);
+	outEvents.push_back(BaseEnvLightComponent::EVENT_CALC_LIGHT_INTENSITY_AT_POINT);
+}
 util::EventReply BaseEnvLightDirectionalComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(eventId == BaseEnvLightComponent::EVENT_CALC_LIGHT_DIRECTION_TO_POINT) {
@@ -21,6 +21,12 @@ void BaseEnvLightPointComponent::Initialize()
 	ent.AddComponent("light");
 	ent.AddComponent("radius");
 }
+void BaseEnvLightPointComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseEnvLightComponent::EVENT_CALC_LIGHT_DIRECTION_TO_POINT);
+	outEvents.push_back(BaseEnvLightComponent::EVENT_CALC_LIGHT_INTENSITY_AT_POINT);
+}
 util::EventReply BaseEnvLightPointComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(eventId == BaseEnvLightComponent::EVENT_CALC_LIGHT_DIRECTION_TO_POINT) {
@@ -102,6 +102,12 @@ Candela BaseEnvLightSpotComponent::CalcIntensityAtPoint(const Vector3 &lightPos,
 	intensity *= CalcIntensityFalloff(lightPos, lightDir, outerConeAngle, innerConeAngle, point, radius);
 	return intensity;
 }
+void BaseEnvLightSpotComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseEnvLightComponent::EVENT_CALC_LIGHT_DIRECTION_TO_POINT);
+	outEvents.push_back(BaseEnvLightComponent::EVENT_CALC_LIGHT_INTENSITY_AT_POINT);
+}
 util::EventReply BaseEnvLightSpotComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(eventId == BaseEnvLightComponent::EVENT_CALC_LIGHT_DIRECTION_TO_POINT) {
@@ -45,6 +45,12 @@ void BaseFuncButtonComponent::Initialize()
 	ent.AddComponent<pragma::UsableComponent>();
 }
 
+void BaseFuncButtonComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(UsableComponent::EVENT_ON_USE);
+}
+
 util::EventReply BaseFuncButtonComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
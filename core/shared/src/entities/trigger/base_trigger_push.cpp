@@ -103,6 +103,12 @@ void BaseTriggerPushComponent::OnTick(double dt)
 	}
 }
 
+void BaseTriggerPushComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseTouchComponent::EVENT_ON_START_TOUCH);
+}
+
 util::EventReply BaseTriggerPushComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
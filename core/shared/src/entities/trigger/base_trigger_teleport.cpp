@@ -33,6 +33,12 @@ void BaseTriggerTeleportComponent::Initialize()
 	ent.AddComponent("touch");
 }
 
+void BaseTriggerTeleportComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseTouchComponent::EVENT_ON_START_TOUCH);
+}
+
 util::EventReply BaseTriggerTeleportComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
@@ -74,6 +74,12 @@ void BaseEntityTriggerGravityComponent::OnEndTouch(BaseEntity *ent)
 	}
 }
 void BaseEntityTriggerGravityComponent::OnResetGravity(BaseEntity *ent, GravitySettings &settings) {}
+void BaseEntityTriggerGravityComponent::GetHandledEvents(std::vector<ComponentEventId> &outEvents)
+{
+	BaseEntityComponent::GetHandledEvents(outEvents);
+	outEvents.push_back(BaseTouchComponent::EVENT_ON_START_TOUCH);
+	outEvents.push_back(BaseTouchComponent::EVENT_ON_END_TOUCH);
+}
 util::EventReply BaseEntityTriggerGravityComponent::HandleEvent(ComponentEventId eventId, ComponentEvent &evData)
 {
 	if(BaseEntityComponent::HandleEvent(eventId, evData) == util::EventReply::Handled)
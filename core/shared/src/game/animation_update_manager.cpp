@@ -11,10 +11,14 @@
 #include "pragma/entities/components/animation_driver_component.hpp"
 #include "pragma/entities/components/panima_component.hpp"
 #include "pragma/entities/components/constraints/constraint_manager_component.hpp"
+#include "pragma/entities/components/base_player_component.hpp"
+#include "pragma/entities/components/base_transform_component.hpp"
+#include "pragma/util/util_bsp_tree.hpp"
 #include "pragma/entities/entity_iterator.hpp"
 #include "pragma/entities/entity_component_system_t.hpp"
+#include "pragma/engine.h"
 
-pragma::AnimationUpdateManager::AnimationUpdateManager(Game &game) : game {game}, m_threadPool {10, "animation_update"}
+pragma::AnimationUpdateManager::AnimationUpdateManager(Game &game) : game {game}
 {
 	auto &componentManager = game.GetEntityComponentManager();
 	auto r = componentManager.GetComponentTypeId("animated", m_animatedComponentId);
@@ -58,21 +62,214 @@ void pragma::AnimationUpdateManager::UpdateEntityAnimationDrivers(double dt)
 		ent->GetComponent<pragma::AnimationDriverComponent>()->ApplyDriver();
 }
 void pragma::AnimationUpdateManager::UpdateConstraints(double dt) { pragma::ConstraintManagerComponent::ApplyConstraints(*game.GetNetworkState()); }
-void pragma::AnimationUpdateManager::UpdateAnimations(double dt)
+static auto cvMultiThreaded = GetConVar("sh_animation_update_multithreaded");
+static auto cvLodEnabled = GetConVar("sh_animation_lod_enabled");
+static auto cvLodReducedDistance = GetConVar("sh_animation_lod_reduced_distance");
+static auto cvLodCachedDistance = GetConVar("sh_animation_lod_cached_distance");
+static auto cvLodReducedInterval = GetConVar("sh_animation_lod_reduced_interval");
+static auto cvLodCachedInterval = GetConVar("sh_animation_lod_cached_interval");
+void pragma::AnimationUpdateManager::SetBSPTree(const std::shared_ptr<util::BSPTree> &bspTree) { m_bspTree = bspTree; }
+uint32_t pragma::AnimationUpdateManager::GetLodUpdateInterval(LodTier tier)
+{
+	switch(tier) {
+	case LodTier::Reduced:
+		return umath::max(cvLodReducedInterval->GetInt(), 1);
+	case LodTier::Cached:
+		return umath::max(cvLodCachedInterval->GetInt(), 1);
+	default:
+		return 1;
+	}
+}
+pragma::AnimationUpdateManager::LodTier pragma::AnimationUpdateManager::DetermineLodTier(const AnimatedEntity &entInfo) const
 {
+	auto *trC = entInfo.entity->GetTransformComponent();
+	if(!trC)
+		return LodTier::Full;
+	auto &pos = trC->GetPosition();
+	auto minDistSqr = std::numeric_limits<float>::max();
+	auto visible = false;
+	auto cluster = std::numeric_limits<util::BSPTree::ClusterIndex>::max();
+	auto clusterDetermined = false;
+	for(auto &observer : m_lodObservers) {
+		minDistSqr = umath::min(minDistSqr, uvec::length_sqr(pos - observer.position));
+		if(visible)
+			continue;
+		if(observer.visibleClusters.empty()) {
+			visible = true;
+			continue;
+		}
+		if(!clusterDetermined) {
+			clusterDetermined = true;
+			auto *node = m_bspTree->FindLeafNode(pos);
+			if(node)
+				cluster = node->cluster;
+		}
+		// The origin may be inside of solid geometry, in which case we can't make any assumptions
+		visible = (cluster == std::numeric_limits<util::BSPTree::ClusterIndex>::max()) || util::BSPTree::IsClusterVisible(observer.visibleClusters, cluster);
+	}
+	if(!visible)
+		return LodTier::Cached;
+	auto dist = umath::sqrt(minDistSqr);
+	if(dist >= cvLodCachedDistance->GetFloat())
+		return LodTier::Cached;
+	if(dist >= cvLodReducedDistance->GetFloat())
+		return LodTier::Reduced;
+	return LodTier::Full;
+}
+void pragma::AnimationUpdateManager::UpdateLodTiers(double dt)
+{
+	++m_lodTick;
+	size_t numObservers = 0;
+	if(cvLodEnabled->GetBool()) {
+		std::vector<BaseEntity *> players;
+		game.GetPlayers(&players);
+		for(auto *ent : players) {
+			auto plC = ent->GetPlayerComponent();
+			if(plC.expired())
+				continue;
+			if(numObservers >= m_lodObservers.size())
+				m_lodObservers.push_back({});
+			auto &observer = m_lodObservers[numObservers++];
+			observer.position = plC->GetViewPos();
+			observer.visibleClusters.clear();
+			if(!m_bspTree)
+				continue;
+			auto *node = m_bspTree->FindLeafNode(observer.position);
+			if(node && node->cluster != std::numeric_limits<util::BSPTree::ClusterIndex>::max())
+				m_bspTree->DecompressClusterVisibility(node->cluster, observer.visibleClusters);
+		}
+	}
+	m_lodObservers.resize(numObservers);
+
 	for(auto &entInfo : m_animatedEntities) {
-		auto maintainAnimations = entInfo.animatedC ? entInfo.animatedC->PreMaintainAnimations(dt) : false;
+		// Panima animations may modify bone poses through their channels every tick, so they're always fully updated.
+		// Without any observers (e.g. if LOD is disabled) there's nothing to determine the level of detail from.
+		auto tier = (m_lodObservers.empty() || entInfo.panimaC) ? LodTier::Full : DetermineLodTier(entInfo);
+		// Entities that have become more relevant are updated immediately
+		auto promoted = tier < entInfo.lodTier;
+		entInfo.lodTier = tier;
+		if(tier != LodTier::Reduced) {
+			entInfo.lodSrcPoses.clear();
+			entInfo.lodDstPoses.clear();
+		}
+		// The entity index is used as phase offset, so throttled entities are spread evenly across ticks
+		entInfo.lodUpdate = (tier == LodTier::Full || promoted || ((m_lodTick + entInfo.entity->GetIndex()) % GetLodUpdateInterval(tier)) == 0);
+		if(entInfo.lodUpdate) {
+			entInfo.lodUpdateSpan = entInfo.lodTicksSinceUpdate + 1;
+			entInfo.lodTicksSinceUpdate = 0;
+			continue;
+		}
+		entInfo.lodAccumulatedDt += dt;
+		++entInfo.lodTicksSinceUpdate;
+	}
+}
+void pragma::AnimationUpdateManager::ApplyLodInterpolation(AnimatedEntity &entInfo) const
+{
+	if(entInfo.lodTier != LodTier::Reduced || !entInfo.animatedC)
+		return;
+	auto &bones = entInfo.animatedC->GetBoneTransforms();
+	if(entInfo.lodUpdate) {
+		// The newly evaluated pose is used as-is, we only have to remember it for the following skipped ticks
+		entInfo.lodSrcPoses = std::move(entInfo.lodDstPoses);
+		entInfo.lodDstPoses = bones;
+		return;
+	}
+	auto &src = entInfo.lodSrcPoses;
+	auto &dst = entInfo.lodDstPoses;
+	if(src.size() != bones.size() || dst.size() != bones.size() || entInfo.lodUpdateSpan == 0)
+		return;
+	// Skipped tick: The motion between the last two evaluated poses is continued past the last one, so the pose keeps
+	// moving until the next update without lagging behind the animation. Since the factor only depends on the number
+	// of ticks, this is deterministic and never goes further than one update span ahead.
+	auto f = 1.f + umath::min(static_cast<float>(entInfo.lodTicksSinceUpdate) / static_cast<float>(entInfo.lodUpdateSpan), 1.f);
+	for(size_t i = 0; i < bones.size(); ++i) {
+		bones[i] = src[i];
+		bones[i].Interpolate(dst[i], f);
+	}
+	entInfo.animatedC->SetAbsolutePosesDirty();
+}
+void pragma::AnimationUpdateManager::UpdateAnimationsST(double dt)
+{
+	for(auto &entInfo : m_animatedEntities) {
+		if(!entInfo.lodUpdate) {
+			ApplyLodInterpolation(entInfo);
+			// The bone poses may still have changed through the interpolation
+			if(entInfo.animatedC && entInfo.animatedC->IsPostAnimationUpdateEnabled())
+				m_postAnimListenerQueue.push_back(entInfo.animatedC);
+			continue;
+		}
+		auto entDt = dt + entInfo.lodAccumulatedDt;
+		entInfo.lodAccumulatedDt = 0.0;
+		auto maintainAnimations = entInfo.animatedC ? entInfo.animatedC->PreMaintainAnimations(entDt) : false;
 		if(maintainAnimations)
-			entInfo.animatedC->UpdateAnimations(dt);
+			entInfo.animatedC->UpdateAnimations(entDt);
 
 		if(entInfo.panimaC)
-			entInfo.panimaC->UpdateAnimations(dt);
+			entInfo.panimaC->UpdateAnimations(entDt);
+
+		ApplyLodInterpolation(entInfo);
+
+		if(entInfo.animatedC && entInfo.animatedC->IsPostAnimationUpdateEnabled())
+			m_postAnimListenerQueue.push_back(entInfo.animatedC);
+	}
+}
+void pragma::AnimationUpdateManager::UpdateAnimationsMT(double dt)
+{
+	// Everything that may invoke Lua callbacks has to be evaluated on the main thread before
+	// the entities are handed to the worker threads.
+	for(auto &entInfo : m_animatedEntities) {
+		if(!entInfo.lodUpdate) {
+			entInfo.animatedDt = {};
+			entInfo.panimaDt = {};
+			// The bone poses may still have changed through the interpolation
+			if(entInfo.animatedC && entInfo.animatedC->IsPostAnimationUpdateEnabled())
+				m_postAnimListenerQueue.push_back(entInfo.animatedC);
+			continue;
+		}
+		auto entDt = dt + entInfo.lodAccumulatedDt;
+		entInfo.lodAccumulatedDt = 0.0;
+		auto maintainAnimations = entInfo.animatedC ? entInfo.animatedC->PreMaintainAnimations(entDt) : false;
+		entInfo.animatedDt = maintainAnimations ? entInfo.animatedC->PrepareAnimationUpdate(entDt) : std::optional<double> {};
+		entInfo.panimaDt = entInfo.panimaC ? entInfo.panimaC->PrepareAnimationUpdate(entDt) : std::optional<double> {};
 
 		if(entInfo.animatedC && entInfo.animatedC->IsPostAnimationUpdateEnabled())
 			m_postAnimListenerQueue.push_back(entInfo.animatedC);
 	}
 
-	m_threadPool.WaitForCompletion();
+	auto &jobSystem = pragma::get_engine()->GetJobSystem();
+	if(m_jobSubsystem == JobSystem::DEFAULT_SUBSYSTEM)
+		m_jobSubsystem = jobSystem.RegisterSubsystem({"animation_update", JobSystem::Priority::High});
+	auto numEntities = static_cast<uint32_t>(m_animatedEntities.size());
+	// The main thread takes part in the update as well
+	auto numThreads = jobSystem.GetWorkerCount() + 1;
+	constexpr uint32_t minItemsPerJob = 4;
+	auto numItemsPerJob = umath::max((numEntities + numThreads - 1) / numThreads, minItemsPerJob);
+	jobSystem.ParallelFor(
+	  numEntities, numItemsPerJob,
+	  [this](uint32_t start, uint32_t end) {
+		  for(auto i = start; i < end; ++i) {
+			  auto &entInfo = m_animatedEntities[i];
+			  if(entInfo.animatedDt)
+				  entInfo.animatedC->UpdateAnimationsMT(*entInfo.animatedDt);
+			  if(entInfo.panimaDt)
+				  entInfo.panimaC->AdvanceAnimationsMT(*entInfo.panimaDt);
+			  ApplyLodInterpolation(entInfo);
+		  }
+	  },
+	  m_jobSubsystem);
+
+	for(auto &entInfo : m_animatedEntities) {
+		if(entInfo.panimaDt)
+			entInfo.panimaC->FinalizeAnimationUpdate();
+	}
+}
+void pragma::AnimationUpdateManager::UpdateAnimations(double dt)
+{
+	UpdateLodTiers(dt);
+	if(cvMultiThreaded->GetBool())
+		UpdateAnimationsMT(dt);
+	else
+		UpdateAnimationsST(dt);
 
 	// The remaining steps have to be executed on the main thread because
 	// they may affect arbitrary component properties or call listeners and events,
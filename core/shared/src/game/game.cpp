@@ -12,6 +12,9 @@
 #include "luasystem.h"
 #include "pragma/physics/physobj.h"
 #include "pragma/entities/baseentity.h"
+#include "pragma/entities/entity_tick_scheduler.hpp"
+#include "pragma/entities/entity_spatial_index.hpp"
+#include "pragma/entities/entity_lookup_index.hpp"
 #include "pragma/model/brush/brushmesh.h"
 #include "pragma/level/mapgeometry.h"
 #include <pragma/engine.h>
@@ -200,6 +203,12 @@ Game::Game(NetworkState *state)
 	m_luaNetMessageIndex.push_back("invalid");
 	m_luaEnts = std::make_unique<LuaEntityManager>();
 	m_ammoTypes = std::make_unique<AmmoTypeManager>();
+	for(auto &wheel : m_timerWheels)
+		wheel = std::make_unique<pragma::TimingWheel>();
+	m_entityTickScheduler = std::make_unique<pragma::EntityTickScheduler>();
+	m_entitySpatialIndex = std::make_unique<pragma::EntitySpatialIndex>();
+	m_entityNameIndex = std::make_unique<pragma::EntityLookupIndex>();
+	m_entityClassIndex = std::make_unique<pragma::EntityLookupIndex>();
 
 	RegisterCallback<void>("Tick");
 	RegisterCallback<void>("Think");
@@ -632,11 +641,17 @@ void Game::Tick()
 	}
 
 	// Order:
+	// 1) Animations
+	// 2) Physics (pre-simulate, simulation step, post-simulate)
+	// 3) Removal of entities that were scheduled for removal
+	// 4) Entity logic (components are ticked through the entity tick scheduler)
+	// 5) Timers
 	// Animations are updated before logic and physics, because:
 	// - They may affect logic/physics-based properties like entity positions or rotations
 	// - They may generate logic-based animation events
-	// TODO: This is current inefficient because we're not really doing anything
-	// while the animations are being calculated, resulting in wasted CPU cycles.
+	// If sh_animation_update_multithreaded is enabled, the animation evaluation is split into jobs on the
+	// job system. The main thread takes part in it and continues once all entities have been evaluated.
+	// Drivers, constraints and animation events are always applied on the main thread afterwards.
 	StartProfilingStage(CPUProfilingPhase::Animations);
 	UpdateAnimations(m_tDeltaTick);
 	StopProfilingStage(CPUProfilingPhase::Animations);
@@ -696,25 +711,8 @@ void Game::Tick()
 	// Perform some cleanup
 	pragma::BaseEntityComponentSystem::Cleanup();
 
-	auto &logicComponents = GetEntityTickComponents();
-	// Note: During the loop, new items may be appended to the end of logicComponents, but no elements
-	// may be erased from outside sources. If an element is removed, it's set to nullptr.
-	for(auto i = decltype(logicComponents.size()) {0u}; i < logicComponents.size();) {
-		auto *c = logicComponents[i];
-		if(c == nullptr) {
-			logicComponents.erase(logicComponents.begin() + i);
-			continue;
-		}
-		if(m_tCur < c->GetNextTick()) {
-			++i;
-			continue;
-		}
-		if(c->Tick(m_tDeltaTick) == false) {
-			logicComponents.erase(logicComponents.begin() + i);
-			continue;
-		}
-		++i;
-	}
+	// Note: Components that are added during the tick will be ticked as well
+	m_entityTickScheduler->Tick(m_tCur, m_tDeltaTick);
 
 	StopProfilingStage(CPUProfilingPhase::GameObjectLogic);
 
@@ -860,7 +858,11 @@ bool Game::LoadMap(const std::string &map, const Vector3 &origin, std::vector<En
 	return true;
 }
 
-void Game::InitializeWorldData(pragma::asset::WorldData &worldData) {}
+void Game::InitializeWorldData(pragma::asset::WorldData &worldData)
+{
+	auto *bspTree = worldData.GetBSPTree();
+	m_animUpdateManager->SetBSPTree(bspTree ? bspTree->shared_from_this() : nullptr);
+}
 void Game::InitializeMapEntities(pragma::asset::WorldData &worldData, std::vector<EntityHandle> &outEnt)
 {
 	auto &entityData = worldData.GetEntities();
@@ -1623,9 +1623,10 @@ LuaEntityIteratorFilterFunction::LuaEntityIteratorFilterFunction(Lua::func<bool>
 void LuaEntityIteratorFilterFunction::Attach(EntityIterator &iterator)
 {
 	auto *data = iterator.GetIteratorData();
-	auto *components = (data && data->entities && typeid(*data->entities) == typeid(ComponentContainer)) ? static_cast<ComponentContainer *>(data->entities.get()) : nullptr;
 	auto *l = m_function.interpreter();
-	iterator.AttachFilter<EntityIteratorFilterUser>([this, l, components](BaseEntity &ent, std::size_t index) -> bool {
+	iterator.AttachFilter<EntityIteratorFilterUser>([this, l, data](BaseEntity &ent, std::size_t index) -> bool {
+		// Filters with candidates may replace the container after this filter was attached, so it has to be looked up when the filter is called
+		auto *components = (data && data->entities) ? dynamic_cast<ComponentContainer *>(data->entities.get()) : nullptr;
 		auto r = Lua::CallFunction(
 		  l,
 		  [this, &ent, index, components](lua_State *l) -> Lua::StatusCode {
@@ -1558,6 +1558,8 @@ void pragma::lua::base_animated_component::register_class(luabind::module_ &mod)
 	def.def("SetLayeredAnimationFlags", &pragma::BaseAnimatedComponent::SetLayeredAnimationFlags);
 	def.def("SetPostAnimationUpdateEnabled", &pragma::BaseAnimatedComponent::SetPostAnimationUpdateEnabled);
 	def.def("IsPostAnimationUpdateEnabled", &pragma::BaseAnimatedComponent::IsPostAnimationUpdateEnabled);
+	def.def("SetSoaPoseEnabled", &pragma::BaseAnimatedComponent::SetSoaPoseEnabled);
+	def.def("IsSoaPoseEnabled", &pragma::BaseAnimatedComponent::IsSoaPoseEnabled);
 	def.def("GetMetaBoneId", &pragma::BaseAnimatedComponent::GetMetaBoneId);
 	def.def(
 	  "GetMetaBonePose", +[](pragma::BaseAnimatedComponent &animC, animation::MetaRigBoneType boneType, umath::CoordinateSpace space) -> std::optional<umath::ScaledTransform> {
@@ -13,7 +13,7 @@
 #include "pragma/lua/ldefinitions.h"
 #include "luasystem.h"
 
-Timer::Timer() : m_bRemove(false), m_next(0), m_bRunning(false), m_bIsValid(true), m_callback() {}
+Timer::Timer() : m_bRemove(false), m_next(0), m_bRunning(false), m_bIsValid(true), m_callback() { m_wheelNode.userData = this; }
 
 Timer::Timer(float delay, unsigned int reps, LuaFunctionObject luaFunction, TimerType timetype) : Timer()
 {
@@ -52,34 +52,51 @@ double Timer::GetCurTime(Game *game)
 	return game->ServerTime();
 }
 
-double Timer::GetDeltaTime(Game *game)
+static double get_timer_delta_time(Game &game, TimerType timeType)
 {
-	switch(m_timeType) {
+	switch(timeType) {
 	case TimerType::CurTime:
-		return game->DeltaTickTime();
+		return game.DeltaTickTime();
 	case TimerType::RealTime:
-		return game->DeltaRealTime();
+		return game.DeltaRealTime();
 	}
-	return game->DeltaTickTime();
+	return game.DeltaTickTime();
+}
+
+void Timer::Schedule(pragma::TimingWheel &wheel)
+{
+	auto ticks = static_cast<uint64_t>(umath::max(std::ceil(static_cast<double>(m_next) * TICKS_PER_SECOND), 0.0));
+	wheel.Schedule(m_wheelNode, wheel.GetTime() + ticks);
+}
+
+float Timer::GetCycleTimeLeft() const
+{
+	if(m_wheelNode.IsScheduled() == false)
+		return m_next;
+	return static_cast<float>(static_cast<double>(m_wheelNode.GetTicksLeft()) / TICKS_PER_SECOND);
 }
 
 void Timer::Update(Game *game)
 {
-	if(!m_bRunning)
+	// The timer may have been removed, paused or restarted by another timer that was due in the same tick
+	if(!m_bRunning || !m_bIsValid || m_wheelNode.IsScheduled())
+		return;
+	auto &wheel = game->GetTimerWheel(m_timeType);
+	// Carry over the time we're late, so repeating timers don't drift
+	m_next = -static_cast<float>(static_cast<double>(wheel.GetTime() - umath::min(m_wheelNode.deadline, wheel.GetTime())) / TICKS_PER_SECOND);
+	Call(game);
+	if(!m_bIsValid)
 		return;
-	m_next -= static_cast<float>(GetDeltaTime(game));
-	if(m_next <= 0) {
-		Call(game);
-		if(m_reps > 0) {
-			m_reps--;
-			if(m_reps == 0)
-				Remove(game);
-			else
-				Reset();
+	if(m_reps > 0) {
+		m_reps--;
+		if(m_reps == 0) {
+			Remove(game);
+			return;
 		}
-		else
-			Reset();
 	}
+	Reset();
+	if(m_bRunning && m_wheelNode.IsScheduled() == false)
+		Schedule(wheel);
 }
 
 void Timer::Call(Game *game)
@@ -110,27 +127,40 @@ void Timer::SetCall(Game *game, const CallbackHandle &hCallback)
 
 void Timer::Reset() { m_next = m_delay + m_next; }
 
-void Timer::Start(Game *)
+void Timer::Start(Game *game)
 {
-	if(m_bRunning)
+	if(m_bRunning || !m_bIsValid)
 		return;
 	if(m_next == 0.f)
 		Reset();
 	m_bRunning = true;
+	Schedule(game->GetTimerWheel(m_timeType));
 }
 
-void Timer::Pause() { m_bRunning = false; }
+void Timer::Pause()
+{
+	if(!m_bRunning)
+		return;
+	m_next = GetCycleTimeLeft();
+	m_wheelNode.Unschedule();
+	m_bRunning = false;
+}
 
 void Timer::Stop()
 {
+	m_wheelNode.Unschedule();
 	m_bRunning = false;
 	m_next = 0.f;
 }
 
 void Timer::Remove(Game *game)
 {
+	if(!m_bIsValid)
+		return;
+	m_wheelNode.Unschedule();
 	m_bIsValid = false;
 	m_luaFunction = {};
+	game->OnTimerRemoved(*this);
 }
 
 bool Timer::IsValid() { return m_bIsValid; }
@@ -160,7 +190,7 @@ float Timer::GetTimeLeft()
 {
 	if(m_reps == 0)
 		return 0;
-	return std::max(m_next, 0.f) + (m_reps - 1) * m_delay;
+	return std::max(GetCycleTimeLeft(), 0.f) + (m_reps - 1) * m_delay;
 }
 void Timer::SetTimeInterval(float time)
 {
@@ -169,7 +199,10 @@ void Timer::SetTimeInterval(float time)
 	if(!IsRunning())
 		return;
 	float tDelta = time - delayOld;
-	m_next += tDelta;
+	auto *wheel = m_wheelNode.GetWheel();
+	m_next = GetCycleTimeLeft() + tDelta;
+	if(wheel)
+		Schedule(*wheel);
 }
 float Timer::GetTimeInterval() { return m_delay; }
 unsigned int Timer::GetRepetitionsLeft() { return m_reps; }
@@ -193,27 +226,69 @@ extern DLLNETWORK Engine *engine;
 Timer *Game::CreateTimer(float delay, int reps, LuaFunctionObject luaFunction, TimerType timeType)
 {
 	m_timers.push_back(std::make_unique<Timer>(delay, reps, luaFunction, timeType));
-	return m_timers.back().get();
+	auto *timer = m_timers.back().get();
+	timer->m_timerIndex = m_timers.size() - 1;
+	return timer;
 }
 
 Timer *Game::CreateTimer(float delay, int reps, const CallbackHandle &hCallback, TimerType timeType)
 {
 	m_timers.push_back(std::make_unique<Timer>(delay, reps, hCallback, timeType));
-	return m_timers.back().get();
+	auto *timer = m_timers.back().get();
+	timer->m_timerIndex = m_timers.size() - 1;
+	return timer;
 }
 
-void Game::ClearTimers() { m_timers.clear(); }
+pragma::TimingWheel &Game::GetTimerWheel(TimerType timeType) { return *m_timerWheels[umath::to_integral(timeType)]; }
 
-void Game::UpdateTimers()
+void Game::ClearTimers()
+{
+	for(auto &wheel : m_timerWheels)
+		wheel->Clear();
+	m_expiredTimers.clear();
+	m_removedTimers.clear();
+	m_timers.clear();
+	++m_timerClearCount;
+}
+
+void Game::OnTimerRemoved(Timer &timer) { m_removedTimers.push_back(&timer); }
+
+void Game::DestroyRemovedTimers()
 {
-	for(auto i = decltype(m_timers.size()) {0u}; i < m_timers.size(); ++i) {
-		auto &timer = *m_timers.at(i);
-		if(timer.IsValid() == false) {
-			m_timers.erase(m_timers.begin() + i);
-			continue;
+	// Swap-and-pop, the order of the timers is irrelevant
+	for(auto *timer : m_removedTimers) {
+		auto idx = timer->m_timerIndex;
+		if(idx != m_timers.size() - 1) {
+			std::swap(m_timers[idx], m_timers.back());
+			m_timers[idx]->m_timerIndex = idx;
 		}
-		timer.Update(this);
+		m_timers.pop_back();
+	}
+	m_removedTimers.clear();
+}
+
+void Game::UpdateTimers()
+{
+	DestroyRemovedTimers();
+	for(auto i = decltype(m_timerWheels.size()) {0u}; i < m_timerWheels.size(); ++i) {
+		m_timerClocks[i] += get_timer_delta_time(*this, static_cast<TimerType>(i));
+		m_timerWheels[i]->Advance(static_cast<uint64_t>(m_timerClocks[i] * Timer::TICKS_PER_SECOND), m_expiredTimers);
+	}
+	// All wheels have to be advanced before any timers are called, in case a timer callback creates new timers.
+	// Timers which are rescheduled during this loop will not be called again before the next update.
+	// The callbacks may also clear all timers, so we iterate over a local copy of the list.
+	std::vector<pragma::TimingWheel::Node *> expiredTimers;
+	expiredTimers.swap(m_expiredTimers);
+	auto clearCount = m_timerClearCount;
+	for(auto *node : expiredTimers) {
+		if(m_timerClearCount != clearCount)
+			break; // The remaining timers have been destroyed
+		static_cast<Timer *>(node->userData)->Update(this);
 	}
+	// Keep the allocation for the next update
+	expiredTimers.clear();
+	if(m_expiredTimers.empty())
+		m_expiredTimers.swap(expiredTimers);
 }
 
 /////////////////////////////
@@ -140,6 +140,7 @@ void Lua::nav::register_library(Lua::Interface &lua)
 	classDefConfig.def_readwrite("sampleDetailDist", &pragma::nav::Config::sampleDetailDist);
 	classDefConfig.def_readwrite("sampleDetailMaxError", &pragma::nav::Config::sampleDetailMaxError);
 	classDefConfig.def_readwrite("samplePartitionType", reinterpret_cast<std::underlying_type_t<decltype(pragma::nav::Config::partitionType)> pragma::nav::Config::*>(&pragma::nav::Config::partitionType));
+	classDefConfig.def_readwrite("tileSize", &pragma::nav::Config::tileSize);
 	classDefConfig.add_static_constant("PARTITION_TYPE_WATERSHED", umath::to_integral(pragma::nav::Config::PartitionType::Watershed));
 	classDefConfig.add_static_constant("PARTITION_TYPE_MONOTONE", umath::to_integral(pragma::nav::Config::PartitionType::Monotone));
 	classDefConfig.add_static_constant("PARTITION_TYPE_LAYERS", umath::to_integral(pragma::nav::Config::PartitionType::Layers));
@@ -174,6 +175,15 @@ void Lua::nav::register_library(Lua::Interface &lua)
 		else
 			Lua::Push<Vector3>(l, hit);
 	}));
+	classDefMesh.def("RebuildTiles", static_cast<void (*)(lua_State *, pragma::nav::Mesh &, const Vector3 &, const Vector3 &)>([](lua_State *l, pragma::nav::Mesh &navMesh, const Vector3 &min, const Vector3 &max) {
+		auto &nw = *engine->GetNetworkState(l);
+		auto &game = *nw.GetGameState();
+		std::string err;
+		auto r = navMesh.RebuildTiles(game, min, max, &err);
+		Lua::PushBool(l, r);
+		if(r == false)
+			Lua::PushString(l, err);
+	}));
 	classDefMesh.def("GetConfig", static_cast<const pragma::nav::Config *(*)(lua_State *, pragma::nav::Mesh &)>([](lua_State *l, pragma::nav::Mesh &navMesh) -> const pragma::nav::Config * {
 		auto &config = navMesh.GetConfig();
 		return &config;
@@ -0,0 +1,312 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/model/animation/soa_pose.hpp"
+#include "pragma/model/animation/skeleton.hpp"
+#include "pragma/model/animation/bone.hpp"
+#include <cmath>
+
+void pragma::animation::SoaPose::Streams::Resize(size_t n)
+{
+	for(auto *v : {&px, &py, &pz, &rx, &ry, &rz, &rw, &sx, &sy, &sz})
+		v->resize(n);
+}
+
+void pragma::animation::SoaPose::Initialize(const Skeleton &skeleton)
+{
+	m_skeleton = &skeleton;
+	auto &bones = skeleton.GetBones();
+	m_order.clear();
+	m_parents.clear();
+	m_levels.clear();
+	m_order.reserve(bones.size());
+	m_parents.reserve(bones.size());
+
+	// Bones that can't be reached from any of the skeleton's root bones are treated as additional roots, so that
+	// the pose always covers the entire skeleton
+	std::vector<BoneId> roots;
+	std::vector<bool> reachable(bones.size(), false);
+	auto markReachable = [&bones, &reachable](BoneId rootId) {
+		std::vector<BoneId> stack {rootId};
+		while(!stack.empty()) {
+			auto boneId = stack.back();
+			stack.pop_back();
+			if(reachable[boneId])
+				continue;
+			reachable[boneId] = true;
+			for(auto &pair : bones[boneId]->children) {
+				if(pair.first < bones.size())
+					stack.push_back(pair.first);
+			}
+		}
+	};
+	for(auto &pair : skeleton.GetRootBones()) {
+		if(pair.first >= bones.size() || reachable[pair.first])
+			continue;
+		roots.push_back(pair.first);
+		markReachable(pair.first);
+	}
+	for(BoneId boneId = 0; boneId < bones.size(); ++boneId) {
+		if(reachable[boneId])
+			continue;
+		// Use the top-most unreachable ancestor, so the bone keeps its parent transforms where possible
+		auto rootId = boneId;
+		for(size_t depth = 0; depth < bones.size(); ++depth) {
+			auto parent = bones[rootId]->parent.lock();
+			if(!parent || parent->ID >= bones.size() || reachable[parent->ID])
+				break;
+			rootId = parent->ID;
+		}
+		roots.push_back(rootId);
+		markReachable(rootId);
+	}
+
+	// Breadth-first, so that the bones are sorted by depth and every parent comes before its children
+	std::vector<uint32_t> boneIdToPoseIdx(bones.size(), std::numeric_limits<uint32_t>::max());
+	m_levels.push_back(0);
+	for(auto boneId : roots) {
+		boneIdToPoseIdx[boneId] = m_order.size();
+		m_parents.push_back(m_order.size());
+		m_order.push_back(boneId);
+	}
+	size_t levelStart = 0;
+	while(levelStart < m_order.size()) {
+		auto levelEnd = m_order.size();
+		m_levels.push_back(levelEnd);
+		for(auto i = levelStart; i < levelEnd; ++i) {
+			auto &bone = bones[m_order[i]];
+			for(auto &pair : bone->children) {
+				if(pair.first >= bones.size() || boneIdToPoseIdx[pair.first] != std::numeric_limits<uint32_t>::max())
+					continue;
+				boneIdToPoseIdx[pair.first] = m_order.size();
+				m_parents.push_back(i);
+				m_order.push_back(pair.first);
+			}
+		}
+		levelStart = levelEnd;
+	}
+
+	auto n = m_order.size();
+	m_local.Resize(n);
+	m_global.Resize(n);
+	ClearBindPoses();
+}
+bool pragma::animation::SoaPose::IsInitialized(const Skeleton &skeleton) const { return m_skeleton == &skeleton && m_order.size() == skeleton.GetBoneCount(); }
+
+void pragma::animation::SoaPose::SetLocalPoses(const std::vector<umath::ScaledTransform> &poses)
+{
+	auto n = m_order.size();
+	for(size_t i = 0; i < n; ++i) {
+		auto boneId = m_order[i];
+		if(boneId >= poses.size())
+			continue;
+		auto &pose = poses[boneId];
+		auto &pos = pose.GetOrigin();
+		auto &rot = pose.GetRotation();
+		auto &scale = pose.GetScale();
+		m_local.px[i] = pos.x;
+		m_local.py[i] = pos.y;
+		m_local.pz[i] = pos.z;
+		m_local.rx[i] = rot.x;
+		m_local.ry[i] = rot.y;
+		m_local.rz[i] = rot.z;
+		m_local.rw[i] = rot.w;
+		m_local.sx[i] = scale.x;
+		m_local.sy[i] = scale.y;
+		m_local.sz[i] = scale.z;
+	}
+}
+
+void pragma::animation::SoaPose::Blend(const SoaPose &other, float factor)
+{
+	auto n = std::min(m_order.size(), other.m_order.size());
+	auto &a = m_local;
+	auto &b = other.m_local;
+	auto inv = 1.f - factor;
+	for(size_t i = 0; i < n; ++i) {
+		a.px[i] = a.px[i] * inv + b.px[i] * factor;
+		a.py[i] = a.py[i] * inv + b.py[i] * factor;
+		a.pz[i] = a.pz[i] * inv + b.pz[i] * factor;
+		a.sx[i] = a.sx[i] * inv + b.sx[i] * factor;
+		a.sy[i] = a.sy[i] * inv + b.sy[i] * factor;
+		a.sz[i] = a.sz[i] * inv + b.sz[i] * factor;
+	}
+	// Normalized lerp along the shortest path
+	for(size_t i = 0; i < n; ++i) {
+		auto d = a.rx[i] * b.rx[i] + a.ry[i] * b.ry[i] + a.rz[i] * b.rz[i] + a.rw[i] * b.rw[i];
+		auto f = (d < 0.f) ? -factor : factor;
+		auto x = a.rx[i] * inv + b.rx[i] * f;
+		auto y = a.ry[i] * inv + b.ry[i] * f;
+		auto z = a.rz[i] * inv + b.rz[i] * f;
+		auto w = a.rw[i] * inv + b.rw[i] * f;
+		auto l = 1.f / std::sqrt(x * x + y * y + z * z + w * w);
+		a.rx[i] = x * l;
+		a.ry[i] = y * l;
+		a.rz[i] = z * l;
+		a.rw[i] = w * l;
+	}
+}
+
+void pragma::animation::SoaPose::ComputeGlobalPoses()
+{
+	auto &l = m_local;
+	auto &g = m_global;
+	if(m_levels.size() < 2)
+		return;
+	// Root bones
+	for(size_t i = m_levels[0]; i < m_levels[1]; ++i) {
+		g.px[i] = l.px[i];
+		g.py[i] = l.py[i];
+		g.pz[i] = l.pz[i];
+		g.rx[i] = l.rx[i];
+		g.ry[i] = l.ry[i];
+		g.rz[i] = l.rz[i];
+		g.rw[i] = l.rw[i];
+		g.sx[i] = l.sx[i];
+		g.sy[i] = l.sy[i];
+		g.sz[i] = l.sz[i];
+	}
+	// Every level only reads from the previous one
+	for(size_t level = 1; level + 1 < m_levels.size(); ++level) {
+		auto start = m_levels[level];
+		auto end = m_levels[level + 1];
+		for(auto i = start; i < end; ++i) {
+			auto p = m_parents[i];
+			auto qx = g.rx[p];
+			auto qy = g.ry[p];
+			auto qz = g.rz[p];
+			auto qw = g.rw[p];
+
+			// Local translation is scaled by the parent scale, then rotated by the parent rotation
+			auto vx = l.px[i] * g.sx[p];
+			auto vy = l.py[i] * g.sy[p];
+			auto vz = l.pz[i] * g.sz[p];
+			auto tx = 2.f * (qy * vz - qz * vy);
+			auto ty = 2.f * (qz * vx - qx * vz);
+			auto tz = 2.f * (qx * vy - qy * vx);
+			g.px[i] = g.px[p] + vx + qw * tx + (qy * tz - qz * ty);
+			g.py[i] = g.py[p] + vy + qw * ty + (qz * tx - qx * tz);
+			g.pz[i] = g.pz[p] + vz + qw * tz + (qx * ty - qy * tx);
+
+			auto lx = l.rx[i];
+			auto ly = l.ry[i];
+			auto lz = l.rz[i];
+			auto lw = l.rw[i];
+			g.rw[i] = qw * lw - qx * lx - qy * ly - qz * lz;
+			g.rx[i] = qw * lx + qx * lw + qy * lz - qz * ly;
+			g.ry[i] = qw * ly - qx * lz + qy * lw + qz * lx;
+			g.rz[i] = qw * lz + qx * ly - qy * lx + qz * lw;
+
+			g.sx[i] = g.sx[p] * l.sx[i];
+			g.sy[i] = g.sy[p] * l.sy[i];
+			g.sz[i] = g.sz[p] * l.sz[i];
+		}
+	}
+}
+
+void pragma::animation::SoaPose::GetGlobalPoses(std::vector<umath::ScaledTransform> &outPoses) const
+{
+	auto &g = m_global;
+	auto n = m_order.size();
+	for(size_t i = 0; i < n; ++i) {
+		auto boneId = m_order[i];
+		if(boneId >= outPoses.size())
+			continue;
+		outPoses[boneId] = umath::ScaledTransform {Vector3 {g.px[i], g.py[i], g.pz[i]}, Quat {g.rw[i], g.rx[i], g.ry[i], g.rz[i]}, Vector3 {g.sx[i], g.sy[i], g.sz[i]}};
+	}
+}
+
+void pragma::animation::SoaPose::ClearBindPoses()
+{
+	for(auto &v : m_invBindRot)
+		v.clear();
+	for(auto &v : m_invBindPos)
+		v.clear();
+}
+void pragma::animation::SoaPose::SetBindPoses(const std::vector<umath::Transform> &bindPoses)
+{
+	auto n = m_order.size();
+	for(auto &v : m_invBindRot)
+		v.resize(n);
+	for(auto &v : m_invBindPos)
+		v.resize(n);
+	for(size_t i = 0; i < n; ++i) {
+		auto boneId = m_order[i];
+		auto inv = (boneId < bindPoses.size()) ? bindPoses[boneId].GetInverse() : umath::Transform {};
+		auto &rot = inv.GetRotation();
+		auto &pos = inv.GetOrigin();
+		auto x = rot.x;
+		auto y = rot.y;
+		auto z = rot.z;
+		auto w = rot.w;
+		m_invBindRot[0][i] = 1.f - 2.f * (y * y + z * z);
+		m_invBindRot[1][i] = 2.f * (x * y - w * z);
+		m_invBindRot[2][i] = 2.f * (x * z + w * y);
+		m_invBindRot[3][i] = 2.f * (x * y + w * z);
+		m_invBindRot[4][i] = 1.f - 2.f * (x * x + z * z);
+		m_invBindRot[5][i] = 2.f * (y * z - w * x);
+		m_invBindRot[6][i] = 2.f * (x * z - w * y);
+		m_invBindRot[7][i] = 2.f * (y * z + w * x);
+		m_invBindRot[8][i] = 1.f - 2.f * (x * x + y * y);
+		m_invBindPos[0][i] = pos.x;
+		m_invBindPos[1][i] = pos.y;
+		m_invBindPos[2][i] = pos.z;
+	}
+}
+
+void pragma::animation::SoaPose::ComputeSkinningMatrices(std::vector<Mat4> &outMatrices, std::optional<BoneId> identityBoneId) const
+{
+	if(!HasBindPoses())
+		return;
+	auto &g = m_global;
+	auto &b = m_invBindRot;
+	auto &bt = m_invBindPos;
+	auto n = m_order.size();
+	for(size_t i = 0; i < n; ++i) {
+		auto boneId = m_order[i];
+		if(boneId >= outMatrices.size())
+			continue;
+		auto &mat = outMatrices[boneId];
+		if(identityBoneId && boneId == *identityBoneId) {
+			mat = umat::identity();
+			continue;
+		}
+		auto x = g.rx[i];
+		auto y = g.ry[i];
+		auto z = g.rz[i];
+		auto w = g.rw[i];
+		// Rotation * scale of the global pose (row-major)
+		auto a00 = (1.f - 2.f * (y * y + z * z)) * g.sx[i];
+		auto a01 = (2.f * (x * y - w * z)) * g.sy[i];
+		auto a02 = (2.f * (x * z + w * y)) * g.sz[i];
+		auto a10 = (2.f * (x * y + w * z)) * g.sx[i];
+		auto a11 = (1.f - 2.f * (x * x + z * z)) * g.sy[i];
+		auto a12 = (2.f * (y * z - w * x)) * g.sz[i];
+		auto a20 = (2.f * (x * z - w * y)) * g.sx[i];
+		auto a21 = (2.f * (y * z + w * x)) * g.sy[i];
+		auto a22 = (1.f - 2.f * (x * x + y * y)) * g.sz[i];
+
+		// Multiply with the inverse bind pose; Mat4 is column-major
+		mat[0][0] = a00 * b[0][i] + a01 * b[3][i] + a02 * b[6][i];
+		mat[0][1] = a10 * b[0][i] + a11 * b[3][i] + a12 * b[6][i];
+		mat[0][2] = a20 * b[0][i] + a21 * b[3][i] + a22 * b[6][i];
+		mat[0][3] = 0.f;
+		mat[1][0] = a00 * b[1][i] + a01 * b[4][i] + a02 * b[7][i];
+		mat[1][1] = a10 * b[1][i] + a11 * b[4][i] + a12 * b[7][i];
+		mat[1][2] = a20 * b[1][i] + a21 * b[4][i] + a22 * b[7][i];
+		mat[1][3] = 0.f;
+		mat[2][0] = a00 * b[2][i] + a01 * b[5][i] + a02 * b[8][i];
+		mat[2][1] = a10 * b[2][i] + a11 * b[5][i] + a12 * b[8][i];
+		mat[2][2] = a20 * b[2][i] + a21 * b[5][i] + a22 * b[8][i];
+		mat[2][3] = 0.f;
+		mat[3][0] = a00 * bt[0][i] + a01 * bt[1][i] + a02 * bt[2][i] + g.px[i];
+		mat[3][1] = a10 * bt[0][i] + a11 * bt[1][i] + a12 * bt[2][i] + g.py[i];
+		mat[3][2] = a20 * bt[0][i] + a21 * bt[1][i] + a22 * bt[2][i] + g.pz[i];
+		mat[3][3] = 1.f;
+	}
+}
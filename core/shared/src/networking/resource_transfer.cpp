@@ -0,0 +1,95 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/networking/resource_transfer.hpp"
+#include "pragma/game/game_resources.h"
+#include "pragma/encryption/md5.h"
+#include "pragma/engine.h"
+#include "pragma/util/job_system.hpp"
+#include <fsys/filesystem.h>
+#include <lz4.h>
+#include <array>
+
+using namespace pragma::networking;
+
+void pragma::networking::write_resource_fragment(NetPacket &packet, uint32_t transferId, uint64_t offset, const uint8_t *data, uint32_t size, bool compress)
+{
+	packet->Write<uint32_t>(transferId);
+	packet->Write<uint64_t>(offset);
+	if(compress) {
+		std::vector<uint8_t> compressed;
+		compressed.resize(LZ4_compressBound(size));
+		auto compressedSize = LZ4_compress_default(reinterpret_cast<const char *>(data), reinterpret_cast<char *>(compressed.data()), size, compressed.size());
+		// Already compressed formats (e.g. textures or sounds) usually don't get any smaller, in which case we send them as-is
+		if(compressedSize > 0 && static_cast<uint32_t>(compressedSize) < size) {
+			packet->Write<ResourceFragmentFlags>(ResourceFragmentFlags::Lz4Compressed);
+			packet->Write<uint32_t>(size);
+			packet->Write<uint32_t>(compressedSize);
+			packet->Write(compressed.data(), compressedSize);
+			return;
+		}
+	}
+	packet->Write<ResourceFragmentFlags>(ResourceFragmentFlags::None);
+	packet->Write<uint32_t>(size);
+	packet->Write(data, size);
+}
+bool pragma::networking::read_resource_fragment(NetPacket &packet, ResourceFragment &outFragment)
+{
+	outFragment.transferId = packet->Read<uint32_t>();
+	outFragment.offset = packet->Read<uint64_t>();
+	auto flags = packet->Read<ResourceFragmentFlags>();
+	auto size = packet->Read<uint32_t>();
+	if(size > RESOURCE_TRANSFER_FRAGMENT_SIZE)
+		return false;
+	outFragment.data.resize(size);
+	if(umath::is_flag_set(flags, ResourceFragmentFlags::Lz4Compressed) == false) {
+		if(packet->GetOffset() + size > packet->GetSize())
+			return false;
+		packet->Read(outFragment.data.data(), size);
+		return true;
+	}
+	auto compressedSize = packet->Read<uint32_t>();
+	if(packet->GetOffset() + compressedSize > packet->GetSize())
+		return false;
+	auto *compressed = reinterpret_cast<const char *>(packet->GetData()) + packet->GetOffset();
+	auto decompressedSize = LZ4_decompress_safe(compressed, reinterpret_cast<char *>(outFragment.data.data()), compressedSize, size);
+	packet->SetOffset(packet->GetOffset() + compressedSize);
+	return decompressedSize == static_cast<int>(size);
+}
+
+std::string pragma::networking::compute_resource_hash(VFilePtrInternal &f)
+{
+	auto pos = f.Tell();
+	f.Seek(0);
+	MD5 md5 {};
+	std::array<uint8_t, 65'536> buf;
+	for(;;) {
+		auto read = f.Read(buf.data(), buf.size());
+		if(read == 0)
+			break;
+		md5.update(buf.data(), static_cast<MD5::size_type>(read));
+		if(read < buf.size())
+			break;
+	}
+	f.Seek(pos);
+	return md5.finalize().hexdigest();
+}
+
+std::shared_ptr<ResourceHashJob> pragma::networking::schedule_resource_hash(const std::string &fileName)
+{
+	auto job = std::make_shared<ResourceHashJob>();
+	pragma::get_engine()->GetJobSystem().Schedule(
+	  [job, fileName]() {
+		  auto f = FileManager::OpenFile(fileName.c_str(), "rb");
+		  if(f != nullptr)
+			  job->hash = compute_resource_hash(*f);
+		  job->complete = true;
+	  },
+	  JobSystem::BACKGROUND_SUBSYSTEM);
+	return job;
+}
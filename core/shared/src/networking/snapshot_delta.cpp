@@ -0,0 +1,211 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/networking/snapshot_delta.hpp"
+#include <glm/gtc/packing.hpp>
+#include <bit>
+
+using namespace pragma::networking;
+
+static constexpr float DEFAULT_QUANTIZATION_EXTENT = 32'768.f;
+pragma::networking::SnapshotQuantizer::SnapshotQuantizer() { SetBounds(Vector3 {-DEFAULT_QUANTIZATION_EXTENT}, Vector3 {DEFAULT_QUANTIZATION_EXTENT}); }
+void pragma::networking::SnapshotQuantizer::SetBounds(const Vector3 &min, const Vector3 &max)
+{
+	m_bounds = {min, max};
+	// Make sure we never divide by zero
+	for(uint8_t i = 0; i < 3; ++i) {
+		if(m_bounds.second[i] - m_bounds.first[i] < 1.f)
+			m_bounds.second[i] = m_bounds.first[i] + 1.f;
+	}
+}
+const std::pair<Vector3, Vector3> &pragma::networking::SnapshotQuantizer::GetBounds() const { return m_bounds; }
+
+QuantizedEntityState pragma::networking::SnapshotQuantizer::Quantize(const Vector3 &pos, const Vector3 &vel, const Vector3 &angVel, const Quat &rot) const
+{
+	QuantizedEntityState state {};
+	auto &[min, max] = m_bounds;
+	for(uint8_t i = 0; i < 3; ++i) {
+		if(pos[i] < min[i] || pos[i] > max[i]) {
+			state.unboundedPosition = true;
+			break;
+		}
+	}
+	for(uint8_t i = 0; i < 3; ++i) {
+		if(state.unboundedPosition) {
+			state.position[i] = std::bit_cast<uint32_t>(pos[i]);
+			continue;
+		}
+		auto t = (pos[i] - min[i]) / (max[i] - min[i]);
+		state.position[i] = umath::min(static_cast<uint32_t>(umath::round(t * static_cast<float>(POSITION_MAX))), POSITION_MAX);
+	}
+	state.velocity = QuantizeVelocity(vel);
+	state.angularVelocity = QuantizeVelocity(angVel);
+	state.rotation = QuantizeRotation(rot);
+	return state;
+}
+Vector3 pragma::networking::SnapshotQuantizer::DequantizePosition(const QuantizedEntityState &state) const
+{
+	Vector3 pos;
+	auto &[min, max] = m_bounds;
+	for(uint8_t i = 0; i < 3; ++i) {
+		if(state.unboundedPosition) {
+			pos[i] = std::bit_cast<float>(state.position[i]);
+			continue;
+		}
+		auto t = static_cast<float>(state.position[i]) / static_cast<float>(POSITION_MAX);
+		pos[i] = min[i] + t * (max[i] - min[i]);
+	}
+	return pos;
+}
+
+static constexpr uint32_t ROTATION_COMPONENT_BITS = 10;
+static constexpr uint32_t ROTATION_COMPONENT_MAX = (1u << ROTATION_COMPONENT_BITS) - 1u;
+uint32_t pragma::networking::SnapshotQuantizer::QuantizeRotation(const Quat &rot)
+{
+	auto n = uquat::get_normal(rot);
+	std::array<float, 4> components {n.w, n.x, n.y, n.z};
+	uint32_t largest = 0;
+	for(uint32_t i = 1; i < components.size(); ++i) {
+		if(umath::abs(components[i]) > umath::abs(components[largest]))
+			largest = i;
+	}
+	// q and -q represent the same rotation, so we can always make the largest component positive
+	auto sign = (components[largest] < 0.f) ? -1.f : 1.f;
+	uint32_t result = largest << (ROTATION_COMPONENT_BITS * 3);
+	uint32_t shift = ROTATION_COMPONENT_BITS * 2;
+	for(uint32_t i = 0; i < components.size(); ++i) {
+		if(i == largest)
+			continue;
+		// The remaining components are in the range [-1/sqrt(2), 1/sqrt(2)]
+		auto v = umath::clamp((components[i] * sign * umath::sqrt(2.f) + 1.f) * 0.5f, 0.f, 1.f);
+		result |= static_cast<uint32_t>(umath::round(v * static_cast<float>(ROTATION_COMPONENT_MAX))) << shift;
+		shift -= ROTATION_COMPONENT_BITS;
+	}
+	return result;
+}
+Quat pragma::networking::SnapshotQuantizer::DequantizeRotation(uint32_t rot)
+{
+	auto largest = rot >> (ROTATION_COMPONENT_BITS * 3);
+	std::array<float, 4> components {};
+	auto sumSqr = 0.f;
+	uint32_t shift = ROTATION_COMPONENT_BITS * 2;
+	for(uint32_t i = 0; i < components.size(); ++i) {
+		if(i == largest)
+			continue;
+		auto v = static_cast<float>((rot >> shift) & ROTATION_COMPONENT_MAX) / static_cast<float>(ROTATION_COMPONENT_MAX);
+		components[i] = (v * 2.f - 1.f) / umath::sqrt(2.f);
+		sumSqr += components[i] * components[i];
+		shift -= ROTATION_COMPONENT_BITS;
+	}
+	components[largest] = umath::sqrt(umath::max(1.f - sumSqr, 0.f));
+	return uquat::get_normal(Quat {components[0], components[1], components[2], components[3]});
+}
+std::array<uint16_t, 3> pragma::networking::SnapshotQuantizer::QuantizeVelocity(const Vector3 &vel) { return {glm::packHalf1x16(vel.x), glm::packHalf1x16(vel.y), glm::packHalf1x16(vel.z)}; }
+Vector3 pragma::networking::SnapshotQuantizer::DequantizeVelocity(const std::array<uint16_t, 3> &vel) { return {glm::unpackHalf1x16(vel[0]), glm::unpackHalf1x16(vel[1]), glm::unpackHalf1x16(vel[2])}; }
+
+void pragma::networking::write_entity_state_delta(NetPacket &packet, const QuantizedEntityState &state, const QuantizedEntityState *baseline)
+{
+	auto fields = SnapshotEntityFields::None;
+	if(!baseline || baseline->position != state.position || baseline->unboundedPosition != state.unboundedPosition)
+		fields |= SnapshotEntityFields::Position;
+	if(!baseline || baseline->velocity != state.velocity)
+		fields |= SnapshotEntityFields::Velocity;
+	if(!baseline || baseline->angularVelocity != state.angularVelocity)
+		fields |= SnapshotEntityFields::AngularVelocity;
+	if(!baseline || baseline->rotation != state.rotation)
+		fields |= SnapshotEntityFields::Rotation;
+	if(state.unboundedPosition)
+		fields |= SnapshotEntityFields::UnboundedPosition;
+	packet->Write<SnapshotEntityFields>(fields);
+
+	if(umath::is_flag_set(fields, SnapshotEntityFields::Position)) {
+		for(auto v : state.position) {
+			if(state.unboundedPosition) {
+				packet->Write<uint32_t>(v);
+				continue;
+			}
+			// 24 bit
+			packet->Write<uint16_t>(static_cast<uint16_t>(v & 0xFFFF));
+			packet->Write<uint8_t>(static_cast<uint8_t>((v >> 16) & 0xFF));
+		}
+	}
+	if(umath::is_flag_set(fields, SnapshotEntityFields::Velocity))
+		packet->Write<std::array<uint16_t, 3>>(state.velocity);
+	if(umath::is_flag_set(fields, SnapshotEntityFields::AngularVelocity))
+		packet->Write<std::array<uint16_t, 3>>(state.angularVelocity);
+	if(umath::is_flag_set(fields, SnapshotEntityFields::Rotation))
+		packet->Write<uint32_t>(state.rotation);
+}
+SnapshotEntityFields pragma::networking::read_entity_state_delta(NetPacket &packet, QuantizedEntityState &inOutState)
+{
+	auto fields = packet->Read<SnapshotEntityFields>();
+	if(umath::is_flag_set(fields, SnapshotEntityFields::Position)) {
+		inOutState.unboundedPosition = umath::is_flag_set(fields, SnapshotEntityFields::UnboundedPosition);
+		for(auto &v : inOutState.position) {
+			if(inOutState.unboundedPosition) {
+				v = packet->Read<uint32_t>();
+				continue;
+			}
+			auto low = packet->Read<uint16_t>();
+			auto high = packet->Read<uint8_t>();
+			v = static_cast<uint32_t>(low) | (static_cast<uint32_t>(high) << 16);
+		}
+	}
+	if(umath::is_flag_set(fields, SnapshotEntityFields::Velocity))
+		inOutState.velocity = packet->Read<std::array<uint16_t, 3>>();
+	if(umath::is_flag_set(fields, SnapshotEntityFields::AngularVelocity))
+		inOutState.angularVelocity = packet->Read<std::array<uint16_t, 3>>();
+	if(umath::is_flag_set(fields, SnapshotEntityFields::Rotation))
+		inOutState.rotation = packet->Read<uint32_t>();
+	return fields;
+}
+
+const QuantizedEntityState *pragma::networking::SnapshotBaselineBuffer::Baseline::FindEntityState(uint32_t entIdx) const
+{
+	auto it = entityStates.find(entIdx);
+	return (it != entityStates.end()) ? &it->second : nullptr;
+}
+SnapshotBaselineBuffer::Baseline &pragma::networking::SnapshotBaselineBuffer::Add(uint8_t snapshotId, double timestamp, EntityStates &&entityStates)
+{
+	auto &baseline = m_baselines[snapshotId % SIZE];
+	baseline.snapshotId = snapshotId;
+	baseline.timestamp = timestamp;
+	baseline.valid = true;
+	baseline.acknowledged = false;
+	baseline.entityStates = std::move(entityStates);
+	return baseline;
+}
+const SnapshotBaselineBuffer::Baseline *pragma::networking::SnapshotBaselineBuffer::Find(uint8_t snapshotId) const
+{
+	auto &baseline = m_baselines[snapshotId % SIZE];
+	return (baseline.valid && baseline.snapshotId == snapshotId) ? &baseline : nullptr;
+}
+bool pragma::networking::SnapshotBaselineBuffer::Acknowledge(uint8_t snapshotId, double timestamp)
+{
+	auto &baseline = m_baselines[snapshotId % SIZE];
+	if(!baseline.valid || baseline.snapshotId != snapshotId || baseline.timestamp != timestamp)
+		return false;
+	baseline.acknowledged = true;
+	return true;
+}
+const SnapshotBaselineBuffer::Baseline *pragma::networking::SnapshotBaselineBuffer::GetLatestAcknowledged() const
+{
+	const Baseline *latest = nullptr;
+	for(auto &baseline : m_baselines) {
+		if(!baseline.valid || !baseline.acknowledged)
+			continue;
+		if(!latest || baseline.timestamp > latest->timestamp)
+			latest = &baseline;
+	}
+	return latest;
+}
+void pragma::networking::SnapshotBaselineBuffer::Clear()
+{
+	for(auto &baseline : m_baselines)
+		baseline = {};
+}
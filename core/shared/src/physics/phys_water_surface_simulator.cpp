@@ -30,7 +30,6 @@ void PhysWaterSurfaceSimulator::Particle::SetNeighbor(std::size_t idx, uint32_t
 		return;
 	m_neighbors.at(idx) = ptIdx;
 }
-PhysWaterSurfaceSimulator::Edge::Edge(uint32_t idx0, uint32_t idx1) : index0(idx0), index1(idx1) {}
 
 PhysWaterSurfaceSimulator::PhysWaterSurfaceSimulator(Vector2 aabbMin, Vector2 aabbMax, float originY, uint32_t spacing, float stiffness, float propagation)
 {
@@ -53,7 +52,7 @@ PhysWaterSurfaceSimulator::PhysWaterSurfaceSimulator(Vector2 aabbMin, Vector2 aa
 	m_surfaceInfo.length = (aabbMax.x - aabbMin.x) / spacing;
 	m_surfaceInfo.width = (aabbMax.y - aabbMin.y) / spacing;
 }
-PhysWaterSurfaceSimulator::~PhysWaterSurfaceSimulator() { JoinThread(); }
+PhysWaterSurfaceSimulator::~PhysWaterSurfaceSimulator() { WaitForSimulation(); }
 const Vector3 &PhysWaterSurfaceSimulator::GetOrigin() const { return m_surfaceInfo.origin; }
 void PhysWaterSurfaceSimulator::InitializeSurface()
 {
@@ -62,62 +61,51 @@ void PhysWaterSurfaceSimulator::InitializeSurface()
 	auto numParticles = static_cast<uint64_t>(width) * static_cast<uint64_t>(length);
 	if(numParticles > std::numeric_limits<uint32_t>::max())
 		return;
-	m_particleField.resize(numParticles);
+	m_heights.resize(numParticles);
+	m_oldHeights.resize(numParticles);
+	m_targetHeights.resize(numParticles);
+	m_velocities.resize(numParticles);
 	m_particleHeights.resize(numParticles);
-	m_threadParticleHeights.resize(numParticles);
-
-	m_particleEdges.reserve(4 * 2 +              // Corner particles
-	  ((width - 2) * 2 + (length - 2) * 2) * 3 + // Edge particles
-	  (width - 2) * (length - 2) * 4             // Inner particles
-	);
-	for(auto i = decltype(width) {0}; i < width; ++i) {
-		for(auto j = decltype(length) {0}; j < length; ++j) {
-			std::size_t edgeIdx = 0;
-			auto ptIdx = GetParticleIndex(m_surfaceInfo, i, j);
-			auto &pt = m_particleField.at(ptIdx);
-			if(j > 0) {
-				auto ptIdxOther = GetParticleIndex(m_surfaceInfo, i, j - 1);
-				m_particleEdges.push_back(Edge(ptIdx, ptIdxOther));
-				pt.SetNeighbor(edgeIdx++, m_particleEdges.back().index1);
-			}
-			if(j < (length - 1)) {
-				auto ptIdxOther = GetParticleIndex(m_surfaceInfo, i, j + 1);
-				m_particleEdges.push_back(Edge(ptIdx, ptIdxOther));
-				pt.SetNeighbor(edgeIdx++, m_particleEdges.back().index1);
-			}
-			if(i > 0) {
-				auto ptIdxOther = GetParticleIndex(m_surfaceInfo, i - 1, j);
-				m_particleEdges.push_back(Edge(ptIdx, ptIdxOther));
-				pt.SetNeighbor(edgeIdx++, m_particleEdges.back().index1);
-			}
-			if(i < (width - 1)) {
-				auto ptIdxOther = GetParticleIndex(m_surfaceInfo, i + 1, j);
-				m_particleEdges.push_back(Edge(ptIdx, ptIdxOther));
-				pt.SetNeighbor(edgeIdx++, m_particleEdges.back().index1);
-			}
-		}
-	}
 }
 void PhysWaterSurfaceSimulator::Initialize()
 {
 	InitializeSurface();
-	if(m_particleField.empty() == true)
+	if(m_heights.empty() == true)
 		return;
 	if(m_bUseThread == false)
 		return;
-	m_simThread = std::thread([this]() {
-		while(m_bRunThread == true)
-			SimulateWaves(0.01); // TODO: Delta?
-	});
+	m_jobSubsystem = engine->GetJobSystem().RegisterSubsystem({"water_surface_simulation", pragma::JobSystem::Priority::Normal});
+}
+std::vector<PhysWaterSurfaceSimulator::Particle> PhysWaterSurfaceSimulator::CreateParticleField() const
+{
+	auto width = GetWidth();
+	auto length = GetLength();
+	std::vector<Particle> particles(GetParticleCount());
+	for(auto i = decltype(width) {0}; i < width; ++i) {
+		for(auto j = decltype(length) {0}; j < length; ++j) {
+			std::size_t edgeIdx = 0;
+			auto ptIdx = GetParticleIndex(m_surfaceInfo, i, j);
+			auto &pt = particles[ptIdx];
+			if(j > 0)
+				pt.SetNeighbor(edgeIdx++, GetParticleIndex(m_surfaceInfo, i, j - 1));
+			if(j < (length - 1))
+				pt.SetNeighbor(edgeIdx++, GetParticleIndex(m_surfaceInfo, i, j + 1));
+			if(i > 0)
+				pt.SetNeighbor(edgeIdx++, GetParticleIndex(m_surfaceInfo, i - 1, j));
+			if(i < (width - 1))
+				pt.SetNeighbor(edgeIdx++, GetParticleIndex(m_surfaceInfo, i + 1, j));
+			pt.SetHeight(m_heights[ptIdx]);
+			pt.SetOldHeight(m_oldHeights[ptIdx]);
+			pt.SetTargetHeight(m_targetHeights[ptIdx]);
+			pt.SetVelocity(m_velocities[ptIdx]);
+		}
+	}
+	return particles;
 }
 uint32_t PhysWaterSurfaceSimulator::GetSpacing() const { return m_surfaceInfo.spacing; }
 uint32_t PhysWaterSurfaceSimulator::GetWidth() const { return m_surfaceInfo.width; }
 uint32_t PhysWaterSurfaceSimulator::GetLength() const { return m_surfaceInfo.length; }
-std::vector<PhysWaterSurfaceSimulator::Particle> &PhysWaterSurfaceSimulator::GetParticleField() { return m_particleField; }
-std::vector<PhysWaterSurfaceSimulator::Edge> &PhysWaterSurfaceSimulator::GetParticleEdges() { return m_particleEdges; }
-const std::vector<PhysWaterSurfaceSimulator::Particle> &PhysWaterSurfaceSimulator::GetParticleField() const { return const_cast<PhysWaterSurfaceSimulator *>(this)->GetParticleField(); }
-const std::vector<PhysWaterSurfaceSimulator::Edge> &PhysWaterSurfaceSimulator::GetParticleEdges() const { return const_cast<PhysWaterSurfaceSimulator *>(this)->GetParticleEdges(); }
-std::size_t PhysWaterSurfaceSimulator::GetParticleCount() const { return m_particleField.size(); }
+std::size_t PhysWaterSurfaceSimulator::GetParticleCount() const { return m_heights.size(); }
 float PhysWaterSurfaceSimulator::GetStiffness() const { return m_surfaceInfo.stiffness; }
 void PhysWaterSurfaceSimulator::SetStiffness(float stiffness) { m_surfaceInfo.stiffness = stiffness; }
 float PhysWaterSurfaceSimulator::GetMaxWaveHeight() const { return m_surfaceInfo.maxHeight; }
@@ -138,55 +126,94 @@ void PhysWaterSurfaceSimulator::CreateSplash(const Vector3 &origin, float radius
 //void PhysWaterSurfaceSimulator::SetRotation(const Quat &rot) {m_rotation = rot;} // TODO
 void PhysWaterSurfaceSimulator::Simulate(double dt)
 {
-	if(m_bUseThread == true)
+	if(m_bUseThread == false) {
+		SimulateWaves(dt);
+		return;
+	}
+	auto &jobSystem = engine->GetJobSystem();
+	// If the previous step hasn't completed yet, this step is skipped instead of queueing up more work.
+	// Its time is simulated with the next step.
+	m_pendingSimTime += dt;
+	if(m_simJob.IsValid() && jobSystem.IsComplete(m_simJob) == false)
 		return;
-	SimulateWaves(dt);
+	dt = m_pendingSimTime;
+	m_pendingSimTime = 0.0;
+	m_simJob = jobSystem.Schedule([this, dt]() { SimulateWaves(dt); }, m_jobSubsystem);
 }
-void PhysWaterSurfaceSimulator::SimulateWaves(double dt)
+void PhysWaterSurfaceSimulator::WaitForSimulation()
 {
-	//if(dt <= 0.0) // TODO
-	//	return;
-
-	m_settingsMutex.lock();
-	auto surfInfo = m_surfaceInfo; // Copy settings to avoid race conditions
-	m_settingsMutex.unlock();
-
-	// Apply splashes
-	auto width = GetWidth();
-	auto length = GetLength();
-	m_splashMutex.lock();
+	if(m_simJob.IsValid() == false)
+		return;
+	engine->GetJobSystem().Wait(m_simJob);
+	m_simJob = {};
+}
+void PhysWaterSurfaceSimulator::ApplySplashes(const SurfaceInfo &surfInfo)
+{
+	std::scoped_lock lock {m_splashMutex};
 	while(m_splashQueue.empty() == false) {
 		auto &info = m_splashQueue.front();
 		auto r2 = info.radiusSqr;
-		auto &particleField = GetParticleField();
-		for(auto i = decltype(particleField.size()) {0}; i < particleField.size(); ++i) {
-			auto pos = CalcParticlePosition(surfInfo, m_threadParticleHeights, i);
+		for(auto i = decltype(m_heights.size()) {0}; i < m_heights.size(); ++i) {
+			auto pos = CalcParticlePosition(surfInfo, m_heights, i);
 			auto l = uvec::length_sqr(pos - info.origin);
 			if(l < r2) {
 				l = umath::sqrt(l);
 				auto factor = (info.radius - l) / info.radius;
-				auto &pt = particleField.at(i);
-				pt.SetOldHeight(pt.GetHeight());
-				SetParticleHeight(surfInfo, i, pt.GetHeight() + info.force * factor);
+				m_oldHeights[i] = m_heights[i];
+				m_heights[i] = std::min(m_heights[i] + info.force * factor, surfInfo.maxHeight);
 			}
 		}
 		m_splashQueue.pop();
 	}
-	m_splashMutex.unlock();
+}
+uint32_t PhysWaterSurfaceSimulator::GetRowGrainSize() const
+{
+	// Roughly 4096 particles per range, so the scheduling overhead is negligible compared to the work per range
+	return std::max(4'096u / std::max(GetWidth(), 1u), 1u);
+}
+void PhysWaterSurfaceSimulator::SimulateWaves(double dt)
+{
+	if(m_heights.empty() || dt <= 0.0)
+		return;
+	m_settingsMutex.lock();
+	auto surfInfo = m_surfaceInfo; // Copy settings to avoid race conditions
+	m_settingsMutex.unlock();
+
+	ApplySplashes(surfInfo);
 
-	dt = 0.01;
-	Integrate(surfInfo, dt);
+	// The solver is only stable for small steps, so larger deltas are split into sub-steps. If the delta is too large
+	// even for the maximum number of sub-steps, the simulation falls behind instead of becoming unstable.
+	constexpr double maxStepSize = 0.01;
+	constexpr uint32_t maxStepCount = 8;
+	auto numSteps = static_cast<uint32_t>(std::min(std::ceil(dt / maxStepSize), static_cast<double>(maxStepCount)));
+	auto stepDt = std::min(dt / static_cast<double>(numSteps), maxStepSize);
+
+	auto &jobSystem = engine->GetJobSystem();
+	auto numRows = GetLength();
+	auto grainSize = GetRowGrainSize();
 	auto sovleEdgeCount = GetEdgeIterationCount();
-	for(auto i = decltype(sovleEdgeCount) {0}; i < sovleEdgeCount; ++i)
-		SolveEdges(surfInfo);
-	SolveDepths(surfInfo);
-	VelocityFixup(surfInfo, 1.0 / dt);
+	for(auto step = decltype(numSteps) {0}; step < numSteps; ++step) {
+		jobSystem.ParallelFor(numRows, grainSize, [this, &surfInfo, stepDt](uint32_t start, uint32_t end) { Integrate(surfInfo, stepDt, start, end); }, m_jobSubsystem);
+		for(auto i = decltype(sovleEdgeCount) {0}; i < sovleEdgeCount; ++i) {
+			for(uint32_t color = 0; color < 2; ++color)
+				jobSystem.ParallelFor(numRows, grainSize, [this, &surfInfo, color](uint32_t start, uint32_t end) { SolveEdges(surfInfo, color, start, end); }, m_jobSubsystem);
+		}
+		jobSystem.ParallelFor(numRows, grainSize, [this, &surfInfo](uint32_t start, uint32_t end) { SolveDepths(surfInfo, start, end); }, m_jobSubsystem);
 
-	m_heightMutex.lock();
-	std::copy(m_threadParticleHeights.begin(), m_threadParticleHeights.end(), m_particleHeights.begin());
-	m_heightMutex.unlock();
+		// The depth solver doesn't clamp its heights, so the unclamped heights can be published before the velocity fixup clamps them
+		if(step == numSteps - 1) {
+			m_heightMutex.lock();
+			std::copy(m_heights.begin(), m_heights.end(), m_particleHeights.begin());
+			m_heightMutex.unlock();
+		}
+		jobSystem.ParallelFor(numRows, grainSize, [this, &surfInfo, stepDt](uint32_t start, uint32_t end) { VelocityFixup(surfInfo, 1.0 / stepDt, start, end); }, m_jobSubsystem);
+	}
+}
+uint8_t PhysWaterSurfaceSimulator::GetEdgeIterationCount() const
+{
+	auto *nw = engine->GetServerNetworkState();
+	return nw ? nw->GetConVarInt("sv_water_surface_simulation_edge_iteration_count") : 5;
 }
-uint8_t PhysWaterSurfaceSimulator::GetEdgeIterationCount() const { return engine->GetServerNetworkState()->GetConVarInt("sv_water_surface_simulation_edge_iteration_count"); }
 Vector3 PhysWaterSurfaceSimulator::CalcParticlePosition(const SurfaceInfo &surfInfo, const std::vector<float> &heights, std::size_t ptIdx) const
 {
 	auto c = GetParticleCoordinates(surfInfo, ptIdx);
@@ -198,7 +225,7 @@ void PhysWaterSurfaceSimulator::UnlockParticleHeights() { m_heightMutex.unlock()
 bool PhysWaterSurfaceSimulator::CalcPointSurfaceIntersection(const Vector3 &origin, Vector3 &intersection) const
 {
 	auto posFirst = CalcParticlePosition(0);
-	auto posLast = CalcParticlePosition(m_particleField.size() - 1);
+	auto posLast = CalcParticlePosition(GetParticleCount() - 1);
 	posFirst.y = 0.f; // TODO: Relative to plane!
 	posLast.y = 0.f;
 	auto bounds = posLast - posFirst;
@@ -217,7 +244,7 @@ bool PhysWaterSurfaceSimulator::CalcPointSurfaceIntersection(const Vector3 &orig
 	auto ptIdx1 = GetParticleIndex(m_surfaceInfo, x + 1, y);
 	auto ptIdx2 = GetParticleIndex(m_surfaceInfo, x, y + 1);
 	auto ptIdx3 = GetParticleIndex(m_surfaceInfo, x + 1, y + 1);
-	auto numParticles = m_particleField.size();
+	auto numParticles = GetParticleCount();
 	assert(ptIdx0 < numParticles && ptIdx1 < numParticles && ptIdx2 < numParticles && ptIdx3 < numParticles);
 	if(ptIdx0 >= numParticles || ptIdx1 >= numParticles || ptIdx2 >= numParticles || ptIdx3 >= numParticles)
 		return false;
@@ -8,58 +8,75 @@
 #include "stdafx_shared.h"
 #include "pragma/physics/phys_water_surface_simulator.hpp"
 
-void PhysWaterSurfaceSimulator::JoinThread()
-{
-	m_bRunThread = false;
-	m_simThread.join();
-}
 std::size_t PhysWaterSurfaceSimulator::GetParticleIndex(uint32_t x, uint32_t y) const { return GetParticleIndex(m_surfaceInfo, x, y); }
 std::pair<uint32_t, uint32_t> PhysWaterSurfaceSimulator::GetParticleCoordinates(std::size_t idx) const { return GetParticleCoordinates(m_surfaceInfo, idx); }
 std::size_t PhysWaterSurfaceSimulator::GetParticleIndex(const SurfaceInfo &surfInfo, uint32_t x, uint32_t y) const { return y * surfInfo.width + x; }
 std::pair<uint32_t, uint32_t> PhysWaterSurfaceSimulator::GetParticleCoordinates(const SurfaceInfo &surfInfo, std::size_t idx) const { return std::pair<uint32_t, uint32_t>(idx / surfInfo.width, idx % surfInfo.width); }
-void PhysWaterSurfaceSimulator::SolveDepths(const SurfaceInfo &surfInfo)
+// The solver loops work on raw pointers without bounds checks and without any dependencies between the iterations, so they can be vectorized
+void PhysWaterSurfaceSimulator::SolveDepths(const SurfaceInfo &surfInfo, uint32_t rowStart, uint32_t rowEnd)
 {
-	std::size_t ptIdx = 0;
-	for(auto &pt : GetParticleField()) {
-		auto x = pt.GetTargetHeight() - pt.GetHeight();
-		SetParticleHeight(surfInfo, ptIdx++, pt.GetHeight() + x * surfInfo.stiffness);
-	}
+	auto start = static_cast<std::size_t>(rowStart) * surfInfo.width;
+	auto end = static_cast<std::size_t>(rowEnd) * surfInfo.width;
+	auto *heights = m_heights.data();
+	auto *targetHeights = m_targetHeights.data();
+	auto stiffness = surfInfo.stiffness;
+	// Not clamped here, see VelocityFixup
+	for(auto i = start; i < end; ++i)
+		heights[i] = heights[i] + (targetHeights[i] - heights[i]) * stiffness;
 }
-void PhysWaterSurfaceSimulator::SolveEdges(const SurfaceInfo &surfInfo)
+void PhysWaterSurfaceSimulator::SolveEdges(const SurfaceInfo &surfInfo, uint32_t color, uint32_t rowStart, uint32_t rowEnd)
 {
-	auto &particleField = GetParticleField();
-	for(auto &edge : GetParticleEdges()) {
-		auto &pt0 = particleField.at(edge.index0);
-		auto &pt1 = particleField.at(edge.index1);
-
-		auto d = pt1.GetHeight() - pt0.GetHeight();
-		d *= surfInfo.propagation;
-
-		SetParticleHeight(surfInfo, edge.index0, pt0.GetHeight() + d);
-		SetParticleHeight(surfInfo, edge.index1, pt1.GetHeight() - d);
+	// Previously every edge was relaxed in both directions, i.e. every particle was pulled towards each neighbor twice per iteration
+	auto factor = surfInfo.propagation * 2.f;
+	auto maxHeight = surfInfo.maxHeight;
+	auto width = surfInfo.width;
+	auto length = surfInfo.length;
+	auto *heights = m_heights.data();
+	for(auto y = rowStart; y < rowEnd; ++y) {
+		auto *row = heights + static_cast<std::size_t>(y) * width;
+		// Missing neighbors at the border of the grid are substituted with the particle itself, which doesn't contribute anything
+		auto *rowUp = (y > 0) ? (row - width) : row;
+		auto *rowDown = (y < length - 1) ? (row + width) : row;
+		auto relax = [&](uint32_t x, float left, float right) {
+			auto h = row[x];
+			auto d = (rowUp[x] - h) + (rowDown[x] - h) + (left - h) + (right - h);
+			row[x] = std::min(h + d * factor, maxHeight);
+		};
+		auto x = (y + color) % 2;
+		if(x == 0) {
+			relax(0, row[0], (width > 1) ? row[1] : row[0]);
+			x = 2;
+		}
+		for(; x < width - 1; x += 2)
+			relax(x, row[x - 1], row[x + 1]);
+		if(x == width - 1 && x > 0)
+			relax(x, row[x - 1], row[x]);
 	}
 }
-void PhysWaterSurfaceSimulator::SetParticleHeight(const SurfaceInfo &surfInfo, std::size_t ptIdx, float height)
-{
-	auto &pt = m_particleField.at(ptIdx);
-	pt.SetHeight(umath::min(height, surfInfo.maxHeight));
-	m_threadParticleHeights.at(ptIdx) = height;
-}
-void PhysWaterSurfaceSimulator::Integrate(const SurfaceInfo &surfInfo, double dt)
+void PhysWaterSurfaceSimulator::Integrate(const SurfaceInfo &surfInfo, double dt, uint32_t rowStart, uint32_t rowEnd)
 {
-	std::size_t ptIdx = 0;
-	for(auto &pt : GetParticleField())
-		SetParticleHeight(surfInfo, ptIdx++, pt.GetHeight() + dt * pt.GetVelocity());
+	auto start = static_cast<std::size_t>(rowStart) * surfInfo.width;
+	auto end = static_cast<std::size_t>(rowEnd) * surfInfo.width;
+	auto *heights = m_heights.data();
+	auto *velocities = m_velocities.data();
+	auto fdt = static_cast<float>(dt);
+	auto maxHeight = surfInfo.maxHeight;
+	for(auto i = start; i < end; ++i)
+		heights[i] = std::min(heights[i] + fdt * velocities[i], maxHeight);
 }
-void PhysWaterSurfaceSimulator::VelocityFixup(const SurfaceInfo &surfInfo, double invDt)
+void PhysWaterSurfaceSimulator::VelocityFixup(const SurfaceInfo &surfInfo, double invDt, uint32_t rowStart, uint32_t rowEnd)
 {
-	auto &particleField = GetParticleField();
-	for(auto i = decltype(particleField.size()) {0}; i < particleField.size(); ++i) {
-		auto &pt = particleField.at(i);
-		auto delta = pt.GetHeight() - pt.GetOldHeight();
-		pt.SetVelocity(invDt * delta);
-		pt.SetOldHeight(pt.GetHeight());
-
-		//UpdateParticlePosition(surfInfo,i);
+	auto start = static_cast<std::size_t>(rowStart) * surfInfo.width;
+	auto end = static_cast<std::size_t>(rowEnd) * surfInfo.width;
+	auto *heights = m_heights.data();
+	auto *oldHeights = m_oldHeights.data();
+	auto *velocities = m_velocities.data();
+	auto fInvDt = static_cast<float>(invDt);
+	auto maxHeight = surfInfo.maxHeight;
+	for(auto i = start; i < end; ++i) {
+		auto h = std::min(heights[i], maxHeight);
+		heights[i] = h;
+		velocities[i] = fInvDt * (h - oldHeights[i]);
+		oldHeights[i] = h;
 	}
 }
@@ -0,0 +1,432 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/util/job_system.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace pragma;
+
+struct JobSystem::Job {
+	Task task;
+	uint32_t index = INVALID_JOB;
+	SubsystemId subsystem = DEFAULT_SUBSYSTEM;
+	Priority priority = Priority::Normal;
+	WorkerMask workerMask = ALL_WORKERS;
+	bool allowHelping = true;
+	std::atomic<uint32_t> generation = 0;
+	// Includes an additional reference which is released by Submit
+	std::atomic<int32_t> pendingDependencyCount = 0;
+
+	// Guards the completion state and the continuations
+	std::mutex mutex;
+	bool complete = false;
+	std::vector<Job *> continuations;
+};
+
+struct JobSystem::Worker {
+	std::thread thread;
+	std::mutex mutex;
+	std::array<std::deque<Job *>, PRIORITY_COUNT> queues;
+};
+
+static thread_local JobSystem *g_currentJobSystem = nullptr;
+static thread_local uint32_t g_currentWorkerIndex = JobSystem::INVALID_JOB;
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+	for(auto &block : m_jobBlockTable)
+		block = nullptr;
+	if(workerCount == 0)
+		workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	workerCount = std::min(workerCount, MAX_WORKERS);
+
+	RegisterSubsystem({"default", Priority::Normal, ALL_WORKERS});
+	RegisterSubsystem({"background", Priority::Low, ALL_WORKERS, false});
+
+	m_workers.reserve(workerCount);
+	for(auto i = decltype(workerCount) {0u}; i < workerCount; ++i)
+		m_workers.push_back(std::make_unique<Worker>());
+	// All workers have to exist before the first one starts stealing
+	for(auto i = decltype(workerCount) {0u}; i < workerCount; ++i) {
+		auto &worker = *m_workers[i];
+		worker.thread = std::thread {[this, i]() { RunWorker(i); }};
+		util::set_thread_name(worker.thread, "pr_job_worker");
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::scoped_lock lock {m_sleepMutex};
+		m_stopping = true;
+	}
+	m_workCondition.notify_all();
+	for(auto &worker : m_workers) {
+		if(worker->thread.joinable())
+			worker->thread.join();
+	}
+}
+
+JobSystem::SubsystemId JobSystem::RegisterSubsystem(const Subsystem &subsystem)
+{
+	std::scoped_lock lock {m_subsystemMutex};
+	auto count = m_subsystemCount.load();
+	for(auto i = decltype(count) {0u}; i < count; ++i) {
+		if(m_subsystems[i].name == subsystem.name)
+			return i;
+	}
+	if(count >= MAX_SUBSYSTEMS)
+		throw std::logic_error {"Maximum number of job subsystems exceeded!"};
+	auto &newSubsystem = m_subsystems[count];
+	newSubsystem = subsystem;
+	// Masks which don't include any existing worker would never be executed
+	auto numWorkers = static_cast<uint32_t>(m_workers.size());
+	auto validMask = (numWorkers >= MAX_WORKERS) ? ALL_WORKERS : ((WorkerMask {1} << numWorkers) - 1);
+	if(m_workers.empty() == false && (newSubsystem.workerMask & validMask) == 0)
+		newSubsystem.workerMask = ALL_WORKERS;
+	if((newSubsystem.workerMask & validMask) == validMask)
+		newSubsystem.workerMask = ALL_WORKERS;
+	m_subsystemCount = count + 1;
+	return count;
+}
+const JobSystem::Subsystem &JobSystem::GetSubsystem(SubsystemId id) const { return m_subsystems[(id < m_subsystemCount) ? id : DEFAULT_SUBSYSTEM]; }
+
+JobSystem::Job &JobSystem::GetJob(uint32_t index) const { return m_jobBlockTable[index / JOB_BLOCK_SIZE].load()[index % JOB_BLOCK_SIZE]; }
+
+JobSystem::Job *JobSystem::AllocateJob()
+{
+	std::scoped_lock lock {m_jobPoolMutex};
+	if(m_freeJobs.empty()) {
+		auto blockIndex = m_jobBlocks.size();
+		if(blockIndex >= m_jobBlockTable.size())
+			throw std::logic_error {"Maximum number of jobs in flight exceeded!"};
+		auto block = std::make_unique<Job[]>(JOB_BLOCK_SIZE);
+		m_freeJobs.reserve(m_freeJobs.size() + JOB_BLOCK_SIZE);
+		// Reverse order, so jobs are handed out in ascending order
+		for(auto i = JOB_BLOCK_SIZE; i > 0; --i) {
+			auto &job = block[i - 1];
+			job.index = static_cast<uint32_t>(blockIndex * JOB_BLOCK_SIZE + (i - 1));
+			m_freeJobs.push_back(&job);
+		}
+		m_jobBlockTable[blockIndex] = block.get();
+		m_jobBlocks.push_back(std::move(block));
+	}
+	auto *job = m_freeJobs.back();
+	m_freeJobs.pop_back();
+	return job;
+}
+
+void JobSystem::ReleaseJob(Job &job)
+{
+	{
+		std::scoped_lock lock {job.mutex};
+		// Invalidates all outstanding handles to this job
+		++job.generation;
+		job.continuations.clear();
+	}
+	std::scoped_lock lock {m_jobPoolMutex};
+	m_freeJobs.push_back(&job);
+}
+
+JobSystem::JobHandle JobSystem::CreateJob(Task task, SubsystemId subsystemId)
+{
+	auto &subsystem = GetSubsystem(subsystemId);
+	auto &job = *AllocateJob();
+	job.task = std::move(task);
+	job.subsystem = (subsystemId < m_subsystemCount) ? subsystemId : DEFAULT_SUBSYSTEM;
+	job.priority = subsystem.priority;
+	job.workerMask = subsystem.workerMask;
+	job.allowHelping = subsystem.allowHelping;
+	job.pendingDependencyCount = 1;
+	{
+		std::scoped_lock lock {job.mutex};
+		job.complete = false;
+	}
+	return {job.index, job.generation.load()};
+}
+
+void JobSystem::AddDependency(JobHandle jobHandle, JobHandle dependencyHandle)
+{
+	if(jobHandle.IsValid() == false || dependencyHandle.IsValid() == false)
+		return;
+	auto &job = GetJob(jobHandle.index);
+	auto &dependency = GetJob(dependencyHandle.index);
+	std::scoped_lock lock {dependency.mutex};
+	if(dependency.generation != dependencyHandle.generation || dependency.complete)
+		return;
+	++job.pendingDependencyCount;
+	dependency.continuations.push_back(&job);
+}
+
+void JobSystem::Submit(JobHandle jobHandle)
+{
+	if(jobHandle.IsValid() == false)
+		return;
+	++m_statistics.submittedCount;
+	auto &job = GetJob(jobHandle.index);
+	if(--job.pendingDependencyCount == 0)
+		Enqueue(job);
+}
+
+JobSystem::JobHandle JobSystem::Schedule(Task task, SubsystemId subsystem)
+{
+	auto handle = CreateJob(std::move(task), subsystem);
+	Submit(handle);
+	return handle;
+}
+
+bool JobSystem::IsComplete(JobHandle jobHandle) const
+{
+	if(jobHandle.IsValid() == false)
+		return true;
+	auto &job = GetJob(jobHandle.index);
+	std::scoped_lock lock {job.mutex};
+	return job.generation != jobHandle.generation || job.complete;
+}
+
+void JobSystem::Enqueue(Job &job)
+{
+	auto priority = static_cast<size_t>(job.priority);
+	auto workerIndex = (g_currentJobSystem == this) ? g_currentWorkerIndex : INVALID_JOB;
+	++m_queuedJobCount;
+	if(workerIndex != INVALID_JOB && job.workerMask == ALL_WORKERS) {
+		auto &worker = *m_workers[workerIndex];
+		std::scoped_lock lock {worker.mutex};
+		worker.queues[priority].push_back(&job);
+	}
+	else {
+		std::scoped_lock lock {m_globalQueueMutex};
+		m_globalQueues[priority].push_back(&job);
+	}
+	NotifyStateChanged(true);
+}
+
+void JobSystem::NotifyStateChanged(bool newWork)
+{
+	++m_stateGeneration;
+	auto notifyWorkers = newWork && m_sleepingWorkerCount > 0;
+	auto notifyWaiters = m_waitingThreadCount > 0;
+	if(notifyWorkers == false && notifyWaiters == false)
+		return;
+	// Locking the mutex ensures that a thread which is about to go to sleep has either already seen the new generation, or is waiting
+	{
+		std::scoped_lock lock {m_sleepMutex};
+	}
+	if(notifyWorkers)
+		m_workCondition.notify_all();
+	if(notifyWaiters)
+		m_completionCondition.notify_all();
+}
+
+bool JobSystem::HelpFilter::Accepts(const Job &job) const
+{
+	if(job.subsystem == subsystem)
+		return true;
+	// Lower values have a higher priority
+	return job.allowHelping && job.priority <= priority;
+}
+
+JobSystem::Job *JobSystem::PopJob(uint32_t workerIndex, const HelpFilter *filter)
+{
+	if(m_queuedJobCount == 0)
+		return nullptr;
+	auto isWorker = (workerIndex != INVALID_JOB);
+	auto workerBit = isWorker ? (WorkerMask {1} << workerIndex) : WorkerMask {0};
+	auto numWorkers = static_cast<uint32_t>(m_workers.size());
+	auto accepts = [filter](const Job *job) { return filter == nullptr || filter->Accepts(*job); };
+	for(auto p = decltype(PRIORITY_COUNT) {0u}; p < PRIORITY_COUNT; ++p) {
+		// Own jobs first, most recent first, since their data is most likely still in the cache
+		if(isWorker) {
+			auto &worker = *m_workers[workerIndex];
+			std::scoped_lock lock {worker.mutex};
+			auto &queue = worker.queues[p];
+			auto it = std::find_if(queue.rbegin(), queue.rend(), accepts);
+			if(it != queue.rend()) {
+				auto *job = *it;
+				queue.erase(std::next(it).base());
+				--m_queuedJobCount;
+				return job;
+			}
+		}
+		{
+			std::scoped_lock lock {m_globalQueueMutex};
+			auto &queue = m_globalQueues[p];
+			auto it = std::find_if(queue.begin(), queue.end(), [workerBit, &accepts](const Job *job) { return (job->workerMask == ALL_WORKERS || (job->workerMask & workerBit) != 0) && accepts(job); });
+			if(it != queue.end()) {
+				auto *job = *it;
+				queue.erase(it);
+				--m_queuedJobCount;
+				return job;
+			}
+		}
+		// Steal the oldest job of another worker
+		auto offset = isWorker ? (workerIndex + 1) : 0u;
+		for(auto i = decltype(numWorkers) {0u}; i < numWorkers; ++i) {
+			auto victimIndex = (offset + i) % numWorkers;
+			if(victimIndex == workerIndex)
+				continue;
+			auto &victim = *m_workers[victimIndex];
+			std::scoped_lock lock {victim.mutex};
+			auto &queue = victim.queues[p];
+			auto it = std::find_if(queue.begin(), queue.end(), accepts);
+			if(it == queue.end())
+				continue;
+			auto *job = *it;
+			queue.erase(it);
+			--m_queuedJobCount;
+			++m_statistics.stolenCount;
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+void JobSystem::Execute(Job &job)
+{
+	if(job.task)
+		job.task();
+	job.task = nullptr;
+	++m_statistics.executedCount;
+
+	std::vector<Job *> continuations;
+	{
+		std::scoped_lock lock {job.mutex};
+		job.complete = true;
+		continuations.swap(job.continuations);
+	}
+	for(auto *continuation : continuations) {
+		if(--continuation->pendingDependencyCount == 0)
+			Enqueue(*continuation);
+	}
+	ReleaseJob(job);
+	NotifyStateChanged(false);
+}
+
+bool JobSystem::RunPendingJob(uint32_t workerIndex, const HelpFilter *filter)
+{
+	auto *job = PopJob(workerIndex, filter);
+	if(job == nullptr)
+		return false;
+	Execute(*job);
+	return true;
+}
+
+void JobSystem::RunWorker(uint32_t workerIndex)
+{
+	g_currentJobSystem = this;
+	g_currentWorkerIndex = workerIndex;
+	for(;;) {
+		auto generation = m_stateGeneration.load();
+		if(RunPendingJob(workerIndex))
+			continue;
+		std::unique_lock lock {m_sleepMutex};
+		if(m_stopping && m_queuedJobCount == 0)
+			return;
+		++m_sleepingWorkerCount;
+		m_workCondition.wait(lock, [this, generation]() { return m_stopping || m_stateGeneration != generation; });
+		--m_sleepingWorkerCount;
+	}
+}
+
+void JobSystem::Wait(JobHandle jobHandle)
+{
+	if(jobHandle.IsValid() == false)
+		return;
+	auto subsystem = DEFAULT_SUBSYSTEM;
+	{
+		auto &job = GetJob(jobHandle.index);
+		std::scoped_lock lock {job.mutex};
+		if(job.generation != jobHandle.generation || job.complete)
+			return;
+		subsystem = job.subsystem;
+	}
+	// Waiting on the job's own subsystem makes sure we can help with the job itself, even if its subsystem doesn't allow helping
+	WaitUntil([this, jobHandle]() { return IsComplete(jobHandle); }, subsystem);
+}
+
+void JobSystem::NotifyWaiters() { NotifyStateChanged(false); }
+
+void JobSystem::WaitUntil(const std::function<bool()> &condition, SubsystemId subsystem)
+{
+	auto workerIndex = (g_currentJobSystem == this) ? g_currentWorkerIndex : INVALID_JOB;
+	HelpFilter filter {};
+	filter.subsystem = (subsystem < m_subsystemCount) ? subsystem : DEFAULT_SUBSYSTEM;
+	filter.priority = GetSubsystem(filter.subsystem).priority;
+	for(;;) {
+		// The generation has to be read before the condition is evaluated, otherwise we could miss a change that happens in between
+		auto generation = m_stateGeneration.load();
+		if(condition())
+			break;
+		if(RunPendingJob(workerIndex, &filter)) {
+			++m_statistics.helpedCount;
+			continue;
+		}
+		std::unique_lock lock {m_sleepMutex};
+		++m_waitingThreadCount;
+		m_completionCondition.wait(lock, [this, generation]() { return m_stateGeneration != generation; });
+		--m_waitingThreadCount;
+	}
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)> &f, SubsystemId subsystem)
+{
+	if(count == 0)
+		return;
+	grainSize = std::max(grainSize, 1u);
+	auto numRanges = (count + grainSize - 1) / grainSize;
+	if(numRanges == 1 || m_workers.empty()) {
+		f(0, count);
+		return;
+	}
+	// Ranges are claimed dynamically, so ranges which take longer to process don't hold back the others
+	struct State {
+		std::atomic<uint32_t> nextRange = 0;
+	};
+	auto state = std::make_shared<State>();
+	auto processRanges = [state, numRanges, grainSize, count, &f]() {
+		for(;;) {
+			auto range = state->nextRange++;
+			if(range >= numRanges)
+				break;
+			auto start = range * grainSize;
+			f(start, std::min(start + grainSize, count));
+		}
+	};
+	auto numHelpers = std::min(numRanges - 1, static_cast<uint32_t>(m_workers.size()));
+	std::vector<JobHandle> helpers;
+	helpers.reserve(numHelpers);
+	for(auto i = decltype(numHelpers) {0u}; i < numHelpers; ++i)
+		helpers.push_back(Schedule(processRanges, subsystem));
+	processRanges();
+	// The helper jobs reference f, so they have to be complete before returning
+	for(auto &helper : helpers)
+		Wait(helper);
+}
+
+uint32_t JobSystem::GetWorkerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+uint32_t JobSystem::GetCurrentWorkerIndex() const { return (g_currentJobSystem == this) ? g_currentWorkerIndex : INVALID_JOB; }
+
+JobSystem::Statistics JobSystem::GetStatistics() const
+{
+	Statistics stats {};
+	stats.submittedCount = m_statistics.submittedCount;
+	stats.executedCount = m_statistics.executedCount;
+	stats.stolenCount = m_statistics.stolenCount;
+	stats.helpedCount = m_statistics.helpedCount;
+	std::scoped_lock lock {m_jobPoolMutex};
+	stats.allocatedJobCount = static_cast<uint32_t>(m_jobBlocks.size() * JOB_BLOCK_SIZE);
+	return stats;
+}
+void JobSystem::ResetStatistics()
+{
+	m_statistics.submittedCount = 0;
+	m_statistics.executedCount = 0;
+	m_statistics.stolenCount = 0;
+	m_statistics.helpedCount = 0;
+}
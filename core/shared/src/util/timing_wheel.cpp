@@ -0,0 +1,182 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Copyright (c) 2024 Silverlan
+ */
+
+#include "stdafx_shared.h"
+#include "pragma/util/timing_wheel.hpp"
+#include <algorithm>
+
+using namespace pragma;
+
+TimingWheel::Node::~Node() { Unschedule(); }
+bool TimingWheel::Node::IsScheduled() const { return m_wheel != nullptr; }
+TimingWheel *TimingWheel::Node::GetWheel() const { return m_wheel; }
+uint64_t TimingWheel::Node::GetTicksLeft() const
+{
+	if(m_wheel == nullptr || deadline <= m_wheel->m_time)
+		return 0;
+	return deadline - m_wheel->m_time;
+}
+void TimingWheel::Node::Unschedule()
+{
+	if(m_wheel == nullptr)
+		return;
+	TimingWheel::Unlink(*this);
+	--m_wheel->m_levelNodeCounts[m_level];
+	--m_wheel->m_nodeCount;
+	m_wheel = nullptr;
+}
+
+TimingWheel::TimingWheel()
+{
+	for(auto &level : m_slots) {
+		for(auto &head : level) {
+			head.m_prev = &head;
+			head.m_next = &head;
+		}
+	}
+}
+TimingWheel::~TimingWheel() { Clear(); }
+uint64_t TimingWheel::GetTime() const { return m_time; }
+size_t TimingWheel::GetNodeCount() const { return m_nodeCount; }
+
+void TimingWheel::Link(Node &head, Node &node)
+{
+	node.m_prev = head.m_prev;
+	node.m_next = &head;
+	head.m_prev->m_next = &node;
+	head.m_prev = &node;
+}
+void TimingWheel::Unlink(Node &node)
+{
+	node.m_prev->m_next = node.m_next;
+	node.m_next->m_prev = node.m_prev;
+	node.m_prev = nullptr;
+	node.m_next = nullptr;
+}
+void TimingWheel::MoveList(Node &srcHead, Node &dstHead)
+{
+	if(srcHead.m_next == &srcHead) {
+		dstHead.m_next = &dstHead;
+		dstHead.m_prev = &dstHead;
+		return;
+	}
+	dstHead.m_next = srcHead.m_next;
+	dstHead.m_prev = srcHead.m_prev;
+	dstHead.m_next->m_prev = &dstHead;
+	dstHead.m_prev->m_next = &dstHead;
+	srcHead.m_next = &srcHead;
+	srcHead.m_prev = &srcHead;
+}
+
+void TimingWheel::Schedule(Node &node, uint64_t deadline)
+{
+	node.Unschedule();
+	// The slot of the current tick has already been processed
+	node.deadline = std::max(deadline, m_time + 1);
+	node.m_wheel = this;
+	++m_nodeCount;
+	Insert(node);
+}
+
+void TimingWheel::Insert(Node &node)
+{
+	// Deadlines equal to the current time are only possible while cascading, in which case
+	// the node ends up in the level 0 slot that is about to be processed.
+	auto deadline = std::max(node.deadline, m_time);
+	auto delta = deadline - m_time;
+	for(auto level = decltype(LEVEL_COUNT) {0u}; level < LEVEL_COUNT; ++level) {
+		auto shift = SLOT_BITS * level;
+		if(delta < (uint64_t {1} << (shift + SLOT_BITS))) {
+			Link(m_slots[level][(deadline >> shift) & SLOT_MASK], node);
+			node.m_level = level;
+			++m_levelNodeCounts[level];
+			return;
+		}
+	}
+	// Beyond the range of the wheel; Park the node in the last slot of the highest level.
+	// It will be re-inserted once that slot is cascaded.
+	constexpr auto shift = SLOT_BITS * (LEVEL_COUNT - 1);
+	Link(m_slots[LEVEL_COUNT - 1][((m_time >> shift) + SLOT_MASK) & SLOT_MASK], node);
+	node.m_level = LEVEL_COUNT - 1;
+	++m_levelNodeCounts[LEVEL_COUNT - 1];
+}
+
+void TimingWheel::Cascade(uint32_t level)
+{
+	auto &head = m_slots[level][(m_time >> (SLOT_BITS * level)) & SLOT_MASK];
+	if(head.m_next == &head)
+		return;
+	// Nodes may be re-inserted into the same slot (for the next revolution), so we have to detach the list first
+	Node tmp {};
+	MoveList(head, tmp);
+	while(tmp.m_next != &tmp) {
+		auto &node = *tmp.m_next;
+		Unlink(node);
+		--m_levelNodeCounts[level];
+		Insert(node);
+	}
+}
+
+void TimingWheel::Expire(Node &head, std::vector<Node *> &outExpired)
+{
+	while(head.m_next != &head) {
+		auto *node = head.m_next;
+		Unlink(*node);
+		node->m_wheel = nullptr;
+		--m_levelNodeCounts[0];
+		--m_nodeCount;
+		outExpired.push_back(node);
+	}
+}
+
+void TimingWheel::Advance(uint64_t time, std::vector<Node *> &outExpired)
+{
+	while(m_time < time) {
+		if(m_nodeCount == 0) {
+			m_time = time;
+			break;
+		}
+		// If the lower levels are empty, nothing can expire before the next slot of the lowest non-empty level is cascaded
+		uint32_t lowestLevel = 0;
+		while(lowestLevel + 1 < LEVEL_COUNT && m_levelNodeCounts[lowestLevel] == 0)
+			++lowestLevel;
+		if(lowestLevel > 0) {
+			auto skipTo = m_time | ((uint64_t {1} << (SLOT_BITS * lowestLevel)) - 1);
+			if(skipTo >= time) {
+				m_time = time;
+				break;
+			}
+			m_time = skipTo;
+		}
+		++m_time;
+		auto idx = m_time & SLOT_MASK;
+		if(idx == 0) {
+			// Higher levels have to be cascaded first, since their nodes may end up in the lower levels' current slots
+			uint32_t maxLevel = 1;
+			while(maxLevel + 1 < LEVEL_COUNT && ((m_time >> (SLOT_BITS * maxLevel)) & SLOT_MASK) == 0)
+				++maxLevel;
+			for(auto level = maxLevel; level >= 1; --level)
+				Cascade(level);
+		}
+		Expire(m_slots[0][idx], outExpired);
+	}
+}
+
+void TimingWheel::Clear()
+{
+	for(auto &level : m_slots) {
+		for(auto &head : level) {
+			while(head.m_next != &head) {
+				auto *node = head.m_next;
+				Unlink(*node);
+				node->m_wheel = nullptr;
+			}
+		}
+	}
+	m_nodeCount = 0;
+	m_levelNodeCounts = {};
+}
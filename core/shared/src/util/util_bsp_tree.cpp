@@ -8,11 +8,15 @@
 #include "stdafx_shared.h"
 #include "pragma/util/util_bsp_tree.hpp"
 #include <udm.hpp>
+#include <mutex>
 
 extern DLLNETWORK Engine *engine;
 
 using namespace util;
 
+BSPTree::BSPTree() : m_clusterVisibilityMutex {std::make_unique<std::mutex>()} {}
+BSPTree::~BSPTree() = default;
+
 std::shared_ptr<BSPTree> BSPTree::Create()
 {
 	auto tree = std::shared_ptr<BSPTree> {new BSPTree {}};
@@ -103,14 +107,46 @@ bool BSPTree::Save(udm::AssetDataArg outData, std::string &outErr)
 	udm["rootNode"] = static_cast<uint32_t>(it - m_nodes.begin());
 	udm["nodes"] = udm::compress_lz4_blob(m_nodes);
 
-	auto &clusterVisibility = GetClusterVisibility();
+	auto &clusterVisibility = static_cast<const BSPTree &>(*this).GetClusterVisibility();
 	udm["clusterVisibility"] = udm::compress_lz4_blob(clusterVisibility);
 	return true;
 }
 
 bool BSPTree::IsValid() const { return m_rootNode < m_nodes.size(); }
+bool BSPTree::IsClusterVisible(const std::vector<uint8_t> &visibilityRow, ClusterIndex clusterDst)
+{
+	auto offset = clusterDst / 8u;
+	return offset < visibilityRow.size() && (visibilityRow[offset] & (1 << (clusterDst % 8u))) > 0u;
+}
 bool BSPTree::IsClusterVisible(uint16_t clusterSrc, uint16_t clusterDst) const
 {
+	// If there is compressed data, it is authoritative. The full matrix may still be in the process of being decompressed by another thread.
+	if(HasCompressedClusterVisibility()) {
+		if(clusterSrc >= m_compressedClusterVisibilityRowOffsets.size() || clusterDst >= m_clusterCount)
+			return false;
+		// Walk the compressed row up to the byte containing the destination bit; Zero-runs are skipped as a whole.
+		// Callers that test many clusters against the same source should use DecompressClusterVisibility instead.
+		auto byteIdx = static_cast<uint64_t>(clusterDst / 8u);
+		auto *p = m_compressedClusterVisibility.data() + m_compressedClusterVisibilityRowOffsets[clusterSrc];
+		auto *end = m_compressedClusterVisibility.data() + m_compressedClusterVisibility.size();
+		uint64_t pos = 0;
+		while(p < end) {
+			if(*p != 0) {
+				if(pos == byteIdx)
+					return (*p & (1 << (clusterDst % 8u))) > 0u;
+				++pos;
+				++p;
+				continue;
+			}
+			if(p + 1 >= end)
+				break;
+			pos += p[1];
+			if(pos > byteIdx)
+				break;
+			p += 2;
+		}
+		return false;
+	}
 	auto bit = static_cast<uint64_t>(clusterSrc) * m_clusterCount + static_cast<uint64_t>(clusterDst);
 	auto offset = bit / 8u;
 	bit %= 8u;
@@ -130,8 +166,10 @@ void BSPTree::UpdateVisibilityBounds(BSPTree::Node &node)
 	auto maxInit = Vector3 {std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
 	node.minVisible = minInit;
 	node.maxVisible = maxInit;
+	std::vector<uint8_t> row;
+	DecompressClusterVisibility(node.cluster, row);
 	for(auto &nodeOther : m_nodes) {
-		if(!nodeOther.leaf || &nodeOther == &node || !IsClusterVisible(node.cluster, nodeOther.cluster))
+		if(!nodeOther.leaf || &nodeOther == &node || !IsClusterVisible(row, nodeOther.cluster))
 			continue;
 		uvec::to_min_max(node.minVisible, node.maxVisible, nodeOther.min, nodeOther.max);
 	}
@@ -144,8 +182,113 @@ const BSPTree::Node &BSPTree::GetRootNode() const { return const_cast<BSPTree *>
 BSPTree::Node &BSPTree::GetRootNode() { return m_nodes[m_rootNode]; }
 const std::vector<BSPTree::Node> &BSPTree::GetNodes() const { return const_cast<BSPTree *>(this)->GetNodes(); }
 std::vector<BSPTree::Node> &BSPTree::GetNodes() { return m_nodes; }
-const std::vector<uint8_t> &BSPTree::GetClusterVisibility() const { return const_cast<BSPTree *>(this)->GetClusterVisibility(); }
-std::vector<uint8_t> &BSPTree::GetClusterVisibility() { return m_clusterVisibility; }
+void BSPTree::SetRootNode(ChildIndex rootNode) { m_rootNode = rootNode; }
+const std::vector<uint8_t> &BSPTree::GetClusterVisibility() const
+{
+	if(!HasCompressedClusterVisibility())
+		return m_clusterVisibility;
+	std::scoped_lock lock {*m_clusterVisibilityMutex};
+	if(m_clusterVisibility.empty()) {
+		auto numBits = m_clusterCount * m_clusterCount;
+		auto &matrix = const_cast<BSPTree *>(this)->m_clusterVisibility;
+		matrix.resize(numBits / 8u + ((numBits % 8u) > 0u ? 1u : 0u), 0u);
+		std::vector<uint8_t> row;
+		for(auto clusterSrc = decltype(m_clusterCount) {0u}; clusterSrc < m_clusterCount; ++clusterSrc) {
+			if(!DecompressClusterVisibility(clusterSrc, row))
+				continue;
+			for(auto clusterDst = decltype(m_clusterCount) {0u}; clusterDst < m_clusterCount; ++clusterDst) {
+				if(!IsClusterVisible(row, clusterDst))
+					continue;
+				auto bit = clusterSrc * m_clusterCount + clusterDst;
+				matrix[bit / 8u] |= 1 << (bit % 8u);
+			}
+		}
+	}
+	return m_clusterVisibility;
+}
+std::vector<uint8_t> &BSPTree::GetClusterVisibility()
+{
+	static_cast<const BSPTree *>(this)->GetClusterVisibility();
+	if(HasCompressedClusterVisibility()) {
+		m_compressedClusterVisibility.clear();
+		m_compressedClusterVisibilityRowOffsets.clear();
+	}
+	return m_clusterVisibility;
+}
+uint64_t BSPTree::GetClusterVisibilityRowSize() const { return m_clusterCount / 8u + ((m_clusterCount % 8u) > 0u ? 1u : 0u); }
+void BSPTree::SetCompressedClusterVisibility(std::vector<uint8_t> &&data, std::vector<uint32_t> &&rowOffsets)
+{
+	m_compressedClusterVisibility = std::move(data);
+	m_compressedClusterVisibilityRowOffsets = std::move(rowOffsets);
+	m_clusterVisibility.clear();
+}
+bool BSPTree::HasCompressedClusterVisibility() const { return !m_compressedClusterVisibility.empty(); }
+const std::vector<uint8_t> &BSPTree::GetCompressedClusterVisibility() const { return m_compressedClusterVisibility; }
+const std::vector<uint32_t> &BSPTree::GetCompressedClusterVisibilityRowOffsets() const { return m_compressedClusterVisibilityRowOffsets; }
+void BSPTree::CompressClusterVisibility(std::vector<uint8_t> &outData, std::vector<uint32_t> &outRowOffsets) const
+{
+	if(HasCompressedClusterVisibility()) {
+		outData = m_compressedClusterVisibility;
+		outRowOffsets = m_compressedClusterVisibilityRowOffsets;
+		return;
+	}
+	auto rowSize = GetClusterVisibilityRowSize();
+	outData.clear();
+	outData.reserve(m_clusterVisibility.size());
+	outRowOffsets.resize(m_clusterCount);
+	std::vector<uint8_t> row(rowSize, 0u);
+	for(auto clusterSrc = decltype(m_clusterCount) {0u}; clusterSrc < m_clusterCount; ++clusterSrc) {
+		std::fill(row.begin(), row.end(), 0u);
+		for(auto clusterDst = decltype(m_clusterCount) {0u}; clusterDst < m_clusterCount; ++clusterDst) {
+			if(IsClusterVisible(clusterSrc, clusterDst))
+				row[clusterDst / 8u] |= 1 << (clusterDst % 8u);
+		}
+		outRowOffsets[clusterSrc] = outData.size();
+		for(auto i = decltype(rowSize) {0u}; i < rowSize;) {
+			if(row[i] != 0u) {
+				outData.push_back(row[i++]);
+				continue;
+			}
+			uint8_t runLength = 0;
+			while(i < rowSize && row[i] == 0u && runLength < std::numeric_limits<uint8_t>::max()) {
+				++runLength;
+				++i;
+			}
+			outData.push_back(0u);
+			outData.push_back(runLength);
+		}
+	}
+}
+bool BSPTree::DecompressClusterVisibility(ClusterIndex clusterSrc, std::vector<uint8_t> &outRow) const
+{
+	auto rowSize = GetClusterVisibilityRowSize();
+	outRow.assign(rowSize, 0u);
+	if(clusterSrc >= m_clusterCount)
+		return false;
+	if(!HasCompressedClusterVisibility()) {
+		for(auto clusterDst = decltype(m_clusterCount) {0u}; clusterDst < m_clusterCount; ++clusterDst) {
+			if(IsClusterVisible(clusterSrc, clusterDst))
+				outRow[clusterDst / 8u] |= 1 << (clusterDst % 8u);
+		}
+		return true;
+	}
+	if(clusterSrc >= m_compressedClusterVisibilityRowOffsets.size())
+		return false;
+	auto *p = m_compressedClusterVisibility.data() + m_compressedClusterVisibilityRowOffsets[clusterSrc];
+	auto *end = m_compressedClusterVisibility.data() + m_compressedClusterVisibility.size();
+	uint64_t pos = 0;
+	while(pos < rowSize && p < end) {
+		if(*p != 0) {
+			outRow[pos++] = *(p++);
+			continue;
+		}
+		if(p + 1 >= end)
+			return false;
+		pos += p[1];
+		p += 2;
+	}
+	return true;
+}
 uint64_t BSPTree::GetClusterCount() const { return m_clusterCount; }
 void BSPTree::SetClusterCount(uint64_t numClusters) { m_clusterCount = numClusters; }
 
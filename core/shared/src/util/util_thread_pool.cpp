@@ -8,27 +8,53 @@
 #include "stdafx_shared.h"
 #include "pragma/lua/custom_constructor.hpp"
 #include "pragma/util/util_thread_pool.hpp"
-
+#include "pragma/engine.h"
 
 pragma::ThreadPool::ThreadPool(uint32_t threadCount) : ThreadPool {threadCount, ""} {}
-pragma::ThreadPool::ThreadPool(uint32_t threadCount, const std::string &name, const std::string &baseName) : m_pool {static_cast<int>(threadCount)}
+pragma::ThreadPool::ThreadPool(uint32_t threadCount, const std::string &name, const std::string &baseName) : m_jobSystem {pragma::get_engine()->GetJobSystem()}, m_threadCount {std::max(threadCount, 1u)}
+{
+	// Pools are grouped by their base name, so the number of subsystems doesn't depend on the number of pools.
+	// Tasks may run arbitrary (e.g. Lua) code, so threads waiting on other work must not pick them up.
+	m_subsystem = m_jobSystem.RegisterSubsystem({"thread_pool_" + baseName, JobSystem::Priority::Normal, JobSystem::ALL_WORKERS, false});
+}
+
+pragma::ThreadPool::~ThreadPool()
 {
-	auto n = m_pool.size();
-	std::string fullName = baseName;
-	if(!name.empty())
-		fullName += '_' + name;
-	for(auto i = decltype(n) {0u}; i < n; ++i)
-		util::set_thread_name(m_pool.get_thread(i), fullName);
+	// Tasks which are still running reference this pool
+	Stop(true);
 }
 
-void pragma::ThreadPool::Stop(bool execRemainingQueue) { m_pool.stop(execRemainingQueue); }
+void pragma::ThreadPool::Stop(bool execRemainingQueue)
+{
+	{
+		std::scoped_lock lock {m_mutex};
+		m_stopped = true;
+		if(execRemainingQueue)
+			SubmitQueuedTasks();
+		else {
+			for(auto &queuedTask : m_queue) {
+				if(!queuedTask.barrier)
+					CompleteTask(queuedTask.taskId, nullptr);
+			}
+			m_queue.clear();
+		}
+	}
+	WaitForCompletion();
+}
 
 void pragma::ThreadPool::PushResults(uint32_t taskId)
 {
-	std::scoped_lock slock {m_taskCompletedMutex};
-	if(taskId >= m_taskCompleted.size() || m_taskCompleted[taskId].isComplete == false || m_taskCompleted[taskId].resultHandler == nullptr)
-		return;
-	m_taskCompleted[taskId].resultHandler();
+	ResultHandler resultHandler = nullptr;
+	{
+		std::scoped_lock lock {m_mutex};
+		auto it = m_taskStates.find(taskId);
+		if(it == m_taskStates.end() || it->second.isComplete == false)
+			return;
+		resultHandler = std::move(it->second.resultHandler);
+		m_taskStates.erase(it);
+	}
+	if(resultHandler)
+		resultHandler();
 }
 
 void pragma::ThreadPool::BatchProcess(uint32_t numJobs, uint32_t numItemsPerJob, const std::function<ResultHandler(uint32_t, uint32_t)> &f)
@@ -47,35 +73,81 @@ void pragma::ThreadPool::WaitForCompletion() { return WaitForPendingCount(0); }
 
 void pragma::ThreadPool::WaitForPendingCount(uint32_t count)
 {
-	if(GetPendingTaskCount() <= count)
-		return;
-	auto ul = std::unique_lock<std::mutex>(m_taskCompletedMutex);
-	m_taskCompleteCondition.wait(ul, [this, count]() { return GetPendingTaskCount() <= count; });
+	// Instead of blocking, the calling thread helps with the pending jobs
+	m_jobSystem.WaitUntil([this, count]() { return GetPendingTaskCount() <= count; }, m_subsystem);
+	// The mutex has to be acquired even if the count has already been reached, since the last task may still be holding it
+	std::scoped_lock lock {m_mutex};
 }
 
 bool pragma::ThreadPool::IsComplete(uint32_t taskId) const
 {
-	std::scoped_lock slock {m_taskCompletedMutex};
-	return (taskId < m_taskCompleted.size()) ? m_taskCompleted[taskId].isComplete : false;
+	std::scoped_lock lock {m_mutex};
+	if(taskId >= m_totalTaskCount)
+		return false;
+	auto it = m_taskStates.find(taskId);
+	return (it != m_taskStates.end()) ? it->second.isComplete : true;
 }
 
-void pragma::ThreadPool::AddBarrier() { m_pool.barrier(); }
+void pragma::ThreadPool::AddBarrier()
+{
+	std::scoped_lock lock {m_mutex};
+	QueuedTask barrier {};
+	barrier.barrier = true;
+	m_queue.push_back(std::move(barrier));
+}
 
 uint32_t pragma::ThreadPool::AddTask(const std::function<ResultHandler()> &task)
 {
+	std::scoped_lock lock {m_mutex};
 	auto taskId = m_totalTaskCount++;
-	if(m_totalTaskCount >= m_taskCompleted.size()) {
-		std::scoped_lock slock {m_taskCompletedMutex};
-		m_taskCompleted.resize(m_totalTaskCount);
+	if(m_stopped) {
+		CompleteTask(taskId, nullptr);
+		return taskId;
 	}
-	m_pool.push([this, task, taskId](int id) {
-		auto resultHandler = task ? task() : nullptr;
-		++m_completedTaskCount;
-
-		std::scoped_lock slock {m_taskCompletedMutex};
-		m_taskCompleted[taskId].resultHandler = std::move(resultHandler);
-		m_taskCompleted[taskId].isComplete = true;
-		m_taskCompleteCondition.notify_one();
-	});
+	m_taskStates[taskId] = {};
+	m_queue.push_back({taskId, task});
+	SubmitQueuedTasks();
 	return taskId;
 }
+
+void pragma::ThreadPool::SubmitQueuedTasks()
+{
+	while(!m_queue.empty() && m_runningTaskCount < m_threadCount) {
+		auto &front = m_queue.front();
+		if(front.barrier) {
+			if(m_runningTaskCount > 0)
+				break;
+			m_queue.pop_front();
+			continue;
+		}
+		auto queuedTask = std::move(front);
+		m_queue.pop_front();
+		++m_runningTaskCount;
+		m_jobSystem.Schedule([this, taskId = queuedTask.taskId, task = std::move(queuedTask.task)]() { RunTask(taskId, task); }, m_subsystem);
+	}
+}
+
+void pragma::ThreadPool::CompleteTask(uint32_t taskId, ResultHandler resultHandler)
+{
+	// Tasks without results don't need to be tracked anymore, IsComplete treats unknown task ids as complete
+	if(resultHandler == nullptr)
+		m_taskStates.erase(taskId);
+	else {
+		auto &state = m_taskStates[taskId];
+		state.isComplete = true;
+		state.resultHandler = std::move(resultHandler);
+	}
+	++m_completedTaskCount;
+	// Tasks may also be completed outside of a job (e.g. if the pool has been stopped)
+	m_jobSystem.NotifyWaiters();
+}
+
+void pragma::ThreadPool::RunTask(uint32_t taskId, const std::function<ResultHandler()> &task)
+{
+	auto resultHandler = task ? task() : nullptr;
+
+	std::scoped_lock lock {m_mutex};
+	--m_runningTaskCount;
+	CompleteTask(taskId, std::move(resultHandler));
+	SubmitQueuedTasks();
+}